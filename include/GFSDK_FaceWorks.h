@@ -181,13 +181,14 @@
 // =================================================================================
 
 /// Header version number - used to check that the header matches the DLL.
-#define GFSDK_FaceWorks_HeaderVersion 100
+#define GFSDK_FaceWorks_HeaderVersion 200
 
 /// Retrieves the version number of the .dll actually being used
 /// \return the binary version as an integer (version is multiplied by 100)
 GFSDK_FACEWORKS_API int GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GetBinaryVersion();
 
 /// Retrive baked-in build info string (branch, date/time, versions, etc.)
+/// Also reports which SIMD instruction set the precomputation code selected for this CPU.
 ///
 /// \return a null-terminated char string containing the build information
 GFSDK_FACEWORKS_API const char * GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GetBuildInfo();
@@ -205,6 +206,8 @@ typedef enum
 	GFSDK_FaceWorks_InvalidArgument,		///< A required argument is NULL, or not in the valid range
 	GFSDK_FaceWorks_OutOfMemory,			///< Couldn't allocate memory
 	GFSDK_FaceWorks_VersionMismatch,		///< Header version doesn't match DLL version
+	GFSDK_FaceWorks_Aborted,				///< The caller's callback asked for the operation to stop
+	GFSDK_FaceWorks_FileError,				///< Couldn't create, write or map a file
 } GFSDK_FaceWorks_Result;
 
 /// \brief Error blob, for returning verbose error messages.
@@ -240,6 +243,34 @@ inline GFSDK_FaceWorks_Result GFSDK_FaceWorks_Init() {
 
 
 
+// =================================================================================
+//	Parallel execution
+// =================================================================================
+
+/// Task function passed to a parallel-for implementation.
+///
+/// \param pTaskData			[in] opaque pointer passed through from the parallel-for call
+/// \param iTask				[in] index of the task to run, in [0, taskCount)
+typedef void (*GFSDK_FaceWorks_TaskFunc)(void * pTaskData, int iTask);
+
+/// \brief Parameters for running precomputation work on multiple threads.
+/// \details Functions that accept this struct split their work into independent tasks.  If
+/// m_parallelFor is set, the tasks are handed to it, so they can run on the caller's own job
+/// system; it must call pfnTask(pTaskData, iTask) exactly once for each iTask in
+/// [0, taskCount), on any threads and in any order, and return only once all of them have
+/// finished.  Otherwise FaceWorks runs the tasks on an internal pool of m_workerCount threads.
+/// Passing a null pointer for this struct runs everything serially on the calling thread.
+/// Results are identical regardless of how the work is distributed.
+typedef struct
+{
+	int					m_workerCount;		///< Number of worker threads (0 = one per hardware thread, 1 = serial)
+	void				(*m_parallelFor)(void * pUserData, int taskCount, GFSDK_FaceWorks_TaskFunc pfnTask, void * pTaskData);
+											///< [optional] Caller's parallel-for implementation
+	void *				m_pUserData;		///< [optional] Passed through to m_parallelFor
+} GFSDK_FaceWorks_ParallelConfig;
+
+
+
 // =================================================================================
 //	Building mesh data for SSS
 // =================================================================================
@@ -255,8 +286,11 @@ GFSDK_FACEWORKS_API size_t GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateCur
 /// Generate per-vertex curvature for SSS.
 /// The positions and normals of the mesh are assumed to be in float3 format and the
 /// curvature is written out as a single float per vertex.
-/// Indices are assumed to be 32-bit ints.
-/// One or more smoothing passes can also be done on the calculated curvatures.
+/// Indices are assumed to be 32-bit ints, and must be in [0, vertexCount).
+/// Each edge's curvature is calculated once, from the mesh's unique edges.
+/// One or more smoothing passes can also be done on the calculated curvatures; each pass
+/// averages every vertex's neighbors from a neighbor list built once per call, and the
+/// vertices can be spread over threads.  pCurvaturesOut is only written once, at the end.
 ///
 /// \param vertexCount			[in] the vertex count
 /// \param pPositions			[in] pointer to the positions (per-vertex)
@@ -272,12 +306,14 @@ GFSDK_FACEWORKS_API size_t GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateCur
 ///								Error messages will be stored in the error blob, if one is given;
 ///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
 ///								to free the storage.
-///								The given allocator will be used to allocate temporary storage for
+/// \param pAllocator			[in] the given allocator will be used to allocate temporary storage for
 ///								working data, if provided; if not, the standard CRT allocator will
 ///								be used.
+/// \param pParallelConfig		[in] how to distribute the smoothing passes' vertices over threads;
+///								if null, the curvatures are calculated serially on the calling thread.
 ///
 /// \return						GFSDK_FaceWorks_OK if parameters are correct
-/// 							GFSDK_FaceWorks_InvalidArgument if pConfig contains invalid values
+/// 							GFSDK_FaceWorks_InvalidArgument if any parameter contains invalid values
 GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateMeshCurvature(
 												int vertexCount,
 												const void * pPositions,
@@ -290,7 +326,80 @@ GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWo
 												void * pCurvaturesOut,
 												int curvatureStrideBytes,
 												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
-												gfsdk_new_delete_t * pAllocator);
+												gfsdk_new_delete_t * pAllocator,
+												const GFSDK_FaceWorks_ParallelConfig * pParallelConfig);
+
+/// Number of bins in the histogram of GFSDK_FaceWorks_CurvatureStats
+#define GFSDK_FaceWorks_CurvatureHistogramBinCount 256
+
+/// Bins per doubling of curvature in the histogram of GFSDK_FaceWorks_CurvatureStats
+#define GFSDK_FaceWorks_CurvatureHistogramBinsPerOctave 8
+
+/// log2 of the curvature at the bottom edge of bin 1 of the histogram of GFSDK_FaceWorks_CurvatureStats
+#define GFSDK_FaceWorks_CurvatureHistogramMinLog2 (-16)
+
+/// \brief Statistics of a mesh's per-vertex curvatures, used to fit the range of the curvature LUT.
+/// \details Curvatures are in units of 1 / world units, as written by GFSDK_FaceWorks_CalculateMeshCurvature().
+/// Histogram bin i counts the curvatures in [2^(MinLog2 + (i - 1) / BinsPerOctave), 2^(MinLog2 + i / BinsPerOctave)),
+/// using the constants above; bin 0 also counts everything below 2^MinLog2, including flat areas,
+/// and the last bin everything above its lower edge.  The bins are the same for every mesh, so the
+/// histograms of several meshes can be summed to get the statistics of all of them together.
+typedef struct
+{
+	int			m_vertexCount;				///< Number of vertices the statistics cover
+	float		m_curvatureMin;				///< Smallest curvature
+	float		m_curvatureMax;				///< Largest curvature
+	float		m_curvatureMean;			///< Mean curvature
+	float		m_curvatureP1;				///< 1st percentile of curvature
+	float		m_curvatureP5;				///< 5th percentile of curvature
+	float		m_curvatureMedian;			///< Median curvature
+	float		m_curvatureP95;				///< 95th percentile of curvature
+	float		m_curvatureP99;				///< 99th percentile of curvature
+	int			m_histogram[GFSDK_FaceWorks_CurvatureHistogramBinCount];	///< Vertex count in each bin (see above)
+} GFSDK_FaceWorks_CurvatureStats;
+
+/// Generate per-vertex curvature for SSS, like GFSDK_FaceWorks_CalculateMeshCurvature(), and also
+/// gather statistics of the smoothed curvatures, in the same call.  Pass the statistics of one or
+/// more meshes to GFSDK_FaceWorks_FitCurvatureLUTRange() to fit the curvature LUT to them.
+///
+/// \param vertexCount			[in] the vertex count
+/// \param pPositions			[in] pointer to the positions (per-vertex)
+/// \param positionStrideBytes	[in] distance, in bytes, between two positions in the pPosition buffer
+/// \param pNormals				[in] pointer to the normals (per-vertex)
+/// \param normalStrideBytes	[in] distance, in bytes, between two normals in the pNormal buffer
+/// \param indexCount			[in] the index count
+/// \param pIndices				[in] pointer to the indices buffer
+/// \param smoothingPassCount	[in] number of smoothing passes applied to the curvatures
+/// \param pCurvaturesOut		[out] pointer to the curvatures buffer (written by this function)
+/// \param curvatureStrideBytes	[in] distance, in bytes, between two curvatures in the pCurvaturesOut
+/// \param pStatsOut			[out] the statistics of the curvatures written to pCurvaturesOut
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+/// \param pAllocator			[in] the given allocator will be used to allocate temporary storage for
+///								working data, if provided; if not, the standard CRT allocator will
+///								be used.
+/// \param pParallelConfig		[in] how to distribute the smoothing passes' vertices over threads;
+///								if null, the curvatures are calculated serially on the calling thread.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if any parameter contains invalid values
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateMeshCurvatureWithStats(
+												int vertexCount,
+												const void * pPositions,
+												int positionStrideBytes,
+												const void * pNormals,
+												int normalStrideBytes,
+												int indexCount,
+												const int * pIndices,
+												int smoothingPassCount,
+												void * pCurvaturesOut,
+												int curvatureStrideBytes,
+												GFSDK_FaceWorks_CurvatureStats * pStatsOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+												gfsdk_new_delete_t * pAllocator,
+												const GFSDK_FaceWorks_ParallelConfig * pParallelConfig);
 
 /// Calculate average UV scale.
 /// The positions and UVs of the mesh are assumed to be in float3 and float2 format,
@@ -326,12 +435,419 @@ GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWo
 												float * pAverageUVScaleOut,
 												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut);
 
+/// \brief A mesh's topology, cached so it can be reused by several precomputation calls.
+/// \details It's opaque; create one with GFSDK_FaceWorks_CreateMeshContext(), pass it to the
+/// FromContext functions, and release it with GFSDK_FaceWorks_ReleaseMeshContext().  It holds the
+/// mesh's unique edges, each vertex's neighbors, a map welding the vertices that share a position,
+/// and per-triangle data from the positions it was created with.  The FromContext functions
+/// can be called on several threads at once with the same context.
+typedef struct GFSDK_FaceWorks_MeshContext GFSDK_FaceWorks_MeshContext;
+
+/// \brief Statistics of a mesh context.
+typedef struct
+{
+	int			m_vertexCount;				///< Number of vertices
+	int			m_triCount;					///< Number of triangles
+	int			m_edgeCount;				///< Number of unique edges (between welded vertices, if welded)
+	int			m_boundaryEdgeCount;		///< Number of those edges used by only one triangle
+	int			m_weldedVertexCount;		///< Number of distinct vertex positions
+	int			m_isWelded;					///< Nonzero if the topology joins vertices that share a position
+	size_t		m_sizeBytes;				///< Memory held by the context
+} GFSDK_FaceWorks_MeshContextInfo;
+
+/// Build a mesh context from a mesh's positions and indices, for the FromContext functions.
+/// The positions are assumed to be in float3 format; indices are assumed to be 32-bit ints, and
+/// must be in [0, vertexCount).  The positions are only read by this function, to weld the
+/// vertices and for the per-triangle data used by GFSDK_FaceWorks_CalculateMeshUVScaleFromContext().
+///
+/// \param vertexCount			[in] the vertex count
+/// \param pPositions			[in] pointer to the positions (per-vertex)
+/// \param positionStrideBytes	[in] distance, in bytes, between two positions in the pPosition buffer
+/// \param indexCount			[in] the index count; a multiple of 3
+/// \param pIndices				[in] pointer to the indices buffer
+/// \param weldPositions		[in] nonzero to join the vertices that share a position (compared
+///								bitwise) in the topology, so curvature is continuous across UV seams
+///								and other splits in the mesh.  Each vertex then gets the curvature
+///								calculated from the positions and normals of the lowest-numbered
+///								vertex at its position.
+/// \param ppContextOut			[out] the context; release it with GFSDK_FaceWorks_ReleaseMeshContext()
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+/// \param pAllocator			[in] the given allocator will be used to allocate the context, and
+///								temporary storage for working data in the calls that use it, if
+///								provided; if not, the standard CRT allocator will be used.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if any parameter contains invalid values
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CreateMeshContext(
+												int vertexCount,
+												const void * pPositions,
+												int positionStrideBytes,
+												int indexCount,
+												const int * pIndices,
+												int weldPositions,
+												GFSDK_FaceWorks_MeshContext ** ppContextOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+												gfsdk_new_delete_t * pAllocator);
+
+/// Get the statistics of a mesh context.
+///
+/// \param pContext				[in] the mesh context
+/// \param pInfoOut				[out] the statistics
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if pContext or pInfoOut is null
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GetMeshContextInfo(
+												const GFSDK_FaceWorks_MeshContext * pContext,
+												GFSDK_FaceWorks_MeshContextInfo * pInfoOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut);
+
+/// Get a mesh context's welded-position map: for each vertex, the lowest-numbered vertex at the
+/// same position.  It's built whether or not the context's topology is welded.
+///
+/// \param pContext				[in] the mesh context
+/// \param pWeldedVertsOut		[out] buffer of vertexCount ints to write the map to
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if pContext or pWeldedVertsOut is null
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GetMeshContextWeldedVerts(
+												const GFSDK_FaceWorks_MeshContext * pContext,
+												int * pWeldedVertsOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut);
+
+/// Generate per-vertex curvature for SSS, like GFSDK_FaceWorks_CalculateMeshCurvature(), using the
+/// topology cached in a mesh context.  The positions and normals can be any pose of the mesh, such
+/// as a blendshape; for an unwelded context, the curvatures are the same as from
+/// GFSDK_FaceWorks_CalculateMeshCurvature() with the context's indices.
+///
+/// \param pContext				[in] the mesh context
+/// \param pPositions			[in] pointer to the positions (per-vertex)
+/// \param positionStrideBytes	[in] distance, in bytes, between two positions in the pPosition buffer
+/// \param pNormals				[in] pointer to the normals (per-vertex)
+/// \param normalStrideBytes	[in] distance, in bytes, between two normals in the pNormal buffer
+/// \param smoothingPassCount	[in] number of smoothing passes applied to the curvatures
+/// \param pCurvaturesOut		[out] pointer to the curvatures buffer (written by this function)
+/// \param curvatureStrideBytes	[in] distance, in bytes, between two curvatures in the pCurvaturesOut
+/// \param pStatsOut			[out] the statistics of the curvatures written to pCurvaturesOut, as
+///								from GFSDK_FaceWorks_CalculateMeshCurvatureWithStats(); may be null
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+/// \param pParallelConfig		[in] how to distribute the smoothing passes' vertices over threads;
+///								if null, the curvatures are calculated serially on the calling thread.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if any parameter contains invalid values
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateMeshCurvatureFromContext(
+												const GFSDK_FaceWorks_MeshContext * pContext,
+												const void * pPositions,
+												int positionStrideBytes,
+												const void * pNormals,
+												int normalStrideBytes,
+												int smoothingPassCount,
+												void * pCurvaturesOut,
+												int curvatureStrideBytes,
+												GFSDK_FaceWorks_CurvatureStats * pStatsOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+												const GFSDK_FaceWorks_ParallelConfig * pParallelConfig);
+
+/// Calculate average UV scale, like GFSDK_FaceWorks_CalculateMeshUVScale(), using the triangles
+/// cached in a mesh context and their sizes at the positions the context was created with.
+///
+/// \param pContext				[in] the mesh context
+/// \param pUVs					[in] pointer to the UV coordinates (per-vertex)
+/// \param uvStrideBytes		[in] distance, in bytes, between two UV coordinates in the pUVs buffer
+/// \param pAverageUVScaleOut	[out] pointer to a float where the average UV scale will be stored
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if any parameter contains invalid values
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateMeshUVScaleFromContext(
+												const GFSDK_FaceWorks_MeshContext * pContext,
+												const void * pUVs,
+												int uvStrideBytes,
+												float * pAverageUVScaleOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut);
+
+/// Release a mesh context.
+///
+/// \param pContext				[in] the mesh context; may be null
+GFSDK_FACEWORKS_API void GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_ReleaseMeshContext(
+												GFSDK_FaceWorks_MeshContext * pContext);
+
+/// \brief Curvatures of a deforming mesh, kept so they can be updated when some vertices move.
+/// \details It's opaque; create one with GFSDK_FaceWorks_BeginIncrementalCurvature(), update it
+/// with GFSDK_FaceWorks_UpdateIncrementalCurvature(), and release it with
+/// GFSDK_FaceWorks_ReleaseIncrementalCurvature().  It holds the curvatures before each smoothing
+/// pass, vertexCount floats per pass, and refers to the mesh context it was created from, which
+/// must outlive it.  Updates change it, so it can't be updated on several threads at once.
+typedef struct GFSDK_FaceWorks_IncrementalCurvature GFSDK_FaceWorks_IncrementalCurvature;
+
+/// Generate per-vertex curvature for SSS, like GFSDK_FaceWorks_CalculateMeshCurvatureFromContext(),
+/// and keep what's needed to update the curvatures when some of the vertices move.
+///
+/// \param pContext				[in] the mesh context; must outlive the incremental curvature
+/// \param pPositions			[in] pointer to the positions (per-vertex)
+/// \param positionStrideBytes	[in] distance, in bytes, between two positions in the pPosition buffer
+/// \param pNormals				[in] pointer to the normals (per-vertex)
+/// \param normalStrideBytes	[in] distance, in bytes, between two normals in the pNormal buffer
+/// \param smoothingPassCount	[in] number of smoothing passes applied to the curvatures
+/// \param pCurvaturesOut		[out] pointer to the curvatures buffer (written by this function)
+/// \param curvatureStrideBytes	[in] distance, in bytes, between two curvatures in the pCurvaturesOut
+/// \param ppIncrementalOut		[out] the incremental curvature; release it with
+///								GFSDK_FaceWorks_ReleaseIncrementalCurvature()
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+/// \param pParallelConfig		[in] how to distribute the smoothing passes' vertices over threads;
+///								if null, the curvatures are calculated serially on the calling thread.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if any parameter contains invalid values
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_BeginIncrementalCurvature(
+												const GFSDK_FaceWorks_MeshContext * pContext,
+												const void * pPositions,
+												int positionStrideBytes,
+												const void * pNormals,
+												int normalStrideBytes,
+												int smoothingPassCount,
+												void * pCurvaturesOut,
+												int curvatureStrideBytes,
+												GFSDK_FaceWorks_IncrementalCurvature ** ppIncrementalOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+												const GFSDK_FaceWorks_ParallelConfig * pParallelConfig);
+
+/// Update curvatures after some of the mesh's vertices have moved.  Only the curvatures that can
+/// change are recalculated and written: those of the moved vertices and their neighbors, and then
+/// one ring further for each smoothing pass.  The result is the same as recalculating the whole
+/// mesh with GFSDK_FaceWorks_CalculateMeshCurvatureFromContext(), up to rounding.
+///
+/// \param pIncremental			[in] the incremental curvature
+/// \param pPositions			[in] pointer to all the positions (per-vertex), after the move
+/// \param positionStrideBytes	[in] distance, in bytes, between two positions in the pPosition buffer
+/// \param pNormals				[in] pointer to all the normals (per-vertex), after the move
+/// \param normalStrideBytes	[in] distance, in bytes, between two normals in the pNormal buffer
+/// \param movedVertexCount		[in] number of vertices whose position or normal changed
+/// \param pMovedVerts			[in] the indices of those vertices, in [0, vertexCount).  For a welded
+///								context, moving any vertex at a welded position counts as moving
+///								the lowest-numbered one, whose position and normal are used.
+/// \param pCurvaturesInOut		[in,out] pointer to the curvatures buffer from the last call; the
+///								curvatures that changed are written
+/// \param curvatureStrideBytes	[in] distance, in bytes, between two curvatures in the pCurvaturesInOut
+/// \param pUpdatedVertexCountOut	[out] number of curvatures written; may be null
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+/// \param pParallelConfig		[in] how to distribute the updated vertices over threads;
+///								if null, the curvatures are calculated serially on the calling thread.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if any parameter contains invalid values
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_UpdateIncrementalCurvature(
+												GFSDK_FaceWorks_IncrementalCurvature * pIncremental,
+												const void * pPositions,
+												int positionStrideBytes,
+												const void * pNormals,
+												int normalStrideBytes,
+												int movedVertexCount,
+												const int * pMovedVerts,
+												void * pCurvaturesInOut,
+												int curvatureStrideBytes,
+												int * pUpdatedVertexCountOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+												const GFSDK_FaceWorks_ParallelConfig * pParallelConfig);
+
+/// Release an incremental curvature.
+///
+/// \param pIncremental			[in] the incremental curvature; may be null
+GFSDK_FACEWORKS_API void GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_ReleaseIncrementalCurvature(
+												GFSDK_FaceWorks_IncrementalCurvature * pIncremental);
+
+/// \brief A morph target (blendshape), as the sparse offsets it applies to a base mesh.
+typedef struct
+{
+	int				m_vertexCount;			///< Number of vertices the target moves
+	const int *		m_pVerts;				///< Indices of those vertices, in [0, vertexCount)
+	const float *	m_pPositionDeltas;		///< Per moved vertex: float3 offset from the base position
+	const float *	m_pNormalDeltas;		///< Per moved vertex: float3 offset from the base normal; may be null
+} GFSDK_FaceWorks_MorphTarget;
+
+/// \brief Sparse per-target curvature deltas, from GFSDK_FaceWorks_BakeCurvatureDeltas().
+/// \details It's opaque; read each target's deltas with GFSDK_FaceWorks_GetCurvatureDeltas(), and
+/// release it with GFSDK_FaceWorks_ReleaseCurvatureDeltas().
+typedef struct GFSDK_FaceWorks_CurvatureDeltas GFSDK_FaceWorks_CurvatureDeltas;
+
+/// Generate the change in per-vertex curvature that each of a set of morph targets makes to a base
+/// mesh, so curvature can be blended at runtime along with the positions and normals.  Each
+/// target's curvatures are those GFSDK_FaceWorks_CalculateMeshCurvatureFromContext() would give
+/// for the base mesh with the target's offsets added (the normals aren't renormalized), but only
+/// the moved vertices and the rings of neighbors their curvature spreads to are recalculated.
+/// The targets are spread over threads.
+///
+/// \param pContext				[in] the mesh context
+/// \param pPositions			[in] pointer to the base positions (per-vertex)
+/// \param positionStrideBytes	[in] distance, in bytes, between two positions in the pPosition buffer
+/// \param pNormals				[in] pointer to the base normals (per-vertex)
+/// \param normalStrideBytes	[in] distance, in bytes, between two normals in the pNormal buffer
+/// \param smoothingPassCount	[in] number of smoothing passes applied to the curvatures
+/// \param targetCount			[in] number of morph targets
+/// \param pTargets				[in] the morph targets.  For a welded context, only the offsets of the
+///								lowest-numbered vertex at each welded position are used.
+/// \param deltaThreshold		[in] only curvature deltas with a magnitude above this are kept;
+///								0 keeps every one that isn't exactly zero
+/// \param pBaseCurvaturesOut	[out] pointer to a buffer for the base mesh's curvatures; may be null
+/// \param curvatureStrideBytes	[in] distance, in bytes, between two curvatures in the pBaseCurvaturesOut
+/// \param ppDeltasOut			[out] the curvature deltas; release them with
+///								GFSDK_FaceWorks_ReleaseCurvatureDeltas()
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+/// \param pParallelConfig		[in] how to distribute the targets over threads; if null, they're
+///								calculated serially on the calling thread.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if any parameter contains invalid values
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_BakeCurvatureDeltas(
+												const GFSDK_FaceWorks_MeshContext * pContext,
+												const void * pPositions,
+												int positionStrideBytes,
+												const void * pNormals,
+												int normalStrideBytes,
+												int smoothingPassCount,
+												int targetCount,
+												const GFSDK_FaceWorks_MorphTarget * pTargets,
+												float deltaThreshold,
+												void * pBaseCurvaturesOut,
+												int curvatureStrideBytes,
+												GFSDK_FaceWorks_CurvatureDeltas ** ppDeltasOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+												const GFSDK_FaceWorks_ParallelConfig * pParallelConfig);
+
+/// Get one morph target's curvature deltas: the vertices whose curvature it changes by more than
+/// the threshold, in increasing order, and the change in each.  The arrays belong to pDeltas.
+///
+/// \param pDeltas				[in] the curvature deltas
+/// \param iTarget				[in] index of the target, in [0, targetCount)
+/// \param pDeltaCountOut		[out] number of deltas
+/// \param ppVertsOut			[out] pointer to the vertex of each delta; null if there are none
+/// \param ppDeltasOut			[out] pointer to the deltas; null if there are none
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if any parameter contains invalid values
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GetCurvatureDeltas(
+												const GFSDK_FaceWorks_CurvatureDeltas * pDeltas,
+												int iTarget,
+												int * pDeltaCountOut,
+												const int ** ppVertsOut,
+												const float ** ppDeltasOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut);
+
+/// Release curvature deltas.
+///
+/// \param pDeltas				[in] the curvature deltas; may be null
+GFSDK_FACEWORKS_API void GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_ReleaseCurvatureDeltas(
+												GFSDK_FaceWorks_CurvatureDeltas * pDeltas);
+
 
 
 // =================================================================================
 //	Building lookup textures for SSS
 // =================================================================================
 
+/// \brief Methods for integrating the diffusion profile when building the LUTs.
+typedef enum
+{
+	GFSDK_FaceWorks_LUTIntegration_Midpoint,		///< Evenly spaced samples across the profile, summed for every texel.
+													///< The sample count is per texel (default 200, max 512).  In the curvature
+													///< LUT, texels whose profile falls on one side of the terminator (all but its
+													///< far tails) are computed in closed form instead.
+	GFSDK_FaceWorks_LUTIntegration_Piecewise,		///< Each Gaussian in the profile is integrated separately, split at the kinks
+													///< of the lighting function, using running-integral tables interpolated
+													///< at a handful of points per texel.  Meant for accuracy, not speed: it
+													///< costs about twice as much per texel as the default.  The sample count is
+													///< the number of table cells per Gaussian (default 48, range 8 to 64).
+	GFSDK_FaceWorks_LUTIntegration_Analytic,		///< Shadow LUT only: each texel is evaluated in closed form, using erf and
+													///< the Gaussian's moments, in single precision with SIMD across texels.
+													///< The sample count is ignored.
+	GFSDK_FaceWorks_LUTIntegration_Convolution,		///< Curvature LUT only: each row is a convolution of the lighting with the profile
+													///< around the circle, done with running sums over evenly spaced bins of angle, so
+													///< each texel costs the same however wide the profile is.  The sample count is the
+													///< number of bins, a multiple of 4 (default 512, range 64 to 16384).
+} GFSDK_FaceWorks_LUTIntegrationMode;
+
+/// \brief Pixel formats the LUTs can be generated in.  Texels are stored in left-to-right,
+/// top-to-bottom order, tightly packed, with multi-byte values in little-endian order.
+/// The shadow LUT stores the same values in every format.  The curvature LUT's encoding depends on the
+/// format, as described at GFSDK_FaceWorks_GenerateCurvatureLUT, so shaders that sample it must define
+/// GFSDK_FaceWorks_CurvatureLUTDecode to match (see GFSDK_FaceWorks.hlsli).
+typedef enum
+{
+	GFSDK_FaceWorks_LUTFormat_RGBA8,				///< 8-bit unorm RGBA with alpha 255, 4 bytes per texel
+													///< (default; DXGI_FORMAT_R8G8B8A8_UNORM or _UNORM_SRGB).
+	GFSDK_FaceWorks_LUTFormat_RGB8,					///< 8-bit unorm RGB, 3 bytes per texel, for file formats and
+													///< APIs that take packed RGB.
+	GFSDK_FaceWorks_LUTFormat_R11G11B10F,			///< Unsigned 11/11/10-bit floats, 4 bytes per texel
+													///< (DXGI_FORMAT_R11G11B10_FLOAT).
+	GFSDK_FaceWorks_LUTFormat_RGB9E5,				///< Unsigned 9-bit mantissas with a shared 5-bit exponent, 4 bytes
+													///< per texel (DXGI_FORMAT_R9G9B9E5_SHAREDEXP).
+	GFSDK_FaceWorks_LUTFormat_RGBA16F,				///< Half-precision floats with alpha 1, 8 bytes per texel
+													///< (DXGI_FORMAT_R16G16B16A16_FLOAT).
+	GFSDK_FaceWorks_LUTFormat_RGB565,				///< 5/6/5-bit unorm, red in the high bits, 2 bytes per texel
+													///< (DXGI_FORMAT_B5G6R5_UNORM).
+} GFSDK_FaceWorks_LUTFormat;
+
+/// Calculate the size of one texel of a LUT in the given format.
+///
+/// \param format				[in] the LUT's pixel format
+///
+/// \return						the texel size in bytes, or 0 if the format isn't valid
+GFSDK_FACEWORKS_API size_t GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateLUTTexelSizeBytes(
+												GFSDK_FaceWorks_LUTFormat format);
+
+/// \brief Receiver for LUT rows, used to generate a LUT a block of rows at a time without
+/// holding all of it in memory.
+/// \details The generator fills one block of rows (in parallel, if a parallel config is given),
+/// then passes it to m_pfnRows on the calling thread, and so on from top to bottom.  The block's
+/// texels are in the LUT's format, tightly packed, and are only valid for the duration of the call.
+typedef struct
+{
+	int					(*m_pfnRows)(void * pUserData, int iRowBegin, int rowCount, const void * pRows);
+											///< Called with each finished block; return nonzero to continue,
+											///< or 0 to stop generating the LUT
+	void *				m_pUserData;		///< [optional] Passed through to m_pfnRows
+	int					m_blockRowCount;	///< Rows per block, or 0 to use blocks of about 4 MB
+} GFSDK_FaceWorks_LUTRowSink;
+
+/// \brief Estimated accuracy of a LUT configuration, compared to a high-quality reference.
+/// Errors are in normalized texel values, before conversion to integer format;
+/// multiply by 255 to get units of 8-bit LSBs.
+typedef struct
+{
+	float		m_maxError;					///< Largest error of any texel channel that was tested
+	float		m_rmsError;					///< Root-mean-square error over the texel channels that were tested
+} GFSDK_FaceWorks_LUTErrorEstimate;
+
 /// \brief Parameters for building curvature lookup texture (LUT) for SSS.
 typedef struct
 {
@@ -340,6 +856,9 @@ typedef struct
 	int			m_texHeight;				///< Height of curvature LUT (typically 512)
 	float		m_curvatureRadiusMin;		///< Min radius of curvature used to build the LUT (typically ~0.1 cm min)
 	float		m_curvatureRadiusMax;		///< Max radius of curvature used to build the LUT (typically ~10.0 cm max)
+	GFSDK_FaceWorks_LUTIntegrationMode m_integrationMode;	///< How to integrate the diffusion profile
+	int			m_integrationSampleCount;	///< Sample count for the integration mode, or 0 to use the mode's default
+	GFSDK_FaceWorks_LUTFormat m_format;		///< Pixel format of the generated LUT (default RGBA8)
 } GFSDK_FaceWorks_CurvatureLUTConfig;
 
 /// Calculate size needed to store pixels of texture generated by GFSDK_FaceWorks_GenerateCurvatureLUT.
@@ -352,8 +871,11 @@ GFSDK_FACEWORKS_API size_t GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateCur
 								const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig);
 
 /// Generate curvature lookup texture for SSS shaders.
-/// The image is stored in RGBA8 format to the given pointer, in left-to-right, top-to-bottom
-/// order. The curvature LUT is in linear color space.
+/// The image is stored in the config's m_format to the given pointer, in left-to-right, top-to-bottom
+/// order. The curvature LUT is in linear color space.  Each texel is the scattered light's difference
+/// from N.L: unorm formats remap it from [-0.25, 0.25] to [0, 1] and clamp it; R11G11B10F and RGB9E5
+/// store it plus 0.25, clamped at 0; and RGBA16F stores it as is, unclamped.  Shaders decode it with
+/// the format's GFSDK_FaceWorks_CurvatureLUTDecode_* constant in GFSDK_FaceWorks.hlsli.
 ///
 /// \param pConfig				[in] the parameters for building curvature lookup texture for SSS
 /// \param pCurvatureLUTOut		[out] buffer where the curvature LUT is stored
@@ -361,17 +883,138 @@ GFSDK_FACEWORKS_API size_t GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateCur
 ///								Error messages will be stored in the error blob, if one is given;
 ///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
 ///								to free the storage.
-///								The given allocator will be used to allocate temporary storage for
+/// \param pAllocator			[in] the given allocator will be used to allocate temporary storage for
 ///								working data, if provided; if not, the standard CRT allocator will
 ///								be used.
+/// \param pParallelConfig		[in] how to distribute the LUT rows over threads; if null, the LUT is
+///								generated serially on the calling thread.
 ///
 /// \return						GFSDK_FaceWorks_OK if parameters are correct
 /// 							GFSDK_FaceWorks_InvalidArgument if pConfig contains invalid values
 GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GenerateCurvatureLUT(
 												const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig,
 												void * pCurvatureLUTOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+												gfsdk_new_delete_t * pAllocator,
+												const GFSDK_FaceWorks_ParallelConfig * pParallelConfig);
+
+/// Generate curvature lookup texture for SSS shaders, passing it to a row sink a block at a time
+/// instead of storing it to one buffer.  The texels are the same as from
+/// GFSDK_FaceWorks_GenerateCurvatureLUT, but only one block of rows is held in memory.
+///
+/// \param pConfig				[in] the parameters for building curvature lookup texture for SSS
+/// \param pRowSink				[in] the callback that receives the blocks of rows
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+/// \param pAllocator			[in] the given allocator will be used to allocate the block and temporary
+///								storage for working data, if provided; if not, the standard CRT allocator
+///								will be used.
+/// \param pParallelConfig		[in] how to distribute each block's rows over threads; if null, the LUT is
+///								generated serially on the calling thread.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if pConfig or pRowSink contains invalid values
+///								GFSDK_FaceWorks_Aborted if the row sink asked to stop
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_StreamCurvatureLUT(
+												const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig,
+												const GFSDK_FaceWorks_LUTRowSink * pRowSink,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+												gfsdk_new_delete_t * pAllocator,
+												const GFSDK_FaceWorks_ParallelConfig * pParallelConfig);
+
+/// Estimate the error of a curvature LUT generated with the given integration mode and sample count.
+/// A subset of the LUT's rows is generated both ways and compared against a dense midpoint-rule
+/// reference, so this is much cheaper than generating the whole LUT.
+///
+/// \param pConfig				[in] the parameters for building curvature lookup texture for SSS
+/// \param pErrorEstimateOut	[out] the estimated error
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if pConfig contains invalid values
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_EstimateCurvatureLUTError(
+												const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig,
+												GFSDK_FaceWorks_LUTErrorEstimate * pErrorEstimateOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut);
+
+/// Fit the curvature range of a curvature LUT config to the curvature statistics of one or more meshes,
+/// so none of the LUT's rows are spent on curvatures the meshes don't use.  The histograms are summed,
+/// and the range is set to cover the given fraction of all the vertices, trimming the rest evenly from
+/// the flattest and the most curved ends; curvatures outside the range are clamped to the LUT's edge
+/// rows by the shaders.  The range is rounded outward to the histogram bins, and is never wider than
+/// the curvatures actually seen.  m_texHeight is then scaled so the rows have the same spacing in
+/// curvature as in the config passed in (up to 16384), so a tighter range gives a smaller LUT of equal
+/// quality; set m_texHeight back afterward to spend the saved rows on accuracy instead.
+/// The statistics must be in the same world units as the config.  Set m_curvatureRadiusMinLUT and
+/// m_curvatureRadiusMaxLUT in GFSDK_FaceWorks_SSSConfig to the fitted range.
+///
+/// \param pStats				[in] array of curvature statistics, from GFSDK_FaceWorks_CalculateMeshCurvatureWithStats()
+/// \param statsCount			[in] number of elements in pStats
+/// \param coverage				[in] fraction of the vertices whose curvature is covered by the range, in (0, 1]
+///								(typically 0.98 to 1.0)
+/// \param pConfig				[in/out] the parameters for building curvature lookup texture for SSS; on
+///								return, m_curvatureRadiusMin, m_curvatureRadiusMax and m_texHeight are fitted
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if pConfig or pStats contains invalid values
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_FitCurvatureLUTRange(
+												const GFSDK_FaceWorks_CurvatureStats * pStats,
+												int statsCount,
+												float coverage,
+												GFSDK_FaceWorks_CurvatureLUTConfig * pConfig,
 												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut);
 
+/// Calculate size needed to store pixels of texture array generated by GFSDK_FaceWorks_GenerateCurvatureLUTArray.
+///
+/// \param pConfigs				[in] array of parameters for building each slice's curvature lookup texture
+/// \param sliceCount			[in] number of slices, and elements in pConfigs
+///
+/// \return						the size needed to store pixels of texture array generated by
+///								GFSDK_FaceWorks_GenerateCurvatureLUTArray
+GFSDK_FACEWORKS_API size_t GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateCurvatureLUTArraySizeBytes(
+												const GFSDK_FaceWorks_CurvatureLUTConfig * pConfigs,
+												int sliceCount);
+
+/// Generate a texture array of curvature lookup textures for SSS shaders, one slice per config, so
+/// materials with different diffusion radii or LUT ranges can share one bound texture.
+/// The slices are generated as by GFSDK_FaceWorks_GenerateCurvatureLUT and stored one after another,
+/// the layout of a texture array with one mip level.  All the slices are generated in one parallel job.
+/// The configs must all have the same m_texWidth, m_texHeight and m_format; the other parameters may
+/// differ.  Each material selects its slice with m_lutArraySlice in GFSDK_FaceWorks_SSSConfig, and the
+/// rest of its GFSDK_FaceWorks_SSSConfig must match that slice's config.
+///
+/// \param pConfigs				[in] array of parameters for building each slice's curvature lookup texture
+/// \param sliceCount			[in] number of slices, and elements in pConfigs (at most 2048)
+/// \param pCurvatureLUTArrayOut	[out] buffer where the curvature LUT array is stored
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+/// \param pAllocator			[in] the given allocator will be used to allocate temporary storage for
+///								working data, if provided; if not, the standard CRT allocator will
+///								be used.
+/// \param pParallelConfig		[in] how to distribute the LUT rows over threads; if null, the LUTs are
+///								generated serially on the calling thread.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if pConfigs contains invalid or mismatched values
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GenerateCurvatureLUTArray(
+												const GFSDK_FaceWorks_CurvatureLUTConfig * pConfigs,
+												int sliceCount,
+												void * pCurvatureLUTArrayOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+												gfsdk_new_delete_t * pAllocator,
+												const GFSDK_FaceWorks_ParallelConfig * pParallelConfig);
+
 /// \brief Parameters for building shadow lookup texture (LUT) for SSS.
 typedef struct
 {
@@ -381,6 +1024,9 @@ typedef struct
 	float		m_shadowWidthMin;			///< Min world-space penumbra width used to build the LUT (typically ~0.8 cm)
 	float		m_shadowWidthMax;			///< Max world-space penumbra width used to build the LUT (typically ~10.0 cm)
 	float		m_shadowSharpening;			///< Ratio by which output shadow is sharpened (adjust to taste; typically 3.0 to 10.0)
+	GFSDK_FaceWorks_LUTIntegrationMode m_integrationMode;	///< How to integrate the diffusion profile
+	int			m_integrationSampleCount;	///< Sample count for the integration mode, or 0 to use the mode's default
+	GFSDK_FaceWorks_LUTFormat m_format;		///< Pixel format of the generated LUT (default RGBA8)
 } GFSDK_FaceWorks_ShadowLUTConfig;
 
 /// Calculate size needed to store pixels of texture generated by GFSDK_FaceWorks_GenerateShadowLUT.
@@ -392,9 +1038,10 @@ GFSDK_FACEWORKS_API size_t GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateSha
 												const GFSDK_FaceWorks_ShadowLUTConfig * pConfig);
 
 /// Generate shadow lookup texture for SSS shaders.
-/// The image is stored in RGBA8 format to the given pointer, in left-to-right, top-to-bottom
+/// The image is stored in the config's m_format to the given pointer, in left-to-right, top-to-bottom
 /// order.
-/// The shadow LUT is in sRGB color space.
+/// In the 8-bit formats (RGBA8 and RGB8) the shadow LUT is in sRGB color space, to be sampled through
+/// an sRGB view; the other formats have no sRGB views, so they store linear values.
 ///
 /// \param pConfig				[in] the parameters for building shadow lookup texture for SSS
 /// \param pShadowLUTOut		[out] buffer where the shadow LUT is stored
@@ -402,15 +1049,481 @@ GFSDK_FACEWORKS_API size_t GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateSha
 ///								Error messages will be stored in the error blob, if one is given;
 ///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
 ///								to free the storage.
-///								The given allocator will be used to allocate temporary storage for
+/// \param pAllocator			[in] the given allocator will be used to allocate temporary storage for
 ///								working data, if provided; if not, the standard CRT allocator will
 ///								be used.
+/// \param pParallelConfig		[in] how to distribute the LUT rows over threads; if null, the LUT is
+///								generated serially on the calling thread.
 ///
 /// \return						GFSDK_FaceWorks_OK if parameters are correct
 /// 							GFSDK_FaceWorks_InvalidArgument if pConfig contains invalid values
 GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GenerateShadowLUT(
 												const GFSDK_FaceWorks_ShadowLUTConfig * pConfig,
 												void * pShadowLUTOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+												gfsdk_new_delete_t * pAllocator,
+												const GFSDK_FaceWorks_ParallelConfig * pParallelConfig);
+
+/// Generate shadow lookup texture for SSS shaders, passing it to a row sink a block at a time
+/// instead of storing it to one buffer.  The texels are the same as from
+/// GFSDK_FaceWorks_GenerateShadowLUT, but only one block of rows is held in memory.
+///
+/// \param pConfig				[in] the parameters for building shadow lookup texture for SSS
+/// \param pRowSink				[in] the callback that receives the blocks of rows
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+/// \param pAllocator			[in] the given allocator will be used to allocate the block and temporary
+///								storage for working data, if provided; if not, the standard CRT allocator
+///								will be used.
+/// \param pParallelConfig		[in] how to distribute each block's rows over threads; if null, the LUT is
+///								generated serially on the calling thread.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if pConfig or pRowSink contains invalid values
+///								GFSDK_FaceWorks_Aborted if the row sink asked to stop
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_StreamShadowLUT(
+												const GFSDK_FaceWorks_ShadowLUTConfig * pConfig,
+												const GFSDK_FaceWorks_LUTRowSink * pRowSink,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+												gfsdk_new_delete_t * pAllocator,
+												const GFSDK_FaceWorks_ParallelConfig * pParallelConfig);
+
+/// Estimate the error of a shadow LUT generated with the given integration mode and sample count.
+/// A subset of the LUT's rows is generated both ways and compared against the exact, analytic
+/// result, so this is much cheaper than generating the whole LUT.
+///
+/// \param pConfig				[in] the parameters for building shadow lookup texture for SSS
+/// \param pErrorEstimateOut	[out] the estimated error
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if pConfig contains invalid values
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_EstimateShadowLUTError(
+												const GFSDK_FaceWorks_ShadowLUTConfig * pConfig,
+												GFSDK_FaceWorks_LUTErrorEstimate * pErrorEstimateOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut);
+
+/// Calculate size needed to store pixels of texture array generated by GFSDK_FaceWorks_GenerateShadowLUTArray.
+///
+/// \param pConfigs				[in] array of parameters for building each slice's shadow lookup texture
+/// \param sliceCount			[in] number of slices, and elements in pConfigs
+///
+/// \return						the size needed to store pixels of texture array generated by
+///								GFSDK_FaceWorks_GenerateShadowLUTArray
+GFSDK_FACEWORKS_API size_t GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateShadowLUTArraySizeBytes(
+												const GFSDK_FaceWorks_ShadowLUTConfig * pConfigs,
+												int sliceCount);
+
+/// Generate a texture array of shadow lookup textures for SSS shaders, one slice per config, so
+/// materials with different diffusion radii or sharpening can share one bound texture.
+/// The slices are generated as by GFSDK_FaceWorks_GenerateShadowLUT and stored one after another,
+/// the layout of a texture array with one mip level.  The integration tables are built once for each
+/// integration rule used and shared by the slices, and all the slices are generated in one parallel job.
+/// The configs must all have the same m_texWidth, m_texHeight and m_format; the other parameters may
+/// differ.  Each material selects its slice with m_lutArraySlice in GFSDK_FaceWorks_SSSConfig, and the
+/// rest of its GFSDK_FaceWorks_SSSConfig must match that slice's config.
+///
+/// \param pConfigs				[in] array of parameters for building each slice's shadow lookup texture
+/// \param sliceCount			[in] number of slices, and elements in pConfigs (at most 2048)
+/// \param pShadowLUTArrayOut	[out] buffer where the shadow LUT array is stored
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+/// \param pAllocator			[in] the given allocator will be used to allocate temporary storage for
+///								working data, if provided; if not, the standard CRT allocator will
+///								be used.
+/// \param pParallelConfig		[in] how to distribute the LUT rows over threads; if null, the LUTs are
+///								generated serially on the calling thread.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if pConfigs contains invalid or mismatched values
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GenerateShadowLUTArray(
+												const GFSDK_FaceWorks_ShadowLUTConfig * pConfigs,
+												int sliceCount,
+												void * pShadowLUTArrayOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+												gfsdk_new_delete_t * pAllocator,
+												const GFSDK_FaceWorks_ParallelConfig * pParallelConfig);
+
+/// Most mip levels a LUT atlas may have
+#define GFSDK_FaceWorks_LUTAtlasMipCountMax 8
+
+/// \brief Layout of a LUT atlas, from GFSDK_FaceWorks_CalculateLUTAtlasLayout().
+/// \details The atlas is one texture holding the curvature LUT on the left and the shadow LUT on the
+/// right, each surrounded by copies of its edge texels, so it can be bound with one SRV.  The padding is
+/// 2^(m_mipCount - 1) texels at level 0 and halves at each level, so bilinear samples never bleed from one
+/// LUT into the other at any level.  Each level's texels follow the previous level's, in rows with no gaps.
+typedef struct
+{
+	int					m_width;			///< Width of the atlas at level 0, in texels
+	int					m_height;			///< Height of the atlas at level 0, in texels
+	int					m_mipCount;			///< Number of mip levels
+	int					m_lutWidth;			///< Width of each LUT at level 0, in texels
+	int					m_lutHeight;		///< Height of each LUT at level 0, in texels
+	int					m_padding;			///< Texels of padding on each side of each LUT at level 0
+	GFSDK_FaceWorks_LUTFormat	m_format;	///< Pixel format of the atlas
+	size_t				m_mipOffsetBytes[GFSDK_FaceWorks_LUTAtlasMipCountMax];	///< Offset of each level's texels
+	size_t				m_mipRowPitchBytes[GFSDK_FaceWorks_LUTAtlasMipCountMax];	///< Bytes per row at each level
+	size_t				m_sizeBytes;		///< Size of all the levels' texels
+} GFSDK_FaceWorks_LUTAtlasLayout;
+
+/// Calculate the layout of a LUT atlas holding the LUTs of the two configs.  The configs must have the
+/// same m_texWidth, m_texHeight and m_format, and the LUT size must be a multiple of 2^(mipCount - 1).
+///
+/// \param pCurvatureConfig		[in] the parameters for building curvature lookup texture for SSS
+/// \param pShadowConfig		[in] the parameters for building shadow lookup texture for SSS
+/// \param mipCount				[in] number of mip levels, in [1, 8]
+/// \param pLayoutOut			[out] the atlas layout
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if the configs contain invalid or mismatched values
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateLUTAtlasLayout(
+												const GFSDK_FaceWorks_CurvatureLUTConfig * pCurvatureConfig,
+												const GFSDK_FaceWorks_ShadowLUTConfig * pShadowConfig,
+												int mipCount,
+												GFSDK_FaceWorks_LUTAtlasLayout * pLayoutOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut);
+
+/// Generate a LUT atlas: the curvature and shadow LUTs packed into one texture with a mip chain, laid out
+/// as given by GFSDK_FaceWorks_CalculateLUTAtlasLayout().  The levels are box-filtered from level 0 in
+/// linear space.  In the 8-bit formats both LUTs are stored in sRGB space, unlike the curvature LUT from
+/// GFSDK_FaceWorks_GenerateCurvatureLUT(), so view the whole atlas with a UNORM_SRGB format; the other
+/// formats store both LUTs in linear space.  Sample it with the "FromAtlas" shader functions, after
+/// writing the remap constants with GFSDK_FaceWorks_WriteCBDataForLUTAtlas().
+///
+/// \param pCurvatureConfig		[in] the parameters for building curvature lookup texture for SSS
+/// \param pShadowConfig		[in] the parameters for building shadow lookup texture for SSS
+/// \param mipCount				[in] number of mip levels, in [1, 8]
+/// \param pLUTAtlasOut			[out] buffer of at least the layout's m_sizeBytes where the atlas is stored
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+/// \param pAllocator			[in] the given allocator will be used to allocate temporary storage for
+///								working data, if provided; if not, the standard CRT allocator will
+///								be used.
+/// \param pParallelConfig		[in] how to distribute the LUT rows over threads; if null, the LUTs are
+///								generated serially on the calling thread.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if the configs contain invalid or mismatched values
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GenerateLUTAtlas(
+												const GFSDK_FaceWorks_CurvatureLUTConfig * pCurvatureConfig,
+												const GFSDK_FaceWorks_ShadowLUTConfig * pShadowConfig,
+												int mipCount,
+												void * pLUTAtlasOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+												gfsdk_new_delete_t * pAllocator,
+												const GFSDK_FaceWorks_ParallelConfig * pParallelConfig);
+
+/// \brief A LUT being generated progressively, for interactive tuning of the LUT parameters.
+/// \details It's opaque; create one with GFSDK_FaceWorks_BeginProgressiveCurvatureLUT() or
+/// GFSDK_FaceWorks_BeginProgressiveShadowLUT(), refine it with GFSDK_FaceWorks_StepProgressiveLUT(),
+/// and release it with GFSDK_FaceWorks_ReleaseProgressiveLUT().
+typedef struct GFSDK_FaceWorks_ProgressiveLUT GFSDK_FaceWorks_ProgressiveLUT;
+
+/// Start generating a curvature LUT progressively into a buffer the caller owns.  A coarse 32x32
+/// pass is evaluated and upsampled into the buffer before this returns, so it holds a complete LUT
+/// straight away; GFSDK_FaceWorks_StepProgressiveLUT() then refines it in passes that double the
+/// resolution, ending with the exact LUT from GFSDK_FaceWorks_GenerateCurvatureLUT().  The buffer
+/// must stay valid until the progressive LUT is released.
+///
+/// \param pConfig				[in] the parameters for building curvature lookup texture for SSS
+/// \param pCurvatureLUTOut		[out] buffer where the LUT is stored, as for GFSDK_FaceWorks_GenerateCurvatureLUT()
+/// \param ppProgressiveLUTOut	[out] the progressive LUT; release it with GFSDK_FaceWorks_ReleaseProgressiveLUT()
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+/// \param pAllocator			[in] the given allocator will be used to allocate the progressive LUT and
+///								its working data, if provided; if not, the standard CRT allocator will
+///								be used.
+/// \param pParallelConfig		[in] how to distribute the coarse pass's rows over threads; if null, it's
+///								run serially on the calling thread.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if pConfig contains invalid values
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_BeginProgressiveCurvatureLUT(
+												const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig,
+												void * pCurvatureLUTOut,
+												GFSDK_FaceWorks_ProgressiveLUT ** ppProgressiveLUTOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+												gfsdk_new_delete_t * pAllocator,
+												const GFSDK_FaceWorks_ParallelConfig * pParallelConfig);
+
+/// Start generating a shadow LUT progressively into a buffer the caller owns.  A coarse 32x32
+/// pass is evaluated and upsampled into the buffer before this returns, so it holds a complete LUT
+/// straight away; GFSDK_FaceWorks_StepProgressiveLUT() then refines it in passes that double the
+/// resolution, ending with the exact LUT from GFSDK_FaceWorks_GenerateShadowLUT().  The buffer
+/// must stay valid until the progressive LUT is released.
+///
+/// \param pConfig				[in] the parameters for building shadow lookup texture for SSS
+/// \param pShadowLUTOut		[out] buffer where the LUT is stored, as for GFSDK_FaceWorks_GenerateShadowLUT()
+/// \param ppProgressiveLUTOut	[out] the progressive LUT; release it with GFSDK_FaceWorks_ReleaseProgressiveLUT()
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+/// \param pAllocator			[in] the given allocator will be used to allocate the progressive LUT and
+///								its working data, if provided; if not, the standard CRT allocator will
+///								be used.
+/// \param pParallelConfig		[in] how to distribute the coarse pass's rows over threads; if null, it's
+///								run serially on the calling thread.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if pConfig contains invalid values
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_BeginProgressiveShadowLUT(
+												const GFSDK_FaceWorks_ShadowLUTConfig * pConfig,
+												void * pShadowLUTOut,
+												GFSDK_FaceWorks_ProgressiveLUT ** ppProgressiveLUTOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+												gfsdk_new_delete_t * pAllocator,
+												const GFSDK_FaceWorks_ParallelConfig * pParallelConfig);
+
+/// Refine a progressive LUT by about texelBudget texels of work (at least one row), so it can be called
+/// once a frame without stalling it.  Work is counted in texels evaluated, plus texels upsampled into the
+/// LUT for the passes smaller than it.  The buffer is only ever written a whole row at a time from a
+/// finished or full-size pass, so it always holds a complete LUT, and it can be uploaded between steps.
+/// To cancel, e.g. when the parameters change, release the progressive LUT and begin another; the buffer
+/// keeps the last texels written.
+///
+/// \param pProgressiveLUT		[in] the progressive LUT
+/// \param texelBudget			[in] about how many texels to evaluate or upsample in this step; at least 1
+/// \param pProgressOut			[out] fraction of the refinement done, in [0, 1]; 1 only once it's complete.
+///								May be null.
+/// \param pIsCompleteOut		[out] nonzero once the buffer holds the final LUT; stepping it further does
+///								nothing.  May be null.
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+/// \param pParallelConfig		[in] how to distribute the step's rows over threads; if null, they're
+///								run serially on the calling thread.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if pProgressiveLUT is null or texelBudget < 1
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_StepProgressiveLUT(
+												GFSDK_FaceWorks_ProgressiveLUT * pProgressiveLUT,
+												int texelBudget,
+												float * pProgressOut,
+												int * pIsCompleteOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+												const GFSDK_FaceWorks_ParallelConfig * pParallelConfig);
+
+/// Release a progressive LUT, complete or not.  The caller's LUT buffer isn't touched.
+///
+/// \param pProgressiveLUT		[in] the progressive LUT; may be null
+GFSDK_FACEWORKS_API void GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_ReleaseProgressiveLUT(
+												GFSDK_FaceWorks_ProgressiveLUT * pProgressiveLUT);
+
+/// \brief Block-compressed formats a LUT can be encoded in by GFSDK_FaceWorks_CompressLUT().
+/// Blocks are stored in left-to-right, top-to-bottom order, tightly packed.
+typedef enum
+{
+	GFSDK_FaceWorks_LUTCompression_BC1,				///< 8 bytes per 4x4 block, in 4-color mode
+													///< (DXGI_FORMAT_BC1_UNORM or _UNORM_SRGB).
+	GFSDK_FaceWorks_LUTCompression_BC7,				///< 16 bytes per 4x4 block, in mode 6; alpha is 254 or 255
+													///< (DXGI_FORMAT_BC7_UNORM or _UNORM_SRGB).
+} GFSDK_FaceWorks_LUTCompression;
+
+/// \brief Accuracy of a compressed LUT against the uncompressed one, over the RGB channels.  Errors are
+/// in 8-bit steps of the stored values, which for the shadow LUT are in sRGB space.
+typedef struct
+{
+	float				m_psnr;				///< Peak signal-to-noise ratio in dB; FLT_MAX if the LUT is reproduced exactly
+	float				m_rmsError;			///< RMS error per channel
+	float				m_maxError;			///< Max error of any channel of any texel
+	int					m_blocksOverTarget;	///< Number of blocks whose RMS error is still over the target
+} GFSDK_FaceWorks_LUTCompressionStats;
+
+/// Calculate the size of a block-compressed LUT.  Sizes that aren't multiples of 4 are rounded up
+/// to whole blocks.
+///
+/// \param texWidth				[in] width of the LUT in texels
+/// \param texHeight			[in] height of the LUT in texels
+/// \param compression			[in] the block-compressed format
+///
+/// \return						the size in bytes, or 0 if the parameters aren't valid
+GFSDK_FACEWORKS_API size_t GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateCompressedLUTSizeBytes(
+												int texWidth,
+												int texHeight,
+												GFSDK_FaceWorks_LUTCompression compression);
+
+/// Block-compress a LUT generated in GFSDK_FaceWorks_LUTFormat_RGBA8 or _RGB8, to cut its size by 4x
+/// (BC7) or 8x (BC1) compared to RGBA8.  Each block is fitted to the principal axis of its texels and
+/// refined by least squares; blocks whose RMS error is still over errorTarget then get a local search
+/// over their endpoints, so a lower target costs more time.  The blocks store the same values as the
+/// LUT, so view a compressed shadow LUT with a UNORM_SRGB format, and a compressed curvature LUT with
+/// a UNORM format.  BC7 is typically within one 8-bit step of the LUT; BC1 is coarser, but fine for
+/// the smooth curvature LUT.
+///
+/// \param pLUTTexels			[in] the LUT's texels, as from GFSDK_FaceWorks_GenerateCurvatureLUT() or
+///								GFSDK_FaceWorks_GenerateShadowLUT()
+/// \param texWidth				[in] width of the LUT in texels
+/// \param texHeight			[in] height of the LUT in texels
+/// \param format				[in] the LUT's pixel format; must be RGBA8 or RGB8
+/// \param compression			[in] the block-compressed format
+/// \param errorTarget			[in] RMS error per channel, in 8-bit steps, that a block must meet before the
+///								encoder stops refining it; 0 refines every block as far as it can
+/// \param pBlocksOut			[out] buffer of at least GFSDK_FaceWorks_CalculateCompressedLUTSizeBytes()
+///								where the blocks are stored
+/// \param pStatsOut			[out] the compressed LUT's error against the uncompressed one.  May be null.
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+/// \param pAllocator			[in] the given allocator will be used to allocate temporary storage for
+///								working data, if provided; if not, the standard CRT allocator will
+///								be used.
+/// \param pParallelConfig		[in] how to distribute the rows of blocks over threads; if null, they're
+///								compressed serially on the calling thread.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if the parameters are invalid
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CompressLUT(
+												const void * pLUTTexels,
+												int texWidth,
+												int texHeight,
+												GFSDK_FaceWorks_LUTFormat format,
+												GFSDK_FaceWorks_LUTCompression compression,
+												float errorTarget,
+												void * pBlocksOut,
+												GFSDK_FaceWorks_LUTCompressionStats * pStatsOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+												gfsdk_new_delete_t * pAllocator,
+												const GFSDK_FaceWorks_ParallelConfig * pParallelConfig);
+
+/// \brief A LUT mapped into memory from the LUT cache.
+/// \details The cache is a directory of binary LUT files, each named by a hash of the complete
+/// LUT config and the library version, so a LUT is only generated the first time a config is
+/// used; after that it's mapped straight from the file.  Release it with GFSDK_FaceWorks_UnmapCachedLUT().
+typedef struct
+{
+	const void *		m_pTexels;			///< The LUT's texels, laid out as by the Generate functions
+	size_t				m_sizeBytes;		///< Size of the texels, as from the CalculateSizeBytes functions
+	int					m_wasGenerated;		///< Nonzero if the LUT wasn't in the cache and had to be generated
+	const void *		m_pMapping;			///< [internal] Start of the file mapping
+	size_t				m_mappingSizeBytes;	///< [internal] Size of the file mapping
+} GFSDK_FaceWorks_CachedLUT;
+
+/// Map a curvature LUT from the LUT cache, generating it and adding it to the cache first if it isn't
+/// there.  The file is written under a temporary name and then renamed, so other threads and processes
+/// using the same cache never see a partly written LUT.
+///
+/// \param pConfig				[in] the parameters for building curvature lookup texture for SSS
+/// \param strCacheDirectory	[in] path of the cache directory, which must already exist
+/// \param pCachedLUTOut		[out] the mapped LUT
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+/// \param pAllocator			[in] the given allocator will be used to allocate temporary storage for
+///								working data, if provided; if not, the standard CRT allocator will
+///								be used.
+/// \param pParallelConfig		[in] how to distribute the LUT rows over threads, if the LUT has to be
+///								generated; if null, it's generated serially on the calling thread.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if pConfig contains invalid values
+///								GFSDK_FaceWorks_FileError if the LUT file couldn't be written or mapped
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_MapCachedCurvatureLUT(
+												const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig,
+												const char * strCacheDirectory,
+												GFSDK_FaceWorks_CachedLUT * pCachedLUTOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+												gfsdk_new_delete_t * pAllocator,
+												const GFSDK_FaceWorks_ParallelConfig * pParallelConfig);
+
+/// Map a shadow LUT from the LUT cache, generating it and adding it to the cache first if it isn't
+/// there.  The file is written under a temporary name and then renamed, so other threads and processes
+/// using the same cache never see a partly written LUT.
+///
+/// \param pConfig				[in] the parameters for building shadow lookup texture for SSS
+/// \param strCacheDirectory	[in] path of the cache directory, which must already exist
+/// \param pCachedLUTOut		[out] the mapped LUT
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+/// \param pAllocator			[in] the given allocator will be used to allocate temporary storage for
+///								working data, if provided; if not, the standard CRT allocator will
+///								be used.
+/// \param pParallelConfig		[in] how to distribute the LUT rows over threads, if the LUT has to be
+///								generated; if null, it's generated serially on the calling thread.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if pConfig contains invalid values
+///								GFSDK_FaceWorks_FileError if the LUT file couldn't be written or mapped
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_MapCachedShadowLUT(
+												const GFSDK_FaceWorks_ShadowLUTConfig * pConfig,
+												const char * strCacheDirectory,
+												GFSDK_FaceWorks_CachedLUT * pCachedLUTOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+												gfsdk_new_delete_t * pAllocator,
+												const GFSDK_FaceWorks_ParallelConfig * pParallelConfig);
+
+/// Release a LUT mapped by GFSDK_FaceWorks_MapCachedCurvatureLUT() or GFSDK_FaceWorks_MapCachedShadowLUT().
+/// The cache file stays in the cache.
+///
+/// \param pCachedLUT			[in] the mapped LUT; it's cleared on return
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if pCachedLUT is null
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_UnmapCachedLUT(
+												GFSDK_FaceWorks_CachedLUT * pCachedLUT);
+
+/// Get the curvature LUT built into the library, at one of the built-in sizes.  The built-in LUTs are
+/// generated ahead of time with the default human skin parameters (a 2.7 mm diffusion radius and the
+/// lut_generator defaults), so using them costs nothing at startup and needs no LUT files.
+///
+/// \param texSize				[in] width and height of the LUT; must be 64, 128 or 256
+/// \param pConfigOut			[out] the config the LUT was generated with; use its radii to set up the
+///								GFSDK_FaceWorks_SSSConfig.  May be null.
+/// \param ppTexelsOut			[out] the LUT's texels, in GFSDK_FaceWorks_LUTFormat_RGBA8 and laid out as by
+///								GFSDK_FaceWorks_GenerateCurvatureLUT().  They're owned by the library.
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if texSize isn't a built-in size
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GetBuiltInCurvatureLUT(
+												int texSize,
+												GFSDK_FaceWorks_CurvatureLUTConfig * pConfigOut,
+												const void ** ppTexelsOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut);
+
+/// Get the shadow LUT built into the library, at one of the built-in sizes.  The built-in LUTs are
+/// generated ahead of time with the default human skin parameters (a 2.7 mm diffusion radius and the
+/// lut_generator defaults), so using them costs nothing at startup and needs no LUT files.
+///
+/// \param texSize				[in] width and height of the LUT; must be 64, 128 or 256
+/// \param pConfigOut			[out] the config the LUT was generated with; use its shadow widths to set up
+///								the GFSDK_FaceWorks_SSSConfig.  May be null.
+/// \param ppTexelsOut			[out] the LUT's texels, in GFSDK_FaceWorks_LUTFormat_RGBA8 and laid out as by
+///								GFSDK_FaceWorks_GenerateShadowLUT().  They're owned by the library.
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if texSize isn't a built-in size
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GetBuiltInShadowLUT(
+												int texSize,
+												GFSDK_FaceWorks_ShadowLUTConfig * pConfigOut,
+												const void ** ppTexelsOut,
 												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut);
 
 /// \brief Shared constant buffer
@@ -433,6 +1546,8 @@ typedef struct
 	float		m_shadowFilterWidth;		///< World-space width of shadow filter
 	int			m_normalMapSize;			///< Pixel size of normal map
 	float		m_averageUVScale;			///< Average UV scale of the mesh, i.e. world-space size of UV unit square
+	int			m_lutArraySlice;			///< Slice of the LUT arrays to sample, for the shaders that take LUT
+											///< arrays (see GFSDK_FaceWorks_GenerateCurvatureLUTArray); 0 otherwise
 } GFSDK_FaceWorks_SSSConfig;
 
 /// Write constant buffer data for SSS, using specified configuration options.
@@ -454,6 +1569,118 @@ GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWo
 												GFSDK_FaceWorks_CBData * pCBDataOut,
 												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut);
 
+/// Write constant buffer data for sampling the LUTs from a LUT atlas (see GFSDK_FaceWorks_GenerateLUTAtlas),
+/// with the "FromAtlas" shader functions.  Call it along with GFSDK_FaceWorks_WriteCBDataForSSS(); it only
+/// writes the atlas remap constants.
+///
+/// \param pLayout				[in] the atlas layout, from GFSDK_FaceWorks_CalculateLUTAtlasLayout()
+/// \param pCBDataOut			[out] pointer to CBData struct in your constant buffer
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if pLayout contains invalid values
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_WriteCBDataForLUTAtlas(
+												const GFSDK_FaceWorks_LUTAtlasLayout * pLayout,
+												GFSDK_FaceWorks_CBData * pCBDataOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut);
+
+/// Number of float4s in GFSDK_FaceWorks_LUTFitCBData: 4 of cell layout, then 4 coefficient float4s
+/// for each channel of each of the 6 x 2 cells
+#define GFSDK_FaceWorks_LUTFitCBDataSize 148
+
+/// \brief Constant buffer data for an ALU-only approximation of a LUT.
+/// \details A piecewise bicubic fit of a curvature or shadow LUT, for the shaders that evaluate SSS
+/// without sampling a LUT texture.  It's about 2.4 KB, so it isn't part of GFSDK_FaceWorks_CBData:
+/// fit each LUT config once, and put the fit in a constant buffer that's shared by the materials
+/// using that config.  This structure matches the corresponding struct in GFSDK_FaceWorks.hlsli.
+typedef struct
+{
+	gfsdk_float4 data[GFSDK_FaceWorks_LUTFitCBDataSize];	///< The opaque data used to communicate with shaders
+} GFSDK_FaceWorks_LUTFitCBData;
+
+/// Fit an ALU-only approximation to a curvature LUT, for the GFSDK_FaceWorks_EvaluateSSSDirectLight()
+/// overload that takes a GFSDK_FaceWorks_LUTFitCBData in place of the LUT texture.  The LUT is generated
+/// from the config (so this costs about as much as GFSDK_FaceWorks_GenerateCurvatureLUT) and fitted by
+/// least squares at its texel centers; m_texWidth and m_texHeight set how densely it's sampled, and
+/// m_format is ignored, as the fit is made to the unclamped texels a float format would hold.  The fit
+/// is piecewise bicubic, with cells that are narrowest around the terminator, where the LUT changes fastest.
+///
+/// \param pConfig				[in] the parameters for building curvature lookup texture for SSS
+/// \param pFitOut				[out] the fit, to put in your constant buffer
+/// \param pFitErrorOut			[out] the fit's error relative to the LUT's texels, in the units of
+///								the texels; may be null
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+/// \param pAllocator			[in] the given allocator will be used to allocate temporary storage for
+///								working data, if provided; if not, the standard CRT allocator will
+///								be used.
+/// \param pParallelConfig		[in] how to distribute the LUT rows over threads; if null, the LUT is
+///								generated serially on the calling thread.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if pConfig contains invalid values
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_FitCurvatureLUT(
+												const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig,
+												GFSDK_FaceWorks_LUTFitCBData * pFitOut,
+												GFSDK_FaceWorks_LUTErrorEstimate * pFitErrorOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+												gfsdk_new_delete_t * pAllocator,
+												const GFSDK_FaceWorks_ParallelConfig * pParallelConfig);
+
+/// Fit an ALU-only approximation to a shadow LUT, for the GFSDK_FaceWorks_EvaluateSSSShadow() overload
+/// that takes a GFSDK_FaceWorks_LUTFitCBData in place of the LUT texture.  The LUT is generated from the
+/// config and fitted by least squares at its texel centers, in linear space; m_format is ignored.
+/// The fit is piecewise bicubic, with cells placed around the sharpened shadow edge.
+///
+/// \param pConfig				[in] the parameters for building shadow lookup texture for SSS
+/// \param pFitOut				[out] the fit, to put in your constant buffer
+/// \param pFitErrorOut			[out] the fit's error relative to the LUT's linear texels; may be null
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+/// \param pAllocator			[in] the given allocator will be used to allocate temporary storage for
+///								working data, if provided; if not, the standard CRT allocator will
+///								be used.
+/// \param pParallelConfig		[in] how to distribute the LUT rows over threads; if null, the LUT is
+///								generated serially on the calling thread.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if pConfig contains invalid values
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_FitShadowLUT(
+												const GFSDK_FaceWorks_ShadowLUTConfig * pConfig,
+												GFSDK_FaceWorks_LUTFitCBData * pFitOut,
+												GFSDK_FaceWorks_LUTErrorEstimate * pFitErrorOut,
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+												gfsdk_new_delete_t * pAllocator,
+												const GFSDK_FaceWorks_ParallelConfig * pParallelConfig);
+
+/// Evaluate a LUT fit on the CPU, with the same math as the shaders; the result stands in for a
+/// bilinear sample of a float-format LUT at the same coordinates, and isn't clamped.
+///
+/// \param pFit					[in] the fit, from GFSDK_FaceWorks_FitCurvatureLUT or GFSDK_FaceWorks_FitShadowLUT
+/// \param u					[in] LUT texture coordinate u; clamped to [0, 1]
+/// \param v					[in] LUT texture coordinate v; clamped to [0, 1]
+/// \param rgbOut				[out] the approximated LUT texel, as an RGBA8 LUT stores it
+/// \param pErrorBlobOut		[in] buffer the error blob, where errors are stored.
+///								Error messages will be stored in the error blob, if one is given;
+///								if error messages are generated, use GFSDK_FaceWorks_FreeErrorBlob()
+///								to free the storage.
+///
+/// \return						GFSDK_FaceWorks_OK if parameters are correct
+/// 							GFSDK_FaceWorks_InvalidArgument if pFit or rgbOut is null
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_EvaluateLUTFit(
+												const GFSDK_FaceWorks_LUTFitCBData * pFit,
+												float u,
+												float v,
+												float rgbOut[3],
+												GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut);
+
 /// Enum for projection types.
 typedef enum
 {
@@ -46,6 +46,34 @@ struct GFSDK_FaceWorks_CBData
 	float4 data[3];
 };
 
+/// Number of float4s in GFSDK_FaceWorks_LUTFitCBData (matches GFSDK_FaceWorks.h)
+#define GFSDK_FaceWorks_LUTFitCBDataSize 148
+
+/// Include this struct in a constant buffer to evaluate SSS without a LUT texture; holds an ALU-only
+/// approximation of a curvature or shadow LUT, from GFSDK_FaceWorks_FitCurvatureLUT or
+/// GFSDK_FaceWorks_FitShadowLUT (matches the corresponding struct in GFSDK_FaceWorks.h)
+struct GFSDK_FaceWorks_LUTFitCBData
+{
+	float4 data[GFSDK_FaceWorks_LUTFitCBDataSize];
+};
+
+/// Scale (x) and bias (y) that decode a curvature LUT texel to the scattered light's difference
+/// from saturate(N.L), for each GFSDK_FaceWorks_LUTFormat.  The unorm formats store the difference
+/// remapped to [0, 1]; RGBA16F stores it as is; R11G11B10F and RGB9E5 store it plus 0.25.
+static const float2 GFSDK_FaceWorks_CurvatureLUTDecode_RGBA8 = float2(0.5, -0.25);
+static const float2 GFSDK_FaceWorks_CurvatureLUTDecode_RGB8 = float2(0.5, -0.25);
+static const float2 GFSDK_FaceWorks_CurvatureLUTDecode_R11G11B10F = float2(1.0, -0.25);
+static const float2 GFSDK_FaceWorks_CurvatureLUTDecode_RGB9E5 = float2(1.0, -0.25);
+static const float2 GFSDK_FaceWorks_CurvatureLUTDecode_RGBA16F = float2(1.0, 0.0);
+static const float2 GFSDK_FaceWorks_CurvatureLUTDecode_RGB565 = float2(0.5, -0.25);
+
+/// The decode the GFSDK_FaceWorks_EvaluateSSSDirectLight overloads that sample a curvature LUT or
+/// LUT atlas use; define it as one of the constants above, before including this file, if the
+/// texture isn't RGBA8.
+#ifndef GFSDK_FaceWorks_CurvatureLUTDecode
+#define GFSDK_FaceWorks_CurvatureLUTDecode GFSDK_FaceWorks_CurvatureLUTDecode_RGBA8
+#endif
+
 
 
 // =================================================================================
@@ -120,6 +148,76 @@ float3 GFSDK_FaceWorks_EvaluateSSSDirectLight(
 	Texture2D texCurvatureLUT,
 	SamplerState ssBilinearClamp);
 
+/// Evaluate SSS diffuse light for a single light source, using a slice of a curvature LUT array
+/// (see GFSDK_FaceWorks_GenerateCurvatureLUTArray) chosen by m_lutArraySlice in GFSDK_FaceWorks_SSSConfig.
+///
+/// \param cbdata			[in] the cbdata structure
+/// \param normalGeom		[in] the geometric normal
+/// \param normalShade		[in] the shading normal
+/// \param normalBlurred	[in] the blurred shading normal
+/// \param vecToLight		[in] the normalized vector toward light
+/// \param curvature		[in] curvature of the surface being shaded (interpolated from precomputed 
+/// 						per-vertex values)
+/// \param texCurvatureLUT	[in] the texture array containing the curvature look up tables
+/// \param ssBilinearClamp	[in] the sampler state
+///
+/// \return					the SSS lighting value, to be multiplied by the shadow color, diffuse color, and light color.
+float3 GFSDK_FaceWorks_EvaluateSSSDirectLight(
+	GFSDK_FaceWorks_CBData cbdata,
+	float3 normalGeom,
+	float3 normalShade,
+	float3 normalBlurred,
+	float3 vecToLight,
+	float curvature,
+	Texture2DArray texCurvatureLUT,
+	SamplerState ssBilinearClamp);
+
+/// Evaluate SSS diffuse light for a single light source, using the curvature LUT in a LUT atlas
+/// (see GFSDK_FaceWorks_GenerateLUTAtlas and GFSDK_FaceWorks_WriteCBDataForLUTAtlas).
+///
+/// \param cbdata			[in] the cbdata structure
+/// \param normalGeom		[in] the geometric normal
+/// \param normalShade		[in] the shading normal
+/// \param normalBlurred	[in] the blurred shading normal
+/// \param vecToLight		[in] the normalized vector toward light
+/// \param curvature		[in] curvature of the surface being shaded (interpolated from precomputed 
+/// 						per-vertex values)
+/// \param texLUTAtlas		[in] the texture containing the LUT atlas
+/// \param ssTrilinearClamp	[in] the sampler state
+///
+/// \return					the SSS lighting value, to be multiplied by the shadow color, diffuse color, and light color.
+float3 GFSDK_FaceWorks_EvaluateSSSDirectLightFromAtlas(
+	GFSDK_FaceWorks_CBData cbdata,
+	float3 normalGeom,
+	float3 normalShade,
+	float3 normalBlurred,
+	float3 vecToLight,
+	float curvature,
+	Texture2D texLUTAtlas,
+	SamplerState ssTrilinearClamp);
+
+/// Evaluate SSS diffuse light for a single light source, using an ALU-only fit of the curvature LUT
+/// (see GFSDK_FaceWorks_FitCurvatureLUT) in place of the LUT texture.
+///
+/// \param cbdata			[in] the cbdata structure
+/// \param fitCurvatureLUT	[in] the fit of the curvature look up table
+/// \param normalGeom		[in] the geometric normal
+/// \param normalShade		[in] the shading normal
+/// \param normalBlurred	[in] the blurred shading normal
+/// \param vecToLight		[in] the normalized vector toward light
+/// \param curvature		[in] curvature of the surface being shaded (interpolated from precomputed 
+/// 						per-vertex values)
+///
+/// \return					the SSS lighting value, to be multiplied by the shadow color, diffuse color, and light color.
+float3 GFSDK_FaceWorks_EvaluateSSSDirectLight(
+	GFSDK_FaceWorks_CBData cbdata,
+	GFSDK_FaceWorks_LUTFitCBData fitCurvatureLUT,
+	float3 normalGeom,
+	float3 normalShade,
+	float3 normalBlurred,
+	float3 vecToLight,
+	float curvature);
+
 /// Evaluate SSS shadow color for a single light source.
 ///
 /// \param cbdata			[in] the cbdata structure
@@ -138,6 +236,61 @@ float3 GFSDK_FaceWorks_EvaluateSSSShadow(
 	Texture2D texShadowLUT,
 	SamplerState ssBilinearClamp);
 
+/// Evaluate SSS shadow color for a single light source, using a slice of a shadow LUT array
+/// (see GFSDK_FaceWorks_GenerateShadowLUTArray) chosen by m_lutArraySlice in GFSDK_FaceWorks_SSSConfig.
+///
+/// \param cbdata			[in] the cbdata structure
+/// \param normalGeom		[in] the geometric normal
+/// \param vecToLight		[in] the normalized vector toward light
+/// \param shadow			[in] wide shadow filter (0 = fully shadowed, 1 = fully lit).
+/// \param texShadowLUT		[in] the texture array containing the shadow look up tables
+/// \param ssBilinearClamp	[in] the sampler state
+///
+/// \return					the shadow color, including sharpened shadows and SSS light bleeding.
+float3 GFSDK_FaceWorks_EvaluateSSSShadow(
+	GFSDK_FaceWorks_CBData cbdata,
+	float3 normalGeom,
+	float3 vecToLight,
+	float shadow,
+	Texture2DArray texShadowLUT,
+	SamplerState ssBilinearClamp);
+
+/// Evaluate SSS shadow color for a single light source, using the shadow LUT in a LUT atlas
+/// (see GFSDK_FaceWorks_GenerateLUTAtlas and GFSDK_FaceWorks_WriteCBDataForLUTAtlas).
+///
+/// \param cbdata			[in] the cbdata structure
+/// \param normalGeom		[in] the geometric normal
+/// \param vecToLight		[in] the normalized vector toward light
+/// \param shadow			[in] wide shadow filter (0 = fully shadowed, 1 = fully lit).
+/// \param texLUTAtlas		[in] the texture containing the LUT atlas
+/// \param ssTrilinearClamp	[in] the sampler state
+///
+/// \return					the shadow color, including sharpened shadows and SSS light bleeding.
+float3 GFSDK_FaceWorks_EvaluateSSSShadowFromAtlas(
+	GFSDK_FaceWorks_CBData cbdata,
+	float3 normalGeom,
+	float3 vecToLight,
+	float shadow,
+	Texture2D texLUTAtlas,
+	SamplerState ssTrilinearClamp);
+
+/// Evaluate SSS shadow color for a single light source, using an ALU-only fit of the shadow LUT
+/// (see GFSDK_FaceWorks_FitShadowLUT) in place of the LUT texture.
+///
+/// \param cbdata			[in] the cbdata structure
+/// \param fitShadowLUT		[in] the fit of the shadow look up table
+/// \param normalGeom		[in] the geometric normal
+/// \param vecToLight		[in] the normalized vector toward light
+/// \param shadow			[in] wide shadow filter (0 = fully shadowed, 1 = fully lit).
+///
+/// \return					the shadow color, including sharpened shadows and SSS light bleeding.
+float3 GFSDK_FaceWorks_EvaluateSSSShadow(
+	GFSDK_FaceWorks_CBData cbdata,
+	GFSDK_FaceWorks_LUTFitCBData fitShadowLUT,
+	float3 normalGeom,
+	float3 vecToLight,
+	float shadow);
+
 /// Sharpen an input shadow value to approximate the output shadow after mapping through the
 /// shadow LUT.  This sharpened shadow can be used for specular or other lighting components.
 ///
@@ -270,6 +423,12 @@ struct nvsf_CBData
 	float	nvsf_DeepScatterFalloff;
 	float	nvsf_ShadowFilterRadius;
 	float	nvsf_DecodeDepthScale, nvsf_DecodeDepthBias;
+
+	// Slice of the LUT arrays (SSS)
+	float	nvsf_LUTArraySlice;
+
+	// Size of each LUT relative to the LUT atlas (SSS)
+	float2	nvsf_LUTAtlasScale;
 };
 
 nvsf_CBData nvsf_UnpackCBData(GFSDK_FaceWorks_CBData nvsf_opaqueData)
@@ -282,9 +441,54 @@ nvsf_CBData nvsf_UnpackCBData(GFSDK_FaceWorks_CBData nvsf_opaqueData)
 	nvsf_out.nvsf_ShadowFilterRadius = nvsf_opaqueData.data[1].z;
 	nvsf_out.nvsf_DecodeDepthScale = nvsf_opaqueData.data[1].w;
 	nvsf_out.nvsf_DecodeDepthBias = nvsf_opaqueData.data[2].x;
+	nvsf_out.nvsf_LUTArraySlice = nvsf_opaqueData.data[2].y;
+	nvsf_out.nvsf_LUTAtlasScale = nvsf_opaqueData.data[2].zw;
 	return nvsf_out;
 }
 
+// Remap LUT coordinates to the curvature (iLUT = 0) or shadow (iLUT = 1) LUT of a LUT atlas.
+// The LUTs sit side by side, each centered in its half of the atlas with padding around it,
+// so their offsets follow from their relative size.  Clamping to the LUT first keeps bilinear
+// samples within its padding, as clamp addressing would for a separate texture.
+float2 nvsf_CalculateLUTAtlasCoords(nvsf_CBData nvsf_cb, float2 nvsf_uv, float nvsf_iLUT)
+{
+	float2 nvsf_scale = nvsf_cb.nvsf_LUTAtlasScale;
+	float2 nvsf_bias = float2(0.25 + 0.5 * nvsf_iLUT, 0.5) - 0.5 * nvsf_scale;
+	return saturate(nvsf_uv) * nvsf_scale + nvsf_bias;
+}
+
+// Evaluate an ALU-only LUT fit at LUT coordinates uv, in place of a LUT sample; the same math
+// as GFSDK_FaceWorks_EvaluateLUTFit.  The fit is a bicubic polynomial in each of 6 x 2 cells,
+// in the offset of uv from the cell's center; see src/lutfit.cpp for the layout.
+float3 nvsf_EvaluateLUTFit(GFSDK_FaceWorks_LUTFitCBData nvsf_fit, float2 nvsf_uv)
+{
+	nvsf_uv = saturate(nvsf_uv);
+
+	// Find the cell
+	float nvsf_iU = dot(float4(nvsf_uv.xxxx >= nvsf_fit.data[0]), 1.0) + float(nvsf_uv.x >= nvsf_fit.data[1].x);
+	float nvsf_iV = float(nvsf_uv.y >= nvsf_fit.data[1].y);
+	float nvsf_centerU = dot(nvsf_fit.data[2], float4(nvsf_iU == float4(0.0, 1.0, 2.0, 3.0))) +
+							dot(nvsf_fit.data[3].xy, float2(nvsf_iU == float2(4.0, 5.0)));
+	float nvsf_centerV = (nvsf_iV != 0.0) ? nvsf_fit.data[1].w : nvsf_fit.data[1].z;
+	float nvsf_t = nvsf_uv.x - nvsf_centerU;
+	float nvsf_s = nvsf_uv.y - nvsf_centerV;
+	float4 nvsf_powersV = float4(1.0, nvsf_s, nvsf_s * nvsf_s, nvsf_s * nvsf_s * nvsf_s);
+
+	// Per channel, reduce the cell's coefficients to a cubic in t and evaluate it
+	int nvsf_iCoeff = 4 + int(nvsf_iV * 6.0 + nvsf_iU) * 12;
+	float3 nvsf_rgb;
+	[unroll] for (int nvsf_iChannel = 0; nvsf_iChannel < 3; ++nvsf_iChannel, nvsf_iCoeff += 4)
+	{
+		float4 nvsf_coeffsU = float4(
+								dot(nvsf_fit.data[nvsf_iCoeff], nvsf_powersV),
+								dot(nvsf_fit.data[nvsf_iCoeff + 1], nvsf_powersV),
+								dot(nvsf_fit.data[nvsf_iCoeff + 2], nvsf_powersV),
+								dot(nvsf_fit.data[nvsf_iCoeff + 3], nvsf_powersV));
+		nvsf_rgb[nvsf_iChannel] = ((nvsf_coeffsU.w * nvsf_t + nvsf_coeffsU.z) * nvsf_t + nvsf_coeffsU.y) * nvsf_t + nvsf_coeffsU.x;
+	}
+	return nvsf_rgb;
+}
+
 
 
 // ======================================================================================
@@ -322,23 +526,29 @@ float GFSDK_FaceWorks_CalculateMipLevelForBlurredNormal(
 				nvsf_cb.nvsf_MinLevelForBlurredNormal);
 }
 
-float3 GFSDK_FaceWorks_EvaluateSSSDirectLight(
-	GFSDK_FaceWorks_CBData nvsf_opaqueData,
-	float3 nvsf_normalGeom,
-	float3 nvsf_normalShade,
+// Curvature LUT coordinates for curvature-based scattering
+float2 nvsf_CalculateCurvatureLUTCoords(
+	nvsf_CBData nvsf_cb,
 	float3 nvsf_normalBlurred,
 	float3 nvsf_vecToLight,
-	float nvsf_curvature,
-	Texture2D nvsf_texCurvatureLUT,
-	SamplerState nvsf_ss)
+	float nvsf_curvature)
 {
-	nvsf_CBData nvsf_cb = nvsf_UnpackCBData(nvsf_opaqueData);
-
-	// Curvature-based scattering
 	float nvsf_NdotLBlurredUnclamped = dot(nvsf_normalBlurred, nvsf_vecToLight);
 	float nvsf_curvatureScaled = nvsf_curvature * nvsf_cb.nvsf_CurvatureScaleBias.x + nvsf_cb.nvsf_CurvatureScaleBias.y;
 	float2 nvsf_uvCurvatureLUT = { nvsf_NdotLBlurredUnclamped * 0.5 + 0.5, nvsf_curvatureScaled, };
-	float3 nvsf_rgbCurvature = nvsf_texCurvatureLUT.Sample(nvsf_ss, nvsf_uvCurvatureLUT).rgb * 0.5 - 0.25;
+	return nvsf_uvCurvatureLUT;
+}
+
+// Combine the curvature LUT texel with normal map scattering
+float3 nvsf_EvaluateSSSDirectLight(
+	float3 nvsf_normalShade,
+	float3 nvsf_normalBlurred,
+	float3 nvsf_vecToLight,
+	float3 nvsf_texelCurvatureLUT,
+	float2 nvsf_decode)
+{
+	float nvsf_NdotLBlurredUnclamped = dot(nvsf_normalBlurred, nvsf_vecToLight);
+	float3 nvsf_rgbCurvature = nvsf_texelCurvatureLUT * nvsf_decode.x + nvsf_decode.y;
 
 	// Normal map scattering using separate normals for R, G, B; here, G and B
 	// normals are generated by lerping between the specular and R normals.
@@ -356,25 +566,156 @@ float3 GFSDK_FaceWorks_EvaluateSSSDirectLight(
 	return saturate(nvsf_rgbCurvature + nvsf_rgbNdotL);
 }
 
-float3 GFSDK_FaceWorks_EvaluateSSSShadow(
+float3 GFSDK_FaceWorks_EvaluateSSSDirectLight(
 	GFSDK_FaceWorks_CBData nvsf_opaqueData,
 	float3 nvsf_normalGeom,
+	float3 nvsf_normalShade,
+	float3 nvsf_normalBlurred,
 	float3 nvsf_vecToLight,
-	float nvsf_shadow,
-	Texture2D nvsf_texShadowLUT,
+	float nvsf_curvature,
+	Texture2D nvsf_texCurvatureLUT,
 	SamplerState nvsf_ss)
 {
 	nvsf_CBData nvsf_cb = nvsf_UnpackCBData(nvsf_opaqueData);
 
-	// Shadow penumbra scattering
+	// Curvature-based scattering
+	float2 nvsf_uvCurvatureLUT = nvsf_CalculateCurvatureLUTCoords(nvsf_cb, nvsf_normalBlurred, nvsf_vecToLight, nvsf_curvature);
+	float3 nvsf_texelCurvatureLUT = nvsf_texCurvatureLUT.Sample(nvsf_ss, nvsf_uvCurvatureLUT).rgb;
+
+	return nvsf_EvaluateSSSDirectLight(nvsf_normalShade, nvsf_normalBlurred, nvsf_vecToLight, nvsf_texelCurvatureLUT,
+										GFSDK_FaceWorks_CurvatureLUTDecode);
+}
+float3 GFSDK_FaceWorks_EvaluateSSSDirectLight(
+	GFSDK_FaceWorks_CBData nvsf_opaqueData,
+	float3 nvsf_normalGeom,
+	float3 nvsf_normalShade,
+	float3 nvsf_normalBlurred,
+	float3 nvsf_vecToLight,
+	float nvsf_curvature,
+	Texture2DArray nvsf_texCurvatureLUT,
+	SamplerState nvsf_ss)
+{
+	nvsf_CBData nvsf_cb = nvsf_UnpackCBData(nvsf_opaqueData);
+
+	// Curvature-based scattering
+	float2 nvsf_uvCurvatureLUT = nvsf_CalculateCurvatureLUTCoords(nvsf_cb, nvsf_normalBlurred, nvsf_vecToLight, nvsf_curvature);
+	float3 nvsf_texelCurvatureLUT = nvsf_texCurvatureLUT.Sample(nvsf_ss,
+										float3(nvsf_uvCurvatureLUT, nvsf_cb.nvsf_LUTArraySlice)).rgb;
+
+	return nvsf_EvaluateSSSDirectLight(nvsf_normalShade, nvsf_normalBlurred, nvsf_vecToLight, nvsf_texelCurvatureLUT,
+										GFSDK_FaceWorks_CurvatureLUTDecode);
+}
+
+float3 GFSDK_FaceWorks_EvaluateSSSDirectLightFromAtlas(
+	GFSDK_FaceWorks_CBData nvsf_opaqueData,
+	float3 nvsf_normalGeom,
+	float3 nvsf_normalShade,
+	float3 nvsf_normalBlurred,
+	float3 nvsf_vecToLight,
+	float nvsf_curvature,
+	Texture2D nvsf_texLUTAtlas,
+	SamplerState nvsf_ss)
+{
+	nvsf_CBData nvsf_cb = nvsf_UnpackCBData(nvsf_opaqueData);
+
+	// Curvature-based scattering
+	float2 nvsf_uvCurvatureLUT = nvsf_CalculateCurvatureLUTCoords(nvsf_cb, nvsf_normalBlurred, nvsf_vecToLight, nvsf_curvature);
+	float3 nvsf_texelCurvatureLUT = nvsf_texLUTAtlas.Sample(nvsf_ss,
+										nvsf_CalculateLUTAtlasCoords(nvsf_cb, nvsf_uvCurvatureLUT, 0.0)).rgb;
+
+	return nvsf_EvaluateSSSDirectLight(nvsf_normalShade, nvsf_normalBlurred, nvsf_vecToLight, nvsf_texelCurvatureLUT,
+										GFSDK_FaceWorks_CurvatureLUTDecode);
+}
+float3 GFSDK_FaceWorks_EvaluateSSSDirectLight(
+	GFSDK_FaceWorks_CBData nvsf_opaqueData,
+	GFSDK_FaceWorks_LUTFitCBData nvsf_fitCurvatureLUT,
+	float3 nvsf_normalGeom,
+	float3 nvsf_normalShade,
+	float3 nvsf_normalBlurred,
+	float3 nvsf_vecToLight,
+	float nvsf_curvature)
+{
+	nvsf_CBData nvsf_cb = nvsf_UnpackCBData(nvsf_opaqueData);
+
+	// Curvature-based scattering
+	float2 nvsf_uvCurvatureLUT = nvsf_CalculateCurvatureLUTCoords(nvsf_cb, nvsf_normalBlurred, nvsf_vecToLight, nvsf_curvature);
+	float3 nvsf_texelCurvatureLUT = nvsf_EvaluateLUTFit(nvsf_fitCurvatureLUT, nvsf_uvCurvatureLUT);
+
+	return nvsf_EvaluateSSSDirectLight(nvsf_normalShade, nvsf_normalBlurred, nvsf_vecToLight, nvsf_texelCurvatureLUT,
+										GFSDK_FaceWorks_CurvatureLUTDecode_RGBA8);
+}
+
+// Shadow LUT coordinates for shadow penumbra scattering
+float2 nvsf_CalculateShadowLUTCoords(
+	nvsf_CBData nvsf_cb,
+	float3 nvsf_normalGeom,
+	float3 nvsf_vecToLight,
+	float nvsf_shadow)
+{
 	float nvsf_NdotLGeom = saturate(dot(nvsf_normalGeom, nvsf_vecToLight));
 	float2 nvsf_uvShadowLUT =
 	{
 		nvsf_shadow,
 		nvsf_NdotLGeom * nvsf_cb.nvsf_ShadowScaleBias.x + nvsf_cb.nvsf_ShadowScaleBias.y,
 	};
+	return nvsf_uvShadowLUT;
+}
+
+float3 GFSDK_FaceWorks_EvaluateSSSShadow(
+	GFSDK_FaceWorks_CBData nvsf_opaqueData,
+	float3 nvsf_normalGeom,
+	float3 nvsf_vecToLight,
+	float nvsf_shadow,
+	Texture2D nvsf_texShadowLUT,
+	SamplerState nvsf_ss)
+{
+	nvsf_CBData nvsf_cb = nvsf_UnpackCBData(nvsf_opaqueData);
+
+	// Shadow penumbra scattering
+	float2 nvsf_uvShadowLUT = nvsf_CalculateShadowLUTCoords(nvsf_cb, nvsf_normalGeom, nvsf_vecToLight, nvsf_shadow);
 	return nvsf_texShadowLUT.Sample(nvsf_ss, nvsf_uvShadowLUT).rgb;
 }
+float3 GFSDK_FaceWorks_EvaluateSSSShadow(
+	GFSDK_FaceWorks_CBData nvsf_opaqueData,
+	float3 nvsf_normalGeom,
+	float3 nvsf_vecToLight,
+	float nvsf_shadow,
+	Texture2DArray nvsf_texShadowLUT,
+	SamplerState nvsf_ss)
+{
+	nvsf_CBData nvsf_cb = nvsf_UnpackCBData(nvsf_opaqueData);
+
+	// Shadow penumbra scattering
+	float2 nvsf_uvShadowLUT = nvsf_CalculateShadowLUTCoords(nvsf_cb, nvsf_normalGeom, nvsf_vecToLight, nvsf_shadow);
+	return nvsf_texShadowLUT.Sample(nvsf_ss, float3(nvsf_uvShadowLUT, nvsf_cb.nvsf_LUTArraySlice)).rgb;
+}
+float3 GFSDK_FaceWorks_EvaluateSSSShadowFromAtlas(
+	GFSDK_FaceWorks_CBData nvsf_opaqueData,
+	float3 nvsf_normalGeom,
+	float3 nvsf_vecToLight,
+	float nvsf_shadow,
+	Texture2D nvsf_texLUTAtlas,
+	SamplerState nvsf_ss)
+{
+	nvsf_CBData nvsf_cb = nvsf_UnpackCBData(nvsf_opaqueData);
+
+	// Shadow penumbra scattering
+	float2 nvsf_uvShadowLUT = nvsf_CalculateShadowLUTCoords(nvsf_cb, nvsf_normalGeom, nvsf_vecToLight, nvsf_shadow);
+	return nvsf_texLUTAtlas.Sample(nvsf_ss, nvsf_CalculateLUTAtlasCoords(nvsf_cb, nvsf_uvShadowLUT, 1.0)).rgb;
+}
+float3 GFSDK_FaceWorks_EvaluateSSSShadow(
+	GFSDK_FaceWorks_CBData nvsf_opaqueData,
+	GFSDK_FaceWorks_LUTFitCBData nvsf_fitShadowLUT,
+	float3 nvsf_normalGeom,
+	float3 nvsf_vecToLight,
+	float nvsf_shadow)
+{
+	nvsf_CBData nvsf_cb = nvsf_UnpackCBData(nvsf_opaqueData);
+
+	// Shadow penumbra scattering; the fit may overshoot the LUT's [0, 1] range slightly
+	float2 nvsf_uvShadowLUT = nvsf_CalculateShadowLUTCoords(nvsf_cb, nvsf_normalGeom, nvsf_vecToLight, nvsf_shadow);
+	return saturate(nvsf_EvaluateLUTFit(nvsf_fitShadowLUT, nvsf_uvShadowLUT));
+}
 
 float GFSDK_FaceWorks_SharpenShadow(
 	float nvsf_shadow,
@@ -107,7 +107,7 @@ struct Material
 	ID3D11ShaderResourceView *
 					m_aSrv[4];					// Textures
 	int				m_textureSlots[4];			// Slots where to bind the textures
-	float			m_constants[24];			// Data for CB_SHADER constant buffer - includes
+	float			m_constants[28];			// Data for CB_SHADER constant buffer - includes
 												//   FaceWorks constant buffer data as well
 };
 
@@ -463,32 +463,64 @@ void FreeForFaceWorks(void * p)
 	::operator delete(p);
 }
 
-void CalculateCurvature(CMesh * pMesh)
+GFSDK_FaceWorks_MeshContext * CreateMeshContext(CMesh * pMesh)
 {
-	// Calculate mesh curvature - also demonstrate using a custom allocator
+	// Build the mesh's topology once, for both the curvature and UV scale calculations
+	// - also demonstrate using a custom allocator, which the context keeps using
 
 	GFSDK_FaceWorks_ErrorBlob errorBlob = {};
 	gfsdk_new_delete_t allocator = { &MallocForFaceWorks, &FreeForFaceWorks };
-	GFSDK_FaceWorks_Result result = GFSDK_FaceWorks_CalculateMeshCurvature(
+	GFSDK_FaceWorks_MeshContext * pMeshContext = nullptr;
+	GFSDK_FaceWorks_Result result = GFSDK_FaceWorks_CreateMeshContext(
 										int(pMesh->m_verts.size()),
 										&pMesh->m_verts[0].m_pos,
 										sizeof(Vertex),
-										&pMesh->m_verts[0].m_normal,
-										sizeof(Vertex),
 										int(pMesh->m_indices.size()),
 										&pMesh->m_indices[0],
+										0, // don't weld
+										&pMeshContext,
+										&errorBlob,
+										&allocator);
+
+	if (result != GFSDK_FaceWorks_OK)
+	{
+#if defined(_DEBUG)
+		wchar_t msg[512];
+		_snwprintf_s(msg, dim(msg), _TRUNCATE,
+			L"GFSDK_FaceWorks_CreateMeshContext() failed:\n%hs", errorBlob.m_msg);
+		DXUTTrace(__FILE__, __LINE__, E_FAIL, msg, true);
+#endif
+		GFSDK_FaceWorks_FreeErrorBlob(&errorBlob);
+		return nullptr;
+	}
+
+	return pMeshContext;
+}
+
+void CalculateCurvature(CMesh * pMesh, const GFSDK_FaceWorks_MeshContext * pMeshContext)
+{
+	// Calculate mesh curvature
+
+	GFSDK_FaceWorks_ErrorBlob errorBlob = {};
+	GFSDK_FaceWorks_Result result = GFSDK_FaceWorks_CalculateMeshCurvatureFromContext(
+										pMeshContext,
+										&pMesh->m_verts[0].m_pos,
+										sizeof(Vertex),
+										&pMesh->m_verts[0].m_normal,
+										sizeof(Vertex),
 										2, // smoothing passes
 										&pMesh->m_verts[0].m_curvature,
 										sizeof(Vertex),
+										nullptr, // no stats
 										&errorBlob,
-										&allocator);
+										nullptr); // serial
 
 	if (result != GFSDK_FaceWorks_OK)
 	{
 #if defined(_DEBUG)
 		wchar_t msg[512];
 		_snwprintf_s(msg, dim(msg), _TRUNCATE, 
-			L"GFSDK_FaceWorks_CalculateMeshCurvature() failed:\n%hs", errorBlob.m_msg);
+			L"GFSDK_FaceWorks_CalculateMeshCurvatureFromContext() failed:\n%hs", errorBlob.m_msg);
 		DXUTTrace(__FILE__, __LINE__, E_FAIL, msg, true);
 #endif
 		GFSDK_FaceWorks_FreeErrorBlob(&errorBlob);
@@ -513,17 +545,13 @@ void CalculateCurvature(CMesh * pMesh)
 #endif // defined(_DEBUG)
 }
 
-void CalculateUVScale(CMesh * pMesh)
+void CalculateUVScale(CMesh * pMesh, const GFSDK_FaceWorks_MeshContext * pMeshContext)
 {
 	GFSDK_FaceWorks_ErrorBlob errorBlob = {};
-	GFSDK_FaceWorks_Result result = GFSDK_FaceWorks_CalculateMeshUVScale(
-										int(pMesh->m_verts.size()),
-										&pMesh->m_verts[0].m_pos,
-										sizeof(Vertex),
+	GFSDK_FaceWorks_Result result = GFSDK_FaceWorks_CalculateMeshUVScaleFromContext(
+										pMeshContext,
 										&pMesh->m_verts[0].m_uv,
 										sizeof(Vertex),
-										int(pMesh->m_indices.size()),
-										&pMesh->m_indices[0],
 										&pMesh->m_uvScale,
 										&errorBlob);
 	if (result != GFSDK_FaceWorks_OK)
@@ -531,7 +559,7 @@ void CalculateUVScale(CMesh * pMesh)
 #if defined(_DEBUG)
 		wchar_t msg[512];
 		_snwprintf_s(msg, dim(msg), _TRUNCATE,
-			L"GFSDK_FaceWorks_CalculateMeshUVScale() failed:\n%hs", errorBlob.m_msg);
+			L"GFSDK_FaceWorks_CalculateMeshUVScaleFromContext() failed:\n%hs", errorBlob.m_msg);
 		DXUTTrace(__FILE__, __LINE__, E_FAIL, msg, true);
 #endif
 		GFSDK_FaceWorks_FreeErrorBlob(&errorBlob);
@@ -658,8 +686,12 @@ HRESULT LoadObjMesh(
 	XMStoreFloat3(&pMesh->m_posCenter, 0.5f * (posMin + posMax));
 	pMesh->m_diameter = XMVectorGetX(XMVector3Length(posMax - posMin));
 
-	CalculateCurvature(pMesh);
-	CalculateUVScale(pMesh);
+	if (GFSDK_FaceWorks_MeshContext * pMeshContext = CreateMeshContext(pMesh))
+	{
+		CalculateCurvature(pMesh, pMeshContext);
+		CalculateUVScale(pMesh, pMeshContext);
+		GFSDK_FaceWorks_ReleaseMeshContext(pMeshContext);
+	}
 	CalculateTangents(pMesh);
 
 	D3D11_BUFFER_DESC vtxBufferDesc =
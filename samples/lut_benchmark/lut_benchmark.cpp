@@ -0,0 +1,910 @@
+//----------------------------------------------------------------------------------
+// File:        FaceWorks/samples/lut_benchmark/lut_benchmark.cpp
+// SDK Version: v1.0
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014-2016, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+// Accuracy-versus-speed regression harness for the LUT generators.  For each config in a grid
+// (starting with the lut_generator defaults), it generates a reference LUT with the default
+// 200-sample midpoint rule, then runs every faster path to the same LUT - other integration
+// modes, small LUTs, the ALU fits, the other pixel formats and block compression - and measures
+// each against the reference at the reference's texels, looked up the way the shaders look them
+// up.  The results are written as JSON, and the exit code is nonzero if any mode is over its
+// error budget.
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <GFSDK_FaceWorks.h>
+
+
+
+// Command-line processing
+
+void PrintUsage()
+{
+	printf(
+		"Usage: lut_benchmark [options]\n"
+		"Options:\n"
+		" -json FILENAME                Write the results as JSON; default is lut_benchmark.json\n"
+		" -size INT                     Width and height of the reference LUTs; default is 256\n"
+		" -threads INT                  Number of worker threads; default is 1, for steady timings\n"
+		" -budgetScale FLOAT            Scale every mode's error budget; default is 1.0\n"
+		"\n"
+		"Exits with 1 if any mode's max error is over its budget, or if anything fails.\n"
+		"\n"
+	);
+}
+
+bool ReadInt(
+	const char ** argNameAndValue,
+	int * pValue,
+	int minValid = INT_MIN,
+	int maxValid = INT_MAX)
+{
+	assert(minValid <= maxValid);
+
+	const char * argName = argNameAndValue[0];
+	const char * strValue = argNameAndValue[1];
+
+	if (!strValue)
+	{
+		fprintf(stderr, "%s: missing argument; ignoring\n", argName);
+		return false;
+	}
+
+	int value;
+	if (!sscanf_s(strValue, "%d", &value))
+	{
+		fprintf(stderr, "%s: could not parse \"%s\" as an int; ignoring\n", argName, strValue);
+		return false;
+	}
+
+	*pValue = std::max(minValid, std::min(maxValid, value));
+	return true;
+}
+
+bool ReadFloat(
+	const char ** argNameAndValue,
+	float * pValue,
+	float minValid = -FLT_MAX,
+	float maxValid = FLT_MAX)
+{
+	assert(minValid <= maxValid);
+
+	const char * argName = argNameAndValue[0];
+	const char * strValue = argNameAndValue[1];
+
+	if (!strValue)
+	{
+		fprintf(stderr, "%s: missing argument; ignoring\n", argName);
+		return false;
+	}
+
+	float value;
+	if (!sscanf_s(strValue, "%f", &value))
+	{
+		fprintf(stderr, "%s: could not parse \"%s\" as a float; ignoring\n", argName, strValue);
+		return false;
+	}
+
+	*pValue = std::max(minValid, std::min(maxValid, value));
+	return true;
+}
+
+
+
+// The grid of configs: the lut_generator defaults, then one parameter varied at a time
+
+struct BenchmarkConfig
+{
+	const char *	m_strName;
+	float			m_diffusionRadius;
+	float			m_curvatureRadiusMin, m_curvatureRadiusMax;
+	float			m_shadowWidthMin, m_shadowWidthMax;
+	float			m_shadowSharpening;
+};
+
+static const BenchmarkConfig s_configs[] =
+{
+	{ "default",			2.7f,	1.0f, 100.0f,	8.0f, 100.0f,	10.0f },
+	{ "thinSkin",			1.5f,	1.0f, 100.0f,	8.0f, 100.0f,	10.0f },
+	{ "thickSkin",			5.0f,	1.0f, 100.0f,	8.0f, 100.0f,	10.0f },
+	{ "tightCurvature",		2.7f,	0.5f, 20.0f,	8.0f, 100.0f,	10.0f },
+	{ "softShadow",			2.7f,	1.0f, 100.0f,	2.0f, 50.0f,	3.0f },
+	{ "hardShadow",			2.7f,	1.0f, 100.0f,	8.0f, 100.0f,	30.0f },
+};
+static const int s_configCount = int(sizeof(s_configs) / sizeof(s_configs[0]));
+
+// The other paths, each with the max error it may have against each LUT's reference, in 8-bit
+// LSBs of linear values.  Each budget is the largest error the grid measures, with either the
+// scalar or the AVX-512 precomputation kernels, plus 10%, rounded up to a quarter LSB.  Midpoint
+// integration aliases badly below about 128 samples.  The format modes' budgets are mostly their
+// quantization: half a step of 8 bits (wider in sRGB near white), of 5 bits for RGB565, and of
+// the 6- and 5-bit mantissas of R11G11B10F.
+
+enum ModeKind
+{
+	ModeKind_Integration,		// The same LUT, with another integration rule
+	ModeKind_SmallLUT,			// A smaller LUT, sampled bilinearly
+	ModeKind_Fit,				// The ALU-only fit of the LUT
+	ModeKind_Format,			// The LUT in another pixel format
+	ModeKind_Compressed,		// The LUT in RGBA8, block-compressed
+};
+
+static const int cLUTCurvature = 1;
+static const int cLUTShadow = 2;
+
+struct BenchmarkMode
+{
+	const char *						m_strName;
+	int									m_luts;				// Which LUTs it applies to
+	ModeKind							m_kind;
+	GFSDK_FaceWorks_LUTIntegrationMode	m_integrationMode;
+	int									m_integrationSampleCount;
+	int									m_texSize;			// For small LUTs
+	GFSDK_FaceWorks_LUTFormat			m_format;			// For other formats
+	GFSDK_FaceWorks_LUTCompression		m_compression;
+	float								m_curvatureBudgetLSB, m_shadowBudgetLSB;	// For the LUTs it applies to
+};
+
+static const BenchmarkMode s_modes[] =
+{
+	{ "midpoint128",	cLUTCurvature | cLUTShadow,	ModeKind_Integration,	GFSDK_FaceWorks_LUTIntegration_Midpoint,	128,	0,	GFSDK_FaceWorks_LUTFormat_RGBA16F,	GFSDK_FaceWorks_LUTCompression_BC1,	4.25f, 8.25f },
+	{ "piecewise",		cLUTCurvature | cLUTShadow,	ModeKind_Integration,	GFSDK_FaceWorks_LUTIntegration_Piecewise,	0,	0,	GFSDK_FaceWorks_LUTFormat_RGBA16F,	GFSDK_FaceWorks_LUTCompression_BC1,	0.5f, 1.75f },
+	{ "analytic",		cLUTShadow,					ModeKind_Integration,	GFSDK_FaceWorks_LUTIntegration_Analytic,	0,	0,	GFSDK_FaceWorks_LUTFormat_RGBA16F,	GFSDK_FaceWorks_LUTCompression_BC1,	0.0f, 1.0f },
+	{ "convolution",	cLUTCurvature,				ModeKind_Integration,	GFSDK_FaceWorks_LUTIntegration_Convolution,	0,	0,	GFSDK_FaceWorks_LUTFormat_RGBA16F,	GFSDK_FaceWorks_LUTCompression_BC1,	0.5f, 0.0f },
+	{ "small64",		cLUTCurvature | cLUTShadow,	ModeKind_SmallLUT,		GFSDK_FaceWorks_LUTIntegration_Midpoint,	0,	64,	GFSDK_FaceWorks_LUTFormat_RGBA16F,	GFSDK_FaceWorks_LUTCompression_BC1,	4.75f, 14.75f },
+	{ "fit",			cLUTCurvature | cLUTShadow,	ModeKind_Fit,			GFSDK_FaceWorks_LUTIntegration_Midpoint,	0,	0,	GFSDK_FaceWorks_LUTFormat_RGBA16F,	GFSDK_FaceWorks_LUTCompression_BC1,	1.75f, 7.75f },
+	{ "rgb8",			cLUTCurvature | cLUTShadow,	ModeKind_Format,		GFSDK_FaceWorks_LUTIntegration_Midpoint,	0,	0,	GFSDK_FaceWorks_LUTFormat_RGB8,		GFSDK_FaceWorks_LUTCompression_BC1,	0.75f, 1.5f },
+	{ "r11g11b10f",		cLUTCurvature | cLUTShadow,	ModeKind_Format,		GFSDK_FaceWorks_LUTIntegration_Midpoint,	0,	0,	GFSDK_FaceWorks_LUTFormat_R11G11B10F,	GFSDK_FaceWorks_LUTCompression_BC1,	2.25f, 2.25f },
+	{ "rgb9e5",			cLUTCurvature | cLUTShadow,	ModeKind_Format,		GFSDK_FaceWorks_LUTIntegration_Midpoint,	0,	0,	GFSDK_FaceWorks_LUTFormat_RGB9E5,	GFSDK_FaceWorks_LUTCompression_BC1,	0.5f, 0.75f },
+	{ "rgb565",			cLUTCurvature | cLUTShadow,	ModeKind_Format,		GFSDK_FaceWorks_LUTIntegration_Midpoint,	0,	0,	GFSDK_FaceWorks_LUTFormat_RGB565,	GFSDK_FaceWorks_LUTCompression_BC1,	4.75f, 4.75f },
+	{ "bc7",			cLUTCurvature | cLUTShadow,	ModeKind_Compressed,	GFSDK_FaceWorks_LUTIntegration_Midpoint,	0,	0,	GFSDK_FaceWorks_LUTFormat_RGBA16F,	GFSDK_FaceWorks_LUTCompression_BC7,	2.75f, 4.5f },
+	{ "bc1",			cLUTCurvature | cLUTShadow,	ModeKind_Compressed,	GFSDK_FaceWorks_LUTIntegration_Midpoint,	0,	0,	GFSDK_FaceWorks_LUTFormat_RGBA16F,	GFSDK_FaceWorks_LUTCompression_BC1,	6.75f, 14.25f },
+};
+static const int s_modeCount = int(sizeof(s_modes) / sizeof(s_modes[0]));
+
+
+
+// LUTs as float RGB, for comparison
+
+struct FloatLUT
+{
+	int					m_width;
+	int					m_height;
+	std::vector<float>	m_rgb;
+
+	// Bilinear sample with clamping, as the shaders' samplers do
+	void Sample(float u, float v, float rgbOut[3]) const
+	{
+		float x = std::max(0.0f, std::min(float(m_width - 1), u * float(m_width) - 0.5f));
+		float y = std::max(0.0f, std::min(float(m_height - 1), v * float(m_height) - 0.5f));
+		int iX0 = int(x), iY0 = int(y);
+		int iX1 = std::min(iX0 + 1, m_width - 1), iY1 = std::min(iY0 + 1, m_height - 1);
+		float tx = x - float(iX0), ty = y - float(iY0);
+
+		for (int c = 0; c < 3; ++c)
+		{
+			float top = Texel(iX0, iY0, c) + tx * (Texel(iX1, iY0, c) - Texel(iX0, iY0, c));
+			float bottom = Texel(iX0, iY1, c) + tx * (Texel(iX1, iY1, c) - Texel(iX0, iY1, c));
+			rgbOut[c] = top + ty * (bottom - top);
+		}
+	}
+
+	float Texel(int iX, int iY, int c) const
+	{
+		return m_rgb[3 * (size_t(iY) * size_t(m_width) + size_t(iX)) + c];
+	}
+};
+
+// An unsigned float with a 5-bit exponent (bias 15) and the given number of mantissa bits, as in
+// R11G11B10F and the magnitude of a half
+float SmallFloatToFloat(unsigned int bits, int mantissaBits)
+{
+	unsigned int exponent = (bits >> mantissaBits) & 0x1f;
+	unsigned int mantissa = bits & ((1u << mantissaBits) - 1);
+	return (exponent == 0) ?
+			ldexpf(float(mantissa), -14 - mantissaBits) :
+			ldexpf(float(mantissa | (1u << mantissaBits)), int(exponent) - 15 - mantissaBits);
+}
+
+float HalfToFloat(unsigned int half)
+{
+	float value = SmallFloatToFloat(half, 10);
+	return (half & 0x8000) ? -value : value;
+}
+
+float SRGBToLinear(float value)
+{
+	return (value <= 0.04045f) ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+}
+
+unsigned int ReadLittleEndian(const unsigned char * pPx, int byteCount)
+{
+	unsigned int value = 0;
+	for (int i = 0; i < byteCount; ++i)
+		value |= unsigned(pPx[i]) << (8 * i);
+	return value;
+}
+
+// Expand texels in any LUT format to float RGB, as the shaders' samplers read them; isSRGB says
+// the LUT is stored in sRGB space in the 8-bit formats, as the shadow LUT is
+void DecodeLUTTexels(
+	const std::vector<unsigned char> & texels,
+	GFSDK_FaceWorks_LUTFormat format,
+	bool isSRGB,
+	FloatLUT * pLUT)
+{
+	size_t texelCount = size_t(pLUT->m_width) * size_t(pLUT->m_height);
+	size_t texelBytes = GFSDK_FaceWorks_CalculateLUTTexelSizeBytes(format);
+	pLUT->m_rgb.resize(3 * texelCount);
+	for (size_t i = 0; i < texelCount; ++i)
+	{
+		const unsigned char * pPx = &texels[i * texelBytes];
+		float * pRGB = &pLUT->m_rgb[3 * i];
+		switch (format)
+		{
+		case GFSDK_FaceWorks_LUTFormat_RGBA8:
+		case GFSDK_FaceWorks_LUTFormat_RGB8:
+		default:
+			for (int c = 0; c < 3; ++c)
+				pRGB[c] = isSRGB ? SRGBToLinear(float(pPx[c]) / 255.0f) : float(pPx[c]) / 255.0f;
+			break;
+
+		case GFSDK_FaceWorks_LUTFormat_R11G11B10F:
+		{
+			unsigned int bits = ReadLittleEndian(pPx, 4);
+			pRGB[0] = SmallFloatToFloat(bits & 0x7ff, 6);
+			pRGB[1] = SmallFloatToFloat((bits >> 11) & 0x7ff, 6);
+			pRGB[2] = SmallFloatToFloat(bits >> 22, 5);
+			break;
+		}
+
+		case GFSDK_FaceWorks_LUTFormat_RGB9E5:
+		{
+			unsigned int bits = ReadLittleEndian(pPx, 4);
+			float scale = ldexpf(1.0f, int(bits >> 27) - 15 - 9);
+			for (int c = 0; c < 3; ++c)
+				pRGB[c] = float((bits >> (9 * c)) & 0x1ff) * scale;
+			break;
+		}
+
+		case GFSDK_FaceWorks_LUTFormat_RGBA16F:
+			for (int c = 0; c < 3; ++c)
+				pRGB[c] = HalfToFloat(ReadLittleEndian(pPx + 2 * c, 2));
+			break;
+
+		case GFSDK_FaceWorks_LUTFormat_RGB565:
+		{
+			unsigned int bits = ReadLittleEndian(pPx, 2);
+			pRGB[0] = float(bits >> 11) / 31.0f;
+			pRGB[1] = float((bits >> 5) & 63) / 63.0f;
+			pRGB[2] = float(bits & 31) / 31.0f;
+			break;
+		}
+		}
+	}
+}
+
+
+
+// Decoding the block-compressed LUTs, in the subsets of BC1 and BC7 that GFSDK_FaceWorks_CompressLUT() emits
+
+void DecodeBC1Block(const unsigned char * pBlock, int rgbOut[16][3])
+{
+	unsigned int colors[2] = { pBlock[0] | (unsigned(pBlock[1]) << 8), pBlock[2] | (unsigned(pBlock[3]) << 8) };
+	int palette[4][3];
+	for (int iEnd = 0; iEnd < 2; ++iEnd)
+	{
+		unsigned int r = colors[iEnd] >> 11, g = (colors[iEnd] >> 5) & 63, b = colors[iEnd] & 31;
+		palette[iEnd][0] = (r << 3) | (r >> 2);
+		palette[iEnd][1] = (g << 2) | (g >> 4);
+		palette[iEnd][2] = (b << 3) | (b >> 2);
+	}
+	for (int c = 0; c < 3; ++c)
+	{
+		if (colors[0] > colors[1])
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+		}
+		else
+		{
+			palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+			palette[3][c] = 0;
+		}
+	}
+
+	for (int i = 0; i < 16; ++i)
+	{
+		int index = (pBlock[4 + i / 4] >> (2 * (i % 4))) & 3;
+		for (int c = 0; c < 3; ++c)
+			rgbOut[i][c] = palette[index][c];
+	}
+}
+
+unsigned int ReadBlockBits(const unsigned char * pBlock, int * pIBit, int bitCount)
+{
+	unsigned int value = 0;
+	for (int i = 0; i < bitCount; ++i, ++*pIBit)
+		value |= ((pBlock[*pIBit >> 3] >> (*pIBit & 7)) & 1u) << i;
+	return value;
+}
+
+bool DecodeBC7Block(const unsigned char * pBlock, int rgbOut[16][3])
+{
+	// Mode 6 only
+	int iBit = 0;
+	if (ReadBlockBits(pBlock, &iBit, 7) != (1u << 6))
+		return false;
+
+	unsigned int q[4][2];
+	for (int c = 0; c < 4; ++c)
+		for (int iEnd = 0; iEnd < 2; ++iEnd)
+			q[c][iEnd] = ReadBlockBits(pBlock, &iBit, 7);
+	unsigned int p[2] = { ReadBlockBits(pBlock, &iBit, 1), ReadBlockBits(pBlock, &iBit, 1) };
+
+	static const int s_weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+	for (int i = 0; i < 16; ++i)
+	{
+		int w = s_weights[ReadBlockBits(pBlock, &iBit, (i == 0) ? 3 : 4)];
+		for (int c = 0; c < 3; ++c)
+		{
+			int a = int((q[c][0] << 1) | p[0]), b = int((q[c][1] << 1) | p[1]);
+			rgbOut[i][c] = ((64 - w) * a + w * b + 32) >> 6;
+		}
+	}
+	return true;
+}
+
+bool DecodeCompressedLUT(
+	const std::vector<unsigned char> & blocks,
+	GFSDK_FaceWorks_LUTCompression compression,
+	bool isSRGB,
+	FloatLUT * pLUT)
+{
+	int blockCountX = (pLUT->m_width + 3) / 4;
+	int blockCountY = (pLUT->m_height + 3) / 4;
+	size_t blockBytes = (compression == GFSDK_FaceWorks_LUTCompression_BC1) ? 8 : 16;
+	pLUT->m_rgb.resize(3 * size_t(pLUT->m_width) * size_t(pLUT->m_height));
+
+	for (int iBlockY = 0; iBlockY < blockCountY; ++iBlockY)
+	{
+		for (int iBlockX = 0; iBlockX < blockCountX; ++iBlockX)
+		{
+			const unsigned char * pBlock = &blocks[(size_t(iBlockY) * size_t(blockCountX) + size_t(iBlockX)) * blockBytes];
+			int rgb[16][3];
+			if (compression == GFSDK_FaceWorks_LUTCompression_BC1)
+				DecodeBC1Block(pBlock, rgb);
+			else if (!DecodeBC7Block(pBlock, rgb))
+				return false;
+
+			for (int i = 0; i < 16; ++i)
+			{
+				int iX = 4 * iBlockX + i % 4, iY = 4 * iBlockY + i / 4;
+				if (iX >= pLUT->m_width || iY >= pLUT->m_height)
+					continue;
+				for (int c = 0; c < 3; ++c)
+				{
+					float value = float(rgb[i][c]) / 255.0f;
+					pLUT->m_rgb[3 * (size_t(iY) * size_t(pLUT->m_width) + size_t(iX)) + c] = isSRGB ? SRGBToLinear(value) : value;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+
+
+// The two LUT kinds, behind overloads so one driver can run both
+
+void MakeConfig(const BenchmarkConfig & config, int texSize, GFSDK_FaceWorks_CurvatureLUTConfig * pConfigOut)
+{
+	GFSDK_FaceWorks_CurvatureLUTConfig lutConfig =
+	{
+		config.m_diffusionRadius,
+		texSize, texSize,
+		config.m_curvatureRadiusMin, config.m_curvatureRadiusMax,
+		GFSDK_FaceWorks_LUTIntegration_Midpoint,
+		0,
+		GFSDK_FaceWorks_LUTFormat_RGBA16F,
+	};
+	*pConfigOut = lutConfig;
+}
+
+void MakeConfig(const BenchmarkConfig & config, int texSize, GFSDK_FaceWorks_ShadowLUTConfig * pConfigOut)
+{
+	GFSDK_FaceWorks_ShadowLUTConfig lutConfig =
+	{
+		config.m_diffusionRadius,
+		texSize, texSize,
+		config.m_shadowWidthMin, config.m_shadowWidthMax,
+		config.m_shadowSharpening,
+		GFSDK_FaceWorks_LUTIntegration_Midpoint,
+		0,
+		GFSDK_FaceWorks_LUTFormat_RGBA16F,
+	};
+	*pConfigOut = lutConfig;
+}
+
+size_t CalculateSizeBytes(const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig)
+{
+	return GFSDK_FaceWorks_CalculateCurvatureLUTSizeBytes(pConfig);
+}
+
+size_t CalculateSizeBytes(const GFSDK_FaceWorks_ShadowLUTConfig * pConfig)
+{
+	return GFSDK_FaceWorks_CalculateShadowLUTSizeBytes(pConfig);
+}
+
+GFSDK_FaceWorks_Result Generate(
+	const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig,
+	void * pTexelsOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlob,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	return GFSDK_FaceWorks_GenerateCurvatureLUT(pConfig, pTexelsOut, pErrorBlob, NULL, pParallelConfig);
+}
+
+GFSDK_FaceWorks_Result Generate(
+	const GFSDK_FaceWorks_ShadowLUTConfig * pConfig,
+	void * pTexelsOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlob,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	return GFSDK_FaceWorks_GenerateShadowLUT(pConfig, pTexelsOut, pErrorBlob, NULL, pParallelConfig);
+}
+
+GFSDK_FaceWorks_Result Fit(
+	const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig,
+	GFSDK_FaceWorks_LUTFitCBData * pFitOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlob,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	return GFSDK_FaceWorks_FitCurvatureLUT(pConfig, pFitOut, NULL, pErrorBlob, NULL, pParallelConfig);
+}
+
+GFSDK_FaceWorks_Result Fit(
+	const GFSDK_FaceWorks_ShadowLUTConfig * pConfig,
+	GFSDK_FaceWorks_LUTFitCBData * pFitOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlob,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	return GFSDK_FaceWorks_FitShadowLUT(pConfig, pFitOut, NULL, pErrorBlob, NULL, pParallelConfig);
+}
+
+// Map decoded texels to the normalized values that the errors are measured in.  The curvature LUT
+// is decoded to its difference from N.L with the format's GFSDK_FaceWorks_CurvatureLUTDecode_*
+// constant from GFSDK_FaceWorks.hlsli, then remapped from [-0.25, 0.25] to [0, 1].
+void NormalizeFloatLUT(const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig, FloatLUT * pLUT)
+{
+	float decodeScale = 0.5f, decodeBias = -0.25f;
+	switch (pConfig->m_format)
+	{
+	case GFSDK_FaceWorks_LUTFormat_R11G11B10F:
+	case GFSDK_FaceWorks_LUTFormat_RGB9E5:		decodeScale = 1.0f;	decodeBias = -0.25f;	break;
+	case GFSDK_FaceWorks_LUTFormat_RGBA16F:		decodeScale = 1.0f;	decodeBias = 0.0f;		break;
+	default:																		break;
+	}
+
+	for (float & value : pLUT->m_rgb)
+		value = (value * decodeScale + decodeBias) * 2.0f + 0.5f;
+}
+
+void NormalizeFloatLUT(const GFSDK_FaceWorks_ShadowLUTConfig * /*pConfig*/, FloatLUT * /*pLUT*/)
+{
+}
+
+
+
+// Running the modes
+
+struct ModeResult
+{
+	double	m_timeMs;
+	float	m_maxErrorLSB;
+	float	m_meanErrorLSB;
+	int		m_worstX, m_worstY;
+};
+
+typedef std::chrono::steady_clock BenchmarkClock;
+
+double MillisecondsSince(BenchmarkClock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(BenchmarkClock::now() - start).count();
+}
+
+// Generate a LUT in its config's format and expand it to normalized float RGB, decoding it as
+// the shaders do
+template <typename Config>
+bool GenerateFloatLUT(
+	const Config & lutConfig,
+	bool isSRGB,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig,
+	FloatLUT * pLUTOut)
+{
+	std::vector<unsigned char> texels(CalculateSizeBytes(&lutConfig));
+	GFSDK_FaceWorks_ErrorBlob errorBlob = {};
+	if (Generate(&lutConfig, &texels[0], &errorBlob, pParallelConfig) != GFSDK_FaceWorks_OK)
+	{
+		fprintf(stderr, "LUT generation failed:\n%s", errorBlob.m_msg);
+		GFSDK_FaceWorks_FreeErrorBlob(&errorBlob);
+		return false;
+	}
+
+	pLUTOut->m_width = lutConfig.m_texWidth;
+	pLUTOut->m_height = lutConfig.m_texHeight;
+	DecodeLUTTexels(texels, lutConfig.m_format, isSRGB, pLUTOut);
+	NormalizeFloatLUT(&lutConfig, pLUTOut);
+	return true;
+}
+
+// The range of normalized values a format can hold: [0, 1] in the unorm formats, and
+// non-negative in the unsigned float formats, whose curvature encoding maps 0 to 0
+void CalculateFormatRange(GFSDK_FaceWorks_LUTFormat format, float * pMin, float * pMax)
+{
+	switch (format)
+	{
+	case GFSDK_FaceWorks_LUTFormat_R11G11B10F:
+	case GFSDK_FaceWorks_LUTFormat_RGB9E5:		*pMin = 0.0f;		*pMax = FLT_MAX;	break;
+	case GFSDK_FaceWorks_LUTFormat_RGBA16F:		*pMin = -FLT_MAX;	*pMax = FLT_MAX;	break;
+	default:									*pMin = 0.0f;		*pMax = 1.0f;		break;
+	}
+}
+
+// Compare a mode's lookups against the reference at each reference texel center; modes that go
+// through another format are compared against the reference clamped to what that format can hold
+template <typename LookupFn>
+void MeasureError(const FloatLUT & reference, GFSDK_FaceWorks_LUTFormat format, const LookupFn & lookup, ModeResult * pResult)
+{
+	float referenceMin, referenceMax;
+	CalculateFormatRange(format, &referenceMin, &referenceMax);
+
+	double sumError = 0.0;
+	pResult->m_maxErrorLSB = 0.0f;
+	pResult->m_worstX = 0;
+	pResult->m_worstY = 0;
+
+	for (int iY = 0; iY < reference.m_height; ++iY)
+	{
+		for (int iX = 0; iX < reference.m_width; ++iX)
+		{
+			float u = (float(iX) + 0.5f) / float(reference.m_width);
+			float v = (float(iY) + 0.5f) / float(reference.m_height);
+			float rgb[3];
+			lookup(iX, iY, u, v, rgb);
+
+			for (int c = 0; c < 3; ++c)
+			{
+				float referenceValue = reference.Texel(iX, iY, c);
+				referenceValue = std::max(referenceMin, std::min(referenceMax, referenceValue));
+				float error = 255.0f * fabsf(rgb[c] - referenceValue);
+				sumError += error;
+				if (error > pResult->m_maxErrorLSB)
+				{
+					pResult->m_maxErrorLSB = error;
+					pResult->m_worstX = iX;
+					pResult->m_worstY = iY;
+				}
+			}
+		}
+	}
+
+	pResult->m_meanErrorLSB = float(sumError / (3.0 * double(reference.m_width) * double(reference.m_height)));
+}
+
+template <typename Config>
+bool RunMode(
+	const Config & referenceConfig,
+	const FloatLUT & reference,
+	const BenchmarkMode & mode,
+	bool isSRGB,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig,
+	ModeResult * pResult)
+{
+	Config lutConfig = referenceConfig;
+	GFSDK_FaceWorks_ErrorBlob errorBlob = {};
+	BenchmarkClock::time_point start = BenchmarkClock::now();
+
+	switch (mode.m_kind)
+	{
+	case ModeKind_Integration:
+	case ModeKind_SmallLUT:
+	{
+		if (mode.m_kind == ModeKind_Integration)
+		{
+			lutConfig.m_integrationMode = mode.m_integrationMode;
+			lutConfig.m_integrationSampleCount = mode.m_integrationSampleCount;
+		}
+		else
+		{
+			lutConfig.m_texWidth = mode.m_texSize;
+			lutConfig.m_texHeight = mode.m_texSize;
+		}
+
+		FloatLUT lut;
+		if (!GenerateFloatLUT(lutConfig, isSRGB, pParallelConfig, &lut))
+			return false;
+		pResult->m_timeMs = MillisecondsSince(start);
+
+		MeasureError(reference, lutConfig.m_format, [&](int /*iX*/, int /*iY*/, float u, float v, float rgbOut[3])
+		{
+			lut.Sample(u, v, rgbOut);
+		}, pResult);
+		return true;
+	}
+
+	case ModeKind_Fit:
+	{
+		GFSDK_FaceWorks_LUTFitCBData fit;
+		if (Fit(&lutConfig, &fit, &errorBlob, pParallelConfig) != GFSDK_FaceWorks_OK)
+		{
+			fprintf(stderr, "LUT fit failed:\n%s", errorBlob.m_msg);
+			GFSDK_FaceWorks_FreeErrorBlob(&errorBlob);
+			return false;
+		}
+		pResult->m_timeMs = MillisecondsSince(start);
+
+		MeasureError(reference, GFSDK_FaceWorks_LUTFormat_RGBA16F, [&](int /*iX*/, int /*iY*/, float u, float v, float rgbOut[3])
+		{
+			GFSDK_FaceWorks_EvaluateLUTFit(&fit, u, v, rgbOut, NULL);
+		}, pResult);
+		return true;
+	}
+
+	case ModeKind_Format:
+	{
+		lutConfig.m_format = mode.m_format;
+		FloatLUT lut;
+		if (!GenerateFloatLUT(lutConfig, isSRGB, pParallelConfig, &lut))
+			return false;
+		pResult->m_timeMs = MillisecondsSince(start);
+
+		MeasureError(reference, lutConfig.m_format, [&](int iX, int iY, float /*u*/, float /*v*/, float rgbOut[3])
+		{
+			for (int c = 0; c < 3; ++c)
+				rgbOut[c] = lut.Texel(iX, iY, c);
+		}, pResult);
+		return true;
+	}
+
+	case ModeKind_Compressed:
+	{
+		lutConfig.m_format = GFSDK_FaceWorks_LUTFormat_RGBA8;
+		std::vector<unsigned char> texels(CalculateSizeBytes(&lutConfig));
+		std::vector<unsigned char> blocks(GFSDK_FaceWorks_CalculateCompressedLUTSizeBytes(
+											lutConfig.m_texWidth, lutConfig.m_texHeight, mode.m_compression));
+		if (Generate(&lutConfig, &texels[0], &errorBlob, pParallelConfig) != GFSDK_FaceWorks_OK ||
+			GFSDK_FaceWorks_CompressLUT(&texels[0], lutConfig.m_texWidth, lutConfig.m_texHeight, lutConfig.m_format,
+										mode.m_compression, 0.5f, &blocks[0], NULL,
+										&errorBlob, NULL, pParallelConfig) != GFSDK_FaceWorks_OK)
+		{
+			fprintf(stderr, "LUT compression failed:\n%s", errorBlob.m_msg);
+			GFSDK_FaceWorks_FreeErrorBlob(&errorBlob);
+			return false;
+		}
+		pResult->m_timeMs = MillisecondsSince(start);
+
+		FloatLUT lut;
+		lut.m_width = lutConfig.m_texWidth;
+		lut.m_height = lutConfig.m_texHeight;
+		if (!DecodeCompressedLUT(blocks, mode.m_compression, isSRGB, &lut))
+		{
+			fprintf(stderr, "Couldn't decode the compressed LUT\n");
+			return false;
+		}
+
+		MeasureError(reference, lutConfig.m_format, [&](int iX, int iY, float /*u*/, float /*v*/, float rgbOut[3])
+		{
+			for (int c = 0; c < 3; ++c)
+				rgbOut[c] = lut.Texel(iX, iY, c);
+		}, pResult);
+		return true;
+	}
+	}
+
+	return false;
+}
+
+
+
+// Running the whole grid and writing the JSON report
+
+struct BenchmarkOptions
+{
+	int		m_texSize;
+	float	m_budgetScale;
+};
+
+template <typename Config>
+bool RunLUT(
+	FILE * pFile,
+	const BenchmarkConfig & config,
+	const char * strLUT,
+	int lutMask,
+	bool isSRGB,
+	const BenchmarkOptions & options,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig,
+	bool * pIsFirstResult,
+	bool * pAllPassed)
+{
+	Config referenceConfig;
+	MakeConfig(config, options.m_texSize, &referenceConfig);
+
+	BenchmarkClock::time_point start = BenchmarkClock::now();
+	FloatLUT reference;
+	if (!GenerateFloatLUT(referenceConfig, isSRGB, pParallelConfig, &reference))
+		return false;
+	double referenceTimeMs = MillisecondsSince(start);
+
+	for (int iMode = 0; iMode < s_modeCount; ++iMode)
+	{
+		const BenchmarkMode & mode = s_modes[iMode];
+		if (!(mode.m_luts & lutMask))
+			continue;
+
+		ModeResult result;
+		if (!RunMode(referenceConfig, reference, mode, isSRGB, pParallelConfig, &result))
+			return false;
+
+		float budget = ((lutMask == cLUTCurvature) ? mode.m_curvatureBudgetLSB : mode.m_shadowBudgetLSB) *
+						options.m_budgetScale;
+		bool passed = (result.m_maxErrorLSB <= budget);
+		*pAllPassed = *pAllPassed && passed;
+
+		printf(
+			"%-16s %-10s %-14s %8.1f ms (reference %8.1f ms)  max %7.3f  mean %6.3f LSB at (%d, %d)  %s\n",
+			config.m_strName, strLUT, mode.m_strName, result.m_timeMs, referenceTimeMs,
+			result.m_maxErrorLSB, result.m_meanErrorLSB, result.m_worstX, result.m_worstY,
+			passed ? "ok" : "OVER BUDGET");
+
+		fprintf(pFile,
+			"%s\n\t\t{ \"config\": \"%s\", \"lut\": \"%s\", \"mode\": \"%s\", "
+			"\"timeMs\": %.3f, \"referenceTimeMs\": %.3f, "
+			"\"maxErrorLSB\": %.4f, \"meanErrorLSB\": %.4f, \"worstTexel\": [%d, %d], "
+			"\"budgetLSB\": %.4f, \"passed\": %s }",
+			*pIsFirstResult ? "" : ",",
+			config.m_strName, strLUT, mode.m_strName,
+			result.m_timeMs, referenceTimeMs,
+			result.m_maxErrorLSB, result.m_meanErrorLSB, result.m_worstX, result.m_worstY,
+			budget, passed ? "true" : "false");
+		*pIsFirstResult = false;
+	}
+
+	return true;
+}
+
+int main(int argc, const char ** argv)
+{
+	BenchmarkOptions options =
+	{
+		256,				// m_texSize
+		1.0f,				// m_budgetScale
+	};
+	GFSDK_FaceWorks_ParallelConfig parallelConfig =
+	{
+		1,					// m_workerCount
+		NULL, NULL,			// m_parallelFor, m_pUserData
+	};
+	const char * strJSONFilename = "lut_benchmark.json";
+
+	// Parse command-line params
+	for (int iArg = 1; iArg < argc; ++iArg)
+	{
+		if (_stricmp(argv[iArg], "-h") == 0 ||
+			_stricmp(argv[iArg], "-help") == 0 ||
+			_stricmp(argv[iArg], "--help") == 0 ||
+			_stricmp(argv[iArg], "/?") == 0)
+		{
+			PrintUsage();
+			return 0;
+		}
+		else if (_stricmp(argv[iArg], "-json") == 0)
+		{
+			strJSONFilename = argv[++iArg];
+			if (!strJSONFilename)
+			{
+				fprintf(stderr, "-json: filename expected\n");
+				return 1;
+			}
+		}
+		else if (_stricmp(argv[iArg], "-size") == 0)
+		{
+			ReadInt(&argv[iArg++], &options.m_texSize, 16, 4096);
+		}
+		else if (_stricmp(argv[iArg], "-threads") == 0)
+		{
+			ReadInt(&argv[iArg++], &parallelConfig.m_workerCount, 0, 256);
+		}
+		else if (_stricmp(argv[iArg], "-budgetScale") == 0)
+		{
+			ReadFloat(&argv[iArg++], &options.m_budgetScale, 0.0f);
+		}
+		else
+		{
+			fprintf(
+				stderr,
+				"Warning: unrecognized command-line parameter \"%s\"; ignoring\n",
+				argv[iArg]);
+		}
+	}
+
+	FILE * pFile;
+	if (fopen_s(&pFile, strJSONFilename, "w") != 0 || !pFile)
+	{
+		fprintf(stderr, "Error: couldn't open %s for writing\n", strJSONFilename);
+		return 1;
+	}
+
+	fprintf(pFile, "{\n\t\"referenceSize\": %d,\n\t\"threads\": %d,\n\t\"results\":\n\t[",
+		options.m_texSize, parallelConfig.m_workerCount);
+
+	bool isFirstResult = true;
+	bool allPassed = true;
+	bool ok = true;
+	for (int iConfig = 0; iConfig < s_configCount && ok; ++iConfig)
+	{
+		// The shadow LUT's 8-bit texels are in sRGB space, which matters for the RGB8 and compressed modes
+		ok = RunLUT<GFSDK_FaceWorks_CurvatureLUTConfig>(pFile, s_configs[iConfig], "curvature", cLUTCurvature, false,
+				options, &parallelConfig, &isFirstResult, &allPassed) &&
+			 RunLUT<GFSDK_FaceWorks_ShadowLUTConfig>(pFile, s_configs[iConfig], "shadow", cLUTShadow, true,
+				options, &parallelConfig, &isFirstResult, &allPassed);
+	}
+
+	fprintf(pFile, "\n\t],\n\t\"completed\": %s,\n\t\"passed\": %s\n}\n",
+		ok ? "true" : "false", (ok && allPassed) ? "true" : "false");
+	if (fclose(pFile) != 0)
+	{
+		fprintf(stderr, "Error: couldn't write %s\n", strJSONFilename);
+		return 1;
+	}
+
+	printf("Wrote %s\n", strJSONFilename);
+	if (!ok)
+		return 1;
+	if (!allPassed)
+	{
+		printf("Some modes are over their error budgets\n");
+		return 1;
+	}
+
+	printf("All modes are within their error budgets\n");
+	return 0;
+}
@@ -33,9 +33,17 @@
 //----------------------------------------------------------------------------------
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
 #include <cstdio>
+#include <cstring>
 #include <ctime>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include <GFSDK_FaceWorks.h>
@@ -55,6 +63,20 @@ void PrintUsage()
 		"Options:\n"
 		" -curvatureLUT FILENAME        Generate curvature LUT (.bmp format)\n"
 		" -shadowLUT FILENAME           Generate shadow LUT (.bmp format)\n"
+		" -threads INT                  Number of worker threads; default is 0 (one per CPU core)\n"
+		" -integration MODE             Integration mode, midpoint, piecewise, analytic or convolution;\n"
+		"                               default is midpoint (analytic applies to the shadow LUT only,\n"
+		"                               convolution to the curvature LUT only)\n"
+		" -samples INT                  Integration sample count; default is 0 (the mode's default)\n"
+		" -estimateError                Print the estimated integration error of each LUT\n"
+		" -compress FORMAT              Also write each LUT block-compressed, as a .dds beside it,\n"
+		"                               in BC1 or BC7, and print its PSNR\n"
+		" -errorTarget FLOAT            RMS error per block the compressor refines to, in 8-bit steps;\n"
+		"                               default is 0.5\n"
+		" -bakeTables FILENAME          Generate the library's built-in LUT tables (src/builtinluts.inl)\n"
+		"                               from the curvature and shadow LUT options\n"
+		" -batch FILENAME               Generate every LUT in a sweep manifest (see below), starting\n"
+		"                               from the curvature and shadow LUT options\n"
 		"\n"
 		"Curvature LUT options:\n"
 		" -diffusionRadius FLOAT        Radius of diffusion profile in mm; default is 2.7\n"
@@ -71,6 +93,13 @@ void PrintUsage()
 		" -width INT                    LUT width in pixels; default is 512\n"
 		" -height INT                   LUT height in pixels; default is 512\n"
 		"\n"
+		"A batch manifest is a text file of sweeps.  Each line of a sweep names a LUT option (without\n"
+		"the dash, or \"size\" for square LUTs) followed by one or more values, and the\n"
+		"sweep generates every combination of them; \"luts curvature shadow\" picks which LUTs it\n"
+		"makes.  A line reading \"sweep\" starts a new sweep, and \"output DIR\" sets the directory\n"
+		"the LUTs go in.  '#' starts a comment.  Each LUT is named for a hash of its config, and is\n"
+		"skipped if that file already exists.\n"
+		"\n"
 	);
 }
 
@@ -180,12 +209,40 @@ bool ReadFloat(
 
 
 
+// Options for writing a block-compressed copy of each LUT
+struct CompressOptions
+{
+	bool							m_enabled;
+	GFSDK_FaceWorks_LUTCompression	m_compression;
+	float							m_errorTarget;
+};
+
 int GenerateCurvatureLUT(
 	const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig,
+	bool estimateError,
+	const CompressOptions & compressOptions,
 	const char * strFilename);
 
 int GenerateShadowLUT(
 	const GFSDK_FaceWorks_ShadowLUTConfig * pConfig,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig,
+	bool estimateError,
+	const CompressOptions & compressOptions,
+	const char * strFilename);
+
+int BakeTables(
+	const GFSDK_FaceWorks_CurvatureLUTConfig * pCurvatureConfig,
+	const GFSDK_FaceWorks_ShadowLUTConfig * pShadowConfig,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig,
+	const char * strFilename);
+
+int RunBatch(
+	const GFSDK_FaceWorks_CurvatureLUTConfig * pCurvatureConfig,
+	const GFSDK_FaceWorks_ShadowLUTConfig * pShadowConfig,
+	int workerCount,
+	bool estimateError,
+	const CompressOptions & compressOptions,
 	const char * strFilename);
 
 
@@ -198,6 +255,9 @@ int main(int argc, const char ** argv)
 		2.7f,				// m_diffusionRadius
 		512, 512,			// m_texWidth, m_texHeight
 		1.0f, 100.0f,		// m_curvatureRadiusMin, m_curvatureRadiusMax
+		GFSDK_FaceWorks_LUTIntegration_Midpoint,	// m_integrationMode
+		0,					// m_integrationSampleCount
+		GFSDK_FaceWorks_LUTFormat_RGB8,				// m_format (packed RGB, as the BMP stores it)
 	};
 	GFSDK_FaceWorks_ShadowLUTConfig shadowConfig =
 	{
@@ -205,9 +265,26 @@ int main(int argc, const char ** argv)
 		512, 512,			// m_texWidth, m_texHeight
 		8.0f, 100.0f,		// m_shadowWidthMin, m_shadowWidthMax
 		10.0f,				// m_shadowSharpening
+		GFSDK_FaceWorks_LUTIntegration_Midpoint,	// m_integrationMode
+		0,					// m_integrationSampleCount
+		GFSDK_FaceWorks_LUTFormat_RGB8,				// m_format (packed RGB, as the BMP stores it)
+	};
+	GFSDK_FaceWorks_ParallelConfig parallelConfig =
+	{
+		0,					// m_workerCount
+		NULL, NULL,			// m_parallelFor, m_pUserData
 	};
 	const char * strCurvatureFilename = NULL;
 	const char * strShadowFilename = NULL;
+	const char * strTablesFilename = NULL;
+	const char * strBatchFilename = NULL;
+	bool estimateError = false;
+	CompressOptions compressOptions =
+	{
+		false,								// m_enabled
+		GFSDK_FaceWorks_LUTCompression_BC7,	// m_compression
+		0.5f,								// m_errorTarget
+	};
 
 	// Parse command-line params
 	for (int iArg = 1; iArg < argc; ++iArg)
@@ -232,6 +309,87 @@ int main(int argc, const char ** argv)
 			if (!strShadowFilename)
 				fprintf(stderr, "-shadowLUT: filename expected\n");
 		}
+		else if (_stricmp(argv[iArg], "-bakeTables") == 0)
+		{
+			strTablesFilename = argv[++iArg];
+			if (!strTablesFilename)
+				fprintf(stderr, "-bakeTables: filename expected\n");
+		}
+		else if (_stricmp(argv[iArg], "-batch") == 0)
+		{
+			strBatchFilename = argv[++iArg];
+			if (!strBatchFilename)
+				fprintf(stderr, "-batch: filename expected\n");
+		}
+		else if (_stricmp(argv[iArg], "-threads") == 0)
+		{
+			ReadInt(&argv[iArg++], &parallelConfig.m_workerCount, 0, 256);
+		}
+		else if (_stricmp(argv[iArg], "-integration") == 0)
+		{
+			const char * strMode = argv[++iArg];
+			if (!strMode)
+			{
+				fprintf(stderr, "-integration: mode expected\n");
+			}
+			else if (_stricmp(strMode, "midpoint") == 0)
+			{
+				curvatureConfig.m_integrationMode = GFSDK_FaceWorks_LUTIntegration_Midpoint;
+				shadowConfig.m_integrationMode = GFSDK_FaceWorks_LUTIntegration_Midpoint;
+			}
+			else if (_stricmp(strMode, "piecewise") == 0)
+			{
+				curvatureConfig.m_integrationMode = GFSDK_FaceWorks_LUTIntegration_Piecewise;
+				shadowConfig.m_integrationMode = GFSDK_FaceWorks_LUTIntegration_Piecewise;
+			}
+			else if (_stricmp(strMode, "analytic") == 0)
+			{
+				shadowConfig.m_integrationMode = GFSDK_FaceWorks_LUTIntegration_Analytic;
+			}
+			else if (_stricmp(strMode, "convolution") == 0)
+			{
+				curvatureConfig.m_integrationMode = GFSDK_FaceWorks_LUTIntegration_Convolution;
+			}
+			else
+			{
+				fprintf(stderr, "-integration: unknown mode \"%s\"; ignoring\n", strMode);
+			}
+		}
+		else if (_stricmp(argv[iArg], "-samples") == 0)
+		{
+			int sampleCount;
+			if (ReadInt(&argv[iArg++], &sampleCount, 0, 512))
+			{
+				curvatureConfig.m_integrationSampleCount = sampleCount;
+				shadowConfig.m_integrationSampleCount = sampleCount;
+			}
+		}
+		else if (_stricmp(argv[iArg], "-estimateError") == 0)
+		{
+			estimateError = true;
+		}
+		else if (_stricmp(argv[iArg], "-compress") == 0)
+		{
+			const char * strFormat = argv[++iArg];
+			if (!strFormat)
+				fprintf(stderr, "-compress: format expected\n");
+			else if (_stricmp(strFormat, "bc1") == 0)
+			{
+				compressOptions.m_enabled = true;
+				compressOptions.m_compression = GFSDK_FaceWorks_LUTCompression_BC1;
+			}
+			else if (_stricmp(strFormat, "bc7") == 0)
+			{
+				compressOptions.m_enabled = true;
+				compressOptions.m_compression = GFSDK_FaceWorks_LUTCompression_BC7;
+			}
+			else
+				fprintf(stderr, "-compress: unknown format \"%s\"; ignoring\n", strFormat);
+		}
+		else if (_stricmp(argv[iArg], "-errorTarget") == 0)
+		{
+			ReadFloat(&argv[iArg++], &compressOptions.m_errorTarget, 0.0f);
+		}
 		else if (_stricmp(argv[iArg], "-width") == 0)
 		{
 			int width;
@@ -250,6 +408,15 @@ int main(int argc, const char ** argv)
 				shadowConfig.m_texHeight = height;
 			}
 		}
+		else if (_stricmp(argv[iArg], "-diffusionRadius") == 0)
+		{
+			float diffusionRadius;
+			if (ReadFloat(&argv[iArg++], &diffusionRadius, FLT_MIN))
+			{
+				curvatureConfig.m_diffusionRadius = diffusionRadius;
+				shadowConfig.m_diffusionRadius = diffusionRadius;
+			}
+		}
 		else if (_stricmp(argv[iArg], "-minCurvatureRadius") == 0)
 		{
 			ReadFloat(&argv[iArg++], &curvatureConfig.m_curvatureRadiusMin, FLT_MIN);
@@ -279,34 +446,49 @@ int main(int argc, const char ** argv)
 		}
 	}
 
-	if (!strCurvatureFilename && !strShadowFilename)
+	if (!strCurvatureFilename && !strShadowFilename && !strTablesFilename && !strBatchFilename)
 	{
 		PrintUsage();
 		return 0;
 	}
 
-	if (strCurvatureFilename)
+	if (curvatureConfig.m_curvatureRadiusMin > curvatureConfig.m_curvatureRadiusMax)
 	{
-		if (curvatureConfig.m_curvatureRadiusMin > curvatureConfig.m_curvatureRadiusMax)
-		{
-			fprintf(stderr, "Warning: minCurvatureRadius > maxCurvatureRadius; swapping\n");
-			std::swap(curvatureConfig.m_curvatureRadiusMin, curvatureConfig.m_curvatureRadiusMax);
-		}
+		fprintf(stderr, "Warning: minCurvatureRadius > maxCurvatureRadius; swapping\n");
+		std::swap(curvatureConfig.m_curvatureRadiusMin, curvatureConfig.m_curvatureRadiusMax);
+	}
 
-		int res = GenerateCurvatureLUT(&curvatureConfig, strCurvatureFilename);
+	if (shadowConfig.m_shadowWidthMin > shadowConfig.m_shadowWidthMax)
+	{
+		fprintf(stderr, "Warning: minShadowWidth > maxShadowWidth; swapping\n");
+		std::swap(shadowConfig.m_shadowWidthMin, shadowConfig.m_shadowWidthMax);
+	}
+
+	if (strCurvatureFilename)
+	{
+		int res = GenerateCurvatureLUT(&curvatureConfig, &parallelConfig, estimateError, compressOptions, strCurvatureFilename);
 		if (res != 0)
 			return 1;
 	}
 
 	if (strShadowFilename)
 	{
-		if (shadowConfig.m_shadowWidthMin > shadowConfig.m_shadowWidthMax)
-		{
-			fprintf(stderr, "Warning: minShadowWidth > maxShadowWidth; swapping\n");
-			std::swap(shadowConfig.m_shadowWidthMin, shadowConfig.m_shadowWidthMax);
-		}
+		int res = GenerateShadowLUT(&shadowConfig, &parallelConfig, estimateError, compressOptions, strShadowFilename);
+		if (res != 0)
+			return 1;
+	}
+
+	if (strTablesFilename)
+	{
+		int res = BakeTables(&curvatureConfig, &shadowConfig, &parallelConfig, strTablesFilename);
+		if (res != 0)
+			return 1;
+	}
 
-		int res = GenerateShadowLUT(&shadowConfig, strShadowFilename);
+	if (strBatchFilename)
+	{
+		int res = RunBatch(&curvatureConfig, &shadowConfig, parallelConfig.m_workerCount,
+							estimateError, compressOptions, strBatchFilename);
 		if (res != 0)
 			return 1;
 	}
@@ -316,10 +498,20 @@ int main(int argc, const char ** argv)
 
 
 
-int WriteBMP(
+// Writes a top-down 24-bit BMP a block of rows at a time, as a FaceWorks LUT row sink
+struct BMPWriter
+{
+	FILE *						m_pFile;
+	int							m_width;
+	std::vector<unsigned char>	m_row;		// One row in BGR order, padded to a multiple of 4 bytes
+	std::vector<unsigned char> *	m_pTexelsCopy;	// If not null, the rows are also appended here, for compression
+};
+
+int OpenBMP(
 	int width, int height,
-	void * pPixelsRGBA,
-	const char * strFilename)
+	const char * strFilename,
+	BMPWriter * pWriter,
+	std::vector<unsigned char> * pTexelsCopy = NULL)
 {
 	FILE * pFile;
 	if (fopen_s(&pFile, strFilename, "wb") != 0 || !pFile)
@@ -345,24 +537,138 @@ int WriteBMP(
 	};
 	fwrite(&bmpInfoHeader, sizeof(bmpInfoHeader), 1, pFile);
 
-	// Convert RGBA to BGR pixel order
-	unsigned char * pRGBA = static_cast<unsigned char *>(pPixelsRGBA);
-	int pixelCount = width * height;
-	for (int i = 0; i < pixelCount; ++i)
+	pWriter->m_pFile = pFile;
+	pWriter->m_width = width;
+	pWriter->m_row.assign((3 * width + 3) & ~3, 0);
+	pWriter->m_pTexelsCopy = pTexelsCopy;
+
+	return 0;
+}
+
+// Row sink callback; takes rows of packed RGB and writes them out in BGR order
+int WriteBMPRows(
+	void * pUserData,
+	int /*iRowBegin*/,
+	int rowCount,
+	const void * pRowsRGB)
+{
+	BMPWriter * pWriter = static_cast<BMPWriter *>(pUserData);
+	const unsigned char * pRGB = static_cast<const unsigned char *>(pRowsRGB);
+
+	if (pWriter->m_pTexelsCopy)
+		pWriter->m_pTexelsCopy->insert(pWriter->m_pTexelsCopy->end(), pRGB, pRGB + 3 * size_t(pWriter->m_width) * size_t(rowCount));
+
+	for (int iRow = 0; iRow < rowCount; ++iRow)
 	{
-		unsigned char r = *(pRGBA++);
-		unsigned char g = *(pRGBA++);
-		unsigned char b = *(pRGBA++);
-		pRGBA++;	// skip alpha
+		unsigned char * pBGR = &pWriter->m_row[0];
+		for (int i = 0; i < pWriter->m_width; ++i)
+		{
+			pBGR[0] = pRGB[2];
+			pBGR[1] = pRGB[1];
+			pBGR[2] = pRGB[0];
+			pBGR += 3;
+			pRGB += 3;
+		}
 
-		fputc(b, pFile);
-		fputc(g, pFile);
-		fputc(r, pFile);
+		if (fwrite(&pWriter->m_row[0], pWriter->m_row.size(), 1, pWriter->m_pFile) != 1)
+			return 0;
+	}
+
+	return 1;
+}
+
+int CloseBMP(
+	BMPWriter * pWriter,
+	const char * strFilename)
+{
+	if (fclose(pWriter->m_pFile) != 0)
+	{
+		fprintf(stderr, "Error: couldn't write %s\n", strFilename);
+		return 1;
 	}
 
-	fclose(pFile);
 	printf("Wrote %s\n", strFilename);
+	return 0;
+}
+
+
+
+// Compress a LUT's packed RGB texels and write them as a .dds with a DX10 header, named after the LUT
 
+int WriteCompressedLUT(
+	const std::vector<unsigned char> & texels,
+	int width, int height,
+	bool isSRGB,
+	const CompressOptions & compressOptions,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig,
+	const char * strLUTFilename)
+{
+	bool isBC1 = (compressOptions.m_compression == GFSDK_FaceWorks_LUTCompression_BC1);
+	printf("Compressing to %s...\n", isBC1 ? "BC1" : "BC7");
+	clock_t start = clock();
+
+	std::vector<unsigned char> blocks(GFSDK_FaceWorks_CalculateCompressedLUTSizeBytes(width, height, compressOptions.m_compression));
+	GFSDK_FaceWorks_LUTCompressionStats stats = {};
+	GFSDK_FaceWorks_ErrorBlob errorBlob = {};
+	GFSDK_FaceWorks_Result res = GFSDK_FaceWorks_CompressLUT(
+									&texels[0], width, height, GFSDK_FaceWorks_LUTFormat_RGB8,
+									compressOptions.m_compression, compressOptions.m_errorTarget,
+									&blocks[0], &stats, &errorBlob, NULL, pParallelConfig);
+	if (res != GFSDK_FaceWorks_OK)
+	{
+		fprintf(stderr, "GFSDK_FaceWorks_CompressLUT() failed:\n%s", errorBlob.m_msg);
+		GFSDK_FaceWorks_FreeErrorBlob(&errorBlob);
+		return 1;
+	}
+
+	clock_t clocks = clock() - start;
+	printf("Done in %0.3f seconds\n", float(clocks) / float(CLOCKS_PER_SEC));
+	printf(
+		"PSNR %0.2f dB, RMS error %0.3f, max error %0.0f (8-bit LSBs); %d blocks over target\n",
+		stats.m_psnr, stats.m_rmsError, stats.m_maxError, stats.m_blocksOverTarget);
+
+	// Swap the LUT's extension for .dds
+	std::string strFilename(strLUTFilename);
+	size_t iExtension = strFilename.find_last_of("./\\");
+	if (iExtension != std::string::npos && strFilename[iExtension] == '.')
+		strFilename.erase(iExtension);
+	strFilename += ".dds";
+
+	FILE * pFile;
+	if (fopen_s(&pFile, strFilename.c_str(), "wb") != 0 || !pFile)
+	{
+		fprintf(stderr, "Error: couldn't open %s for writing\n", strFilename.c_str());
+		return 1;
+	}
+
+	// DXGI_FORMAT_BC1_UNORM is 71, BC7_UNORM is 98; each _SRGB variant follows it
+	unsigned int dxgiFormat = (isBC1 ? 71 : 98) + (isSRGB ? 1 : 0);
+	unsigned int header[32 + 5] =
+	{
+		0x20534444,						// "DDS "
+		124,							// dwSize
+		0x1 | 0x2 | 0x4 | 0x1000 | 0x80000,	// dwFlags: caps, height, width, pixel format, linear size
+		unsigned(height), unsigned(width),
+		unsigned(blocks.size()),		// dwPitchOrLinearSize
+		0, 1,							// dwDepth, dwMipMapCount
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	// dwReserved1
+		32, 0x4, 0x30315844,			// ddspf: dwSize, dwFlags (fourCC), dwFourCC ("DX10")
+		0, 0, 0, 0, 0,					// ddspf: bit count and masks
+		0x1000,							// dwCaps: texture
+		0, 0, 0, 0,						// dwCaps2-4, dwReserved2
+		dxgiFormat,
+		3,								// D3D10_RESOURCE_DIMENSION_TEXTURE2D
+		0, 1, 0,						// miscFlag, arraySize, miscFlags2
+	};
+	bool ok = (fwrite(header, sizeof(header), 1, pFile) == 1 &&
+			   fwrite(&blocks[0], blocks.size(), 1, pFile) == 1);
+	if (fclose(pFile) != 0 || !ok)
+	{
+		fprintf(stderr, "Error: couldn't write %s\n", strFilename.c_str());
+		return 1;
+	}
+
+	printf("Wrote %s\n", strFilename.c_str());
 	return 0;
 }
 
@@ -370,60 +676,899 @@ int WriteBMP(
 
 int GenerateCurvatureLUT(
 	const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig,
+	bool estimateError,
+	const CompressOptions & compressOptions,
 	const char * strFilename)
 {
 	printf("Generating curvature LUT...\n");
 	clock_t start = clock();
 
-	std::vector<unsigned char> pixels;
-	pixels.resize(GFSDK_FaceWorks_CalculateCurvatureLUTSizeBytes(pConfig));
+	// Stream the rows straight into the file, so only a block of them is in memory at once
+	// Compression needs the whole LUT, so keep a copy of the rows if it's enabled
+	BMPWriter writer;
+	std::vector<unsigned char> texels;
+	if (OpenBMP(pConfig->m_texWidth, pConfig->m_texHeight, strFilename, &writer,
+				compressOptions.m_enabled ? &texels : NULL) != 0)
+		return 1;
 
+	GFSDK_FaceWorks_LUTRowSink rowSink = { &WriteBMPRows, &writer, 0 };
 	GFSDK_FaceWorks_ErrorBlob errorBlob = {};
-	GFSDK_FaceWorks_Result res = GFSDK_FaceWorks_GenerateCurvatureLUT(pConfig, &pixels[0], &errorBlob);
+	GFSDK_FaceWorks_Result res = GFSDK_FaceWorks_StreamCurvatureLUT(pConfig, &rowSink, &errorBlob, NULL, pParallelConfig);
+	if (res == GFSDK_FaceWorks_Aborted)
+	{
+		fprintf(stderr, "Error: couldn't write %s\n", strFilename);
+		fclose(writer.m_pFile);
+		return 1;
+	}
 	if (res != GFSDK_FaceWorks_OK)
 	{
-		fprintf(stderr, "GFSDK_FaceWorks_GenerateCurvatureLUT() failed:\n%s", errorBlob.m_msg);
+		fprintf(stderr, "GFSDK_FaceWorks_StreamCurvatureLUT() failed:\n%s", errorBlob.m_msg);
 		GFSDK_FaceWorks_FreeErrorBlob(&errorBlob);
+		fclose(writer.m_pFile);
 		return 1;
 	}
 
 	clock_t clocks = clock() - start;
 	printf("Done in %0.3f seconds\n", float(clocks) / float(CLOCKS_PER_SEC));
 
-	return WriteBMP(
-			pConfig->m_texWidth,
-			pConfig->m_texHeight,
-			&pixels[0],
-			strFilename);
+	if (CloseBMP(&writer, strFilename) != 0)
+		return 1;
+
+	if (estimateError)
+	{
+		GFSDK_FaceWorks_LUTErrorEstimate errorEstimate = {};
+		res = GFSDK_FaceWorks_EstimateCurvatureLUTError(pConfig, &errorEstimate, &errorBlob);
+		if (res != GFSDK_FaceWorks_OK)
+		{
+			fprintf(stderr, "GFSDK_FaceWorks_EstimateCurvatureLUTError() failed:\n%s", errorBlob.m_msg);
+			GFSDK_FaceWorks_FreeErrorBlob(&errorBlob);
+			return 1;
+		}
+		printf(
+			"Estimated error: max %0.3f, RMS %0.3f (8-bit LSBs)\n",
+			errorEstimate.m_maxError * 255.0f,
+			errorEstimate.m_rmsError * 255.0f);
+	}
+
+	if (compressOptions.m_enabled)
+	{
+		// The shadow LUT is stored in sRGB space, the curvature LUT in linear space
+		if (WriteCompressedLUT(texels, pConfig->m_texWidth, pConfig->m_texHeight, false,
+								compressOptions, pParallelConfig, strFilename) != 0)
+			return 1;
+	}
+
+	return 0;
 }
 
 
 
 int GenerateShadowLUT(
 	const GFSDK_FaceWorks_ShadowLUTConfig * pConfig,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig,
+	bool estimateError,
+	const CompressOptions & compressOptions,
 	const char * strFilename)
 {
 	printf("Generating shadow LUT...\n");
 	clock_t start = clock();
 
-	std::vector<unsigned char> pixels;
-	pixels.resize(GFSDK_FaceWorks_CalculateShadowLUTSizeBytes(pConfig));
+	// Stream the rows straight into the file, so only a block of them is in memory at once
+	// Compression needs the whole LUT, so keep a copy of the rows if it's enabled
+	BMPWriter writer;
+	std::vector<unsigned char> texels;
+	if (OpenBMP(pConfig->m_texWidth, pConfig->m_texHeight, strFilename, &writer,
+				compressOptions.m_enabled ? &texels : NULL) != 0)
+		return 1;
 
+	GFSDK_FaceWorks_LUTRowSink rowSink = { &WriteBMPRows, &writer, 0 };
 	GFSDK_FaceWorks_ErrorBlob errorBlob = {};
-	GFSDK_FaceWorks_Result res = GFSDK_FaceWorks_GenerateShadowLUT(pConfig, &pixels[0], &errorBlob);
+	GFSDK_FaceWorks_Result res = GFSDK_FaceWorks_StreamShadowLUT(pConfig, &rowSink, &errorBlob, NULL, pParallelConfig);
+	if (res == GFSDK_FaceWorks_Aborted)
+	{
+		fprintf(stderr, "Error: couldn't write %s\n", strFilename);
+		fclose(writer.m_pFile);
+		return 1;
+	}
 	if (res != GFSDK_FaceWorks_OK)
 	{
-		fprintf(stderr, "GFSDK_FaceWorks_GenerateShadowLUT() failed:\n%s", errorBlob.m_msg);
+		fprintf(stderr, "GFSDK_FaceWorks_StreamShadowLUT() failed:\n%s", errorBlob.m_msg);
 		GFSDK_FaceWorks_FreeErrorBlob(&errorBlob);
+		fclose(writer.m_pFile);
 		return 1;
 	}
 
 	clock_t clocks = clock() - start;
 	printf("Done in %0.3f seconds\n", float(clocks) / float(CLOCKS_PER_SEC));
 
-	return WriteBMP(
-			pConfig->m_texWidth,
-			pConfig->m_texHeight,
-			&pixels[0],
-			strFilename);
+	if (CloseBMP(&writer, strFilename) != 0)
+		return 1;
+
+	if (estimateError)
+	{
+		GFSDK_FaceWorks_LUTErrorEstimate errorEstimate = {};
+		res = GFSDK_FaceWorks_EstimateShadowLUTError(pConfig, &errorEstimate, &errorBlob);
+		if (res != GFSDK_FaceWorks_OK)
+		{
+			fprintf(stderr, "GFSDK_FaceWorks_EstimateShadowLUTError() failed:\n%s", errorBlob.m_msg);
+			GFSDK_FaceWorks_FreeErrorBlob(&errorBlob);
+			return 1;
+		}
+		printf(
+			"Estimated error: max %0.3f, RMS %0.3f (8-bit LSBs)\n",
+			errorEstimate.m_maxError * 255.0f,
+			errorEstimate.m_rmsError * 255.0f);
+	}
+
+	if (compressOptions.m_enabled)
+	{
+		// The shadow LUT is stored in sRGB space, the curvature LUT in linear space
+		if (WriteCompressedLUT(texels, pConfig->m_texWidth, pConfig->m_texHeight, true,
+								compressOptions, pParallelConfig, strFilename) != 0)
+			return 1;
+	}
+
+	return 0;
+}
+
+
+
+// Writing the library's built-in LUTs as C++ tables
+
+static const int s_bakedLUTSizes[] = { 64, 128, 256 };
+static const int s_bakedLUTSizeCount = int(sizeof(s_bakedLUTSizes) / sizeof(s_bakedLUTSizes[0]));
+
+const char * IntegrationModeName(GFSDK_FaceWorks_LUTIntegrationMode mode)
+{
+	switch (mode)
+	{
+	case GFSDK_FaceWorks_LUTIntegration_Midpoint:		return "GFSDK_FaceWorks_LUTIntegration_Midpoint";
+	case GFSDK_FaceWorks_LUTIntegration_Piecewise:		return "GFSDK_FaceWorks_LUTIntegration_Piecewise";
+	case GFSDK_FaceWorks_LUTIntegration_Analytic:		return "GFSDK_FaceWorks_LUTIntegration_Analytic";
+	case GFSDK_FaceWorks_LUTIntegration_Convolution:	return "GFSDK_FaceWorks_LUTIntegration_Convolution";
+	default:											return "GFSDK_FaceWorks_LUTIntegration_Midpoint";
+	}
+}
+
+// Format a float as the shortest fixed-point C++ literal that reads back as the same value
+const char * FormatFloatLiteral(float value, char (&strOut)[32])
+{
+	for (int decimals = 1; decimals <= 9; ++decimals)
+	{
+		_snprintf_s(strOut, sizeof(strOut), _TRUNCATE, "%.*f", decimals, value);
+		float valueRead;
+		if (sscanf_s(strOut, "%f", &valueRead) == 1 && valueRead == value)
+		{
+			strcat_s(strOut, "f");
+			return strOut;
+		}
+	}
+
+	// Tiny values need an exponent
+	_snprintf_s(strOut, sizeof(strOut), _TRUNCATE, "%.9ef", value);
+	return strOut;
+}
+
+// Write RGBA8 texels as an array of little-endian unsigned ints
+void WriteTable(
+	FILE * pFile,
+	const char * strName,
+	int texSize,
+	const std::vector<unsigned char> & texels)
+{
+	fprintf(pFile, "static const unsigned int %s%d[%d * %d] =\n{\n", strName, texSize, texSize, texSize);
+
+	size_t texelCount = texels.size() / 4;
+	for (size_t i = 0; i < texelCount; ++i)
+	{
+		const unsigned char * pTexel = &texels[4 * i];
+		unsigned int value = static_cast<unsigned int>(pTexel[0]) |
+							 (static_cast<unsigned int>(pTexel[1]) << 8) |
+							 (static_cast<unsigned int>(pTexel[2]) << 16) |
+							 (static_cast<unsigned int>(pTexel[3]) << 24);
+		fprintf(pFile, "%s0x%08x,%s", (i % 8 == 0) ? "\t" : "", value, (i % 8 == 7) ? "\n" : " ");
+	}
+
+	fprintf(pFile, "%s};\n\n", (texelCount % 8 == 0) ? "" : "\n");
+}
+
+int BakeTables(
+	const GFSDK_FaceWorks_CurvatureLUTConfig * pCurvatureConfig,
+	const GFSDK_FaceWorks_ShadowLUTConfig * pShadowConfig,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig,
+	const char * strFilename)
+{
+	printf("Generating built-in LUT tables...\n");
+
+	FILE * pFile;
+	if (fopen_s(&pFile, strFilename, "w") != 0 || !pFile)
+	{
+		fprintf(stderr, "Error: couldn't open %s for writing\n", strFilename);
+		return 1;
+	}
+
+	fprintf(pFile, "// Built-in LUTs for FaceWorks/src/builtinluts.cpp.\n");
+	fprintf(pFile, "// Generated by \"lut_generator -bakeTables\"; don't edit by hand.\n");
+
+	// The SIMD kernels round differently, so record which ones made the tables; generating the
+	// same LUTs with other kernels can differ by an LSB in a few texels
+	const char * strSimd = strstr(GFSDK_FaceWorks_GetBuildInfo(), "SIMD: ");
+	if (strSimd)
+	{
+		strSimd += strlen("SIMD: ");
+		fprintf(pFile, "// Made with the %.*s precomputation kernels.\n", int(strcspn(strSimd, "\n")), strSimd);
+	}
+	fprintf(pFile, "\n");
+
+	// The configs, without the size, which depends on the table
+	GFSDK_FaceWorks_CurvatureLUTConfig curvatureConfig = *pCurvatureConfig;
+	GFSDK_FaceWorks_ShadowLUTConfig shadowConfig = *pShadowConfig;
+	curvatureConfig.m_format = GFSDK_FaceWorks_LUTFormat_RGBA8;
+	shadowConfig.m_format = GFSDK_FaceWorks_LUTFormat_RGBA8;
+
+	char strFloats[3][32];
+	fprintf(pFile, "static const GFSDK_FaceWorks_CurvatureLUTConfig s_builtInCurvatureLUTConfig =\n{\n");
+	fprintf(pFile, "\t%s,\t// m_diffusionRadius\n", FormatFloatLiteral(curvatureConfig.m_diffusionRadius, strFloats[0]));
+	fprintf(pFile, "\t0, 0,\t// m_texWidth, m_texHeight\n");
+	fprintf(pFile, "\t%s, %s,\t// m_curvatureRadiusMin, m_curvatureRadiusMax\n",
+		FormatFloatLiteral(curvatureConfig.m_curvatureRadiusMin, strFloats[1]),
+		FormatFloatLiteral(curvatureConfig.m_curvatureRadiusMax, strFloats[2]));
+	fprintf(pFile, "\t%s,\t// m_integrationMode\n", IntegrationModeName(curvatureConfig.m_integrationMode));
+	fprintf(pFile, "\t%d,\t// m_integrationSampleCount\n", curvatureConfig.m_integrationSampleCount);
+	fprintf(pFile, "\tGFSDK_FaceWorks_LUTFormat_RGBA8,\t// m_format\n};\n\n");
+
+	fprintf(pFile, "static const GFSDK_FaceWorks_ShadowLUTConfig s_builtInShadowLUTConfig =\n{\n");
+	fprintf(pFile, "\t%s,\t// m_diffusionRadius\n", FormatFloatLiteral(shadowConfig.m_diffusionRadius, strFloats[0]));
+	fprintf(pFile, "\t0, 0,\t// m_texWidth, m_texHeight\n");
+	fprintf(pFile, "\t%s, %s,\t// m_shadowWidthMin, m_shadowWidthMax\n",
+		FormatFloatLiteral(shadowConfig.m_shadowWidthMin, strFloats[1]),
+		FormatFloatLiteral(shadowConfig.m_shadowWidthMax, strFloats[2]));
+	fprintf(pFile, "\t%s,\t// m_shadowSharpening\n", FormatFloatLiteral(shadowConfig.m_shadowSharpening, strFloats[0]));
+	fprintf(pFile, "\t%s,\t// m_integrationMode\n", IntegrationModeName(shadowConfig.m_integrationMode));
+	fprintf(pFile, "\t%d,\t// m_integrationSampleCount\n", shadowConfig.m_integrationSampleCount);
+	fprintf(pFile, "\tGFSDK_FaceWorks_LUTFormat_RGBA8,\t// m_format\n};\n\n");
+
+	// The tables themselves
+	GFSDK_FaceWorks_ErrorBlob errorBlob = {};
+	std::vector<unsigned char> texels;
+	for (int i = 0; i < s_bakedLUTSizeCount; ++i)
+	{
+		int texSize = s_bakedLUTSizes[i];
+
+		curvatureConfig.m_texWidth = texSize;
+		curvatureConfig.m_texHeight = texSize;
+		texels.resize(GFSDK_FaceWorks_CalculateCurvatureLUTSizeBytes(&curvatureConfig));
+		if (GFSDK_FaceWorks_GenerateCurvatureLUT(&curvatureConfig, &texels[0], &errorBlob, NULL, pParallelConfig) != GFSDK_FaceWorks_OK)
+		{
+			fprintf(stderr, "GFSDK_FaceWorks_GenerateCurvatureLUT() failed:\n%s", errorBlob.m_msg);
+			GFSDK_FaceWorks_FreeErrorBlob(&errorBlob);
+			fclose(pFile);
+			return 1;
+		}
+		WriteTable(pFile, "s_builtInCurvatureLUT", texSize, texels);
+
+		shadowConfig.m_texWidth = texSize;
+		shadowConfig.m_texHeight = texSize;
+		texels.resize(GFSDK_FaceWorks_CalculateShadowLUTSizeBytes(&shadowConfig));
+		if (GFSDK_FaceWorks_GenerateShadowLUT(&shadowConfig, &texels[0], &errorBlob, NULL, pParallelConfig) != GFSDK_FaceWorks_OK)
+		{
+			fprintf(stderr, "GFSDK_FaceWorks_GenerateShadowLUT() failed:\n%s", errorBlob.m_msg);
+			GFSDK_FaceWorks_FreeErrorBlob(&errorBlob);
+			fclose(pFile);
+			return 1;
+		}
+		WriteTable(pFile, "s_builtInShadowLUT", texSize, texels);
+	}
+
+	// Lists of the tables, by size
+	const char * strKinds[] = { "Curvature", "Shadow" };
+	for (int iKind = 0; iKind < 2; ++iKind)
+	{
+		fprintf(pFile, "static const BuiltInLUT s_builtIn%sLUTs[] =\n{\n", strKinds[iKind]);
+		for (int i = 0; i < s_bakedLUTSizeCount; ++i)
+			fprintf(pFile, "\t{ %d, s_builtIn%sLUT%d },\n", s_bakedLUTSizes[i], strKinds[iKind], s_bakedLUTSizes[i]);
+		fprintf(pFile, "};\n%s", (iKind == 0) ? "\n" : "");
+	}
+
+	if (fclose(pFile) != 0)
+	{
+		fprintf(stderr, "Error: couldn't write %s\n", strFilename);
+		return 1;
+	}
+
+	printf("Wrote %s\n", strFilename);
+	return 0;
+}
+
+
+
+// A fixed set of worker threads that runs the library's row tasks for every LUT in a batch,
+// so the threads are started once, rather than for each block of rows of each LUT
+
+struct WorkerPool
+{
+	std::vector<std::thread>	m_threads;
+	std::mutex					m_mutex;
+	std::condition_variable		m_cvWork;			// Signaled when a job is posted, or on shutdown
+	std::condition_variable		m_cvIdle;			// Signaled when a worker leaves a job
+	unsigned int				m_jobSerial;		// Bumped for each job posted
+	int							m_activeWorkers;	// Workers currently in a job
+	bool						m_shutdown;
+
+	// The current job; only changed under the mutex, with no workers active
+	GFSDK_FaceWorks_TaskFunc	m_pfnTask;
+	void *						m_pTaskData;
+	int							m_taskCount;
+	std::atomic<int>			m_iTaskNext;
+};
+
+void RunWorkerPoolTasks(WorkerPool * pPool, GFSDK_FaceWorks_TaskFunc pfnTask, void * pTaskData, int taskCount)
+{
+	for (;;)
+	{
+		int iTask = pPool->m_iTaskNext.fetch_add(1);
+		if (iTask >= taskCount)
+			return;
+		pfnTask(pTaskData, iTask);
+	}
+}
+
+void WorkerPoolMain(WorkerPool * pPool)
+{
+	unsigned int jobSerialSeen = 0;
+	std::unique_lock<std::mutex> lock(pPool->m_mutex);
+	for (;;)
+	{
+		pPool->m_cvWork.wait(lock, [&]() { return pPool->m_shutdown || pPool->m_jobSerial != jobSerialSeen; });
+		if (pPool->m_shutdown)
+			return;
+
+		jobSerialSeen = pPool->m_jobSerial;
+		GFSDK_FaceWorks_TaskFunc pfnTask = pPool->m_pfnTask;
+		void * pTaskData = pPool->m_pTaskData;
+		int taskCount = pPool->m_taskCount;
+		++pPool->m_activeWorkers;
+
+		lock.unlock();
+		RunWorkerPoolTasks(pPool, pfnTask, pTaskData, taskCount);
+		lock.lock();
+
+		if (--pPool->m_activeWorkers == 0)
+			pPool->m_cvIdle.notify_all();
+	}
+}
+
+// Parallel-for callback for GFSDK_FaceWorks_ParallelConfig; the calling thread works on the
+// tasks too, and it returns once they're all done
+void WorkerPoolParallelFor(void * pUserData, int taskCount, GFSDK_FaceWorks_TaskFunc pfnTask, void * pTaskData)
+{
+	WorkerPool * pPool = static_cast<WorkerPool *>(pUserData);
+
+	{
+		// Workers that woke late for the previous job may still be in it; wait them out
+		// before replacing it
+		std::unique_lock<std::mutex> lock(pPool->m_mutex);
+		pPool->m_cvIdle.wait(lock, [&]() { return pPool->m_activeWorkers == 0; });
+		pPool->m_pfnTask = pfnTask;
+		pPool->m_pTaskData = pTaskData;
+		pPool->m_taskCount = taskCount;
+		pPool->m_iTaskNext = 0;
+		++pPool->m_jobSerial;
+	}
+	pPool->m_cvWork.notify_all();
+
+	RunWorkerPoolTasks(pPool, pfnTask, pTaskData, taskCount);
+
+	// Every task has been claimed; the ones not run here are in workers still active
+	std::unique_lock<std::mutex> lock(pPool->m_mutex);
+	pPool->m_cvIdle.wait(lock, [&]() { return pPool->m_activeWorkers == 0; });
+}
+
+void StartWorkerPool(int workerCount, WorkerPool * pPool)
+{
+	pPool->m_jobSerial = 0;
+	pPool->m_activeWorkers = 0;
+	pPool->m_shutdown = false;
+	pPool->m_pfnTask = NULL;
+	pPool->m_pTaskData = NULL;
+	pPool->m_taskCount = 0;
+	pPool->m_iTaskNext = 0;
+
+	// The calling thread works on the tasks too, so start one fewer worker than requested
+	if (workerCount <= 0)
+		workerCount = std::max(1, int(std::thread::hardware_concurrency()));
+	for (int i = 0; i < workerCount - 1; ++i)
+		pPool->m_threads.push_back(std::thread(WorkerPoolMain, pPool));
+}
+
+void StopWorkerPool(WorkerPool * pPool)
+{
+	{
+		std::lock_guard<std::mutex> lock(pPool->m_mutex);
+		pPool->m_shutdown = true;
+	}
+	pPool->m_cvWork.notify_all();
+
+	for (size_t i = 0; i < pPool->m_threads.size(); ++i)
+		pPool->m_threads[i].join();
+	pPool->m_threads.clear();
+}
+
+
+
+// Batch generation from a sweep manifest
+
+enum SweepParam
+{
+	SweepParam_DiffusionRadius,
+	SweepParam_MinCurvatureRadius,
+	SweepParam_MaxCurvatureRadius,
+	SweepParam_MinShadowWidth,
+	SweepParam_MaxShadowWidth,
+	SweepParam_ShadowSharpening,
+	SweepParam_Size,				// Width and height together; applied before them
+	SweepParam_Width,
+	SweepParam_Height,
+
+	SweepParam_Count
+};
+
+// Names as in the manifest, with the same valid ranges as the command-line options
+static const struct
+{
+	const char *	m_strName;
+	float			m_minValid;
+	float			m_maxValid;
+} s_sweepParams[SweepParam_Count] =
+{
+	{ "diffusionRadius",	FLT_MIN,	FLT_MAX },
+	{ "minCurvatureRadius",	FLT_MIN,	FLT_MAX },
+	{ "maxCurvatureRadius",	FLT_MIN,	FLT_MAX },
+	{ "minShadowWidth",		FLT_MIN,	FLT_MAX },
+	{ "maxShadowWidth",		FLT_MIN,	FLT_MAX },
+	{ "shadowSharpening",	1.0f,		FLT_MAX },
+	{ "size",				1.0f,		16384.0f },
+	{ "width",				1.0f,		16384.0f },
+	{ "height",				1.0f,		16384.0f },
+};
+
+// One sweep: the values listed for each parameter, whose cartesian product makes its configs;
+// parameters it doesn't list keep the command-line value
+struct BatchSweep
+{
+	std::vector<float>	m_values[SweepParam_Count];
+	bool				m_curvature;
+	bool				m_shadow;
+};
+
+// One LUT to generate, from any sweep
+struct BatchLUT
+{
+	bool								m_isShadow;
+	GFSDK_FaceWorks_CurvatureLUTConfig	m_curvatureConfig;
+	GFSDK_FaceWorks_ShadowLUTConfig		m_shadowConfig;
+	unsigned long long					m_hash;
+	std::string							m_strFilename;
+};
+
+void ApplySweepParam(
+	SweepParam param,
+	float value,
+	GFSDK_FaceWorks_CurvatureLUTConfig * pCurvatureConfig,
+	GFSDK_FaceWorks_ShadowLUTConfig * pShadowConfig)
+{
+	switch (param)
+	{
+	case SweepParam_DiffusionRadius:
+		pCurvatureConfig->m_diffusionRadius = value;
+		pShadowConfig->m_diffusionRadius = value;
+		break;
+	case SweepParam_MinCurvatureRadius:	pCurvatureConfig->m_curvatureRadiusMin = value;	break;
+	case SweepParam_MaxCurvatureRadius:	pCurvatureConfig->m_curvatureRadiusMax = value;	break;
+	case SweepParam_MinShadowWidth:		pShadowConfig->m_shadowWidthMin = value;		break;
+	case SweepParam_MaxShadowWidth:		pShadowConfig->m_shadowWidthMax = value;		break;
+	case SweepParam_ShadowSharpening:	pShadowConfig->m_shadowSharpening = value;		break;
+	case SweepParam_Size:
+		pCurvatureConfig->m_texWidth = pCurvatureConfig->m_texHeight = int(value);
+		pShadowConfig->m_texWidth = pShadowConfig->m_texHeight = int(value);
+		break;
+	case SweepParam_Width:
+		pCurvatureConfig->m_texWidth = int(value);
+		pShadowConfig->m_texWidth = int(value);
+		break;
+	case SweepParam_Height:
+		pCurvatureConfig->m_texHeight = int(value);
+		pShadowConfig->m_texHeight = int(value);
+		break;
+	default:							break;
+	}
+}
+
+// Split a manifest line into whitespace-separated words, dropping any comment
+void SplitManifestLine(char * strLine, std::vector<const char *> * pWords)
+{
+	pWords->clear();
+	char * pComment = strchr(strLine, '#');
+	if (pComment)
+		*pComment = '\0';
+
+	char * pChar = strLine;
+	for (;;)
+	{
+		while (*pChar == ' ' || *pChar == '\t' || *pChar == '\r' || *pChar == '\n')
+			++pChar;
+		if (!*pChar)
+			return;
+		pWords->push_back(pChar);
+		while (*pChar && *pChar != ' ' && *pChar != '\t' && *pChar != '\r' && *pChar != '\n')
+			++pChar;
+		if (*pChar)
+			*pChar++ = '\0';
+	}
+}
+
+int ReadManifest(
+	const char * strFilename,
+	std::vector<BatchSweep> * pSweeps,
+	std::string * pStrOutputDir)
+{
+	FILE * pFile;
+	if (fopen_s(&pFile, strFilename, "r") != 0 || !pFile)
+	{
+		fprintf(stderr, "Error: couldn't open %s for reading\n", strFilename);
+		return 1;
+	}
+
+	BatchSweep emptySweep;
+	emptySweep.m_curvature = true;
+	emptySweep.m_shadow = true;
+	pSweeps->assign(1, emptySweep);
+
+	char strLine[1024];
+	std::vector<const char *> words;
+	int result = 0;
+	for (int iLine = 1; fgets(strLine, sizeof(strLine), pFile); ++iLine)
+	{
+		SplitManifestLine(strLine, &words);
+		if (words.empty())
+			continue;
+
+		BatchSweep & sweep = pSweeps->back();
+		if (_stricmp(words[0], "sweep") == 0)
+		{
+			// Don't leave an empty sweep behind for the lines before the first "sweep"
+			bool isEmpty = true;
+			for (int iParam = 0; iParam < SweepParam_Count; ++iParam)
+				isEmpty = isEmpty && sweep.m_values[iParam].empty();
+			if (!isEmpty || !sweep.m_curvature || !sweep.m_shadow)
+				pSweeps->push_back(emptySweep);
+			continue;
+		}
+
+		if (_stricmp(words[0], "output") == 0)
+		{
+			if (words.size() != 2)
+			{
+				fprintf(stderr, "%s(%d): output expects one directory\n", strFilename, iLine);
+				result = 1;
+				continue;
+			}
+			*pStrOutputDir = words[1];
+			continue;
+		}
+
+		if (_stricmp(words[0], "luts") == 0)
+		{
+			sweep.m_curvature = false;
+			sweep.m_shadow = false;
+			for (size_t iWord = 1; iWord < words.size(); ++iWord)
+			{
+				if (_stricmp(words[iWord], "curvature") == 0)
+					sweep.m_curvature = true;
+				else if (_stricmp(words[iWord], "shadow") == 0)
+					sweep.m_shadow = true;
+				else
+				{
+					fprintf(stderr, "%s(%d): unknown LUT \"%s\"\n", strFilename, iLine, words[iWord]);
+					result = 1;
+				}
+			}
+			continue;
+		}
+
+		int iParam = 0;
+		while (iParam < SweepParam_Count && _stricmp(words[0], s_sweepParams[iParam].m_strName) != 0)
+			++iParam;
+		if (iParam == SweepParam_Count)
+		{
+			fprintf(stderr, "%s(%d): unknown parameter \"%s\"\n", strFilename, iLine, words[0]);
+			result = 1;
+			continue;
+		}
+		if (words.size() < 2)
+		{
+			fprintf(stderr, "%s(%d): %s needs at least one value\n", strFilename, iLine, words[0]);
+			result = 1;
+			continue;
+		}
+
+		bool isInteger = (iParam == SweepParam_Size || iParam == SweepParam_Width || iParam == SweepParam_Height);
+		std::vector<float> & values = sweep.m_values[iParam];
+		values.clear();
+		for (size_t iWord = 1; iWord < words.size(); ++iWord)
+		{
+			float value;
+			if (!sscanf_s(words[iWord], "%f", &value) ||
+				value < s_sweepParams[iParam].m_minValid ||
+				value > s_sweepParams[iParam].m_maxValid ||
+				(isInteger && value != floorf(value)))
+			{
+				fprintf(stderr, "%s(%d): invalid value \"%s\" for %s\n", strFilename, iLine, words[iWord], words[0]);
+				result = 1;
+				continue;
+			}
+			values.push_back(value);
+		}
+	}
+
+	fclose(pFile);
+	return result;
+}
+
+// FNV-1a over the fields that affect a LUT's texels, to name its file; the version is bumped
+// when the generators change, so stale LUTs are regenerated
+static const unsigned int s_batchHashVersion = 1;
+
+struct ConfigHasher
+{
+	unsigned long long	m_hash;
+
+	ConfigHasher() : m_hash(14695981039346656037ull) {}
+
+	void Add(const void * pData, size_t sizeBytes)
+	{
+		const unsigned char * pBytes = static_cast<const unsigned char *>(pData);
+		for (size_t i = 0; i < sizeBytes; ++i)
+			m_hash = (m_hash ^ pBytes[i]) * 1099511628211ull;
+	}
+
+	template <typename T>
+	void Add(T value) { Add(&value, sizeof(value)); }
+};
+
+unsigned long long HashConfig(const GFSDK_FaceWorks_CurvatureLUTConfig & config)
+{
+	ConfigHasher hasher;
+	hasher.Add(s_batchHashVersion);
+	hasher.Add("curvature", 9);
+	hasher.Add(config.m_diffusionRadius);
+	hasher.Add(config.m_texWidth);
+	hasher.Add(config.m_texHeight);
+	hasher.Add(config.m_curvatureRadiusMin);
+	hasher.Add(config.m_curvatureRadiusMax);
+	hasher.Add(int(config.m_integrationMode));
+	hasher.Add(config.m_integrationSampleCount);
+	hasher.Add(int(config.m_format));
+	return hasher.m_hash;
+}
+
+unsigned long long HashConfig(const GFSDK_FaceWorks_ShadowLUTConfig & config)
+{
+	ConfigHasher hasher;
+	hasher.Add(s_batchHashVersion);
+	hasher.Add("shadow", 6);
+	hasher.Add(config.m_diffusionRadius);
+	hasher.Add(config.m_texWidth);
+	hasher.Add(config.m_texHeight);
+	hasher.Add(config.m_shadowWidthMin);
+	hasher.Add(config.m_shadowWidthMax);
+	hasher.Add(config.m_shadowSharpening);
+	hasher.Add(int(config.m_integrationMode));
+	hasher.Add(config.m_integrationSampleCount);
+	hasher.Add(int(config.m_format));
+	return hasher.m_hash;
+}
+
+bool FileExists(const std::string & strFilename)
+{
+	FILE * pFile;
+	if (fopen_s(&pFile, strFilename.c_str(), "rb") != 0 || !pFile)
+		return false;
+	fclose(pFile);
+	return true;
+}
+
+// Expand the sweeps into the list of distinct LUTs they make
+void ExpandSweeps(
+	const std::vector<BatchSweep> & sweeps,
+	const GFSDK_FaceWorks_CurvatureLUTConfig & baseCurvatureConfig,
+	const GFSDK_FaceWorks_ShadowLUTConfig & baseShadowConfig,
+	const std::string & strOutputDir,
+	std::vector<BatchLUT> * pLUTs)
+{
+	for (size_t iSweep = 0; iSweep < sweeps.size(); ++iSweep)
+	{
+		const BatchSweep & sweep = sweeps[iSweep];
+
+		// Step through the combinations like an odometer
+		int iValues[SweepParam_Count] = {};
+		for (;;)
+		{
+			BatchLUT lut;
+			lut.m_curvatureConfig = baseCurvatureConfig;
+			lut.m_shadowConfig = baseShadowConfig;
+			for (int iParam = 0; iParam < SweepParam_Count; ++iParam)
+			{
+				if (!sweep.m_values[iParam].empty())
+					ApplySweepParam(SweepParam(iParam), sweep.m_values[iParam][iValues[iParam]], &lut.m_curvatureConfig, &lut.m_shadowConfig);
+			}
+
+			if (lut.m_curvatureConfig.m_curvatureRadiusMin > lut.m_curvatureConfig.m_curvatureRadiusMax)
+				std::swap(lut.m_curvatureConfig.m_curvatureRadiusMin, lut.m_curvatureConfig.m_curvatureRadiusMax);
+			if (lut.m_shadowConfig.m_shadowWidthMin > lut.m_shadowConfig.m_shadowWidthMax)
+				std::swap(lut.m_shadowConfig.m_shadowWidthMin, lut.m_shadowConfig.m_shadowWidthMax);
+
+			for (int iKind = 0; iKind < 2; ++iKind)
+			{
+				lut.m_isShadow = (iKind == 1);
+				if (!(lut.m_isShadow ? sweep.m_shadow : sweep.m_curvature))
+					continue;
+
+				// Sweeps over shadow parameters repeat the same curvature LUT, and vice versa
+				lut.m_hash = lut.m_isShadow ? HashConfig(lut.m_shadowConfig) : HashConfig(lut.m_curvatureConfig);
+				bool isDuplicate = false;
+				for (size_t iLUT = 0; iLUT < pLUTs->size() && !isDuplicate; ++iLUT)
+					isDuplicate = ((*pLUTs)[iLUT].m_hash == lut.m_hash);
+				if (isDuplicate)
+					continue;
+
+				char strName[64];
+				_snprintf_s(strName, sizeof(strName), _TRUNCATE, "%s_%016llx.bmp", lut.m_isShadow ? "shadow" : "curvature", lut.m_hash);
+				lut.m_strFilename = strOutputDir.empty() ? strName : strOutputDir + "/" + strName;
+				pLUTs->push_back(lut);
+			}
+
+			int iParam = 0;
+			for (; iParam < SweepParam_Count; ++iParam)
+			{
+				if (++iValues[iParam] < int(sweep.m_values[iParam].size()))
+					break;
+				iValues[iParam] = 0;
+			}
+			if (iParam == SweepParam_Count)
+				break;
+		}
+	}
+}
+
+// List every LUT in the batch with its parameters, so the hashed filenames can be looked up
+int WriteBatchIndex(const std::vector<BatchLUT> & luts, const std::string & strOutputDir)
+{
+	std::string strFilename = strOutputDir.empty() ? "index.txt" : strOutputDir + "/index.txt";
+	FILE * pFile;
+	if (fopen_s(&pFile, strFilename.c_str(), "w") != 0 || !pFile)
+	{
+		fprintf(stderr, "Error: couldn't open %s for writing\n", strFilename.c_str());
+		return 1;
+	}
+
+	for (size_t iLUT = 0; iLUT < luts.size(); ++iLUT)
+	{
+		const BatchLUT & lut = luts[iLUT];
+		size_t iName = lut.m_strFilename.find_last_of("/\\");
+		const char * strName = lut.m_strFilename.c_str() + ((iName == std::string::npos) ? 0 : iName + 1);
+		if (lut.m_isShadow)
+		{
+			const GFSDK_FaceWorks_ShadowLUTConfig & config = lut.m_shadowConfig;
+			fprintf(pFile,
+				"%s diffusionRadius %g width %d height %d minShadowWidth %g maxShadowWidth %g "
+				"shadowSharpening %g\n",
+				strName, config.m_diffusionRadius, config.m_texWidth, config.m_texHeight,
+				config.m_shadowWidthMin, config.m_shadowWidthMax, config.m_shadowSharpening);
+		}
+		else
+		{
+			const GFSDK_FaceWorks_CurvatureLUTConfig & config = lut.m_curvatureConfig;
+			fprintf(pFile,
+				"%s diffusionRadius %g width %d height %d minCurvatureRadius %g maxCurvatureRadius %g\n",
+				strName, config.m_diffusionRadius, config.m_texWidth, config.m_texHeight,
+				config.m_curvatureRadiusMin, config.m_curvatureRadiusMax);
+		}
+	}
+
+	if (fclose(pFile) != 0)
+	{
+		fprintf(stderr, "Error: couldn't write %s\n", strFilename.c_str());
+		return 1;
+	}
+	return 0;
+}
+
+int RunBatch(
+	const GFSDK_FaceWorks_CurvatureLUTConfig * pCurvatureConfig,
+	const GFSDK_FaceWorks_ShadowLUTConfig * pShadowConfig,
+	int workerCount,
+	bool estimateError,
+	const CompressOptions & compressOptions,
+	const char * strFilename)
+{
+	std::vector<BatchSweep> sweeps;
+	std::string strOutputDir;
+	if (ReadManifest(strFilename, &sweeps, &strOutputDir) != 0)
+		return 1;
+
+	std::vector<BatchLUT> luts;
+	ExpandSweeps(sweeps, *pCurvatureConfig, *pShadowConfig, strOutputDir, &luts);
+	printf("Batch %s: %d LUTs in %d sweeps\n", strFilename, int(luts.size()), int(sweeps.size()));
+
+	if (!strOutputDir.empty() &&
+		!CreateDirectoryA(strOutputDir.c_str(), NULL) &&
+		GetLastError() != ERROR_ALREADY_EXISTS)
+	{
+		fprintf(stderr, "Error: couldn't create directory %s\n", strOutputDir.c_str());
+		return 1;
+	}
+	if (WriteBatchIndex(luts, strOutputDir) != 0)
+		return 1;
+
+	// Every LUT's rows go to the same threads
+	WorkerPool pool;
+	StartWorkerPool(workerCount, &pool);
+	GFSDK_FaceWorks_ParallelConfig parallelConfig =
+	{
+		workerCount,			// m_workerCount
+		&WorkerPoolParallelFor,	// m_parallelFor
+		&pool,					// m_pUserData
+	};
+
+	typedef std::chrono::steady_clock BatchClock;
+	BatchClock::time_point batchStart = BatchClock::now();
+	double texelCountGenerated = 0.0;
+	int generatedCount = 0;
+	int skippedCount = 0;
+	int result = 0;
+
+	for (size_t iLUT = 0; iLUT < luts.size(); ++iLUT)
+	{
+		const BatchLUT & lut = luts[iLUT];
+		std::string strCompressedFilename = lut.m_strFilename.substr(0, lut.m_strFilename.size() - 4) + ".dds";
+		if (FileExists(lut.m_strFilename) && (!compressOptions.m_enabled || FileExists(strCompressedFilename)))
+		{
+			printf("[%d/%d] %s exists; skipping\n", int(iLUT) + 1, int(luts.size()), lut.m_strFilename.c_str());
+			++skippedCount;
+			continue;
+		}
+
+		BatchClock::time_point start = BatchClock::now();
+		int res = lut.m_isShadow ?
+					GenerateShadowLUT(&lut.m_shadowConfig, &parallelConfig, estimateError, compressOptions, lut.m_strFilename.c_str()) :
+					GenerateCurvatureLUT(&lut.m_curvatureConfig, &parallelConfig, estimateError, compressOptions, lut.m_strFilename.c_str());
+		if (res != 0)
+		{
+			result = 1;
+			break;
+		}
+		double seconds = std::chrono::duration<double>(BatchClock::now() - start).count();
+
+		int width = lut.m_isShadow ? lut.m_shadowConfig.m_texWidth : lut.m_curvatureConfig.m_texWidth;
+		int height = lut.m_isShadow ? lut.m_shadowConfig.m_texHeight : lut.m_curvatureConfig.m_texHeight;
+		double texelCount = double(width) * double(height);
+		texelCountGenerated += texelCount;
+		++generatedCount;
+		printf(
+			"[%d/%d] %dx%d in %0.3f seconds, %0.2f Mtexels/s\n",
+			int(iLUT) + 1, int(luts.size()), width, height, seconds, texelCount / std::max(seconds, 1e-9) * 1e-6);
+	}
+
+	StopWorkerPool(&pool);
+
+	double batchSeconds = std::chrono::duration<double>(BatchClock::now() - batchStart).count();
+	printf(
+		"Batch done: %d LUTs generated, %d skipped, in %0.3f seconds; %0.2f LUTs/s, %0.2f Mtexels/s\n",
+		generatedCount, skippedCount, batchSeconds,
+		double(generatedCount) / std::max(batchSeconds, 1e-9),
+		texelCountGenerated / std::max(batchSeconds, 1e-9) * 1e-6);
+
+	return result;
 }
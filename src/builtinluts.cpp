@@ -0,0 +1,129 @@
+//----------------------------------------------------------------------------------
+// File:        FaceWorks/src/builtinluts.cpp
+// SDK Version: v1.0
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014-2016, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+#include "internal.h"
+
+#include <cstring>
+
+
+
+// The built-in LUTs, square and in GFSDK_FaceWorks_LUTFormat_RGBA8.  Each texel is stored as a
+// little-endian unsigned int, so the tables can be handed out as bytes without copying.
+struct BuiltInLUT
+{
+	int						m_texSize;
+	const unsigned int *	m_pTexels;
+};
+
+// builtinluts.inl is generated by "lut_generator -bakeTables"; it defines the configs and the tables
+#include "builtinluts.inl"
+
+template <int N>
+static const unsigned int * FindBuiltInLUT(
+	const BuiltInLUT (&luts)[N],
+	int texSize,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut)
+{
+	for (int i = 0; i < N; ++i)
+	{
+		if (luts[i].m_texSize == texSize)
+			return luts[i].m_pTexels;
+	}
+
+	char strSizes[256] = {};
+	for (int i = 0; i < N; ++i)
+	{
+		size_t length = strlen(strSizes);
+		_snprintf_s(strSizes + length, dim(strSizes) - length, _TRUNCATE, i == 0 ? "%d" : ", %d", luts[i].m_texSize);
+	}
+
+	ErrPrintf("texSize is %d; should be one of the built-in sizes (%s)\n", texSize, strSizes);
+	return nullptr;
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GetBuiltInCurvatureLUT(
+	int texSize,
+	GFSDK_FaceWorks_CurvatureLUTConfig * pConfigOut,
+	const void ** ppTexelsOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut)
+{
+	// Validate parameters
+	if (!ppTexelsOut)
+	{
+		ErrPrintf("ppTexelsOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	const unsigned int * pTexels = FindBuiltInLUT(s_builtInCurvatureLUTs, texSize, pErrorBlobOut);
+	if (!pTexels)
+		return GFSDK_FaceWorks_InvalidArgument;
+
+	if (pConfigOut)
+	{
+		*pConfigOut = s_builtInCurvatureLUTConfig;
+		pConfigOut->m_texWidth = texSize;
+		pConfigOut->m_texHeight = texSize;
+	}
+
+	*ppTexelsOut = pTexels;
+	return GFSDK_FaceWorks_OK;
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GetBuiltInShadowLUT(
+	int texSize,
+	GFSDK_FaceWorks_ShadowLUTConfig * pConfigOut,
+	const void ** ppTexelsOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut)
+{
+	// Validate parameters
+	if (!ppTexelsOut)
+	{
+		ErrPrintf("ppTexelsOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	const unsigned int * pTexels = FindBuiltInLUT(s_builtInShadowLUTs, texSize, pErrorBlobOut);
+	if (!pTexels)
+		return GFSDK_FaceWorks_InvalidArgument;
+
+	if (pConfigOut)
+	{
+		*pConfigOut = s_builtInShadowLUTConfig;
+		pConfigOut->m_texWidth = texSize;
+		pConfigOut->m_texHeight = texSize;
+	}
+
+	*ppTexelsOut = pTexels;
+	return GFSDK_FaceWorks_OK;
+}
@@ -39,6 +39,7 @@
 #include <cmath>
 #include <cstdarg>
 #include <memory>
+#include <vector>
 
 #include <GFSDK_FaceWorks.h>
 
@@ -70,8 +71,20 @@ struct CBData
 	float	m_deepScatterFalloff;
 	float	m_shadowFilterRadius;
 	float	m_decodeDepthScale, m_decodeDepthBias;
+
+	// Slice of the LUT arrays (SSS)
+	float	m_lutArraySlice;
+
+	// Size of each LUT relative to the LUT atlas (SSS)
+	float	m_lutAtlasScaleU, m_lutAtlasScaleV;
 };
 
+// Most mip levels a LUT atlas may have
+static const int cLUTAtlasMipCountMax = GFSDK_FaceWorks_LUTAtlasMipCountMax;
+
+// Most slices a LUT array may have (the max texture array size in D3D11)
+static const int cLUTArraySliceCountMax = 2048;
+
 
 
 // Memory allocation helper functions
@@ -150,6 +163,279 @@ public:
 
 
 
+// Parallel execution helper functions
+
+// Number of threads that work will be spread over, given the user's parallel config
+int GetParallelWorkerCount(const GFSDK_FaceWorks_ParallelConfig * pParallelConfig);
+
+// Call pfnTask(pTaskData, iTask) for each iTask in [0, taskCount), using the user's
+// parallel-for callback or the internal thread pool; returns when all tasks have finished.
+void RunParallel(
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig,
+	int taskCount,
+	GFSDK_FaceWorks_TaskFunc pfnTask,
+	void * pTaskData,
+	gfsdk_new_delete_t * pAllocator);
+
+// Split [0, itemCount) into contiguous ranges and call fn(iBegin, iEnd) on each, in parallel
+template <typename Fn>
+void ParallelForRanges(
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig,
+	int itemCount,
+	const Fn & fn,
+	gfsdk_new_delete_t * pAllocator)
+{
+	struct Ranges
+	{
+		const Fn *	m_pFn;
+		int			m_itemCount;
+		int			m_rangeCount;
+
+		static void Run(void * pTaskData, int iTask)
+		{
+			const Ranges * pRanges = static_cast<const Ranges *>(pTaskData);
+			int iBegin = int((long long)pRanges->m_itemCount * iTask / pRanges->m_rangeCount);
+			int iEnd = int((long long)pRanges->m_itemCount * (iTask + 1) / pRanges->m_rangeCount);
+			(*pRanges->m_pFn)(iBegin, iEnd);
+		}
+	};
+
+	// Use several ranges per worker, to balance the load if some ranges are more costly
+	static const int cRangesPerWorker = 4;
+	Ranges ranges = { &fn, itemCount, min(itemCount, GetParallelWorkerCount(pParallelConfig) * cRangesPerWorker) };
+	RunParallel(pParallelConfig, ranges.m_rangeCount, &Ranges::Run, &ranges, pAllocator);
+}
+
+
+
+// SIMD kernels for the inner loops of the precomputation math.  Each instruction set
+// gets its own implementation; the best one supported by the CPU is picked at load time.
+
+enum SimdLevel
+{
+	SimdLevel_Scalar,
+	SimdLevel_SSE41,
+	SimdLevel_AVX2,
+	SimdLevel_AVX512,
+	SimdLevel_Count,
+};
+
+struct SimdKernels
+{
+	const char *	m_name;
+
+	// Evaluate a mixture of Gaussians with RGB weights at count positions, multiplied by scale
+	void (*m_pfnEvaluateGaussianMixture)(
+			const float * pX, int count,
+			const float * pSigmas, const float * pWeightsR, const float * pWeightsG, const float * pWeightsB, int lobeCount,
+			float scale, float * pROut, float * pGOut, float * pBOut);
+
+	// Sum over samples of max(0, cosTheta * pCos[i] + sinTheta * pSin[i]) times RGB weights
+	void (*m_pfnIntegrateClampedCosine)(
+			float cosTheta, float sinTheta, const float * pCos, const float * pSin,
+			const float * pWeightsR, const float * pWeightsG, const float * pWeightsB, int count,
+			float rgbOut[3]);
+
+	// Sum over samples of smoothstep(saturate(pDelta[i] * posSlope + posBias)) times RGB weights
+	void (*m_pfnIntegrateSmoothstep)(
+			float posSlope, float posBias, const float * pDelta,
+			const float * pWeightsR, const float * pWeightsG, const float * pWeightsB, int count,
+			float rgbOut[3]);
+
+	// For count texels, the integral of smoothstep(saturate(delta * posSlope + pPosBias[i])) for delta
+	// in [-10, 10] mm against a mixture of Gaussians with RGB weights, in closed form; pUpperTails
+	// holds each Gaussian's mass above 10 mm
+	void (*m_pfnIntegrateSmoothstepAnalytic)(
+			float posSlope, const float * pPosBias, int count,
+			const float * pSigmas, const float * pUpperTails,
+			const float * pWeightsR, const float * pWeightsG, const float * pWeightsB, int lobeCount,
+			float * pROut, float * pGOut, float * pBOut);
+
+	// Estimate curvature along each edge from the change in normals between its two vertices
+	void (*m_pfnCalculateEdgeCurvatures)(
+			const void * pPositions, int positionStrideBytes,
+			const void * pNormals, int normalStrideBytes,
+			const int * pEdgeVerts, int edgeCount,
+			float * pCurvaturesOut);
+
+	// Squared position-space diameter (longest edge) of each triangle
+	void (*m_pfnCalculateTriangleDiametersSq)(
+			const void * pPositions, int positionStrideBytes,
+			const int * pIndices, int triCount,
+			float * pDiametersSqOut);
+
+	// Sum of log(position-space diameter / UV-space diameter) over non-degenerate triangles;
+	// the squared position-space diameters are taken from pDiametersSq if it's not null,
+	// in which case pPositions isn't used
+	void (*m_pfnSumTriangleLogUVScales)(
+			const void * pPositions, int positionStrideBytes,
+			const float * pDiametersSq,
+			const void * pUVs, int uvStrideBytes,
+			const int * pIndices, int triCount,
+			float * pLogUVScaleSumOut, int * pTriCountOut);
+};
+
+// Kernels for the best instruction set supported by this CPU
+const SimdKernels * GetSimdKernels();
+
+// Kernels for a specific instruction set, or null if the CPU or the build doesn't support it
+const SimdKernels * GetSimdKernelsForLevel(SimdLevel level);
+
+
+
+// LUT generator helpers shared by the LUT source files
+
+GFSDK_FaceWorks_Result ValidateCurvatureLUTConfig(
+	const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut);
+
+GFSDK_FaceWorks_Result ValidateShadowLUTConfig(
+	const GFSDK_FaceWorks_ShadowLUTConfig * pConfig,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut);
+
+// Clamp float RGB to the range of a LUT format; [0, 1] for the unorm formats
+void ClampToLUTFormatRange(GFSDK_FaceWorks_LUTFormat format, const float rgb[3], float rgbOut[3]);
+
+// Map curvature LUT texels, 3 floats each, from the normalized values the generators evaluate
+// (the difference from saturate(N.L), remapped from [-0.25, 0.25] to [0, 1]) to the values a
+// format stores, in place.  Only the float formats store anything else.
+void EncodeCurvatureLUTValues(GFSDK_FaceWorks_LUTFormat format, float * pRGB, size_t texelCount);
+
+// Rows [iYBegin, iYEnd) of a LUT as float RGB, 3 floats per texel: m_format is ignored, so they're
+// unclamped, linear and, for the curvature LUT, normalized; pRGBOut points to row iYBegin.  Used
+// to fit the ALU approximations of the LUTs, filter the LUT atlas mips and refine progressive LUTs.
+
+GFSDK_FaceWorks_Result GenerateCurvatureLUTFloat(
+	const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig,
+	int iYBegin,
+	int iYEnd,
+	float * pRGBOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	gfsdk_new_delete_t * pAllocator,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig);
+
+GFSDK_FaceWorks_Result GenerateShadowLUTFloat(
+	const GFSDK_FaceWorks_ShadowLUTConfig * pConfig,
+	int iYBegin,
+	int iYEnd,
+	float * pRGBOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	gfsdk_new_delete_t * pAllocator,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig);
+
+// Convert float RGB texels to a LUT format, clamped to its range.  With encodeSRGB, they're
+// stored in sRGB space in the formats that have sRGB views, as the shadow LUT is.
+void EncodeLUTTexels(
+	GFSDK_FaceWorks_LUTFormat format,
+	bool encodeSRGB,
+	const float * pRGB,
+	int texelCount,
+	void * pPixelsOut);
+
+
+
+// Mesh topology helpers
+
+// Unique edges of a triangle mesh, each a (lower, higher) pair of vertex indices, in order of
+// the lower then the higher vertex.  Boundary edges are the ones used by only one triangle.
+struct MeshEdges
+{
+	std::vector<int, FaceWorks_Allocator<int>>						m_verts;		// Two per edge
+	std::vector<unsigned char, FaceWorks_Allocator<unsigned char>>	m_triCounts;	// One per edge: number of triangles using it, up to 255
+	int																m_boundaryEdgeCount;
+
+	explicit MeshEdges(gfsdk_new_delete_t * pAllocator)
+		: m_verts(FaceWorks_Allocator<int>(pAllocator)),
+		  m_triCounts(FaceWorks_Allocator<unsigned char>(pAllocator)),
+		  m_boundaryEdgeCount(0)
+	{
+	}
+
+	int EdgeCount() const { return int(m_triCounts.size()); }
+	bool IsBoundary(int iEdge) const { return m_triCounts[iEdge] == 1; }
+};
+
+// Build the unique edges of the triangles in pIndices, whose indices must be in
+// [0, vertexCount); may throw std::bad_alloc
+void BuildMeshEdges(
+	int vertexCount,
+	int triCount,
+	const int * pIndices,
+	MeshEdges * pEdgesOut,
+	gfsdk_new_delete_t * pAllocator);
+
+// Each vertex's neighbors in compressed sparse row form: vertex i's neighbors are
+// m_neighbors[m_begin[i]] through m_neighbors[m_begin[i + 1] - 1], in increasing order.
+// Each neighbor is weighted by the number of triangles sharing the edge to it, so gathering
+// over the lists weighs the neighbors the same as visiting every triangle would.
+struct MeshAdjacency
+{
+	std::vector<int, FaceWorks_Allocator<int>>						m_begin;		// vertexCount + 1 entries
+	std::vector<int, FaceWorks_Allocator<int>>						m_neighbors;	// Two per edge
+	std::vector<unsigned char, FaceWorks_Allocator<unsigned char>>	m_weights;		// One per neighbor
+
+	explicit MeshAdjacency(gfsdk_new_delete_t * pAllocator)
+		: m_begin(FaceWorks_Allocator<int>(pAllocator)),
+		  m_neighbors(FaceWorks_Allocator<int>(pAllocator)),
+		  m_weights(FaceWorks_Allocator<unsigned char>(pAllocator))
+	{
+	}
+};
+
+// Build the neighbor lists from a mesh's unique edges; may throw std::bad_alloc
+void BuildMeshAdjacency(
+	int vertexCount,
+	const MeshEdges & edges,
+	MeshAdjacency * pAdjacencyOut);
+
+// One smoothing pass at a vertex: the weighted average of its neighbors' curvatures, as given by
+// curvatureOf(iNeighborVert)
+template <typename CurvatureOf>
+inline float SmoothedCurvature(const MeshAdjacency & adjacency, int iVert, const CurvatureOf & curvatureOf)
+{
+	float curvatureSum = 0.0f;
+	int weightSum = 0;
+	for (int iNeighbor = adjacency.m_begin[iVert], iNeighborEnd = adjacency.m_begin[iVert + 1]; iNeighbor < iNeighborEnd; ++iNeighbor)
+	{
+		int weight = adjacency.m_weights[iNeighbor];
+		curvatureSum += float(weight) * curvatureOf(adjacency.m_neighbors[iNeighbor]);
+		weightSum += weight;
+	}
+	return curvatureSum / float(max(1, weightSum));
+}
+
+// Likewise, with the neighbors' curvatures in pSrc
+inline float SmoothedCurvature(const MeshAdjacency & adjacency, const float * pSrc, int iVert)
+{
+	return SmoothedCurvature(adjacency, iVert, [pSrc](int iNeighborVert) { return pSrc[iNeighborVert]; });
+}
+
+// Per-vertex curvatures from a mesh's unique edges, as for GFSDK_FaceWorks_CalculateMeshCurvature(),
+// into a compact buffer with one float per vertex; the neighbor lists are only used by the
+// smoothing passes, so they can be left empty if there are none.  May throw std::bad_alloc.
+void CalculateVertexCurvatures(
+	int vertexCount,
+	const void * pPositions,
+	int positionStrideBytes,
+	const void * pNormals,
+	int normalStrideBytes,
+	const MeshEdges & edges,
+	const MeshAdjacency & adjacency,
+	int smoothingPassCount,
+	std::vector<float, FaceWorks_Allocator<float>> * pCurvaturesOut,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig,
+	gfsdk_new_delete_t * pAllocator);
+
+// Gather statistics of curvatures written by the mesh curvature functions; may throw std::bad_alloc
+void CalculateCurvatureStats(
+	int vertexCount,
+	const void * pCurvatures,
+	int curvatureStrideBytes,
+	GFSDK_FaceWorks_CurvatureStats * pStatsOut,
+	gfsdk_new_delete_t * pAllocator);
+
+
+
 // Error blob helper functions
 void BlobPrintf(GFSDK_FaceWorks_ErrorBlob * pBlob, const char * fmt, ...);
 #define ErrPrintf(...) BlobPrintf(pErrorBlobOut, "Error: " __VA_ARGS__)
@@ -0,0 +1,255 @@
+//----------------------------------------------------------------------------------
+// File:        FaceWorks/src/lutatlas.cpp
+// SDK Version: v1.0
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014-2016, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+#include "internal.h"
+
+#include <vector>
+
+// LUT atlas: the curvature LUT (left) and shadow LUT (right) in one texture with a mip chain.
+// Each LUT is padded on all sides with copies of its edge texels, 2^(mipCount - 1) texels at
+// level 0, so each level keeps at least one texel of padding and bilinear samples clamped to
+// the LUT's own [0, 1] coordinates never reach the other LUT.  That makes the atlas
+// 2 * (W + 2P) x (H + 2P); the shaders only need each LUT's size relative to it.
+
+static const int cLUTAtlasLUTCount = 2;
+
+typedef std::vector<float, FaceWorks_Allocator<float>> FloatVector;
+
+static GFSDK_FaceWorks_Result CalculateLUTAtlasLayout(
+	const GFSDK_FaceWorks_CurvatureLUTConfig * pCurvatureConfig,
+	const GFSDK_FaceWorks_ShadowLUTConfig * pShadowConfig,
+	int mipCount,
+	GFSDK_FaceWorks_LUTAtlasLayout * pLayoutOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut)
+{
+	// Validate parameters
+	GFSDK_FaceWorks_Result res = ValidateCurvatureLUTConfig(pCurvatureConfig, pErrorBlobOut);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
+
+	res = ValidateShadowLUTConfig(pShadowConfig, pErrorBlobOut);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
+
+	if (pShadowConfig->m_texWidth != pCurvatureConfig->m_texWidth ||
+		pShadowConfig->m_texHeight != pCurvatureConfig->m_texHeight)
+	{
+		ErrPrintf("shadow LUT size (%dx%d) doesn't match curvature LUT size (%dx%d)\n",
+			pShadowConfig->m_texWidth, pShadowConfig->m_texHeight,
+			pCurvatureConfig->m_texWidth, pCurvatureConfig->m_texHeight);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (pShadowConfig->m_format != pCurvatureConfig->m_format)
+	{
+		ErrPrintf("shadow LUT m_format (%d) doesn't match curvature LUT m_format (%d)\n",
+			int(pShadowConfig->m_format), int(pCurvatureConfig->m_format));
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (mipCount < 1 || mipCount > cLUTAtlasMipCountMax)
+	{
+		ErrPrintf("mipCount is %d; should be in [1, %d]\n", mipCount, cLUTAtlasMipCountMax);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	int alignment = 1 << (mipCount - 1);
+	if (pCurvatureConfig->m_texWidth % alignment != 0 || pCurvatureConfig->m_texHeight % alignment != 0)
+	{
+		ErrPrintf("LUT size (%dx%d) should be a multiple of %d for %d mip levels\n",
+			pCurvatureConfig->m_texWidth, pCurvatureConfig->m_texHeight, alignment, mipCount);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	if (!pLayoutOut)
+	{
+		ErrPrintf("pLayoutOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	GFSDK_FaceWorks_LUTAtlasLayout layout = {};
+	layout.m_lutWidth = pCurvatureConfig->m_texWidth;
+	layout.m_lutHeight = pCurvatureConfig->m_texHeight;
+	layout.m_padding = alignment;
+	layout.m_width = cLUTAtlasLUTCount * (layout.m_lutWidth + 2 * layout.m_padding);
+	layout.m_height = layout.m_lutHeight + 2 * layout.m_padding;
+	layout.m_mipCount = mipCount;
+	layout.m_format = pCurvatureConfig->m_format;
+
+	size_t texelBytes = GFSDK_FaceWorks_CalculateLUTTexelSizeBytes(layout.m_format);
+	for (int iMip = 0; iMip < mipCount; ++iMip)
+	{
+		layout.m_mipOffsetBytes[iMip] = layout.m_sizeBytes;
+		layout.m_mipRowPitchBytes[iMip] = texelBytes * size_t(layout.m_width >> iMip);
+		layout.m_sizeBytes += layout.m_mipRowPitchBytes[iMip] * size_t(layout.m_height >> iMip);
+	}
+
+	*pLayoutOut = layout;
+	return GFSDK_FaceWorks_OK;
+}
+
+// Write one level of the atlas from the LUTs at that level, padding them with their edge texels
+static void WriteLUTAtlasLevel(
+	const GFSDK_FaceWorks_LUTAtlasLayout & layout,
+	int iMip,
+	const float * const * ppLUTs,
+	float * pRowWork,
+	unsigned char * pPixelsOut)
+{
+	int lutWidth = layout.m_lutWidth >> iMip;
+	int lutHeight = layout.m_lutHeight >> iMip;
+	int padding = layout.m_padding >> iMip;
+	int width = layout.m_width >> iMip;
+	int height = layout.m_height >> iMip;
+	int lutStride = lutWidth + 2 * padding;
+
+	for (int iY = 0; iY < height; ++iY)
+	{
+		int iYLUT = min(max(iY - padding, 0), lutHeight - 1);
+		float * pRGB = pRowWork;
+		for (int iX = 0; iX < width; ++iX, pRGB += 3)
+		{
+			int iLUT = iX / lutStride;
+			int iXLUT = min(max(iX - iLUT * lutStride - padding, 0), lutWidth - 1);
+			const float * pRGBLUT = &ppLUTs[iLUT][3 * (size_t(iYLUT) * lutWidth + iXLUT)];
+			pRGB[0] = pRGBLUT[0];
+			pRGB[1] = pRGBLUT[1];
+			pRGB[2] = pRGBLUT[2];
+		}
+
+		EncodeLUTTexels(layout.m_format, true, pRowWork, width, pPixelsOut + iY * layout.m_mipRowPitchBytes[iMip]);
+	}
+}
+
+// 2x2 box filter of a LUT's float texels, in place; width and height are those of the source level
+static void DownsampleLUT(float * pRGB, int width, int height)
+{
+	int widthOut = width / 2;
+	int heightOut = height / 2;
+
+	// Each output texel only reads source texels at or after its own position, so this is
+	// safe to do in place
+	for (int iY = 0; iY < heightOut; ++iY)
+	{
+		for (int iX = 0; iX < widthOut; ++iX)
+		{
+			const float * p00 = &pRGB[3 * (size_t(2 * iY) * width + 2 * iX)];
+			const float * p01 = p00 + 3;
+			const float * p10 = p00 + 3 * size_t(width);
+			const float * p11 = p10 + 3;
+			float * pOut = &pRGB[3 * (size_t(iY) * widthOut + iX)];
+			for (int i = 0; i < 3; ++i)
+				pOut[i] = 0.25f * (p00[i] + p01[i] + p10[i] + p11[i]);
+		}
+	}
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateLUTAtlasLayout(
+	const GFSDK_FaceWorks_CurvatureLUTConfig * pCurvatureConfig,
+	const GFSDK_FaceWorks_ShadowLUTConfig * pShadowConfig,
+	int mipCount,
+	GFSDK_FaceWorks_LUTAtlasLayout * pLayoutOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut)
+{
+	return CalculateLUTAtlasLayout(pCurvatureConfig, pShadowConfig, mipCount, pLayoutOut, pErrorBlobOut);
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GenerateLUTAtlas(
+	const GFSDK_FaceWorks_CurvatureLUTConfig * pCurvatureConfig,
+	const GFSDK_FaceWorks_ShadowLUTConfig * pShadowConfig,
+	int mipCount,
+	void * pLUTAtlasOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	gfsdk_new_delete_t * pAllocator,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	// Validate parameters
+	GFSDK_FaceWorks_LUTAtlasLayout layout;
+	GFSDK_FaceWorks_Result res = CalculateLUTAtlasLayout(pCurvatureConfig, pShadowConfig, mipCount, &layout, pErrorBlobOut);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
+
+	if (!pLUTAtlasOut)
+	{
+		ErrPrintf("pLUTAtlasOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	FaceWorks_Allocator<float> allocFloat(pAllocator);
+	FloatVector curvatureLUT(allocFloat), shadowLUT(allocFloat), rowWork(allocFloat);
+	try
+	{
+		size_t lutSize = 3 * size_t(layout.m_lutWidth) * size_t(layout.m_lutHeight);
+		curvatureLUT.resize(lutSize);
+		shadowLUT.resize(lutSize);
+		rowWork.resize(3 * size_t(layout.m_width));
+	}
+	catch (std::bad_alloc)
+	{
+		return GFSDK_FaceWorks_OutOfMemory;
+	}
+
+	// Level 0 as float texels, encoded and clamped to the format's range so the mips filter what the
+	// texture holds
+	res = GenerateCurvatureLUTFloat(pCurvatureConfig, 0, layout.m_lutHeight, &curvatureLUT[0], pErrorBlobOut, pAllocator, pParallelConfig);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
+
+	EncodeCurvatureLUTValues(layout.m_format, &curvatureLUT[0], size_t(layout.m_lutWidth) * size_t(layout.m_lutHeight));
+
+	res = GenerateShadowLUTFloat(pShadowConfig, 0, layout.m_lutHeight, &shadowLUT[0], pErrorBlobOut, pAllocator, pParallelConfig);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
+
+	float * ppLUTs[cLUTAtlasLUTCount] = { &curvatureLUT[0], &shadowLUT[0] };
+	for (int iLUT = 0; iLUT < cLUTAtlasLUTCount; ++iLUT)
+	{
+		float * pRGB = ppLUTs[iLUT];
+		for (size_t i = 0, count = size_t(layout.m_lutWidth) * size_t(layout.m_lutHeight); i < count; ++i, pRGB += 3)
+			ClampToLUTFormatRange(layout.m_format, pRGB, pRGB);
+	}
+
+	// Write each level, then filter the LUTs down to the next
+	unsigned char * pPixels = static_cast<unsigned char *>(pLUTAtlasOut);
+	for (int iMip = 0; iMip < layout.m_mipCount; ++iMip)
+	{
+		WriteLUTAtlasLevel(layout, iMip, ppLUTs, &rowWork[0], pPixels + layout.m_mipOffsetBytes[iMip]);
+
+		if (iMip + 1 < layout.m_mipCount)
+		{
+			for (int iLUT = 0; iLUT < cLUTAtlasLUTCount; ++iLUT)
+				DownsampleLUT(ppLUTs[iLUT], layout.m_lutWidth >> iMip, layout.m_lutHeight >> iMip);
+		}
+	}
+
+	return GFSDK_FaceWorks_OK;
+}
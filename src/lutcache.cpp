@@ -0,0 +1,520 @@
+//----------------------------------------------------------------------------------
+// File:        FaceWorks/src/lutcache.cpp
+// SDK Version: v1.0
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014-2016, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+#include "internal.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#	define NOMINMAX
+#	define WIN32_LEAN_AND_MEAN
+#	include <windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+
+
+// Platform file helpers
+
+static FILE * OpenFileForWriting(const char * strPath)
+{
+#if defined(_WIN32)
+	FILE * pFile;
+	if (fopen_s(&pFile, strPath, "wb") != 0)
+		return nullptr;
+	return pFile;
+#else
+	return fopen(strPath, "wb");
+#endif
+}
+
+static void DeleteFileIfExists(const char * strPath)
+{
+#if defined(_WIN32)
+	DeleteFileA(strPath);
+#else
+	unlink(strPath);
+#endif
+}
+
+// Rename a finished file into place, replacing any existing one; readers see either the old
+// file or the new one, never a partly written one
+static bool PublishFile(const char * strTempPath, const char * strPath)
+{
+#if defined(_WIN32)
+	return MoveFileExA(strTempPath, strPath, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	return rename(strTempPath, strPath) == 0;
+#endif
+}
+
+static unsigned int GetProcessIdForTempName()
+{
+#if defined(_WIN32)
+	return static_cast<unsigned int>(GetCurrentProcessId());
+#else
+	return static_cast<unsigned int>(getpid());
+#endif
+}
+
+// Map a whole file read-only; the mapping stays valid after the file is closed or replaced
+static bool MapFileReadOnly(const char * strPath, const void ** ppMappingOut, size_t * pSizeOut)
+{
+#if defined(_WIN32)
+	HANDLE hFile = CreateFileA(
+						strPath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+						OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart == 0)
+	{
+		CloseHandle(hFile);
+		return false;
+	}
+
+	HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(hFile);
+	if (!hMapping)
+		return false;
+
+	const void * pMapping = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(hMapping);
+	if (!pMapping)
+		return false;
+
+	*ppMappingOut = pMapping;
+	*pSizeOut = size_t(fileSize.QuadPart);
+	return true;
+#else
+	int fd = open(strPath, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	void * pMapping = mmap(nullptr, size_t(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (pMapping == MAP_FAILED)
+		return false;
+
+	*ppMappingOut = pMapping;
+	*pSizeOut = size_t(fileStat.st_size);
+	return true;
+#endif
+}
+
+static void UnmapFile(const void * pMapping, size_t size)
+{
+#if defined(_WIN32)
+	(void)size;
+	UnmapViewOfFile(pMapping);
+#else
+	munmap(const_cast<void *>(pMapping), size);
+#endif
+}
+
+
+
+// Cache keys.  The key is a 64-bit FNV-1a hash of everything that affects the LUT's texels:
+// which LUT it is, every field of its config, the SIMD kernels that generate it, the library
+// version and the cache file version.  The kernel sets round differently (FMA, and the order
+// their lanes are summed in), so a LUT can differ by an LSB between machines.
+
+// Bump this whenever the generated texels or the file layout change without a library version change
+static const unsigned int cLUTCacheFileVersion = 2;
+
+enum LUTCacheKind
+{
+	LUTCacheKind_Curvature,
+	LUTCacheKind_Shadow,
+};
+
+struct LUTCacheHasher
+{
+	unsigned long long	m_hash;
+
+	LUTCacheHasher() : m_hash(14695981039346656037ULL) {}
+
+	void AddBytes(const void * pData, size_t size)
+	{
+		const unsigned char * pBytes = static_cast<const unsigned char *>(pData);
+		for (size_t i = 0; i < size; ++i)
+		{
+			m_hash ^= pBytes[i];
+			m_hash *= 1099511628211ULL;
+		}
+	}
+
+	// Fields are hashed one at a time, so struct padding never gets in
+	void Add(int value)				{ AddBytes(&value, sizeof(value)); }
+	void Add(unsigned int value)	{ AddBytes(&value, sizeof(value)); }
+	void Add(float value)			{ AddBytes(&value, sizeof(value)); }
+	void Add(const char * str)		{ AddBytes(str, strlen(str) + 1); }
+};
+
+static void BeginLUTCacheKey(LUTCacheKind kind, LUTCacheHasher * pHasher)
+{
+	pHasher->Add(cLUTCacheFileVersion);
+	pHasher->Add(GFSDK_FaceWorks_GetBinaryVersion());
+	pHasher->Add(GetSimdKernels()->m_name);
+	pHasher->Add(int(kind));
+}
+
+static unsigned long long CalculateLUTCacheKey(const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig)
+{
+	LUTCacheHasher hasher;
+	BeginLUTCacheKey(LUTCacheKind_Curvature, &hasher);
+	hasher.Add(pConfig->m_diffusionRadius);
+	hasher.Add(pConfig->m_texWidth);
+	hasher.Add(pConfig->m_texHeight);
+	hasher.Add(pConfig->m_curvatureRadiusMin);
+	hasher.Add(pConfig->m_curvatureRadiusMax);
+	hasher.Add(int(pConfig->m_integrationMode));
+	hasher.Add(pConfig->m_integrationSampleCount);
+	hasher.Add(int(pConfig->m_format));
+	return hasher.m_hash;
+}
+
+static unsigned long long CalculateLUTCacheKey(const GFSDK_FaceWorks_ShadowLUTConfig * pConfig)
+{
+	LUTCacheHasher hasher;
+	BeginLUTCacheKey(LUTCacheKind_Shadow, &hasher);
+	hasher.Add(pConfig->m_diffusionRadius);
+	hasher.Add(pConfig->m_texWidth);
+	hasher.Add(pConfig->m_texHeight);
+	hasher.Add(pConfig->m_shadowWidthMin);
+	hasher.Add(pConfig->m_shadowWidthMax);
+	hasher.Add(pConfig->m_shadowSharpening);
+	hasher.Add(int(pConfig->m_integrationMode));
+	hasher.Add(pConfig->m_integrationSampleCount);
+	hasher.Add(int(pConfig->m_format));
+	return hasher.m_hash;
+}
+
+
+
+// Cache files: a fixed-size header, then the texels exactly as the Generate functions
+// store them.  The header is 64 bytes, so the texels are suitably aligned for uploading.
+
+struct LUTCacheFileHeader
+{
+	char				m_magic[8];
+	unsigned int		m_fileVersion;
+	unsigned int		m_kind;
+	unsigned long long	m_key;
+	int					m_texWidth, m_texHeight;
+	int					m_format;
+	unsigned int		m_reserved0;
+	unsigned long long	m_texelBytes;
+	unsigned char		m_reserved1[16];
+};
+static_assert(sizeof(LUTCacheFileHeader) == 64, "LUTCacheFileHeader should be 64 bytes");
+
+static const char cLUTCacheFileMagic[8] = { 'F', 'W', 'L', 'U', 'T', 'C', 'A', 'C' };
+
+static void SetupLUTCacheFileHeader(
+	LUTCacheKind kind,
+	unsigned long long key,
+	int texWidth,
+	int texHeight,
+	GFSDK_FaceWorks_LUTFormat format,
+	size_t texelBytes,
+	LUTCacheFileHeader * pHeader)
+{
+	memset(pHeader, 0, sizeof(*pHeader));
+	memcpy(pHeader->m_magic, cLUTCacheFileMagic, sizeof(cLUTCacheFileMagic));
+	pHeader->m_fileVersion = cLUTCacheFileVersion;
+	pHeader->m_kind = static_cast<unsigned int>(kind);
+	pHeader->m_key = key;
+	pHeader->m_texWidth = texWidth;
+	pHeader->m_texHeight = texHeight;
+	pHeader->m_format = int(format);
+	pHeader->m_texelBytes = texelBytes;
+}
+
+// Path of a LUT's file in the cache, and a temporary path to write it under
+static const int cLUTCachePathLengthMax = 1024;
+
+static bool BuildLUTCachePaths(
+	const char * strCacheDirectory,
+	LUTCacheKind kind,
+	unsigned long long key,
+	char (&strPathOut)[cLUTCachePathLengthMax],
+	char (&strTempPathOut)[cLUTCachePathLengthMax])
+{
+	static std::atomic<unsigned int> s_tempCounter(0);
+
+	size_t dirLength = strlen(strCacheDirectory);
+	const char * strSeparator = (dirLength > 0 &&
+								 strCacheDirectory[dirLength - 1] != '/' &&
+								 strCacheDirectory[dirLength - 1] != '\\') ? "/" : "";
+	const char * strKind = (kind == LUTCacheKind_Curvature) ? "curvature" : "shadow";
+
+	// Leave room for the longest file name
+	if (dirLength + 80 >= size_t(cLUTCachePathLengthMax))
+		return false;
+
+	_snprintf_s(strPathOut, cLUTCachePathLengthMax, _TRUNCATE, "%s%sfaceworks_%s_%016llx.lut",
+		strCacheDirectory, strSeparator, strKind, key);
+	_snprintf_s(strTempPathOut, cLUTCachePathLengthMax, _TRUNCATE, "%s.%08x.%08x.tmp",
+		strPathOut, GetProcessIdForTempName(), static_cast<unsigned int>(s_tempCounter.fetch_add(1)));
+	return true;
+}
+
+// Map a LUT's file, if it's in the cache and its header matches what's expected
+static bool MapLUTCacheFile(
+	const char * strPath,
+	const LUTCacheFileHeader & headerExpected,
+	GFSDK_FaceWorks_CachedLUT * pCachedLUTOut)
+{
+	const void * pMapping;
+	size_t mappingSize;
+	if (!MapFileReadOnly(strPath, &pMapping, &mappingSize))
+		return false;
+
+	if (mappingSize < sizeof(LUTCacheFileHeader) + headerExpected.m_texelBytes ||
+		memcmp(pMapping, &headerExpected, sizeof(LUTCacheFileHeader)) != 0)
+	{
+		UnmapFile(pMapping, mappingSize);
+		return false;
+	}
+
+	pCachedLUTOut->m_pTexels = static_cast<const unsigned char *>(pMapping) + sizeof(LUTCacheFileHeader);
+	pCachedLUTOut->m_sizeBytes = size_t(headerExpected.m_texelBytes);
+	pCachedLUTOut->m_pMapping = pMapping;
+	pCachedLUTOut->m_mappingSizeBytes = mappingSize;
+	return true;
+}
+
+// Row sink that appends the rows to a file
+struct LUTCacheFileWriter
+{
+	FILE *		m_pFile;
+	size_t		m_rowBytes;
+};
+
+static int WriteLUTCacheFileRows(void * pUserData, int /*iRowBegin*/, int rowCount, const void * pRows)
+{
+	LUTCacheFileWriter * pWriter = static_cast<LUTCacheFileWriter *>(pUserData);
+	size_t bytes = size_t(rowCount) * pWriter->m_rowBytes;
+	return fwrite(pRows, 1, bytes, pWriter->m_pFile) == bytes;
+}
+
+// Look up a LUT in the cache, generating and publishing it on a miss.  streamLUT(pRowSink)
+// streams the LUT's rows to a row sink.
+template <typename StreamLUTFn>
+static GFSDK_FaceWorks_Result MapCachedLUT(
+	LUTCacheKind kind,
+	unsigned long long key,
+	int texWidth,
+	int texHeight,
+	GFSDK_FaceWorks_LUTFormat format,
+	size_t texelBytes,
+	const char * strCacheDirectory,
+	GFSDK_FaceWorks_CachedLUT * pCachedLUTOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	const StreamLUTFn & streamLUT)
+{
+	char strPath[cLUTCachePathLengthMax];
+	char strTempPath[cLUTCachePathLengthMax];
+	if (!BuildLUTCachePaths(strCacheDirectory, kind, key, strPath, strTempPath))
+	{
+		ErrPrintf("strCacheDirectory is too long; should be under %d characters\n",
+			cLUTCachePathLengthMax - 80);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	LUTCacheFileHeader header;
+	SetupLUTCacheFileHeader(kind, key, texWidth, texHeight, format, texelBytes, &header);
+
+	// Hit: just map the file
+	if (MapLUTCacheFile(strPath, header, pCachedLUTOut))
+	{
+		pCachedLUTOut->m_wasGenerated = 0;
+		return GFSDK_FaceWorks_OK;
+	}
+
+	// Miss (or a stale or damaged file): generate the LUT into a temporary file, then rename
+	// it into place
+	FILE * pFile = OpenFileForWriting(strTempPath);
+	if (!pFile)
+	{
+		ErrPrintf("couldn't create %s\n", strTempPath);
+		return GFSDK_FaceWorks_FileError;
+	}
+
+	LUTCacheFileWriter writer = { pFile, texelBytes / size_t(texHeight) };
+	GFSDK_FaceWorks_LUTRowSink rowSink = { &WriteLUTCacheFileRows, &writer, 0 };
+	bool headerWritten = (fwrite(&header, sizeof(header), 1, pFile) == 1);
+	GFSDK_FaceWorks_Result res = headerWritten ? streamLUT(&rowSink) : GFSDK_FaceWorks_Aborted;
+	bool closed = (fclose(pFile) == 0);
+
+	if (res == GFSDK_FaceWorks_OK && !closed)
+		res = GFSDK_FaceWorks_Aborted;
+	if (res != GFSDK_FaceWorks_OK)
+	{
+		DeleteFileIfExists(strTempPath);
+		if (res == GFSDK_FaceWorks_Aborted)
+		{
+			ErrPrintf("couldn't write %s\n", strTempPath);
+			return GFSDK_FaceWorks_FileError;
+		}
+		return res;
+	}
+
+	// If the rename fails, another thread or process may have published the same LUT and
+	// still have it open; it's identical to ours, so use that one
+	if (!PublishFile(strTempPath, strPath))
+		DeleteFileIfExists(strTempPath);
+
+	if (!MapLUTCacheFile(strPath, header, pCachedLUTOut))
+	{
+		ErrPrintf("couldn't map %s\n", strPath);
+		return GFSDK_FaceWorks_FileError;
+	}
+
+	pCachedLUTOut->m_wasGenerated = 1;
+	return GFSDK_FaceWorks_OK;
+}
+
+static GFSDK_FaceWorks_Result ValidateLUTCacheArgs(
+	const void * pConfig,
+	const char * strCacheDirectory,
+	GFSDK_FaceWorks_CachedLUT * pCachedLUTOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut)
+{
+	if (!pConfig)
+	{
+		ErrPrintf("pConfig is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!strCacheDirectory)
+	{
+		ErrPrintf("strCacheDirectory is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!pCachedLUTOut)
+	{
+		ErrPrintf("pCachedLUTOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	return GFSDK_FaceWorks_OK;
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_MapCachedCurvatureLUT(
+	const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig,
+	const char * strCacheDirectory,
+	GFSDK_FaceWorks_CachedLUT * pCachedLUTOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	gfsdk_new_delete_t * pAllocator,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	// Validate parameters; the config itself is validated when the LUT is generated, and
+	// a config that fails validation is never in the cache
+	GFSDK_FaceWorks_Result res = ValidateLUTCacheArgs(pConfig, strCacheDirectory, pCachedLUTOut, pErrorBlobOut);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
+
+	memset(pCachedLUTOut, 0, sizeof(*pCachedLUTOut));
+
+	size_t texelBytes = GFSDK_FaceWorks_CalculateCurvatureLUTSizeBytes(pConfig);
+	if (texelBytes == 0 || pConfig->m_texHeight < 1)
+		return GFSDK_FaceWorks_GenerateCurvatureLUT(pConfig, nullptr, pErrorBlobOut, pAllocator, pParallelConfig);
+
+	return MapCachedLUT(
+			LUTCacheKind_Curvature, CalculateLUTCacheKey(pConfig),
+			pConfig->m_texWidth, pConfig->m_texHeight, pConfig->m_format, texelBytes,
+			strCacheDirectory, pCachedLUTOut, pErrorBlobOut,
+			[&](const GFSDK_FaceWorks_LUTRowSink * pRowSink)
+			{
+				return GFSDK_FaceWorks_StreamCurvatureLUT(pConfig, pRowSink, pErrorBlobOut, pAllocator, pParallelConfig);
+			});
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_MapCachedShadowLUT(
+	const GFSDK_FaceWorks_ShadowLUTConfig * pConfig,
+	const char * strCacheDirectory,
+	GFSDK_FaceWorks_CachedLUT * pCachedLUTOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	gfsdk_new_delete_t * pAllocator,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	// Validate parameters; the config itself is validated when the LUT is generated, and
+	// a config that fails validation is never in the cache
+	GFSDK_FaceWorks_Result res = ValidateLUTCacheArgs(pConfig, strCacheDirectory, pCachedLUTOut, pErrorBlobOut);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
+
+	memset(pCachedLUTOut, 0, sizeof(*pCachedLUTOut));
+
+	size_t texelBytes = GFSDK_FaceWorks_CalculateShadowLUTSizeBytes(pConfig);
+	if (texelBytes == 0 || pConfig->m_texHeight < 1)
+		return GFSDK_FaceWorks_GenerateShadowLUT(pConfig, nullptr, pErrorBlobOut, pAllocator, pParallelConfig);
+
+	return MapCachedLUT(
+			LUTCacheKind_Shadow, CalculateLUTCacheKey(pConfig),
+			pConfig->m_texWidth, pConfig->m_texHeight, pConfig->m_format, texelBytes,
+			strCacheDirectory, pCachedLUTOut, pErrorBlobOut,
+			[&](const GFSDK_FaceWorks_LUTRowSink * pRowSink)
+			{
+				return GFSDK_FaceWorks_StreamShadowLUT(pConfig, pRowSink, pErrorBlobOut, pAllocator, pParallelConfig);
+			});
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_UnmapCachedLUT(
+	GFSDK_FaceWorks_CachedLUT * pCachedLUT)
+{
+	if (!pCachedLUT)
+		return GFSDK_FaceWorks_InvalidArgument;
+
+	if (pCachedLUT->m_pMapping)
+		UnmapFile(pCachedLUT->m_pMapping, pCachedLUT->m_mappingSizeBytes);
+
+	memset(pCachedLUT, 0, sizeof(*pCachedLUT));
+	return GFSDK_FaceWorks_OK;
+}
@@ -0,0 +1,665 @@
+//----------------------------------------------------------------------------------
+// File:        FaceWorks/src/lutcompress.cpp
+// SDK Version: v1.0
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014-2016, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+
+#include "internal.h"
+
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+// Block compression of 8-bit LUTs.  The LUTs are smooth gradients, so each 4x4 block is close to
+// a line segment in RGB: both formats are encoded as two endpoints plus a palette of levels
+// between them (BC1's 4-color mode, and BC7 mode 6, which has 16 levels and 8-bit endpoints).
+// The endpoints start at the ends of the block's principal axis and are refined by least squares;
+// blocks still over the error target then get a local search over the quantized endpoints.
+
+static const int cBlockSize = 4;
+static const int cBlockTexelCount = cBlockSize * cBlockSize;
+static const int cLevelCountMax = 16;
+
+// Least-squares refinements of the endpoints, and sweeps of the local search over them
+static const int cRefineIterationCount = 3;
+static const int cLocalSearchSweepCountMax = 16;
+
+// A 4x4 block of the LUT, with 8-bit values as floats; blocks past the right or bottom edge of
+// the LUT are filled out with copies of the edge texels, which don't count toward the error
+struct LUTBlock
+{
+	float	m_rgb[cBlockTexelCount][3];
+	bool	m_isInside[cBlockTexelCount];
+};
+
+// Quantized endpoints and the level picked for each texel, with their squared error
+struct BlockEncoding
+{
+	int				m_q[2][3];
+	int				m_p[2];
+	unsigned char	m_levels[cBlockTexelCount];
+	float			m_sse;
+};
+
+// BC1 in 4-color mode: 5:6:5 endpoints, levels at 0, 1/3, 2/3 and 1
+struct BC1Traits
+{
+	static const int cLevelCount = 4;
+	static const bool cHasPBits = false;
+	static const int cBlockBytes = 8;
+
+	static int QuantMax(int iChannel)
+	{
+		return (iChannel == 1) ? 63 : 31;
+	}
+
+	static int Expand(int q, int /*p*/, int iChannel)
+	{
+		return (iChannel == 1) ? ((q << 2) | (q >> 4)) : ((q << 3) | (q >> 2));
+	}
+
+	static int Interpolate(int a, int b, int iLevel)
+	{
+		return ((3 - iLevel) * a + iLevel * b + 1) / 3;
+	}
+
+	static float LevelWeight(int iLevel)
+	{
+		return float(iLevel) / 3.0f;
+	}
+};
+
+// BC7 mode 6: 7-bit endpoints with a p-bit each, 16 levels with 6-bit weights
+static const int s_bc7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+struct BC7Mode6Traits
+{
+	static const int cLevelCount = 16;
+	static const bool cHasPBits = true;
+	static const int cBlockBytes = 16;
+
+	static int QuantMax(int /*iChannel*/)
+	{
+		return 127;
+	}
+
+	static int Expand(int q, int p, int /*iChannel*/)
+	{
+		return (q << 1) | p;
+	}
+
+	static int Interpolate(int a, int b, int iLevel)
+	{
+		return ((64 - s_bc7Weights4[iLevel]) * a + s_bc7Weights4[iLevel] * b + 32) >> 6;
+	}
+
+	static float LevelWeight(int iLevel)
+	{
+		return float(s_bc7Weights4[iLevel]) / 64.0f;
+	}
+};
+
+static void LoadLUTBlock(
+	const unsigned char * pTexels,
+	size_t texelBytes,
+	int texWidth,
+	int texHeight,
+	int iBlockX,
+	int iBlockY,
+	LUTBlock * pBlock)
+{
+	for (int i = 0; i < cBlockTexelCount; ++i)
+	{
+		int iX = iBlockX * cBlockSize + (i % cBlockSize);
+		int iY = iBlockY * cBlockSize + (i / cBlockSize);
+		pBlock->m_isInside[i] = (iX < texWidth && iY < texHeight);
+
+		const unsigned char * pTexel = pTexels +
+			(size_t(min(iY, texHeight - 1)) * size_t(texWidth) + size_t(min(iX, texWidth - 1))) * texelBytes;
+		for (int c = 0; c < 3; ++c)
+			pBlock->m_rgb[i][c] = float(pTexel[c]);
+	}
+}
+
+template <typename Traits>
+static void DecodePalette(const int q[2][3], const int p[2], int paletteOut[][3])
+{
+	for (int c = 0; c < 3; ++c)
+	{
+		int a = Traits::Expand(q[0][c], p[0], c);
+		int b = Traits::Expand(q[1][c], p[1], c);
+		for (int iLevel = 0; iLevel < Traits::cLevelCount; ++iLevel)
+			paletteOut[iLevel][c] = Traits::Interpolate(a, b, iLevel);
+	}
+}
+
+// Pick the nearest level for each texel; returns the squared error of the texels inside the LUT
+template <typename Traits>
+static float EvaluateEndpoints(const LUTBlock & block, BlockEncoding * pEncoding)
+{
+	int palette[cLevelCountMax][3];
+	DecodePalette<Traits>(pEncoding->m_q, pEncoding->m_p, palette);
+
+	float sse = 0.0f;
+	for (int i = 0; i < cBlockTexelCount; ++i)
+	{
+		float bestError = FLT_MAX;
+		int iBestLevel = 0;
+		for (int iLevel = 0; iLevel < Traits::cLevelCount; ++iLevel)
+		{
+			float error = 0.0f;
+			for (int c = 0; c < 3; ++c)
+			{
+				float d = float(palette[iLevel][c]) - block.m_rgb[i][c];
+				error += d * d;
+			}
+			if (error < bestError)
+			{
+				bestError = error;
+				iBestLevel = iLevel;
+			}
+		}
+
+		pEncoding->m_levels[i] = static_cast<unsigned char>(iBestLevel);
+		if (block.m_isInside[i])
+			sse += bestError;
+	}
+
+	pEncoding->m_sse = sse;
+	return sse;
+}
+
+template <typename Traits>
+static void QuantizeEndpoint(const float rgb[3], int qOut[3], int * pPOut)
+{
+	float bestError = FLT_MAX;
+	for (int p = 0; p < (Traits::cHasPBits ? 2 : 1); ++p)
+	{
+		int q[3];
+		float error = 0.0f;
+		for (int c = 0; c < 3; ++c)
+		{
+			int quantMax = Traits::QuantMax(c);
+			float scale = Traits::cHasPBits ? 0.5f : float(quantMax) / 255.0f;
+			q[c] = max(0, min(quantMax, int(floorf((rgb[c] - float(p)) * scale + 0.5f))));
+			float d = float(Traits::Expand(q[c], p, c)) - rgb[c];
+			error += d * d;
+		}
+
+		if (error < bestError)
+		{
+			bestError = error;
+			qOut[0] = q[0];
+			qOut[1] = q[1];
+			qOut[2] = q[2];
+			*pPOut = p;
+		}
+	}
+}
+
+// Solve for the float endpoints that best fit the texels at their levels; false if the texels
+// are all at one level, so the endpoints aren't determined
+template <typename Traits>
+static bool FitEndpoints(const LUTBlock & block, const unsigned char levels[cBlockTexelCount], float endsOut[2][3])
+{
+	float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+	float ax[3] = {}, bx[3] = {};
+	for (int i = 0; i < cBlockTexelCount; ++i)
+	{
+		if (!block.m_isInside[i])
+			continue;
+
+		float w = Traits::LevelWeight(levels[i]);
+		aa += (1.0f - w) * (1.0f - w);
+		ab += (1.0f - w) * w;
+		bb += w * w;
+		for (int c = 0; c < 3; ++c)
+		{
+			ax[c] += (1.0f - w) * block.m_rgb[i][c];
+			bx[c] += w * block.m_rgb[i][c];
+		}
+	}
+
+	float det = aa * bb - ab * ab;
+	if (fabsf(det) < 1e-6f)
+		return false;
+
+	for (int c = 0; c < 3; ++c)
+	{
+		endsOut[0][c] = max(0.0f, min(255.0f, (ax[c] * bb - bx[c] * ab) / det));
+		endsOut[1][c] = max(0.0f, min(255.0f, (bx[c] * aa - ax[c] * ab) / det));
+	}
+	return true;
+}
+
+// Initial endpoints: the extent of the texels along their principal axis
+static void FindPrincipalEndpoints(const LUTBlock & block, float endsOut[2][3])
+{
+	float mean[3] = {};
+	int count = 0;
+	for (int i = 0; i < cBlockTexelCount; ++i)
+	{
+		if (!block.m_isInside[i])
+			continue;
+		for (int c = 0; c < 3; ++c)
+			mean[c] += block.m_rgb[i][c];
+		++count;
+	}
+	for (int c = 0; c < 3; ++c)
+		mean[c] /= float(count);
+
+	float cov[3][3] = {};
+	for (int i = 0; i < cBlockTexelCount; ++i)
+	{
+		if (!block.m_isInside[i])
+			continue;
+		for (int c0 = 0; c0 < 3; ++c0)
+			for (int c1 = 0; c1 < 3; ++c1)
+				cov[c0][c1] += (block.m_rgb[i][c0] - mean[c0]) * (block.m_rgb[i][c1] - mean[c1]);
+	}
+
+	// Power iteration; the LUTs' gradients are close to lines, so it converges quickly
+	float axis[3] = { 1.0f, 1.0f, 1.0f };
+	for (int iIter = 0; iIter < 8; ++iIter)
+	{
+		float next[3];
+		for (int c = 0; c < 3; ++c)
+			next[c] = cov[c][0] * axis[0] + cov[c][1] * axis[1] + cov[c][2] * axis[2];
+
+		float len = sqrtf(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+		if (len < 1e-6f)
+			break;
+		for (int c = 0; c < 3; ++c)
+			axis[c] = next[c] / len;
+	}
+
+	float tMin = 0.0f, tMax = 0.0f;
+	for (int i = 0; i < cBlockTexelCount; ++i)
+	{
+		if (!block.m_isInside[i])
+			continue;
+		float t = 0.0f;
+		for (int c = 0; c < 3; ++c)
+			t += (block.m_rgb[i][c] - mean[c]) * axis[c];
+		tMin = min(tMin, t);
+		tMax = max(tMax, t);
+	}
+
+	for (int c = 0; c < 3; ++c)
+	{
+		endsOut[0][c] = max(0.0f, min(255.0f, mean[c] + tMin * axis[c]));
+		endsOut[1][c] = max(0.0f, min(255.0f, mean[c] + tMax * axis[c]));
+	}
+}
+
+template <typename Traits>
+static void EncodeBlock(const LUTBlock & block, float sseTarget, BlockEncoding * pBestOut)
+{
+	BlockEncoding & best = *pBestOut;
+	best.m_sse = FLT_MAX;
+
+	float ends[2][3];
+	FindPrincipalEndpoints(block, ends);
+
+	for (int iIter = 0; iIter < cRefineIterationCount; ++iIter)
+	{
+		BlockEncoding encoding;
+		QuantizeEndpoint<Traits>(ends[0], encoding.m_q[0], &encoding.m_p[0]);
+		QuantizeEndpoint<Traits>(ends[1], encoding.m_q[1], &encoding.m_p[1]);
+		if (EvaluateEndpoints<Traits>(block, &encoding) < best.m_sse)
+			best = encoding;
+
+		if (best.m_sse <= sseTarget || !FitEndpoints<Traits>(block, encoding.m_levels, ends))
+			break;
+	}
+
+	// Nudge the quantized endpoints one step at a time while it helps, until the block meets the target
+	for (int iSweep = 0; iSweep < cLocalSearchSweepCountMax && best.m_sse > sseTarget; ++iSweep)
+	{
+		bool improved = false;
+		for (int iEnd = 0; iEnd < 2; ++iEnd)
+		{
+			for (int c = 0; c < 3; ++c)
+			{
+				for (int delta = -1; delta <= 1; delta += 2)
+				{
+					BlockEncoding trial = best;
+					trial.m_q[iEnd][c] += delta;
+					if (trial.m_q[iEnd][c] < 0 || trial.m_q[iEnd][c] > Traits::QuantMax(c))
+						continue;
+					if (EvaluateEndpoints<Traits>(block, &trial) < best.m_sse)
+					{
+						best = trial;
+						improved = true;
+					}
+				}
+			}
+
+			if (Traits::cHasPBits)
+			{
+				BlockEncoding trial = best;
+				trial.m_p[iEnd] ^= 1;
+				if (EvaluateEndpoints<Traits>(block, &trial) < best.m_sse)
+				{
+					best = trial;
+					improved = true;
+				}
+			}
+		}
+
+		if (!improved)
+			break;
+	}
+}
+
+// Squared error and max channel error of the decoded block against the texels inside the LUT
+template <typename Traits>
+static void MeasureBlockError(const LUTBlock & block, const BlockEncoding & encoding, double * pSSEOut, float * pMaxErrorOut)
+{
+	int palette[cLevelCountMax][3];
+	DecodePalette<Traits>(encoding.m_q, encoding.m_p, palette);
+
+	double sse = 0.0;
+	float maxError = 0.0f;
+	for (int i = 0; i < cBlockTexelCount; ++i)
+	{
+		if (!block.m_isInside[i])
+			continue;
+		for (int c = 0; c < 3; ++c)
+		{
+			float d = fabsf(float(palette[encoding.m_levels[i]][c]) - block.m_rgb[i][c]);
+			sse += double(d) * double(d);
+			maxError = max(maxError, d);
+		}
+	}
+
+	*pSSEOut = sse;
+	*pMaxErrorOut = maxError;
+}
+
+static void PackBC1Block(const BlockEncoding & encoding, unsigned char * pBlockOut)
+{
+	unsigned int colors[2];
+	for (int iEnd = 0; iEnd < 2; ++iEnd)
+		colors[iEnd] = (encoding.m_q[iEnd][0] << 11) | (encoding.m_q[iEnd][1] << 5) | encoding.m_q[iEnd][2];
+
+	// 4-color mode needs color0 > color1; swapping the endpoints reverses the levels.  If they're
+	// equal, all the levels decode to the same color, which index 0 gives in either mode.
+	static const unsigned int s_levelToIndex[4] = { 0, 2, 3, 1 };
+	bool swap = (colors[0] < colors[1]);
+	unsigned int indices = 0;
+	for (int i = 0; i < cBlockTexelCount; ++i)
+	{
+		int iLevel = swap ? 3 - encoding.m_levels[i] : encoding.m_levels[i];
+		unsigned int index = (colors[0] == colors[1]) ? 0 : s_levelToIndex[iLevel];
+		indices |= index << (2 * i);
+	}
+	if (swap)
+		std::swap(colors[0], colors[1]);
+
+	pBlockOut[0] = static_cast<unsigned char>(colors[0]);
+	pBlockOut[1] = static_cast<unsigned char>(colors[0] >> 8);
+	pBlockOut[2] = static_cast<unsigned char>(colors[1]);
+	pBlockOut[3] = static_cast<unsigned char>(colors[1] >> 8);
+	for (int i = 0; i < 4; ++i)
+		pBlockOut[4 + i] = static_cast<unsigned char>(indices >> (8 * i));
+}
+
+// Writes bit fields into a block from the least significant bit up, as BC7 lays them out
+struct BlockBitWriter
+{
+	unsigned char *	m_pBlock;
+	int				m_iBit;
+
+	void Write(unsigned int value, int bitCount)
+	{
+		for (int i = 0; i < bitCount; ++i, ++m_iBit)
+		{
+			if (value & (1u << i))
+				m_pBlock[m_iBit >> 3] |= static_cast<unsigned char>(1u << (m_iBit & 7));
+		}
+	}
+};
+
+static void PackBC7Mode6Block(const BlockEncoding & encoding, unsigned char * pBlockOut)
+{
+	// Texel 0's index is stored without its high bit, so swap the endpoints if it's set
+	bool swap = (encoding.m_levels[0] >= 8);
+	int iEnd0 = swap ? 1 : 0;
+	int iEnd1 = swap ? 0 : 1;
+
+	for (int i = 0; i < BC7Mode6Traits::cBlockBytes; ++i)
+		pBlockOut[i] = 0;
+	BlockBitWriter writer = { pBlockOut, 0 };
+
+	writer.Write(1u << 6, 7);
+	for (int c = 0; c < 3; ++c)
+	{
+		writer.Write(encoding.m_q[iEnd0][c], 7);
+		writer.Write(encoding.m_q[iEnd1][c], 7);
+	}
+
+	// The LUTs don't use alpha; it decodes as 254 or 255, with the endpoints' p-bits
+	writer.Write(127, 7);
+	writer.Write(127, 7);
+	writer.Write(encoding.m_p[iEnd0], 1);
+	writer.Write(encoding.m_p[iEnd1], 1);
+
+	for (int i = 0; i < cBlockTexelCount; ++i)
+	{
+		unsigned int index = swap ? 15 - encoding.m_levels[i] : encoding.m_levels[i];
+		writer.Write(index, (i == 0) ? 3 : 4);
+	}
+}
+
+template <typename Traits, typename PackFn>
+static GFSDK_FaceWorks_Result CompressLUTBlocks(
+	const unsigned char * pTexels,
+	size_t texelBytes,
+	int texWidth,
+	int texHeight,
+	float errorTarget,
+	const PackFn & packBlock,
+	unsigned char * pBlocksOut,
+	GFSDK_FaceWorks_LUTCompressionStats * pStatsOut,
+	gfsdk_new_delete_t * pAllocator,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	int blockCountX = (texWidth + cBlockSize - 1) / cBlockSize;
+	int blockCountY = (texHeight + cBlockSize - 1) / cBlockSize;
+
+	// Errors are gathered per row of blocks and summed afterward, so they don't depend on the threading
+	FaceWorks_Allocator<double> allocDouble(pAllocator);
+	FaceWorks_Allocator<float> allocFloat(pAllocator);
+	FaceWorks_Allocator<int> allocInt(pAllocator);
+	std::vector<double, FaceWorks_Allocator<double>> rowSSE(allocDouble);
+	std::vector<float, FaceWorks_Allocator<float>> rowMaxError(allocFloat);
+	std::vector<int, FaceWorks_Allocator<int>> rowBlocksOverTarget(allocInt);
+	try
+	{
+		rowSSE.resize(blockCountY);
+		rowMaxError.resize(blockCountY);
+		rowBlocksOverTarget.resize(blockCountY);
+	}
+	catch (std::bad_alloc)
+	{
+		return GFSDK_FaceWorks_OutOfMemory;
+	}
+
+	ParallelForRanges(pParallelConfig, blockCountY, [&](int iBegin, int iEnd)
+	{
+		for (int iBlockY = iBegin; iBlockY < iEnd; ++iBlockY)
+		{
+			double sse = 0.0;
+			float maxError = 0.0f;
+			int blocksOverTarget = 0;
+
+			for (int iBlockX = 0; iBlockX < blockCountX; ++iBlockX)
+			{
+				LUTBlock block;
+				LoadLUTBlock(pTexels, texelBytes, texWidth, texHeight, iBlockX, iBlockY, &block);
+
+				// The target is an RMS error per channel, over the texels inside the LUT
+				int insideCount = 0;
+				for (int i = 0; i < cBlockTexelCount; ++i)
+					insideCount += block.m_isInside[i] ? 1 : 0;
+				float sseTarget = errorTarget * errorTarget * float(3 * insideCount);
+
+				BlockEncoding encoding;
+				EncodeBlock<Traits>(block, sseTarget, &encoding);
+				packBlock(encoding, pBlocksOut + (size_t(iBlockY) * size_t(blockCountX) + size_t(iBlockX)) * Traits::cBlockBytes);
+
+				double blockSSE;
+				float blockMaxError;
+				MeasureBlockError<Traits>(block, encoding, &blockSSE, &blockMaxError);
+				sse += blockSSE;
+				maxError = max(maxError, blockMaxError);
+				if (encoding.m_sse > sseTarget)
+					++blocksOverTarget;
+			}
+
+			rowSSE[iBlockY] = sse;
+			rowMaxError[iBlockY] = maxError;
+			rowBlocksOverTarget[iBlockY] = blocksOverTarget;
+		}
+	}, pAllocator);
+
+	if (pStatsOut)
+	{
+		double sse = 0.0;
+		float maxError = 0.0f;
+		int blocksOverTarget = 0;
+		for (int iBlockY = 0; iBlockY < blockCountY; ++iBlockY)
+		{
+			sse += rowSSE[iBlockY];
+			maxError = max(maxError, rowMaxError[iBlockY]);
+			blocksOverTarget += rowBlocksOverTarget[iBlockY];
+		}
+
+		double mse = sse / (3.0 * double(texWidth) * double(texHeight));
+		pStatsOut->m_psnr = (mse > 0.0) ? float(10.0 * log10(255.0 * 255.0 / mse)) : FLT_MAX;
+		pStatsOut->m_rmsError = float(sqrt(mse));
+		pStatsOut->m_maxError = maxError;
+		pStatsOut->m_blocksOverTarget = blocksOverTarget;
+	}
+
+	return GFSDK_FaceWorks_OK;
+}
+
+static size_t CalculateCompressedBlockBytes(GFSDK_FaceWorks_LUTCompression compression)
+{
+	switch (compression)
+	{
+	case GFSDK_FaceWorks_LUTCompression_BC1:	return BC1Traits::cBlockBytes;
+	case GFSDK_FaceWorks_LUTCompression_BC7:	return BC7Mode6Traits::cBlockBytes;
+	default:									return 0;
+	}
+}
+
+GFSDK_FACEWORKS_API size_t GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateCompressedLUTSizeBytes(
+	int texWidth,
+	int texHeight,
+	GFSDK_FaceWorks_LUTCompression compression)
+{
+	if (texWidth < 1 || texHeight < 1)
+		return 0;
+
+	return CalculateCompressedBlockBytes(compression) *
+			size_t((texWidth + cBlockSize - 1) / cBlockSize) *
+			size_t((texHeight + cBlockSize - 1) / cBlockSize);
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CompressLUT(
+	const void * pLUTTexels,
+	int texWidth,
+	int texHeight,
+	GFSDK_FaceWorks_LUTFormat format,
+	GFSDK_FaceWorks_LUTCompression compression,
+	float errorTarget,
+	void * pBlocksOut,
+	GFSDK_FaceWorks_LUTCompressionStats * pStatsOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	gfsdk_new_delete_t * pAllocator,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	// Validate parameters
+	if (!pLUTTexels)
+	{
+		ErrPrintf("pLUTTexels is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (texWidth < 1)
+	{
+		ErrPrintf("texWidth is %d; should be at least 1\n", texWidth);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (texHeight < 1)
+	{
+		ErrPrintf("texHeight is %d; should be at least 1\n", texHeight);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (format != GFSDK_FaceWorks_LUTFormat_RGBA8 && format != GFSDK_FaceWorks_LUTFormat_RGB8)
+	{
+		ErrPrintf("format is %d; only RGBA8 and RGB8 LUTs can be compressed\n", int(format));
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (CalculateCompressedBlockBytes(compression) == 0)
+	{
+		ErrPrintf("compression is %d; should be BC1 or BC7\n", int(compression));
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!(errorTarget >= 0.0f))
+	{
+		ErrPrintf("errorTarget is %g; should be at least 0\n", errorTarget);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!pBlocksOut)
+	{
+		ErrPrintf("pBlocksOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	const unsigned char * pTexels = static_cast<const unsigned char *>(pLUTTexels);
+	size_t texelBytes = GFSDK_FaceWorks_CalculateLUTTexelSizeBytes(format);
+	unsigned char * pBlocks = static_cast<unsigned char *>(pBlocksOut);
+
+	if (compression == GFSDK_FaceWorks_LUTCompression_BC1)
+	{
+		return CompressLUTBlocks<BC1Traits>(pTexels, texelBytes, texWidth, texHeight, errorTarget,
+					&PackBC1Block, pBlocks, pStatsOut, pAllocator, pParallelConfig);
+	}
+	else
+	{
+		return CompressLUTBlocks<BC7Mode6Traits>(pTexels, texelBytes, texWidth, texHeight, errorTarget,
+					&PackBC7Mode6Block, pBlocks, pStatsOut, pAllocator, pParallelConfig);
+	}
+}
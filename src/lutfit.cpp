@@ -0,0 +1,535 @@
+//----------------------------------------------------------------------------------
+// File:        FaceWorks/src/lutfit.cpp
+// SDK Version: v1.0
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014-2016, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+#include "internal.h"
+
+#include <vector>
+
+// ALU-only approximations of the LUTs.  Each LUT is fitted by a piecewise bicubic, C0-continuous
+// across the cell edges, by least squares at its texel centers.  In each axis the basis is the
+// cubic polynomials plus the truncated powers (x - b)^n for x > b, n = 1..3, at each cell edge b.
+// The texels are on a grid and the basis is a tensor product, so the least-squares problem
+// separates into a small solve along each axis.  The result is then re-expanded as a polynomial
+// in (u - center) and (v - center) for each cell, which is what the shaders evaluate.
+//
+// GFSDK_FaceWorks_LUTFitCBData layout:
+//	data[0]		u cell edges 0..3
+//	data[1]		(u cell edge 4, v cell edge, v cell center 0, v cell center 1)
+//	data[2]		u cell centers 0..3
+//	data[3]		(u cell centers 4, 5, 0, 0)
+//	data[4 + ((iV * cFitCellCountU + iU) * 3 + channel) * 4 + n]
+//				coefficients of (u - center)^n; xyzw multiply (v - center)^0..3
+
+static const int cFitCellCountU = 6;
+static const int cFitCellCountV = 2;
+static const int cFitHeaderSize = 4;
+static const int cFitCoeffCount = 4;		// Per axis, for a cubic
+
+// Basis functions along each axis: the cubics, plus 3 truncated powers per interior cell edge
+static const int cFitBasisSizeU = cFitCoeffCount + (cFitCellCountU - 1) * (cFitCoeffCount - 1);
+static const int cFitBasisSizeV = cFitCoeffCount + (cFitCellCountV - 1) * (cFitCoeffCount - 1);
+
+static_assert(cFitHeaderSize + cFitCellCountU * cFitCellCountV * 3 * cFitCoeffCount == GFSDK_FaceWorks_LUTFitCBDataSize,
+			"GFSDK_FaceWorks_LUTFitCBDataSize doesn't match the fit layout");
+
+// Cell edges of a fit, in LUT texture coordinates
+struct LUTFitCells
+{
+	float	m_edgesU[cFitCellCountU - 1];
+	float	m_edgeV;
+};
+
+typedef std::vector<double, FaceWorks_Allocator<double>> DoubleVector;
+
+inline gfsdk_float4 MakeFloat4(float x, float y, float z, float w)
+{
+	gfsdk_float4 result = { x, y, z, w };
+	return result;
+}
+
+// Number of basis functions along an axis with edgeCount interior cell edges
+inline int FitBasisSize(int edgeCount)
+{
+	return cFitCoeffCount + edgeCount * (cFitCoeffCount - 1);
+}
+
+// Evaluate the basis functions along an axis at x
+static void EvaluateFitBasis(double x, const float * pEdges, int edgeCount, double * pBasisOut)
+{
+	double power = 1.0;
+	for (int n = 0; n < cFitCoeffCount; ++n, power *= (x - 0.5))
+		*(pBasisOut++) = power;
+
+	for (int iEdge = 0; iEdge < edgeCount; ++iEdge)
+	{
+		double d = max(0.0, x - double(pEdges[iEdge]));
+		for (int n = 1; n < cFitCoeffCount; ++n)
+			*(pBasisOut++) = pow(d, n);
+	}
+}
+
+// Cholesky factorization of a symmetric positive definite n x n matrix, in place (lower triangle).
+// A tiny ridge keeps it positive definite when some basis functions have almost no support.
+static void FactorCholesky(double * pA, int n)
+{
+	double trace = 0.0;
+	for (int i = 0; i < n; ++i)
+		trace += pA[i * n + i];
+	double ridge = 1e-12 * trace / double(n);
+
+	for (int j = 0; j < n; ++j)
+	{
+		double diag = pA[j * n + j] + ridge;
+		for (int k = 0; k < j; ++k)
+			diag -= pA[j * n + k] * pA[j * n + k];
+		diag = sqrt(max(diag, 1e-300));
+		pA[j * n + j] = diag;
+
+		for (int i = j + 1; i < n; ++i)
+		{
+			double sum = pA[i * n + j];
+			for (int k = 0; k < j; ++k)
+				sum -= pA[i * n + k] * pA[j * n + k];
+			pA[i * n + j] = sum / diag;
+		}
+	}
+}
+
+// Solve A x = b in place, given the Cholesky factor of A; b is strided by stride doubles
+static void SolveCholesky(const double * pL, int n, double * pB, int stride)
+{
+	for (int i = 0; i < n; ++i)
+	{
+		double sum = pB[i * stride];
+		for (int k = 0; k < i; ++k)
+			sum -= pL[i * n + k] * pB[k * stride];
+		pB[i * stride] = sum / pL[i * n + i];
+	}
+
+	for (int i = n - 1; i >= 0; --i)
+	{
+		double sum = pB[i * stride];
+		for (int k = i + 1; k < n; ++k)
+			sum -= pL[k * n + i] * pB[k * stride];
+		pB[i * stride] = sum / pL[i * n + i];
+	}
+}
+
+// Set up the basis along an axis sampled at sampleCount texel centers: the samples' basis values
+// (sampleCount x basisSize) and the Cholesky factor of their Gram matrix (basisSize x basisSize)
+static void SetupFitAxis(
+	int sampleCount,
+	const float * pEdges,
+	int edgeCount,
+	double * pBasisOut,
+	double * pGramFactorOut)
+{
+	int basisSize = FitBasisSize(edgeCount);
+
+	for (int i = 0; i < sampleCount; ++i)
+		EvaluateFitBasis((double(i) + 0.5) / double(sampleCount), pEdges, edgeCount, &pBasisOut[i * basisSize]);
+
+	for (int j = 0; j < basisSize; ++j)
+	{
+		for (int k = 0; k <= j; ++k)
+		{
+			double sum = 0.0;
+			for (int i = 0; i < sampleCount; ++i)
+				sum += pBasisOut[i * basisSize + j] * pBasisOut[i * basisSize + k];
+			pGramFactorOut[j * basisSize + k] = sum;
+			pGramFactorOut[k * basisSize + j] = sum;
+		}
+	}
+
+	FactorCholesky(pGramFactorOut, basisSize);
+}
+
+// Matrix that re-expands the basis functions along an axis as polynomials in (x - center) over
+// one cell (cFitCoeffCount x basisSize), and the cell's center
+static void SetupFitCellExpansion(
+	const float * pEdges,
+	int edgeCount,
+	int iCell,
+	double * pExpansionOut,
+	float * pCenterOut)
+{
+	int basisSize = FitBasisSize(edgeCount);
+	float lower = (iCell > 0) ? pEdges[iCell - 1] : 0.0f;
+	float upper = (iCell < edgeCount) ? pEdges[iCell] : 1.0f;
+	float center = 0.5f * (lower + upper);
+	*pCenterOut = center;
+
+	for (int i = 0; i < cFitCoeffCount * basisSize; ++i)
+		pExpansionOut[i] = 0.0;
+
+	// (x - origin)^n = (t + d)^n with t = x - center and d = center - origin; binomial expansion
+	static const double binomial[cFitCoeffCount][cFitCoeffCount] =
+	{
+		{ 1, 0, 0, 0 },
+		{ 1, 1, 0, 0 },
+		{ 1, 2, 1, 0 },
+		{ 1, 3, 3, 1 },
+	};
+	auto expand = [&](int iBasis, int n, double d)
+	{
+		for (int m = 0; m <= n; ++m)
+			pExpansionOut[m * basisSize + iBasis] = binomial[n][m] * pow(d, n - m);
+	};
+
+	for (int n = 0; n < cFitCoeffCount; ++n)
+		expand(n, n, double(center) - 0.5);
+
+	// The truncated powers are only nonzero in the cells above their edge
+	for (int iEdge = 0; iEdge < edgeCount && iEdge < iCell; ++iEdge)
+	{
+		for (int n = 1; n < cFitCoeffCount; ++n)
+			expand(FitBasisSize(iEdge) + n - 1, n, double(center) - double(pEdges[iEdge]));
+	}
+}
+
+static void EvaluateLUTFit(const GFSDK_FaceWorks_LUTFitCBData & fit, float u, float v, float rgbOut[3])
+{
+	const gfsdk_float4 * pData = fit.data;
+	u = min(max(u, 0.0f), 1.0f);
+	v = min(max(v, 0.0f), 1.0f);
+
+	// Find the cell
+	int iU = int(u >= pData[0].x) + int(u >= pData[0].y) + int(u >= pData[0].z) + int(u >= pData[0].w) + int(u >= pData[1].x);
+	int iV = int(v >= pData[1].y);
+	const float centersU[cFitCellCountU] = { pData[2].x, pData[2].y, pData[2].z, pData[2].w, pData[3].x, pData[3].y };
+	float t = u - centersU[iU];
+	float s = v - (iV ? pData[1].w : pData[1].z);
+	float powersV[4] = { 1.0f, s, s * s, s * s * s };
+
+	const gfsdk_float4 * pCoeffs = &pData[cFitHeaderSize + (iV * cFitCellCountU + iU) * 3 * cFitCoeffCount];
+	for (int iChannel = 0; iChannel < 3; ++iChannel, pCoeffs += cFitCoeffCount)
+	{
+		float coeffsU[cFitCoeffCount];
+		for (int n = 0; n < cFitCoeffCount; ++n)
+		{
+			coeffsU[n] = pCoeffs[n].x * powersV[0] + pCoeffs[n].y * powersV[1] +
+						 pCoeffs[n].z * powersV[2] + pCoeffs[n].w * powersV[3];
+		}
+		rgbOut[iChannel] = ((coeffsU[3] * t + coeffsU[2]) * t + coeffsU[1]) * t + coeffsU[0];
+	}
+}
+
+// Fit a LUT given as float RGB texels, and measure the fit's error at the texel centers
+static GFSDK_FaceWorks_Result FitLUT(
+	const float * pRGB,
+	int texWidth,
+	int texHeight,
+	const LUTFitCells & cells,
+	GFSDK_FaceWorks_LUTFitCBData * pFitOut,
+	GFSDK_FaceWorks_LUTErrorEstimate * pFitErrorOut,
+	gfsdk_new_delete_t * pAllocator)
+{
+	static const int cEdgeCountU = cFitCellCountU - 1;
+	static const int cEdgeCountV = cFitCellCountV - 1;
+	const int basisSizeU = cFitBasisSizeU;
+	const int basisSizeV = cFitBasisSizeV;
+	const float * pEdgesU = cells.m_edgesU;
+	const float * pEdgesV = &cells.m_edgeV;
+
+	FaceWorks_Allocator<double> allocDouble(pAllocator);
+	DoubleVector basisU(allocDouble), gramU(allocDouble), basisV(allocDouble), gramV(allocDouble);
+	DoubleVector rowCoeffs(allocDouble), coeffs(allocDouble);
+
+	try
+	{
+		basisU.resize(size_t(texWidth) * basisSizeU);
+		gramU.resize(basisSizeU * basisSizeU);
+		basisV.resize(size_t(texHeight) * basisSizeV);
+		gramV.resize(basisSizeV * basisSizeV);
+		rowCoeffs.resize(size_t(texHeight) * basisSizeU);
+		coeffs.resize(basisSizeV * basisSizeU);
+	}
+	catch (std::bad_alloc)
+	{
+		return GFSDK_FaceWorks_OutOfMemory;
+	}
+
+	SetupFitAxis(texWidth, pEdgesU, cEdgeCountU, &basisU[0], &gramU[0]);
+	SetupFitAxis(texHeight, pEdgesV, cEdgeCountV, &basisV[0], &gramV[0]);
+
+	// Per-cell re-expansion matrices
+	double expansionU[cFitCellCountU][cFitCoeffCount * cFitBasisSizeU];
+	double expansionV[cFitCellCountV][cFitCoeffCount * cFitBasisSizeV];
+	float centersU[cFitCellCountU], centersV[cFitCellCountV];
+	for (int iU = 0; iU < cFitCellCountU; ++iU)
+		SetupFitCellExpansion(pEdgesU, cEdgeCountU, iU, expansionU[iU], &centersU[iU]);
+	for (int iV = 0; iV < cFitCellCountV; ++iV)
+		SetupFitCellExpansion(pEdgesV, cEdgeCountV, iV, expansionV[iV], &centersV[iV]);
+
+	// Header
+	gfsdk_float4 * pData = pFitOut->data;
+	pData[0] = MakeFloat4(pEdgesU[0], pEdgesU[1], pEdgesU[2], pEdgesU[3]);
+	pData[1] = MakeFloat4(pEdgesU[4], pEdgesV[0], centersV[0], centersV[1]);
+	pData[2] = MakeFloat4(centersU[0], centersU[1], centersU[2], centersU[3]);
+	pData[3] = MakeFloat4(centersU[4], centersU[5], 0.0f, 0.0f);
+
+	for (int iChannel = 0; iChannel < 3; ++iChannel)
+	{
+		// Least squares along u for each row: solve (Bu^T Bu) c = Bu^T y
+		for (int iY = 0; iY < texHeight; ++iY)
+		{
+			const float * pRow = &pRGB[3 * size_t(iY) * texWidth + iChannel];
+			double * pRowCoeffs = &rowCoeffs[size_t(iY) * basisSizeU];
+			for (int j = 0; j < basisSizeU; ++j)
+			{
+				double sum = 0.0;
+				for (int iX = 0; iX < texWidth; ++iX)
+					sum += basisU[size_t(iX) * basisSizeU + j] * double(pRow[3 * iX]);
+				pRowCoeffs[j] = sum;
+			}
+			SolveCholesky(&gramU[0], basisSizeU, pRowCoeffs, 1);
+		}
+
+		// ...then along v for each of the row coefficients
+		for (int j = 0; j < basisSizeU; ++j)
+		{
+			for (int k = 0; k < basisSizeV; ++k)
+			{
+				double sum = 0.0;
+				for (int iY = 0; iY < texHeight; ++iY)
+					sum += basisV[size_t(iY) * basisSizeV + k] * rowCoeffs[size_t(iY) * basisSizeU + j];
+				coeffs[k * basisSizeU + j] = sum;
+			}
+			SolveCholesky(&gramV[0], basisSizeV, &coeffs[j], basisSizeU);
+		}
+
+		// Re-expand in each cell: expansionV * coeffs * expansionU^T
+		for (int iV = 0; iV < cFitCellCountV; ++iV)
+		{
+			for (int iU = 0; iU < cFitCellCountU; ++iU)
+			{
+				gfsdk_float4 * pCoeffs = &pData[cFitHeaderSize + ((iV * cFitCellCountU + iU) * 3 + iChannel) * cFitCoeffCount];
+				for (int n = 0; n < cFitCoeffCount; ++n)
+				{
+					float coeffsV[cFitCoeffCount];
+					for (int m = 0; m < cFitCoeffCount; ++m)
+					{
+						double sum = 0.0;
+						for (int k = 0; k < basisSizeV; ++k)
+						{
+							double weightV = expansionV[iV][m * basisSizeV + k];
+							if (weightV == 0.0)
+								continue;
+							for (int j = 0; j < basisSizeU; ++j)
+								sum += weightV * coeffs[k * basisSizeU + j] * expansionU[iU][n * basisSizeU + j];
+						}
+						coeffsV[m] = float(sum);
+					}
+					pCoeffs[n] = MakeFloat4(coeffsV[0], coeffsV[1], coeffsV[2], coeffsV[3]);
+				}
+			}
+		}
+	}
+
+	if (pFitErrorOut)
+	{
+		float maxError = 0.0f;
+		double sumSqError = 0.0;
+		for (int iY = 0; iY < texHeight; ++iY)
+		{
+			float v = (float(iY) + 0.5f) / float(texHeight);
+			for (int iX = 0; iX < texWidth; ++iX)
+			{
+				float rgb[3];
+				EvaluateLUTFit(*pFitOut, (float(iX) + 0.5f) / float(texWidth), v, rgb);
+				const float * pRGBReference = &pRGB[3 * (size_t(iY) * texWidth + iX)];
+				for (int i = 0; i < 3; ++i)
+				{
+					float error = fabsf(rgb[i] - pRGBReference[i]);
+					maxError = max(maxError, error);
+					sumSqError += double(error) * double(error);
+				}
+			}
+		}
+		pFitErrorOut->m_maxError = maxError;
+		pFitErrorOut->m_rmsError = float(sqrt(sumSqError / (3.0 * double(texWidth) * double(texHeight))));
+	}
+
+	return GFSDK_FaceWorks_OK;
+}
+
+// Generate a LUT's float texels with generate() and fit them
+template <typename Config, typename GenerateFn>
+static GFSDK_FaceWorks_Result GenerateAndFitLUT(
+	const Config * pConfig,
+	const GenerateFn & generate,
+	const LUTFitCells & cells,
+	GFSDK_FaceWorks_LUTFitCBData * pFitOut,
+	GFSDK_FaceWorks_LUTErrorEstimate * pFitErrorOut,
+	gfsdk_new_delete_t * pAllocator)
+{
+	FaceWorks_Allocator<float> allocFloat(pAllocator);
+	std::vector<float, FaceWorks_Allocator<float>> rgb(allocFloat);
+	try
+	{
+		rgb.resize(3 * size_t(pConfig->m_texWidth) * size_t(pConfig->m_texHeight));
+	}
+	catch (std::bad_alloc)
+	{
+		return GFSDK_FaceWorks_OutOfMemory;
+	}
+
+	GFSDK_FaceWorks_Result res = generate(&rgb[0]);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
+
+	return FitLUT(&rgb[0], pConfig->m_texWidth, pConfig->m_texHeight, cells, pFitOut, pFitErrorOut, pAllocator);
+}
+
+
+
+// Cell placement.  These were tuned on LUTs over the usual ranges of parameters.
+
+// Curvature LUT: the terminator (u = 0.5) has a kink in the flatter rows, and the
+// LUT is nearly flat at both ends of N.L; the flattest quarter of the rows gets its own cells.
+static const float cCurvatureFitEdgesU[cFitCellCountU - 1] = { 0.35f, 0.45f, 0.5f, 0.55f, 0.65f };
+static const float cCurvatureFitEdgeV = 0.25f;
+
+// Shadow LUT: the sharpened shadow is a smoothstep over shadow = 0.5 +- 0.5 / sharpening, roughly;
+// cells end near its ends and at its middle, with one more on each side to take up the tails
+// of the scattering.
+static const float cShadowFitEdgeSharpeningScale = 0.7f;
+static const float cShadowFitEdgeWidthMax = 0.3f;
+static const float cShadowFitTailFraction = 0.15f;
+static const float cShadowFitEdgeV = 0.25f;
+
+static void SetupShadowFitCells(const GFSDK_FaceWorks_ShadowLUTConfig * pConfig, LUTFitCells * pCells)
+{
+	float edgeWidth = min(0.5f / (cShadowFitEdgeSharpeningScale * pConfig->m_shadowSharpening), cShadowFitEdgeWidthMax);
+	float tailWidth = edgeWidth + cShadowFitTailFraction * (0.5f - edgeWidth);
+	pCells->m_edgesU[0] = 0.5f - tailWidth;
+	pCells->m_edgesU[1] = 0.5f - edgeWidth;
+	pCells->m_edgesU[2] = 0.5f;
+	pCells->m_edgesU[3] = 0.5f + edgeWidth;
+	pCells->m_edgesU[4] = 0.5f + tailWidth;
+	pCells->m_edgeV = cShadowFitEdgeV;
+}
+
+
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_FitCurvatureLUT(
+	const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig,
+	GFSDK_FaceWorks_LUTFitCBData * pFitOut,
+	GFSDK_FaceWorks_LUTErrorEstimate * pFitErrorOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	gfsdk_new_delete_t * pAllocator,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	// Validate parameters (the config is validated when the LUT is generated)
+	if (!pConfig)
+	{
+		ErrPrintf("pConfig is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	if (!pFitOut)
+	{
+		ErrPrintf("pFitOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	LUTFitCells cells;
+	for (int i = 0; i < cFitCellCountU - 1; ++i)
+		cells.m_edgesU[i] = cCurvatureFitEdgesU[i];
+	cells.m_edgeV = cCurvatureFitEdgeV;
+
+	return GenerateAndFitLUT(pConfig,
+		[&](float * pRGBOut)
+		{
+			return GenerateCurvatureLUTFloat(pConfig, 0, pConfig->m_texHeight, pRGBOut, pErrorBlobOut, pAllocator, pParallelConfig);
+		},
+		cells, pFitOut, pFitErrorOut, pAllocator);
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_FitShadowLUT(
+	const GFSDK_FaceWorks_ShadowLUTConfig * pConfig,
+	GFSDK_FaceWorks_LUTFitCBData * pFitOut,
+	GFSDK_FaceWorks_LUTErrorEstimate * pFitErrorOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	gfsdk_new_delete_t * pAllocator,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	// Validate parameters (the config is validated when the LUT is generated)
+	if (!pConfig)
+	{
+		ErrPrintf("pConfig is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	if (!pFitOut)
+	{
+		ErrPrintf("pFitOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	LUTFitCells cells;
+	SetupShadowFitCells(pConfig, &cells);
+
+	return GenerateAndFitLUT(pConfig,
+		[&](float * pRGBOut)
+		{
+			return GenerateShadowLUTFloat(pConfig, 0, pConfig->m_texHeight, pRGBOut, pErrorBlobOut, pAllocator, pParallelConfig);
+		},
+		cells, pFitOut, pFitErrorOut, pAllocator);
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_EvaluateLUTFit(
+	const GFSDK_FaceWorks_LUTFitCBData * pFit,
+	float u,
+	float v,
+	float rgbOut[3],
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut)
+{
+	// Validate parameters
+	if (!pFit)
+	{
+		ErrPrintf("pFit is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	if (!rgbOut)
+	{
+		ErrPrintf("rgbOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	EvaluateLUTFit(*pFit, u, v, rgbOut);
+
+	return GFSDK_FaceWorks_OK;
+}
@@ -0,0 +1,474 @@
+//----------------------------------------------------------------------------------
+// File:        FaceWorks/src/lutprogressive.cpp
+// SDK Version: v1.0
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014-2016, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+
+#include "internal.h"
+
+#include <atomic>
+#include <new>
+#include <vector>
+
+// Progressive LUTs, for interactive tuning: the LUT is evaluated at 32x32 (or smaller, for small
+// LUTs) and upsampled into the caller's buffer straight away, then re-evaluated in passes that
+// double the resolution, each upsampled over the buffer a whole row at a time once it's done.
+// The last pass evaluates the LUT at full size and writes its rows as they're evaluated, so the
+// finished LUT is exactly what the Generate functions produce.  The buffer always holds a
+// complete LUT: each row is either from the previous pass or the current one.
+
+static const int cProgressiveLUTCoarseSize = 32;
+
+typedef std::vector<float, FaceWorks_Allocator<float>> FloatVector;
+
+struct GFSDK_FaceWorks_ProgressiveLUT
+{
+	gfsdk_new_delete_t					m_allocator;
+	bool								m_isShadowLUT;
+	GFSDK_FaceWorks_CurvatureLUTConfig	m_curvatureConfig;
+	GFSDK_FaceWorks_ShadowLUTConfig		m_shadowConfig;
+	GFSDK_FaceWorks_LUTFormat			m_format;
+	int									m_texWidth;
+	int									m_texHeight;
+	unsigned char *						m_pLUTOut;
+	size_t								m_rowBytes;
+
+	int									m_passCount;
+	int									m_iPass;
+	int									m_passWidth;
+	int									m_passHeight;
+	int									m_rowsEvaluated;	// Rows of the current pass evaluated so far
+	int									m_rowsWritten;		// Rows of the LUT written from the current pass
+	FloatVector							m_passTexels;		// Float RGB texels of the current pass
+
+	explicit GFSDK_FaceWorks_ProgressiveLUT(const gfsdk_new_delete_t & allocator)
+	:	m_allocator(allocator),
+		m_passTexels(FaceWorks_Allocator<float>(&m_allocator))
+	{
+	}
+};
+
+static int CalculatePassSize(int texSize, int iPass)
+{
+	return (texSize >> iPass) > cProgressiveLUTCoarseSize ? cProgressiveLUTCoarseSize << iPass : texSize;
+}
+
+static void StartPass(GFSDK_FaceWorks_ProgressiveLUT * pLUT, int iPass)
+{
+	pLUT->m_iPass = iPass;
+	pLUT->m_passWidth = CalculatePassSize(pLUT->m_texWidth, iPass);
+	pLUT->m_passHeight = CalculatePassSize(pLUT->m_texHeight, iPass);
+	pLUT->m_rowsEvaluated = 0;
+	pLUT->m_rowsWritten = 0;
+}
+
+static bool IsProgressiveLUTComplete(const GFSDK_FaceWorks_ProgressiveLUT * pLUT)
+{
+	return pLUT->m_iPass >= pLUT->m_passCount;
+}
+
+// Evaluate rows [iYBegin, iYEnd) of the current pass into m_passTexels
+static GFSDK_FaceWorks_Result EvaluatePassRows(
+	GFSDK_FaceWorks_ProgressiveLUT * pLUT,
+	int iYBegin,
+	int iYEnd,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	float * pRGBOut = &pLUT->m_passTexels[3 * size_t(iYBegin) * size_t(pLUT->m_passWidth)];
+
+	if (pLUT->m_isShadowLUT)
+	{
+		GFSDK_FaceWorks_ShadowLUTConfig config = pLUT->m_shadowConfig;
+		config.m_texWidth = pLUT->m_passWidth;
+		config.m_texHeight = pLUT->m_passHeight;
+		return GenerateShadowLUTFloat(&config, iYBegin, iYEnd, pRGBOut, pErrorBlobOut, &pLUT->m_allocator, pParallelConfig);
+	}
+	else
+	{
+		GFSDK_FaceWorks_CurvatureLUTConfig config = pLUT->m_curvatureConfig;
+		config.m_texWidth = pLUT->m_passWidth;
+		config.m_texHeight = pLUT->m_passHeight;
+		GFSDK_FaceWorks_Result res = GenerateCurvatureLUTFloat(&config, iYBegin, iYEnd, pRGBOut, pErrorBlobOut, &pLUT->m_allocator, pParallelConfig);
+		if (res != GFSDK_FaceWorks_OK)
+			return res;
+
+		// Store the format's encoding, which is affine, so upsampling it is the same as encoding the upsampled texels
+		EncodeCurvatureLUTValues(pLUT->m_format, pRGBOut, size_t(iYEnd - iYBegin) * size_t(pLUT->m_passWidth));
+		return GFSDK_FaceWorks_OK;
+	}
+}
+
+// Write rows [iYBegin, iYEnd) of the LUT from the current pass, bilinearly upsampling it if it's
+// smaller than the LUT
+static GFSDK_FaceWorks_Result WritePassRows(
+	GFSDK_FaceWorks_ProgressiveLUT * pLUT,
+	int iYBegin,
+	int iYEnd,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	int texWidth = pLUT->m_texWidth;
+	int passWidth = pLUT->m_passWidth;
+	int passHeight = pLUT->m_passHeight;
+	const float * pPassTexels = &pLUT->m_passTexels[0];
+
+	if (passWidth == texWidth && passHeight == pLUT->m_texHeight)
+	{
+		ParallelForRanges(pParallelConfig, iYEnd - iYBegin, [&](int iBegin, int iEnd)
+		{
+			for (int iY = iYBegin + iBegin; iY < iYBegin + iEnd; ++iY)
+			{
+				EncodeLUTTexels(pLUT->m_format, pLUT->m_isShadowLUT,
+					pPassTexels + 3 * size_t(iY) * size_t(texWidth), texWidth,
+					pLUT->m_pLUTOut + iY * pLUT->m_rowBytes);
+			}
+		}, &pLUT->m_allocator);
+
+		return GFSDK_FaceWorks_OK;
+	}
+
+	// Texel centers map to pass texel coordinates (i + 0.5) * passSize / texSize - 0.5
+	float scaleX = float(passWidth) / float(texWidth);
+	float scaleY = float(passHeight) / float(pLUT->m_texHeight);
+	std::atomic<bool> outOfMemory(false);
+
+	ParallelForRanges(pParallelConfig, iYEnd - iYBegin, [&](int iBegin, int iEnd)
+	{
+		// Exceptions mustn't escape into the worker threads
+		try
+		{
+			FloatVector rowWork(3 * size_t(texWidth), 0.0f, FaceWorks_Allocator<float>(&pLUT->m_allocator));
+
+			for (int iY = iYBegin + iBegin; iY < iYBegin + iEnd; ++iY)
+			{
+				float y = max(0.0f, min(float(passHeight - 1), (float(iY) + 0.5f) * scaleY - 0.5f));
+				int iY0 = int(y);
+				int iY1 = min(iY0 + 1, passHeight - 1);
+				float ty = y - float(iY0);
+				const float * pRow0 = pPassTexels + 3 * size_t(iY0) * size_t(passWidth);
+				const float * pRow1 = pPassTexels + 3 * size_t(iY1) * size_t(passWidth);
+
+				float * pRGB = &rowWork[0];
+				for (int iX = 0; iX < texWidth; ++iX, pRGB += 3)
+				{
+					float x = max(0.0f, min(float(passWidth - 1), (float(iX) + 0.5f) * scaleX - 0.5f));
+					int iX0 = int(x);
+					int iX1 = min(iX0 + 1, passWidth - 1);
+					float tx = x - float(iX0);
+
+					for (int i = 0; i < 3; ++i)
+					{
+						float top = pRow0[3 * iX0 + i] + tx * (pRow0[3 * iX1 + i] - pRow0[3 * iX0 + i]);
+						float bottom = pRow1[3 * iX0 + i] + tx * (pRow1[3 * iX1 + i] - pRow1[3 * iX0 + i]);
+						pRGB[i] = top + ty * (bottom - top);
+					}
+				}
+
+				EncodeLUTTexels(pLUT->m_format, pLUT->m_isShadowLUT, &rowWork[0], texWidth,
+					pLUT->m_pLUTOut + iY * pLUT->m_rowBytes);
+			}
+		}
+		catch (std::bad_alloc)
+		{
+			outOfMemory = true;
+		}
+	}, &pLUT->m_allocator);
+
+	return outOfMemory ? GFSDK_FaceWorks_OutOfMemory : GFSDK_FaceWorks_OK;
+}
+
+// Run the current pass for about texelBudget texels of work, moving on to the next pass when it's done
+static GFSDK_FaceWorks_Result StepProgressiveLUT(
+	GFSDK_FaceWorks_ProgressiveLUT * pLUT,
+	int texelBudget,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	while (texelBudget > 0 && !IsProgressiveLUTComplete(pLUT))
+	{
+		bool isFullSize = (pLUT->m_passWidth == pLUT->m_texWidth && pLUT->m_passHeight == pLUT->m_texHeight);
+
+		if (pLUT->m_rowsEvaluated < pLUT->m_passHeight)
+		{
+			// At least one row per step, so every step makes progress
+			int rowCount = max(1, min(texelBudget / pLUT->m_passWidth, pLUT->m_passHeight - pLUT->m_rowsEvaluated));
+			int iYBegin = pLUT->m_rowsEvaluated;
+			GFSDK_FaceWorks_Result res = EvaluatePassRows(pLUT, iYBegin, iYBegin + rowCount, pErrorBlobOut, pParallelConfig);
+			if (res != GFSDK_FaceWorks_OK)
+				return res;
+
+			pLUT->m_rowsEvaluated += rowCount;
+			texelBudget -= rowCount * pLUT->m_passWidth;
+
+			// Full-size rows are final, so they can go straight into the LUT
+			if (isFullSize)
+			{
+				res = WritePassRows(pLUT, iYBegin, iYBegin + rowCount, pParallelConfig);
+				if (res != GFSDK_FaceWorks_OK)
+					return res;
+
+				pLUT->m_rowsWritten += rowCount;
+			}
+		}
+		else
+		{
+			// Upsampled rows need all of the pass, so they're written once it's evaluated
+			int rowCount = max(1, min(texelBudget / pLUT->m_texWidth, pLUT->m_texHeight - pLUT->m_rowsWritten));
+			int iYBegin = pLUT->m_rowsWritten;
+			GFSDK_FaceWorks_Result res = WritePassRows(pLUT, iYBegin, iYBegin + rowCount, pParallelConfig);
+			if (res != GFSDK_FaceWorks_OK)
+				return res;
+
+			pLUT->m_rowsWritten += rowCount;
+			texelBudget -= rowCount * pLUT->m_texWidth;
+		}
+
+		if (pLUT->m_rowsWritten == pLUT->m_texHeight)
+			StartPass(pLUT, pLUT->m_iPass + 1);
+	}
+
+	return GFSDK_FaceWorks_OK;
+}
+
+// Fraction of the refinement work done, counting each pass's evaluated and written texels
+static float CalculateProgress(const GFSDK_FaceWorks_ProgressiveLUT * pLUT)
+{
+	if (IsProgressiveLUTComplete(pLUT))
+		return 1.0f;
+
+	double lutTexels = double(pLUT->m_texWidth) * double(pLUT->m_texHeight);
+	double total = 0.0, done = 0.0;
+	for (int iPass = 1; iPass < pLUT->m_passCount; ++iPass)
+	{
+		double passTexels = double(CalculatePassSize(pLUT->m_texWidth, iPass)) *
+							double(CalculatePassSize(pLUT->m_texHeight, iPass));
+		bool isFullSize = (iPass == pLUT->m_passCount - 1);
+		double passWork = isFullSize ? passTexels : passTexels + lutTexels;
+		total += passWork;
+
+		if (iPass < pLUT->m_iPass)
+			done += passWork;
+		else if (iPass == pLUT->m_iPass)
+		{
+			done += double(pLUT->m_rowsEvaluated) * double(pLUT->m_passWidth);
+			if (!isFullSize)
+				done += double(pLUT->m_rowsWritten) * double(pLUT->m_texWidth);
+		}
+	}
+
+	// Never report 1 until the LUT is complete
+	return total > 0.0 ? min(0.999f, float(done / total)) : 0.0f;
+}
+
+static GFSDK_FaceWorks_Result BeginProgressiveLUT(
+	GFSDK_FaceWorks_ProgressiveLUT * pLUTTemplate,
+	void * pLUTOut,
+	GFSDK_FaceWorks_ProgressiveLUT ** ppProgressiveLUTOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	const gfsdk_new_delete_t & allocator = pLUTTemplate->m_allocator;
+
+	void * pMemory = nullptr;
+	try
+	{
+		pMemory = FaceWorks_Malloc(sizeof(GFSDK_FaceWorks_ProgressiveLUT), allocator);
+	}
+	catch (std::bad_alloc)
+	{
+		return GFSDK_FaceWorks_OutOfMemory;
+	}
+	if (!pMemory)
+		return GFSDK_FaceWorks_OutOfMemory;
+
+	GFSDK_FaceWorks_ProgressiveLUT * pLUT = new (pMemory) GFSDK_FaceWorks_ProgressiveLUT(allocator);
+	pLUT->m_isShadowLUT = pLUTTemplate->m_isShadowLUT;
+	pLUT->m_curvatureConfig = pLUTTemplate->m_curvatureConfig;
+	pLUT->m_shadowConfig = pLUTTemplate->m_shadowConfig;
+	pLUT->m_format = pLUTTemplate->m_format;
+	pLUT->m_texWidth = pLUTTemplate->m_texWidth;
+	pLUT->m_texHeight = pLUTTemplate->m_texHeight;
+	pLUT->m_pLUTOut = static_cast<unsigned char *>(pLUTOut);
+	pLUT->m_rowBytes = GFSDK_FaceWorks_CalculateLUTTexelSizeBytes(pLUT->m_format) * size_t(pLUT->m_texWidth);
+
+	pLUT->m_passCount = 1;
+	while (CalculatePassSize(pLUT->m_texWidth, pLUT->m_passCount - 1) < pLUT->m_texWidth ||
+		   CalculatePassSize(pLUT->m_texHeight, pLUT->m_passCount - 1) < pLUT->m_texHeight)
+	{
+		++pLUT->m_passCount;
+	}
+
+	// The full-size pass is the biggest, so this is all the space the passes need
+	try
+	{
+		pLUT->m_passTexels.resize(3 * size_t(pLUT->m_texWidth) * size_t(pLUT->m_texHeight));
+	}
+	catch (std::bad_alloc)
+	{
+		GFSDK_FaceWorks_ReleaseProgressiveLUT(pLUT);
+		return GFSDK_FaceWorks_OutOfMemory;
+	}
+
+	// Run the coarse pass right away, so the buffer holds a complete LUT on return
+	StartPass(pLUT, 0);
+	int coarseWork = pLUT->m_passWidth * pLUT->m_passHeight + pLUT->m_texWidth * pLUT->m_texHeight;
+	GFSDK_FaceWorks_Result res = StepProgressiveLUT(pLUT, coarseWork, pErrorBlobOut, pParallelConfig);
+	if (res != GFSDK_FaceWorks_OK)
+	{
+		GFSDK_FaceWorks_ReleaseProgressiveLUT(pLUT);
+		return res;
+	}
+
+	*ppProgressiveLUTOut = pLUT;
+	return GFSDK_FaceWorks_OK;
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_BeginProgressiveCurvatureLUT(
+	const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig,
+	void * pCurvatureLUTOut,
+	GFSDK_FaceWorks_ProgressiveLUT ** ppProgressiveLUTOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	gfsdk_new_delete_t * pAllocator,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	// Validate parameters
+	GFSDK_FaceWorks_Result res = ValidateCurvatureLUTConfig(pConfig, pErrorBlobOut);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
+
+	if (!pCurvatureLUTOut)
+	{
+		ErrPrintf("pCurvatureLUTOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!ppProgressiveLUTOut)
+	{
+		ErrPrintf("ppProgressiveLUTOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	gfsdk_new_delete_t allocator = {};
+	if (pAllocator)
+		allocator = *pAllocator;
+
+	GFSDK_FaceWorks_ProgressiveLUT lutTemplate(allocator);
+	lutTemplate.m_isShadowLUT = false;
+	lutTemplate.m_curvatureConfig = *pConfig;
+	lutTemplate.m_shadowConfig = GFSDK_FaceWorks_ShadowLUTConfig();
+	lutTemplate.m_format = pConfig->m_format;
+	lutTemplate.m_texWidth = pConfig->m_texWidth;
+	lutTemplate.m_texHeight = pConfig->m_texHeight;
+
+	return BeginProgressiveLUT(&lutTemplate, pCurvatureLUTOut, ppProgressiveLUTOut, pErrorBlobOut, pParallelConfig);
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_BeginProgressiveShadowLUT(
+	const GFSDK_FaceWorks_ShadowLUTConfig * pConfig,
+	void * pShadowLUTOut,
+	GFSDK_FaceWorks_ProgressiveLUT ** ppProgressiveLUTOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	gfsdk_new_delete_t * pAllocator,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	// Validate parameters
+	GFSDK_FaceWorks_Result res = ValidateShadowLUTConfig(pConfig, pErrorBlobOut);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
+
+	if (!pShadowLUTOut)
+	{
+		ErrPrintf("pShadowLUTOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!ppProgressiveLUTOut)
+	{
+		ErrPrintf("ppProgressiveLUTOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	gfsdk_new_delete_t allocator = {};
+	if (pAllocator)
+		allocator = *pAllocator;
+
+	GFSDK_FaceWorks_ProgressiveLUT lutTemplate(allocator);
+	lutTemplate.m_isShadowLUT = true;
+	lutTemplate.m_curvatureConfig = GFSDK_FaceWorks_CurvatureLUTConfig();
+	lutTemplate.m_shadowConfig = *pConfig;
+	lutTemplate.m_format = pConfig->m_format;
+	lutTemplate.m_texWidth = pConfig->m_texWidth;
+	lutTemplate.m_texHeight = pConfig->m_texHeight;
+
+	return BeginProgressiveLUT(&lutTemplate, pShadowLUTOut, ppProgressiveLUTOut, pErrorBlobOut, pParallelConfig);
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_StepProgressiveLUT(
+	GFSDK_FaceWorks_ProgressiveLUT * pProgressiveLUT,
+	int texelBudget,
+	float * pProgressOut,
+	int * pIsCompleteOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	// Validate parameters
+	if (!pProgressiveLUT)
+	{
+		ErrPrintf("pProgressiveLUT is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (texelBudget < 1)
+	{
+		ErrPrintf("texelBudget is %d; should be at least 1\n", texelBudget);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	GFSDK_FaceWorks_Result res = StepProgressiveLUT(pProgressiveLUT, texelBudget, pErrorBlobOut, pParallelConfig);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
+
+	if (pProgressOut)
+		*pProgressOut = CalculateProgress(pProgressiveLUT);
+	if (pIsCompleteOut)
+		*pIsCompleteOut = IsProgressiveLUTComplete(pProgressiveLUT) ? 1 : 0;
+
+	return GFSDK_FaceWorks_OK;
+}
+
+GFSDK_FACEWORKS_API void GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_ReleaseProgressiveLUT(
+	GFSDK_FaceWorks_ProgressiveLUT * pProgressiveLUT)
+{
+	if (!pProgressiveLUT)
+		return;
+
+	gfsdk_new_delete_t allocator = pProgressiveLUT->m_allocator;
+	pProgressiveLUT->~GFSDK_FaceWorks_ProgressiveLUT();
+	FaceWorks_Free(pProgressiveLUT, allocator);
+}
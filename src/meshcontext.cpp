@@ -0,0 +1,1465 @@
+//----------------------------------------------------------------------------------
+// File:        FaceWorks/src/meshcontext.cpp
+// SDK Version: v1.0
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014-2016, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+#include "internal.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <vector>
+
+// Mesh contexts: the topology the mesh functions would otherwise derive from the index buffer on
+// every call (the unique edges, each vertex's neighbors and the welded-position map) is built once
+// and kept, along with the per-triangle data that only depends on the rest positions.  Meshes
+// that share a topology, such as the blendshapes of a face, then only pay for it once.
+//
+// Welding maps each vertex to the lowest-numbered vertex at the same position, so vertices split
+// along UV seams or hard edges can be treated as one.  If the context is welded, its edges and
+// neighbor lists join the welded vertices instead of the original ones, and the curvature of
+// each welded vertex is written to all the vertices it stands for.
+
+typedef std::vector<int, FaceWorks_Allocator<int>> IntVector;
+typedef std::vector<float, FaceWorks_Allocator<float>> FloatVector;
+
+struct GFSDK_FaceWorks_MeshContext
+{
+	gfsdk_new_delete_t	m_allocator;
+	int					m_vertexCount;
+	int					m_triCount;
+	bool				m_isWelded;
+	int					m_weldedVertexCount;
+	IntVector			m_indices;			// Three per triangle, as given
+	IntVector			m_weldedVerts;		// Per vertex: the lowest-numbered vertex at the same position
+	MeshEdges			m_edges;			// Of the welded vertices, if the context is welded
+	MeshAdjacency		m_adjacency;		// Likewise
+	FloatVector			m_triDiametersSq;	// Per triangle: squared diameter at the rest positions
+
+	explicit GFSDK_FaceWorks_MeshContext(const gfsdk_new_delete_t & allocator)
+	:	m_allocator(allocator),
+		m_vertexCount(0),
+		m_triCount(0),
+		m_isWelded(false),
+		m_weldedVertexCount(0),
+		m_indices(FaceWorks_Allocator<int>(&m_allocator)),
+		m_weldedVerts(FaceWorks_Allocator<int>(&m_allocator)),
+		m_edges(&m_allocator),
+		m_adjacency(&m_allocator),
+		m_triDiametersSq(FaceWorks_Allocator<float>(&m_allocator))
+	{
+	}
+};
+
+// Map each vertex to the lowest-numbered vertex with the same position, comparing the positions'
+// bits, with -0 taken as 0.  Returns the number of distinct positions; may throw std::bad_alloc.
+static int WeldPositions(
+	int vertexCount,
+	const void * pPositions,
+	int positionStrideBytes,
+	IntVector * pWeldedVertsOut,
+	gfsdk_new_delete_t * pAllocator)
+{
+	struct PositionKey
+	{
+		unsigned int	m_bits[3];
+		int				m_iVert;
+
+		bool SamePosition(const PositionKey & other) const
+		{
+			return m_bits[0] == other.m_bits[0] && m_bits[1] == other.m_bits[1] && m_bits[2] == other.m_bits[2];
+		}
+
+		bool operator < (const PositionKey & other) const
+		{
+			for (int j = 0; j < 3; ++j)
+			{
+				if (m_bits[j] != other.m_bits[j])
+					return m_bits[j] < other.m_bits[j];
+			}
+			return m_iVert < other.m_iVert;
+		}
+	};
+
+	FaceWorks_Allocator<PositionKey> allocKey(pAllocator);
+	std::vector<PositionKey, FaceWorks_Allocator<PositionKey>> keys(allocKey);
+	keys.resize(vertexCount);
+	for (int i = 0; i < vertexCount; ++i)
+	{
+		const float * pPos = reinterpret_cast<const float *>((const char *)pPositions + i * positionStrideBytes);
+		for (int j = 0; j < 3; ++j)
+		{
+			float coord = (pPos[j] == 0.0f) ? 0.0f : pPos[j];
+			memcpy(&keys[i].m_bits[j], &coord, sizeof(coord));
+		}
+		keys[i].m_iVert = i;
+	}
+
+	// Sorting puts the vertices at each position together, lowest-numbered first
+	std::sort(keys.begin(), keys.end());
+
+	pWeldedVertsOut->resize(vertexCount);
+	int weldedVertexCount = 0;
+	for (int i = 0; i < vertexCount; )
+	{
+		int iRunEnd = i + 1;
+		while (iRunEnd < vertexCount && keys[iRunEnd].SamePosition(keys[i]))
+			++iRunEnd;
+		for (int iKey = i; iKey < iRunEnd; ++iKey)
+			(*pWeldedVertsOut)[keys[iKey].m_iVert] = keys[i].m_iVert;
+		++weldedVertexCount;
+		i = iRunEnd;
+	}
+
+	return weldedVertexCount;
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CreateMeshContext(
+	int vertexCount,
+	const void * pPositions,
+	int positionStrideBytes,
+	int indexCount,
+	const int * pIndices,
+	int weldPositions,
+	GFSDK_FaceWorks_MeshContext ** ppContextOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	gfsdk_new_delete_t * pAllocator)
+{
+	// Validate parameters
+	if (vertexCount < 1)
+	{
+		ErrPrintf("vertexCount is %d; should be at least 1\n", vertexCount);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!pPositions)
+	{
+		ErrPrintf("pPositions is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (positionStrideBytes < 3 * int(sizeof(float)))
+	{
+		ErrPrintf("positionStrideBytes is %d; should be at least %d\n",
+			positionStrideBytes, 3 * sizeof(float));
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (indexCount < 3)
+	{
+		ErrPrintf("indexCount is %d; should be at least 3\n", indexCount);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (indexCount % 3 != 0)
+	{
+		ErrPrintf("indexCount is %d; should be a multiple of 3\n", indexCount);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!pIndices)
+	{
+		ErrPrintf("pIndices is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	for (int i = 0; i < indexCount; ++i)
+	{
+		if (pIndices[i] < 0 || pIndices[i] >= vertexCount)
+		{
+			ErrPrintf("pIndices[%d] is %d; should be in [0, %d)\n", i, pIndices[i], vertexCount);
+			return GFSDK_FaceWorks_InvalidArgument;
+		}
+	}
+	if (!ppContextOut)
+	{
+		ErrPrintf("ppContextOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	gfsdk_new_delete_t allocator = {};
+	if (pAllocator)
+		allocator = *pAllocator;
+
+	void * pMemory = nullptr;
+	try
+	{
+		pMemory = FaceWorks_Malloc(sizeof(GFSDK_FaceWorks_MeshContext), allocator);
+	}
+	catch (std::bad_alloc)
+	{
+		return GFSDK_FaceWorks_OutOfMemory;
+	}
+	if (!pMemory)
+		return GFSDK_FaceWorks_OutOfMemory;
+
+	GFSDK_FaceWorks_MeshContext * pContext = new (pMemory) GFSDK_FaceWorks_MeshContext(allocator);
+	pContext->m_vertexCount = vertexCount;
+	pContext->m_triCount = indexCount / 3;
+	pContext->m_isWelded = (weldPositions != 0);
+
+	// Catch out-of-memory exceptions
+	try
+	{
+		pContext->m_indices.assign(pIndices, pIndices + indexCount);
+		pContext->m_weldedVertexCount = WeldPositions(
+											vertexCount, pPositions, positionStrideBytes,
+											&pContext->m_weldedVerts, &pContext->m_allocator);
+
+		if (pContext->m_isWelded)
+		{
+			FaceWorks_Allocator<int> allocInt(&pContext->m_allocator);
+			IntVector weldedIndices(allocInt);
+			weldedIndices.resize(indexCount);
+			for (int i = 0; i < indexCount; ++i)
+				weldedIndices[i] = pContext->m_weldedVerts[pIndices[i]];
+			BuildMeshEdges(vertexCount, pContext->m_triCount, &weldedIndices[0], &pContext->m_edges, &pContext->m_allocator);
+		}
+		else
+		{
+			BuildMeshEdges(vertexCount, pContext->m_triCount, pIndices, &pContext->m_edges, &pContext->m_allocator);
+		}
+		BuildMeshAdjacency(vertexCount, pContext->m_edges, &pContext->m_adjacency);
+
+		pContext->m_triDiametersSq.resize(pContext->m_triCount);
+		GetSimdKernels()->m_pfnCalculateTriangleDiametersSq(
+							pPositions, positionStrideBytes,
+							pIndices, pContext->m_triCount,
+							&pContext->m_triDiametersSq[0]);
+	}
+	catch (std::bad_alloc)
+	{
+		GFSDK_FaceWorks_ReleaseMeshContext(pContext);
+		return GFSDK_FaceWorks_OutOfMemory;
+	}
+
+	*ppContextOut = pContext;
+	return GFSDK_FaceWorks_OK;
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GetMeshContextInfo(
+	const GFSDK_FaceWorks_MeshContext * pContext,
+	GFSDK_FaceWorks_MeshContextInfo * pInfoOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut)
+{
+	// Validate parameters
+	if (!pContext)
+	{
+		ErrPrintf("pContext is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!pInfoOut)
+	{
+		ErrPrintf("pInfoOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	pInfoOut->m_vertexCount = pContext->m_vertexCount;
+	pInfoOut->m_triCount = pContext->m_triCount;
+	pInfoOut->m_edgeCount = pContext->m_edges.EdgeCount();
+	pInfoOut->m_boundaryEdgeCount = pContext->m_edges.m_boundaryEdgeCount;
+	pInfoOut->m_weldedVertexCount = pContext->m_weldedVertexCount;
+	pInfoOut->m_isWelded = pContext->m_isWelded ? 1 : 0;
+	pInfoOut->m_sizeBytes =
+		sizeof(GFSDK_FaceWorks_MeshContext) +
+		pContext->m_indices.capacity() * sizeof(int) +
+		pContext->m_weldedVerts.capacity() * sizeof(int) +
+		pContext->m_edges.m_verts.capacity() * sizeof(int) +
+		pContext->m_edges.m_triCounts.capacity() * sizeof(unsigned char) +
+		pContext->m_adjacency.m_begin.capacity() * sizeof(int) +
+		pContext->m_adjacency.m_neighbors.capacity() * sizeof(int) +
+		pContext->m_adjacency.m_weights.capacity() * sizeof(unsigned char) +
+		pContext->m_triDiametersSq.capacity() * sizeof(float);
+
+	return GFSDK_FaceWorks_OK;
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GetMeshContextWeldedVerts(
+	const GFSDK_FaceWorks_MeshContext * pContext,
+	int * pWeldedVertsOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut)
+{
+	// Validate parameters
+	if (!pContext)
+	{
+		ErrPrintf("pContext is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!pWeldedVertsOut)
+	{
+		ErrPrintf("pWeldedVertsOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	memcpy(pWeldedVertsOut, &pContext->m_weldedVerts[0], pContext->m_weldedVerts.size() * sizeof(int));
+
+	return GFSDK_FaceWorks_OK;
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateMeshCurvatureFromContext(
+	const GFSDK_FaceWorks_MeshContext * pContext,
+	const void * pPositions,
+	int positionStrideBytes,
+	const void * pNormals,
+	int normalStrideBytes,
+	int smoothingPassCount,
+	void * pCurvaturesOut,
+	int curvatureStrideBytes,
+	GFSDK_FaceWorks_CurvatureStats * pStatsOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	// Validate parameters
+	if (!pContext)
+	{
+		ErrPrintf("pContext is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!pPositions)
+	{
+		ErrPrintf("pPositions is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (positionStrideBytes < 3 * int(sizeof(float)))
+	{
+		ErrPrintf("positionStrideBytes is %d; should be at least %d\n",
+			positionStrideBytes, 3 * sizeof(float));
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!pNormals)
+	{
+		ErrPrintf("pNormals is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (normalStrideBytes < 3 * int(sizeof(float)))
+	{
+		ErrPrintf("normalStrideBytes is %d; should be at least %d\n",
+			normalStrideBytes, 3 * sizeof(float));
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (smoothingPassCount < 0)
+	{
+		ErrPrintf("smoothingPassCount is %d; should be at least 0\n", smoothingPassCount);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!pCurvaturesOut)
+	{
+		ErrPrintf("pCurvaturesOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (curvatureStrideBytes < int(sizeof(float)))
+	{
+		ErrPrintf("curvatureStrideBytes is %d; should be at least %d\n",
+			curvatureStrideBytes, sizeof(float));
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	int vertexCount = pContext->m_vertexCount;
+	gfsdk_new_delete_t allocator = pContext->m_allocator;
+
+	// Catch out-of-memory exceptions
+	try
+	{
+		FaceWorks_Allocator<float> allocFloat(&allocator);
+		FloatVector curvatures(allocFloat);
+		CalculateVertexCurvatures(
+			vertexCount,
+			pPositions, positionStrideBytes,
+			pNormals, normalStrideBytes,
+			pContext->m_edges, pContext->m_adjacency,
+			smoothingPassCount,
+			&curvatures,
+			pParallelConfig, &allocator);
+
+		// Welded vertices that aren't the first at their position aren't in the topology, so
+		// they take the first one's curvature
+		const int * pCurvatureVerts = pContext->m_isWelded ? &pContext->m_weldedVerts[0] : nullptr;
+		for (int i = 0; i < vertexCount; ++i)
+		{
+			float * pCurvature = reinterpret_cast<float *>((char *)pCurvaturesOut + i * curvatureStrideBytes);
+			*pCurvature = curvatures[pCurvatureVerts ? pCurvatureVerts[i] : i];
+		}
+
+		if (pStatsOut)
+			CalculateCurvatureStats(vertexCount, pCurvaturesOut, curvatureStrideBytes, pStatsOut, &allocator);
+	}
+	catch (std::bad_alloc)
+	{
+		return GFSDK_FaceWorks_OutOfMemory;
+	}
+
+	return GFSDK_FaceWorks_OK;
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateMeshUVScaleFromContext(
+	const GFSDK_FaceWorks_MeshContext * pContext,
+	const void * pUVs,
+	int uvStrideBytes,
+	float * pAverageUVScaleOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut)
+{
+	// Validate parameters
+	if (!pContext)
+	{
+		ErrPrintf("pContext is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!pUVs)
+	{
+		ErrPrintf("pUVs is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (uvStrideBytes < 2 * int(sizeof(float)))
+	{
+		ErrPrintf("uvStrideBytes is %d; should be at least %d\n",
+			uvStrideBytes, 2 * sizeof(float));
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!pAverageUVScaleOut)
+	{
+		ErrPrintf("pAverageUVScaleOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	// Calculate average UV scale, as a geometric mean of scale for each triangle, using the
+	// triangles' diameters at the rest positions
+
+	float logUvScaleSum = 0.0f;
+	int logUvScaleCount = 0;
+	GetSimdKernels()->m_pfnSumTriangleLogUVScales(
+						nullptr, 0,
+						&pContext->m_triDiametersSq[0],
+						pUVs, uvStrideBytes,
+						&pContext->m_indices[0], pContext->m_triCount,
+						&logUvScaleSum, &logUvScaleCount);
+
+	*pAverageUVScaleOut = expf(logUvScaleSum / float(logUvScaleCount));
+
+	return GFSDK_FaceWorks_OK;
+}
+
+GFSDK_FACEWORKS_API void GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_ReleaseMeshContext(
+	GFSDK_FaceWorks_MeshContext * pContext)
+{
+	if (!pContext)
+		return;
+
+	gfsdk_new_delete_t allocator = pContext->m_allocator;
+	pContext->~GFSDK_FaceWorks_MeshContext();
+	FaceWorks_Free(pContext, allocator);
+}
+
+
+
+// Curvature near moved vertices: when some vertices move, only the edges touching them change, so
+// only the raw curvatures of the moved vertices and their neighbors change; each smoothing pass
+// then spreads the change one ring further.  Recalculating each level only inside its own ring
+// makes the cost follow the size of that region rather than the mesh.
+
+// A set of vertices around some moved ones, added ring by ring
+struct CurvatureRegion
+{
+	IntVector	m_verts;		// The region's vertices, in the order they were added
+	IntVector	m_stamps;		// Per vertex: the stamp of the last region it was added to
+	IntVector	m_slots;		// Per vertex: its index in m_verts, if it's in the region
+	int			m_stamp;
+
+	explicit CurvatureRegion(gfsdk_new_delete_t * pAllocator)
+	:	m_verts(FaceWorks_Allocator<int>(pAllocator)),
+		m_stamps(FaceWorks_Allocator<int>(pAllocator)),
+		m_slots(FaceWorks_Allocator<int>(pAllocator)),
+		m_stamp(0)
+	{
+	}
+
+	// May throw std::bad_alloc
+	void Init(int vertexCount)
+	{
+		m_stamps.assign(vertexCount, 0);
+		m_slots.resize(vertexCount);
+		m_stamp = 0;
+	}
+
+	// Empty the region.  Stamps are only compared for equality, so when they run out, clear
+	// them to start again.
+	void Clear()
+	{
+		if (m_stamp == INT_MAX)
+		{
+			std::fill(m_stamps.begin(), m_stamps.end(), 0);
+			m_stamp = 0;
+		}
+		++m_stamp;
+		m_verts.clear();
+	}
+
+	// Index of a vertex in m_verts, or -1 if it's not in the region
+	int Slot(int iVert) const
+	{
+		return (m_stamps[iVert] == m_stamp) ? m_slots[iVert] : -1;
+	}
+
+	// Returns true if the vertex wasn't in the region already; may throw std::bad_alloc
+	bool Add(int iVert)
+	{
+		if (m_stamps[iVert] == m_stamp)
+			return false;
+		m_stamps[iVert] = m_stamp;
+		m_slots[iVert] = int(m_verts.size());
+		m_verts.push_back(iVert);
+		return true;
+	}
+
+	// Add the neighbors of m_verts[iBegin, iEnd); may throw std::bad_alloc
+	void Grow(const MeshAdjacency & adjacency, int iBegin, int iEnd)
+	{
+		for (int i = iBegin; i < iEnd; ++i)
+		{
+			int iVert = m_verts[i];
+			for (int iNeighbor = adjacency.m_begin[iVert], iNeighborEnd = adjacency.m_begin[iVert + 1]; iNeighbor < iNeighborEnd; ++iNeighbor)
+				Add(adjacency.m_neighbors[iNeighbor]);
+		}
+	}
+};
+
+// Raw curvature of region.m_verts[iBegin, iEnd) from the edges to their neighbors, into
+// pCurvaturesOut[iBegin, iEnd).  If isRegionIndexed, the positions and normals are given per
+// region vertex, in the order of region.m_verts, and must cover the neighbors too.  The neighbor
+// lists visit each vertex's edges in the same order as the edge list does, so the curvatures come
+// out the same as from CalculateVertexCurvatures().
+static void CalculateRegionRawCurvatures(
+	const MeshAdjacency & adjacency,
+	const CurvatureRegion & region,
+	bool isRegionIndexed,
+	const void * pPositions,
+	int positionStrideBytes,
+	const void * pNormals,
+	int normalStrideBytes,
+	int iBegin,
+	int iEnd,
+	float * pCurvaturesOut)
+{
+	const SimdKernels * pKernels = GetSimdKernels();
+	static const int cEdgeBatch = 256;
+	int edgeVerts[2 * cEdgeBatch];
+	float edgeCurvatures[cEdgeBatch];
+
+	for (int i = iBegin; i < iEnd; ++i)
+	{
+		int iVert = region.m_verts[i];
+		float curvatureMin = FLT_MAX;
+		float curvatureMax = 0.0f;
+
+		for (int iNeighborBegin = adjacency.m_begin[iVert], iNeighborEnd = adjacency.m_begin[iVert + 1];
+			 iNeighborBegin < iNeighborEnd;
+			 iNeighborBegin += cEdgeBatch)
+		{
+			int batchEdgeCount = min(cEdgeBatch, iNeighborEnd - iNeighborBegin);
+			for (int iEdge = 0; iEdge < batchEdgeCount; ++iEdge)
+			{
+				int iNeighborVert = adjacency.m_neighbors[iNeighborBegin + iEdge];
+				edgeVerts[2 * iEdge] = isRegionIndexed ? i : iVert;
+				edgeVerts[2 * iEdge + 1] = isRegionIndexed ? region.m_slots[iNeighborVert] : iNeighborVert;
+			}
+			pKernels->m_pfnCalculateEdgeCurvatures(
+						pPositions, positionStrideBytes,
+						pNormals, normalStrideBytes,
+						edgeVerts, batchEdgeCount,
+						edgeCurvatures);
+
+			for (int iEdge = 0; iEdge < batchEdgeCount; ++iEdge)
+			{
+				curvatureMin = min(curvatureMin, edgeCurvatures[iEdge]);
+				curvatureMax = max(curvatureMax, edgeCurvatures[iEdge]);
+			}
+		}
+
+		pCurvaturesOut[i] = 0.5f * (curvatureMin + curvatureMax);
+	}
+}
+
+// Invert a welded context's welded-position map: the vertices each welded vertex stands for are
+// pWeldGroupVertsOut[(*pWeldGroupBeginOut)[i], (*pWeldGroupBeginOut)[i + 1]).  May throw
+// std::bad_alloc.
+static void BuildWeldGroups(
+	const GFSDK_FaceWorks_MeshContext * pContext,
+	IntVector * pWeldGroupBeginOut,
+	IntVector * pWeldGroupVertsOut)
+{
+	int vertexCount = pContext->m_vertexCount;
+	IntVector & groupBegin = *pWeldGroupBeginOut;
+	groupBegin.assign(size_t(vertexCount) + 2, 0);
+	for (int i = 0; i < vertexCount; ++i)
+		++groupBegin[pContext->m_weldedVerts[i] + 2];
+	for (int i = 0; i <= vertexCount; ++i)
+		groupBegin[i + 1] += groupBegin[i];
+	pWeldGroupVertsOut->resize(vertexCount);
+	for (int i = 0; i < vertexCount; ++i)
+		(*pWeldGroupVertsOut)[groupBegin[pContext->m_weldedVerts[i] + 1]++] = i;
+	groupBegin.resize(size_t(vertexCount) + 1);
+}
+
+// Curvatures as from GFSDK_FaceWorks_CalculateMeshCurvatureFromContext(), one per vertex (or
+// welded vertex) into *pCurvaturesOut, keeping the curvatures before each smoothing pass in
+// *pLevelCurvaturesOut: smoothingPassCount levels of vertexCount floats, starting with the raw
+// curvatures.  May throw std::bad_alloc.
+static void CalculateCurvatureLevels(
+	const GFSDK_FaceWorks_MeshContext * pContext,
+	const void * pPositions,
+	int positionStrideBytes,
+	const void * pNormals,
+	int normalStrideBytes,
+	int smoothingPassCount,
+	FloatVector * pLevelCurvaturesOut,
+	FloatVector * pCurvaturesOut,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig,
+	gfsdk_new_delete_t * pAllocator)
+{
+	int vertexCount = pContext->m_vertexCount;
+	const MeshAdjacency & adjacency = pContext->m_adjacency;
+	FloatVector & curvatures = *pCurvaturesOut;
+
+	CalculateVertexCurvatures(
+		vertexCount,
+		pPositions, positionStrideBytes,
+		pNormals, normalStrideBytes,
+		pContext->m_edges, adjacency,
+		0,
+		&curvatures,
+		pParallelConfig, pAllocator);
+
+	pLevelCurvaturesOut->resize(size_t(smoothingPassCount) * size_t(vertexCount));
+	for (int iPass = 0; iPass < smoothingPassCount; ++iPass)
+	{
+		float * pLevel = &(*pLevelCurvaturesOut)[size_t(iPass) * size_t(vertexCount)];
+		memcpy(pLevel, &curvatures[0], size_t(vertexCount) * sizeof(float));
+		float * pDst = &curvatures[0];
+		ParallelForRanges(pParallelConfig, vertexCount, [&](int iBegin, int iEnd)
+		{
+			for (int i = iBegin; i < iEnd; ++i)
+				pDst[i] = SmoothedCurvature(adjacency, pLevel, i);
+		}, pAllocator);
+	}
+}
+
+
+
+// Incremental curvature: the curvatures before the last smoothing pass are kept for every
+// vertex, and updated in place around the vertices that move.
+
+struct GFSDK_FaceWorks_IncrementalCurvature
+{
+	gfsdk_new_delete_t						m_allocator;
+	const GFSDK_FaceWorks_MeshContext *		m_pContext;
+	int										m_smoothingPassCount;
+	FloatVector								m_levelCurvatures;	// vertexCount per level, for levels [0, smoothingPassCount)
+	IntVector								m_weldGroupBegin;	// If welded, from BuildWeldGroups()
+	IntVector								m_weldGroupVerts;
+	CurvatureRegion							m_region;
+
+	explicit GFSDK_FaceWorks_IncrementalCurvature(const gfsdk_new_delete_t & allocator)
+	:	m_allocator(allocator),
+		m_pContext(nullptr),
+		m_smoothingPassCount(0),
+		m_levelCurvatures(FaceWorks_Allocator<float>(&m_allocator)),
+		m_weldGroupBegin(FaceWorks_Allocator<int>(&m_allocator)),
+		m_weldGroupVerts(FaceWorks_Allocator<int>(&m_allocator)),
+		m_region(&m_allocator)
+	{
+	}
+};
+
+// Write the curvatures of verts pVerts[0, vertCount) (or all of them, if pVerts is null) to the
+// caller's buffer, along with the vertices welded to them; returns the number of curvatures written
+static int WriteCurvatures(
+	const GFSDK_FaceWorks_IncrementalCurvature * pIncremental,
+	const float * pCurvatures,
+	const int * pVerts,
+	int vertCount,
+	void * pCurvaturesOut,
+	int curvatureStrideBytes)
+{
+	bool isWelded = pIncremental->m_pContext->m_isWelded;
+	int writtenCount = 0;
+	for (int i = 0; i < vertCount; ++i)
+	{
+		int iVert = pVerts ? pVerts[i] : i;
+		int iWeldedBegin = isWelded ? pIncremental->m_weldGroupBegin[iVert] : 0;
+		int iWeldedEnd = isWelded ? pIncremental->m_weldGroupBegin[iVert + 1] : 1;
+		for (int iWelded = iWeldedBegin; iWelded < iWeldedEnd; ++iWelded)
+		{
+			int iOutVert = isWelded ? pIncremental->m_weldGroupVerts[iWelded] : iVert;
+			float * pCurvature = reinterpret_cast<float *>((char *)pCurvaturesOut + iOutVert * curvatureStrideBytes);
+			*pCurvature = pCurvatures[i];
+			++writtenCount;
+		}
+	}
+	return writtenCount;
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_BeginIncrementalCurvature(
+	const GFSDK_FaceWorks_MeshContext * pContext,
+	const void * pPositions,
+	int positionStrideBytes,
+	const void * pNormals,
+	int normalStrideBytes,
+	int smoothingPassCount,
+	void * pCurvaturesOut,
+	int curvatureStrideBytes,
+	GFSDK_FaceWorks_IncrementalCurvature ** ppIncrementalOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	// Validate parameters
+	if (!pContext)
+	{
+		ErrPrintf("pContext is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!pPositions)
+	{
+		ErrPrintf("pPositions is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (positionStrideBytes < 3 * int(sizeof(float)))
+	{
+		ErrPrintf("positionStrideBytes is %d; should be at least %d\n",
+			positionStrideBytes, 3 * sizeof(float));
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!pNormals)
+	{
+		ErrPrintf("pNormals is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (normalStrideBytes < 3 * int(sizeof(float)))
+	{
+		ErrPrintf("normalStrideBytes is %d; should be at least %d\n",
+			normalStrideBytes, 3 * sizeof(float));
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (smoothingPassCount < 0)
+	{
+		ErrPrintf("smoothingPassCount is %d; should be at least 0\n", smoothingPassCount);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!pCurvaturesOut)
+	{
+		ErrPrintf("pCurvaturesOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (curvatureStrideBytes < int(sizeof(float)))
+	{
+		ErrPrintf("curvatureStrideBytes is %d; should be at least %d\n",
+			curvatureStrideBytes, sizeof(float));
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!ppIncrementalOut)
+	{
+		ErrPrintf("ppIncrementalOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	const gfsdk_new_delete_t & allocator = pContext->m_allocator;
+
+	void * pMemory = nullptr;
+	try
+	{
+		pMemory = FaceWorks_Malloc(sizeof(GFSDK_FaceWorks_IncrementalCurvature), allocator);
+	}
+	catch (std::bad_alloc)
+	{
+		return GFSDK_FaceWorks_OutOfMemory;
+	}
+	if (!pMemory)
+		return GFSDK_FaceWorks_OutOfMemory;
+
+	GFSDK_FaceWorks_IncrementalCurvature * pIncremental = new (pMemory) GFSDK_FaceWorks_IncrementalCurvature(allocator);
+	pIncremental->m_pContext = pContext;
+	pIncremental->m_smoothingPassCount = smoothingPassCount;
+
+	// Catch out-of-memory exceptions
+	try
+	{
+		pIncremental->m_region.Init(pContext->m_vertexCount);
+
+		// Updates write the curvature of each welded vertex to all the vertices it stands for
+		if (pContext->m_isWelded)
+			BuildWeldGroups(pContext, &pIncremental->m_weldGroupBegin, &pIncremental->m_weldGroupVerts);
+
+		FaceWorks_Allocator<float> allocFloat(&pIncremental->m_allocator);
+		FloatVector curvatures(allocFloat);
+		CalculateCurvatureLevels(
+			pContext,
+			pPositions, positionStrideBytes,
+			pNormals, normalStrideBytes,
+			smoothingPassCount,
+			&pIncremental->m_levelCurvatures,
+			&curvatures,
+			pParallelConfig, &pIncremental->m_allocator);
+
+		WriteCurvatures(pIncremental, &curvatures[0], nullptr, pContext->m_vertexCount, pCurvaturesOut, curvatureStrideBytes);
+	}
+	catch (std::bad_alloc)
+	{
+		GFSDK_FaceWorks_ReleaseIncrementalCurvature(pIncremental);
+		return GFSDK_FaceWorks_OutOfMemory;
+	}
+
+	*ppIncrementalOut = pIncremental;
+	return GFSDK_FaceWorks_OK;
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_UpdateIncrementalCurvature(
+	GFSDK_FaceWorks_IncrementalCurvature * pIncremental,
+	const void * pPositions,
+	int positionStrideBytes,
+	const void * pNormals,
+	int normalStrideBytes,
+	int movedVertexCount,
+	const int * pMovedVerts,
+	void * pCurvaturesInOut,
+	int curvatureStrideBytes,
+	int * pUpdatedVertexCountOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	// Validate parameters
+	if (!pIncremental)
+	{
+		ErrPrintf("pIncremental is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!pPositions)
+	{
+		ErrPrintf("pPositions is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (positionStrideBytes < 3 * int(sizeof(float)))
+	{
+		ErrPrintf("positionStrideBytes is %d; should be at least %d\n",
+			positionStrideBytes, 3 * sizeof(float));
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!pNormals)
+	{
+		ErrPrintf("pNormals is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (normalStrideBytes < 3 * int(sizeof(float)))
+	{
+		ErrPrintf("normalStrideBytes is %d; should be at least %d\n",
+			normalStrideBytes, 3 * sizeof(float));
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (movedVertexCount < 0)
+	{
+		ErrPrintf("movedVertexCount is %d; should be at least 0\n", movedVertexCount);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (movedVertexCount > 0 && !pMovedVerts)
+	{
+		ErrPrintf("pMovedVerts is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!pCurvaturesInOut)
+	{
+		ErrPrintf("pCurvaturesInOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (curvatureStrideBytes < int(sizeof(float)))
+	{
+		ErrPrintf("curvatureStrideBytes is %d; should be at least %d\n",
+			curvatureStrideBytes, sizeof(float));
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	const GFSDK_FaceWorks_MeshContext * pContext = pIncremental->m_pContext;
+	int vertexCount = pContext->m_vertexCount;
+	for (int i = 0; i < movedVertexCount; ++i)
+	{
+		if (pMovedVerts[i] < 0 || pMovedVerts[i] >= vertexCount)
+		{
+			ErrPrintf("pMovedVerts[%d] is %d; should be in [0, %d)\n", i, pMovedVerts[i], vertexCount);
+			return GFSDK_FaceWorks_InvalidArgument;
+		}
+	}
+
+	if (pUpdatedVertexCountOut)
+		*pUpdatedVertexCountOut = 0;
+
+	const MeshAdjacency & adjacency = pContext->m_adjacency;
+	int smoothingPassCount = pIncremental->m_smoothingPassCount;
+
+	// Catch out-of-memory exceptions
+	try
+	{
+		// The moved vertices' edges have changed, which changes the raw curvatures of the
+		// vertices at both their ends: the moved vertices and their neighbors
+		CurvatureRegion & region = pIncremental->m_region;
+		region.Clear();
+		for (int i = 0; i < movedVertexCount; ++i)
+			region.Add(pContext->m_isWelded ? pContext->m_weldedVerts[pMovedVerts[i]] : pMovedVerts[i]);
+		int movedCount = int(region.m_verts.size());
+		if (movedCount == 0)
+			return GFSDK_FaceWorks_OK;
+		region.Grow(adjacency, 0, movedCount);
+
+		int ringBegin = movedCount;
+		int levelCount = int(region.m_verts.size());
+		FaceWorks_Allocator<float> allocFloat(&pIncremental->m_allocator);
+		FloatVector curvatures(levelCount, 0.0f, allocFloat);
+		ParallelForRanges(pParallelConfig, levelCount, [&](int iBegin, int iEnd)
+		{
+			CalculateRegionRawCurvatures(
+				adjacency, region, false,
+				pPositions, positionStrideBytes,
+				pNormals, normalStrideBytes,
+				iBegin, iEnd,
+				&curvatures[0]);
+		}, &pIncremental->m_allocator);
+
+		// Each smoothing pass changes the vertices next to the ones changed by the level
+		// before, so store that level, grow the region by a ring and smooth over all of it
+		for (int iPass = 0; iPass < smoothingPassCount; ++iPass)
+		{
+			float * pLevel = &pIncremental->m_levelCurvatures[size_t(iPass) * size_t(vertexCount)];
+			for (int i = 0; i < levelCount; ++i)
+				pLevel[region.m_verts[i]] = curvatures[i];
+
+			region.Grow(adjacency, ringBegin, levelCount);
+			ringBegin = levelCount;
+			levelCount = int(region.m_verts.size());
+
+			curvatures.resize(levelCount);
+			ParallelForRanges(pParallelConfig, levelCount, [&](int iBegin, int iEnd)
+			{
+				for (int i = iBegin; i < iEnd; ++i)
+					curvatures[i] = SmoothedCurvature(adjacency, pLevel, region.m_verts[i]);
+			}, &pIncremental->m_allocator);
+		}
+
+		int updatedCount = WriteCurvatures(pIncremental, &curvatures[0], &region.m_verts[0], levelCount, pCurvaturesInOut, curvatureStrideBytes);
+		if (pUpdatedVertexCountOut)
+			*pUpdatedVertexCountOut = updatedCount;
+	}
+	catch (std::bad_alloc)
+	{
+		return GFSDK_FaceWorks_OutOfMemory;
+	}
+
+	return GFSDK_FaceWorks_OK;
+}
+
+GFSDK_FACEWORKS_API void GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_ReleaseIncrementalCurvature(
+	GFSDK_FaceWorks_IncrementalCurvature * pIncremental)
+{
+	if (!pIncremental)
+		return;
+
+	gfsdk_new_delete_t allocator = pIncremental->m_allocator;
+	pIncremental->~GFSDK_FaceWorks_IncrementalCurvature();
+	FaceWorks_Free(pIncremental, allocator);
+}
+
+
+
+// Curvature deltas: each morph target only moves some vertices, so its curvatures only differ
+// from the base mesh's near them.  The base curvatures before each smoothing pass are calculated
+// once; for each target, the region around its moved vertices is recalculated from its own
+// positions and normals there, reading the base levels outside the region, and compared with the
+// base curvatures.
+
+struct VertCurvatureDelta
+{
+	int		m_iVert;
+	float	m_delta;
+
+	bool operator < (const VertCurvatureDelta & other) const
+	{
+		return m_iVert < other.m_iVert;
+	}
+};
+
+typedef std::vector<VertCurvatureDelta, FaceWorks_Allocator<VertCurvatureDelta>> VertCurvatureDeltaVector;
+
+struct GFSDK_FaceWorks_CurvatureDeltas
+{
+	gfsdk_new_delete_t	m_allocator;
+	int					m_targetCount;
+	IntVector			m_targetBegin;		// Per target: its deltas are [m_targetBegin[i], m_targetBegin[i + 1])
+	IntVector			m_verts;
+	FloatVector			m_deltas;
+
+	explicit GFSDK_FaceWorks_CurvatureDeltas(const gfsdk_new_delete_t & allocator)
+	:	m_allocator(allocator),
+		m_targetCount(0),
+		m_targetBegin(FaceWorks_Allocator<int>(&m_allocator)),
+		m_verts(FaceWorks_Allocator<int>(&m_allocator)),
+		m_deltas(FaceWorks_Allocator<float>(&m_allocator))
+	{
+	}
+};
+
+// What's shared by all the targets
+struct CurvatureDeltaBase
+{
+	const GFSDK_FaceWorks_MeshContext *	m_pContext;
+	const void *						m_pPositions;
+	int									m_positionStrideBytes;
+	const void *						m_pNormals;
+	int									m_normalStrideBytes;
+	int									m_smoothingPassCount;
+	float								m_deltaThreshold;
+	const float *						m_pLevelCurvatures;		// From CalculateCurvatureLevels()
+	const float *						m_pCurvatures;
+	const int *							m_pWeldGroupBegin;		// From BuildWeldGroups(), if welded
+	const int *							m_pWeldGroupVerts;
+};
+
+// Working data for one thread's targets
+struct CurvatureDeltaScratch
+{
+	CurvatureRegion		m_region;
+	IntVector			m_movedDeltas;		// Per moved vertex, in region order: its index in the target
+	FloatVector			m_positions;		// Per region vertex, in region order
+	FloatVector			m_normals;
+	FloatVector			m_curvatures;		// Per region vertex: the curvature at the current level
+	FloatVector			m_smoothed;
+
+	explicit CurvatureDeltaScratch(gfsdk_new_delete_t * pAllocator)
+	:	m_region(pAllocator),
+		m_movedDeltas(FaceWorks_Allocator<int>(pAllocator)),
+		m_positions(FaceWorks_Allocator<float>(pAllocator)),
+		m_normals(FaceWorks_Allocator<float>(pAllocator)),
+		m_curvatures(FaceWorks_Allocator<float>(pAllocator)),
+		m_smoothed(FaceWorks_Allocator<float>(pAllocator))
+	{
+	}
+};
+
+// Calculate one target's curvature deltas above the threshold, sorted by vertex, into *pDeltasOut;
+// may throw std::bad_alloc
+static void CalculateTargetCurvatureDeltas(
+	const CurvatureDeltaBase & base,
+	const GFSDK_FaceWorks_MorphTarget & target,
+	CurvatureDeltaScratch * pScratch,
+	VertCurvatureDeltaVector * pDeltasOut)
+{
+	const GFSDK_FaceWorks_MeshContext * pContext = base.m_pContext;
+	const MeshAdjacency & adjacency = pContext->m_adjacency;
+	int vertexCount = pContext->m_vertexCount;
+	CurvatureRegion & region = pScratch->m_region;
+
+	// The welded vertices use the position and normal of the lowest-numbered vertex at their
+	// position, so that vertex's deltas are the ones that count
+	region.Clear();
+	pScratch->m_movedDeltas.clear();
+	for (int i = 0; i < target.m_vertexCount; ++i)
+	{
+		int iVert = target.m_pVerts[i];
+		if (pContext->m_isWelded && pContext->m_weldedVerts[iVert] != iVert)
+			continue;
+		if (region.Add(iVert))
+			pScratch->m_movedDeltas.push_back(i);
+	}
+	int movedCount = int(region.m_verts.size());
+	pDeltasOut->clear();
+	if (movedCount == 0)
+		return;
+
+	// The raw curvatures change at the moved vertices and their neighbors, and their edges reach
+	// one ring further; pose all of those
+	region.Grow(adjacency, 0, movedCount);
+	int levelCount = int(region.m_verts.size());
+	region.Grow(adjacency, movedCount, levelCount);
+	int posedCount = int(region.m_verts.size());
+
+	pScratch->m_positions.resize(3 * size_t(posedCount));
+	pScratch->m_normals.resize(3 * size_t(posedCount));
+	for (int i = 0; i < posedCount; ++i)
+	{
+		int iVert = region.m_verts[i];
+		const float * pPos = reinterpret_cast<const float *>((const char *)base.m_pPositions + iVert * base.m_positionStrideBytes);
+		const float * pNormal = reinterpret_cast<const float *>((const char *)base.m_pNormals + iVert * base.m_normalStrideBytes);
+		float * pPosOut = &pScratch->m_positions[3 * i];
+		float * pNormalOut = &pScratch->m_normals[3 * i];
+		for (int j = 0; j < 3; ++j)
+		{
+			pPosOut[j] = pPos[j];
+			pNormalOut[j] = pNormal[j];
+		}
+
+		if (i < movedCount)
+		{
+			int iDelta = pScratch->m_movedDeltas[i];
+			for (int j = 0; j < 3; ++j)
+				pPosOut[j] += target.m_pPositionDeltas[3 * iDelta + j];
+			if (target.m_pNormalDeltas)
+			{
+				for (int j = 0; j < 3; ++j)
+					pNormalOut[j] += target.m_pNormalDeltas[3 * iDelta + j];
+			}
+		}
+	}
+
+	pScratch->m_curvatures.resize(levelCount);
+	CalculateRegionRawCurvatures(
+		adjacency, region, true,
+		&pScratch->m_positions[0], 3 * sizeof(float),
+		&pScratch->m_normals[0], 3 * sizeof(float),
+		0, levelCount,
+		&pScratch->m_curvatures[0]);
+
+	// Each smoothing pass reads this target's curvatures inside the region changed by the level
+	// before, and the base curvatures outside it, and changes one more ring.  The first pass's
+	// ring is the one already posed.
+	int ringBegin = levelCount;
+	for (int iPass = 0; iPass < base.m_smoothingPassCount; ++iPass)
+	{
+		if (iPass > 0)
+		{
+			int ringEnd = int(region.m_verts.size());
+			region.Grow(adjacency, ringBegin, ringEnd);
+			ringBegin = ringEnd;
+		}
+
+		const float * pBaseLevel = base.m_pLevelCurvatures + size_t(iPass) * size_t(vertexCount);
+		const float * pLevel = &pScratch->m_curvatures[0];
+		int smoothedCount = int(region.m_verts.size());
+		pScratch->m_smoothed.resize(smoothedCount);
+		for (int i = 0; i < smoothedCount; ++i)
+		{
+			pScratch->m_smoothed[i] = SmoothedCurvature(adjacency, region.m_verts[i], [&](int iNeighborVert)
+			{
+				int iSlot = region.Slot(iNeighborVert);
+				return (iSlot >= 0 && iSlot < levelCount) ? pLevel[iSlot] : pBaseLevel[iNeighborVert];
+			});
+		}
+		pScratch->m_curvatures.swap(pScratch->m_smoothed);
+		levelCount = smoothedCount;
+	}
+
+	for (int i = 0; i < levelCount; ++i)
+	{
+		int iVert = region.m_verts[i];
+		float delta = pScratch->m_curvatures[i] - base.m_pCurvatures[iVert];
+		if (!(fabsf(delta) > base.m_deltaThreshold))
+			continue;
+
+		int iWeldedBegin = pContext->m_isWelded ? base.m_pWeldGroupBegin[iVert] : 0;
+		int iWeldedEnd = pContext->m_isWelded ? base.m_pWeldGroupBegin[iVert + 1] : 1;
+		for (int iWelded = iWeldedBegin; iWelded < iWeldedEnd; ++iWelded)
+		{
+			VertCurvatureDelta vertDelta = { pContext->m_isWelded ? base.m_pWeldGroupVerts[iWelded] : iVert, delta };
+			pDeltasOut->push_back(vertDelta);
+		}
+	}
+	std::sort(pDeltasOut->begin(), pDeltasOut->end());
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_BakeCurvatureDeltas(
+	const GFSDK_FaceWorks_MeshContext * pContext,
+	const void * pPositions,
+	int positionStrideBytes,
+	const void * pNormals,
+	int normalStrideBytes,
+	int smoothingPassCount,
+	int targetCount,
+	const GFSDK_FaceWorks_MorphTarget * pTargets,
+	float deltaThreshold,
+	void * pBaseCurvaturesOut,
+	int curvatureStrideBytes,
+	GFSDK_FaceWorks_CurvatureDeltas ** ppDeltasOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	// Validate parameters
+	if (!pContext)
+	{
+		ErrPrintf("pContext is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!pPositions)
+	{
+		ErrPrintf("pPositions is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (positionStrideBytes < 3 * int(sizeof(float)))
+	{
+		ErrPrintf("positionStrideBytes is %d; should be at least %d\n",
+			positionStrideBytes, 3 * sizeof(float));
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!pNormals)
+	{
+		ErrPrintf("pNormals is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (normalStrideBytes < 3 * int(sizeof(float)))
+	{
+		ErrPrintf("normalStrideBytes is %d; should be at least %d\n",
+			normalStrideBytes, 3 * sizeof(float));
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (smoothingPassCount < 0)
+	{
+		ErrPrintf("smoothingPassCount is %d; should be at least 0\n", smoothingPassCount);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (targetCount < 0)
+	{
+		ErrPrintf("targetCount is %d; should be at least 0\n", targetCount);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (targetCount > 0 && !pTargets)
+	{
+		ErrPrintf("pTargets is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!(deltaThreshold >= 0.0f))
+	{
+		ErrPrintf("deltaThreshold is %g; should be at least 0\n", deltaThreshold);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (pBaseCurvaturesOut && curvatureStrideBytes < int(sizeof(float)))
+	{
+		ErrPrintf("curvatureStrideBytes is %d; should be at least %d\n",
+			curvatureStrideBytes, sizeof(float));
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!ppDeltasOut)
+	{
+		ErrPrintf("ppDeltasOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	int vertexCount = pContext->m_vertexCount;
+	for (int iTarget = 0; iTarget < targetCount; ++iTarget)
+	{
+		const GFSDK_FaceWorks_MorphTarget & target = pTargets[iTarget];
+		if (target.m_vertexCount < 0)
+		{
+			ErrPrintf("pTargets[%d].m_vertexCount is %d; should be at least 0\n", iTarget, target.m_vertexCount);
+			return GFSDK_FaceWorks_InvalidArgument;
+		}
+		if (target.m_vertexCount == 0)
+			continue;
+		if (!target.m_pVerts)
+		{
+			ErrPrintf("pTargets[%d].m_pVerts is null\n", iTarget);
+			return GFSDK_FaceWorks_InvalidArgument;
+		}
+		if (!target.m_pPositionDeltas)
+		{
+			ErrPrintf("pTargets[%d].m_pPositionDeltas is null\n", iTarget);
+			return GFSDK_FaceWorks_InvalidArgument;
+		}
+		for (int i = 0; i < target.m_vertexCount; ++i)
+		{
+			if (target.m_pVerts[i] < 0 || target.m_pVerts[i] >= vertexCount)
+			{
+				ErrPrintf("pTargets[%d].m_pVerts[%d] is %d; should be in [0, %d)\n",
+					iTarget, i, target.m_pVerts[i], vertexCount);
+				return GFSDK_FaceWorks_InvalidArgument;
+			}
+		}
+	}
+
+	const gfsdk_new_delete_t & allocator = pContext->m_allocator;
+
+	void * pMemory = nullptr;
+	try
+	{
+		pMemory = FaceWorks_Malloc(sizeof(GFSDK_FaceWorks_CurvatureDeltas), allocator);
+	}
+	catch (std::bad_alloc)
+	{
+		return GFSDK_FaceWorks_OutOfMemory;
+	}
+	if (!pMemory)
+		return GFSDK_FaceWorks_OutOfMemory;
+
+	GFSDK_FaceWorks_CurvatureDeltas * pDeltas = new (pMemory) GFSDK_FaceWorks_CurvatureDeltas(allocator);
+	gfsdk_new_delete_t * pAllocator = &pDeltas->m_allocator;
+
+	// Catch out-of-memory exceptions
+	try
+	{
+		FaceWorks_Allocator<float> allocFloat(pAllocator);
+		FaceWorks_Allocator<int> allocInt(pAllocator);
+		FloatVector levelCurvatures(allocFloat);
+		FloatVector curvatures(allocFloat);
+		CalculateCurvatureLevels(
+			pContext,
+			pPositions, positionStrideBytes,
+			pNormals, normalStrideBytes,
+			smoothingPassCount,
+			&levelCurvatures,
+			&curvatures,
+			pParallelConfig, pAllocator);
+
+		IntVector weldGroupBegin(allocInt);
+		IntVector weldGroupVerts(allocInt);
+		if (pContext->m_isWelded)
+			BuildWeldGroups(pContext, &weldGroupBegin, &weldGroupVerts);
+
+		if (pBaseCurvaturesOut)
+		{
+			const int * pCurvatureVerts = pContext->m_isWelded ? &pContext->m_weldedVerts[0] : nullptr;
+			for (int i = 0; i < vertexCount; ++i)
+			{
+				float * pCurvature = reinterpret_cast<float *>((char *)pBaseCurvaturesOut + i * curvatureStrideBytes);
+				*pCurvature = curvatures[pCurvatureVerts ? pCurvatureVerts[i] : i];
+			}
+		}
+
+		CurvatureDeltaBase base =
+		{
+			pContext,
+			pPositions, positionStrideBytes,
+			pNormals, normalStrideBytes,
+			smoothingPassCount,
+			deltaThreshold,
+			levelCurvatures.empty() ? nullptr : &levelCurvatures[0],
+			&curvatures[0],
+			weldGroupBegin.empty() ? nullptr : &weldGroupBegin[0],
+			weldGroupVerts.empty() ? nullptr : &weldGroupVerts[0],
+		};
+
+		// Each range of targets gets its own scratch space, and each target its own deltas
+		FaceWorks_Allocator<VertCurvatureDelta> allocDelta(pAllocator);
+		FaceWorks_Allocator<VertCurvatureDeltaVector> allocTarget(pAllocator);
+		std::vector<VertCurvatureDeltaVector, FaceWorks_Allocator<VertCurvatureDeltaVector>> targetDeltas(
+			targetCount, VertCurvatureDeltaVector(allocDelta), allocTarget);
+		std::atomic<bool> outOfMemory(false);
+
+		ParallelForRanges(pParallelConfig, targetCount, [&](int iBegin, int iEnd)
+		{
+			// Exceptions mustn't escape into the worker threads
+			try
+			{
+				CurvatureDeltaScratch scratch(pAllocator);
+				scratch.m_region.Init(vertexCount);
+				for (int iTarget = iBegin; iTarget < iEnd; ++iTarget)
+					CalculateTargetCurvatureDeltas(base, pTargets[iTarget], &scratch, &targetDeltas[iTarget]);
+			}
+			catch (std::bad_alloc)
+			{
+				outOfMemory = true;
+			}
+		}, pAllocator);
+
+		if (outOfMemory)
+		{
+			GFSDK_FaceWorks_ReleaseCurvatureDeltas(pDeltas);
+			return GFSDK_FaceWorks_OutOfMemory;
+		}
+
+		// Pack them all together
+		pDeltas->m_targetCount = targetCount;
+		pDeltas->m_targetBegin.resize(size_t(targetCount) + 1);
+		pDeltas->m_targetBegin[0] = 0;
+		for (int iTarget = 0; iTarget < targetCount; ++iTarget)
+			pDeltas->m_targetBegin[iTarget + 1] = pDeltas->m_targetBegin[iTarget] + int(targetDeltas[iTarget].size());
+
+		pDeltas->m_verts.resize(pDeltas->m_targetBegin[targetCount]);
+		pDeltas->m_deltas.resize(pDeltas->m_targetBegin[targetCount]);
+		for (int iTarget = 0; iTarget < targetCount; ++iTarget)
+		{
+			int iDeltaOut = pDeltas->m_targetBegin[iTarget];
+			for (size_t i = 0, n = targetDeltas[iTarget].size(); i < n; ++i, ++iDeltaOut)
+			{
+				pDeltas->m_verts[iDeltaOut] = targetDeltas[iTarget][i].m_iVert;
+				pDeltas->m_deltas[iDeltaOut] = targetDeltas[iTarget][i].m_delta;
+			}
+		}
+	}
+	catch (std::bad_alloc)
+	{
+		GFSDK_FaceWorks_ReleaseCurvatureDeltas(pDeltas);
+		return GFSDK_FaceWorks_OutOfMemory;
+	}
+
+	*ppDeltasOut = pDeltas;
+	return GFSDK_FaceWorks_OK;
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GetCurvatureDeltas(
+	const GFSDK_FaceWorks_CurvatureDeltas * pDeltas,
+	int iTarget,
+	int * pDeltaCountOut,
+	const int ** ppVertsOut,
+	const float ** ppDeltasOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut)
+{
+	// Validate parameters
+	if (!pDeltas)
+	{
+		ErrPrintf("pDeltas is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (iTarget < 0 || iTarget >= pDeltas->m_targetCount)
+	{
+		ErrPrintf("iTarget is %d; should be in [0, %d)\n", iTarget, pDeltas->m_targetCount);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!pDeltaCountOut)
+	{
+		ErrPrintf("pDeltaCountOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!ppVertsOut)
+	{
+		ErrPrintf("ppVertsOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!ppDeltasOut)
+	{
+		ErrPrintf("ppDeltasOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	int iBegin = pDeltas->m_targetBegin[iTarget];
+	int deltaCount = pDeltas->m_targetBegin[iTarget + 1] - iBegin;
+	*pDeltaCountOut = deltaCount;
+	*ppVertsOut = (deltaCount > 0) ? &pDeltas->m_verts[iBegin] : nullptr;
+	*ppDeltasOut = (deltaCount > 0) ? &pDeltas->m_deltas[iBegin] : nullptr;
+	return GFSDK_FaceWorks_OK;
+}
+
+GFSDK_FACEWORKS_API void GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_ReleaseCurvatureDeltas(
+	GFSDK_FaceWorks_CurvatureDeltas * pDeltas)
+{
+	if (!pDeltas)
+		return;
+
+	gfsdk_new_delete_t allocator = pDeltas->m_allocator;
+	pDeltas->~GFSDK_FaceWorks_CurvatureDeltas();
+	FaceWorks_Free(pDeltas, allocator);
+}
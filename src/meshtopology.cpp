@@ -0,0 +1,199 @@
+//----------------------------------------------------------------------------------
+// File:        FaceWorks/src/meshtopology.cpp
+// SDK Version: v1.0
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014-2016, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+#include "internal.h"
+
+#include <algorithm>
+#include <vector>
+
+// Mesh topology shared by the mesh precomputation functions.
+//
+// Edges: each triangle edge is bucketed by its lower vertex index with a counting sort, then
+// each bucket's higher vertices are sorted, so the copies of an edge from neighboring
+// triangles end up next to each other.  A bucket holds about half of its vertex's edges on
+// a typical mesh, but a vertex with a low index and a high valence (the pole of a UV sphere,
+// or the center of a fan) can own hundreds, so large buckets get a full sort.
+//
+// Adjacency: the unique edges are scattered to both their vertices with another counting
+// sort, giving each vertex a contiguous neighbor list that passes over the mesh can gather
+// from, rather than scattering from each triangle to its vertices.
+
+typedef std::vector<int, FaceWorks_Allocator<int>> IntVector;
+
+void BuildMeshEdges(
+	int vertexCount,
+	int triCount,
+	const int * pIndices,
+	MeshEdges * pEdgesOut,
+	gfsdk_new_delete_t * pAllocator)
+{
+	FaceWorks_Allocator<int> allocInt(pAllocator);
+
+	// Count the edges at each lower vertex, and turn the counts into bucket offsets; they're
+	// stored shifted up by one, so the fill below advances each one to its bucket's end,
+	// which leaves bucket v at [bucketBegin[v], bucketBegin[v + 1])
+	IntVector bucketBegin(allocInt);
+	bucketBegin.assign(size_t(vertexCount) + 2, 0);
+	for (int iTri = 0; iTri < triCount; ++iTri)
+	{
+		const int * indices = &pIndices[3 * iTri];
+		++bucketBegin[min(indices[0], indices[1]) + 2];
+		++bucketBegin[min(indices[1], indices[2]) + 2];
+		++bucketBegin[min(indices[2], indices[0]) + 2];
+	}
+	for (int iVert = 0; iVert <= vertexCount; ++iVert)
+		bucketBegin[iVert + 1] += bucketBegin[iVert];
+
+	// Fill the buckets with the edges' higher vertices.  The edge list is built in place in
+	// the same array at the end, so it's made big enough for that up front.
+	IntVector & higherVerts = pEdgesOut->m_verts;
+	higherVerts.clear();
+	higherVerts.resize(size_t(3) * size_t(triCount));
+	for (int iTri = 0; iTri < triCount; ++iTri)
+	{
+		const int * indices = &pIndices[3 * iTri];
+		higherVerts[bucketBegin[min(indices[0], indices[1]) + 1]++] = max(indices[0], indices[1]);
+		higherVerts[bucketBegin[min(indices[1], indices[2]) + 1]++] = max(indices[1], indices[2]);
+		higherVerts[bucketBegin[min(indices[2], indices[0]) + 1]++] = max(indices[2], indices[0]);
+	}
+
+	// Sort each bucket, with an insertion sort for the small ones that make up almost all of
+	// them, then pack its distinct edges down to the front of the array, counting the copies
+	// of each.  Packing only ever writes at or before the read position, so it can be done
+	// in place.
+	static const ptrdiff_t cInsertionSortMaxSize = 16;
+	std::vector<unsigned char, FaceWorks_Allocator<unsigned char>> & triCounts = pEdgesOut->m_triCounts;
+	triCounts.clear();
+	triCounts.resize(size_t(3) * size_t(triCount));
+	pEdgesOut->m_boundaryEdgeCount = 0;
+	int edgeCount = 0;
+	for (int iVert = 0; iVert < vertexCount; ++iVert)
+	{
+		int * pBegin = &higherVerts[0] + bucketBegin[iVert];
+		int * pEnd = &higherVerts[0] + bucketBegin[iVert + 1];
+		if (pEnd - pBegin > cInsertionSortMaxSize)
+		{
+			std::sort(pBegin, pEnd);
+		}
+		else
+		{
+			for (int * p = pBegin + 1; p < pEnd; ++p)
+			{
+				int value = *p;
+				int * q = p;
+				for (; q != pBegin && q[-1] > value; --q)
+					*q = q[-1];
+				*q = value;
+			}
+		}
+
+		// The next bucket's start is still needed, so this one's slot is reused to hold
+		// the start of the vertex's packed edges
+		bucketBegin[iVert] = edgeCount;
+		for (int * p = pBegin; p != pEnd; )
+		{
+			int value = *p;
+			int * pRunEnd = p + 1;
+			while (pRunEnd != pEnd && *pRunEnd == value)
+				++pRunEnd;
+			int copyCount = int(pRunEnd - p);
+			pEdgesOut->m_boundaryEdgeCount += (copyCount == 1) ? 1 : 0;
+			triCounts[edgeCount] = (unsigned char)min(copyCount, 255);
+			higherVerts[edgeCount++] = value;
+			p = pRunEnd;
+		}
+	}
+	bucketBegin[vertexCount] = edgeCount;
+
+	// Spread the packed edges out to vertex pairs, from the back so nothing is overwritten
+	// before it's read.  Boundary edges can make the pairs outgrow the triangles' edges, so
+	// reserve exactly the space needed, rather than let the resize grow it geometrically.
+	higherVerts.reserve(2 * size_t(edgeCount));
+	higherVerts.resize(2 * size_t(edgeCount));
+	triCounts.resize(size_t(edgeCount));
+
+	for (int iVert = vertexCount - 1; iVert >= 0; --iVert)
+	{
+		for (int iEdge = bucketBegin[iVert + 1] - 1; iEdge >= bucketBegin[iVert]; --iEdge)
+		{
+			higherVerts[2 * iEdge + 1] = higherVerts[iEdge];
+			higherVerts[2 * iEdge] = iVert;
+		}
+	}
+}
+
+void BuildMeshAdjacency(
+	int vertexCount,
+	const MeshEdges & edges,
+	MeshAdjacency * pAdjacencyOut)
+{
+	int edgeCount = edges.EdgeCount();
+	const int * pEdgeVerts = edgeCount > 0 ? &edges.m_verts[0] : nullptr;
+
+	// Count each vertex's neighbors, with the same shifted offsets as the edge buckets above
+	IntVector & begin = pAdjacencyOut->m_begin;
+	begin.assign(size_t(vertexCount) + 2, 0);
+	for (int iEdge = 0; iEdge < edgeCount; ++iEdge)
+	{
+		++begin[pEdgeVerts[2 * iEdge] + 2];
+		++begin[pEdgeVerts[2 * iEdge + 1] + 2];
+	}
+	for (int iVert = 0; iVert <= vertexCount; ++iVert)
+		begin[iVert + 1] += begin[iVert];
+
+	// Scatter each edge to both its vertices.  The edges are sorted by lower then higher
+	// vertex, so each list gets its lower neighbors, then its higher ones, both in order.
+	// A degenerate edge from a vertex to itself goes into its list twice, as a triangle
+	// would also have counted it once from each end.
+	pAdjacencyOut->m_neighbors.resize(2 * size_t(edgeCount));
+	pAdjacencyOut->m_weights.resize(2 * size_t(edgeCount));
+	int * pNeighbors = edgeCount > 0 ? &pAdjacencyOut->m_neighbors[0] : nullptr;
+	unsigned char * pWeights = edgeCount > 0 ? &pAdjacencyOut->m_weights[0] : nullptr;
+	for (int iEdge = 0; iEdge < edgeCount; ++iEdge)
+	{
+		int iVert0 = pEdgeVerts[2 * iEdge];
+		int iVert1 = pEdgeVerts[2 * iEdge + 1];
+		unsigned char weight = edges.m_triCounts[iEdge];
+
+		int iSlot0 = begin[iVert0 + 1]++;
+		pNeighbors[iSlot0] = iVert1;
+		pWeights[iSlot0] = weight;
+
+		int iSlot1 = begin[iVert1 + 1]++;
+		pNeighbors[iSlot1] = iVert0;
+		pWeights[iSlot1] = weight;
+	}
+
+	begin.resize(size_t(vertexCount) + 1);
+}
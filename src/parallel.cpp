@@ -0,0 +1,124 @@
+//----------------------------------------------------------------------------------
+// File:        FaceWorks/src/parallel.cpp
+// SDK Version: v1.0
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014-2016, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+#include "internal.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+
+
+int GetParallelWorkerCount(const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	if (!pParallelConfig)
+		return 1;
+
+	if (pParallelConfig->m_workerCount > 0)
+		return pParallelConfig->m_workerCount;
+
+	// hardware_concurrency() is allowed to return 0 if it can't tell
+	return max(1, int(std::thread::hardware_concurrency()));
+}
+
+// Shared state for the threads running a set of tasks; each thread just keeps
+// grabbing the next task index until they've all been taken.
+struct TaskQueue
+{
+	std::atomic<int>			m_iTaskNext;
+	int							m_taskCount;
+	GFSDK_FaceWorks_TaskFunc	m_pfnTask;
+	void *						m_pTaskData;
+};
+
+static void DrainTaskQueue(TaskQueue * pQueue)
+{
+	for (;;)
+	{
+		int iTask = pQueue->m_iTaskNext.fetch_add(1);
+		if (iTask >= pQueue->m_taskCount)
+			return;
+		pQueue->m_pfnTask(pQueue->m_pTaskData, iTask);
+	}
+}
+
+void RunParallel(
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig,
+	int taskCount,
+	GFSDK_FaceWorks_TaskFunc pfnTask,
+	void * pTaskData,
+	gfsdk_new_delete_t * pAllocator)
+{
+	if (taskCount <= 0)
+		return;
+
+	// Hand the tasks to the user's job system, if they gave us one
+	if (pParallelConfig && pParallelConfig->m_parallelFor)
+	{
+		pParallelConfig->m_parallelFor(pParallelConfig->m_pUserData, taskCount, pfnTask, pTaskData);
+		return;
+	}
+
+	TaskQueue queue;
+	queue.m_iTaskNext = 0;
+	queue.m_taskCount = taskCount;
+	queue.m_pfnTask = pfnTask;
+	queue.m_pTaskData = pTaskData;
+
+	// The calling thread works on the tasks too, so start one fewer worker than requested
+	int threadCount = min(GetParallelWorkerCount(pParallelConfig), taskCount) - 1;
+
+	FaceWorks_Allocator<std::thread> allocThread(pAllocator);
+	std::vector<std::thread, FaceWorks_Allocator<std::thread>> threads(allocThread);
+
+	if (threadCount > 0)
+	{
+		// If we run out of memory or threads, just go ahead with whatever workers
+		// did get started; the tasks will still all be run, only less in parallel.
+		try
+		{
+			threads.reserve(threadCount);
+			for (int i = 0; i < threadCount; ++i)
+				threads.push_back(std::thread(DrainTaskQueue, &queue));
+		}
+		catch (...)
+		{
+		}
+	}
+
+	DrainTaskQueue(&queue);
+
+	for (size_t i = 0; i < threads.size(); ++i)
+		threads[i].join();
+}
@@ -35,7 +35,10 @@
 
 #include "internal.h"
 
+#include <atomic>
 #include <cstdio>
+#include <cstring>
+#include <mutex>
 #include <vector>
 
 
@@ -53,7 +56,7 @@ GFSDK_FACEWORKS_API const char * GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GetBui
 #define STRINGIZE2(x) #x
 #define STRINGIZE(x) STRINGIZE2(x)
 
-	return 
+	static const char * staticInfo =
 		"GFSDK_FaceWorks_HeaderVersion: " STRINGIZE(GFSDK_FaceWorks_HeaderVersion) "\n"
 		"Built on: " __DATE__ " " __TIME__ "\n"
 
@@ -81,6 +84,17 @@ GFSDK_FACEWORKS_API const char * GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GetBui
 
 #undef STRINGIZE
 #undef STRINGIZE2
+
+	// The SIMD path is only known at runtime, so append it once on first call
+	static char buildInfo[512];
+	static std::once_flag buildInfoOnce;
+	std::call_once(buildInfoOnce, []()
+	{
+		_snprintf_s(buildInfo, dim(buildInfo), _TRUNCATE, "%sSIMD: %s\n",
+			staticInfo, GetSimdKernels()->m_name);
+	});
+
+	return buildInfo;
 }
 
 static const float pi = 3.141592654f;
@@ -157,7 +171,159 @@ GFSDK_FACEWORKS_API size_t GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateCur
 	return sizeof(float) * max(0, vertexCount);
 }
 
-GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateMeshCurvature(
+// Histogram bin of a curvature in GFSDK_FaceWorks_CurvatureStats
+static int CurvatureHistogramBin(float curvature)
+{
+	if (!(curvature > 0.0f))
+		return 0;
+	float bin = (log2(curvature) - float(GFSDK_FaceWorks_CurvatureHistogramMinLog2)) *
+				float(GFSDK_FaceWorks_CurvatureHistogramBinsPerOctave) + 1.0f;
+	return int(max(0.0f, min(float(GFSDK_FaceWorks_CurvatureHistogramBinCount - 1), floorf(bin))));
+}
+
+// Lower edge of a histogram bin; bin 0 is treated as starting at 2^MinLog2, like bin 1,
+// as the curvatures below that are flat for all practical purposes
+static float CurvatureHistogramBinEdge(int iBin)
+{
+	return powf(2.0f, float(GFSDK_FaceWorks_CurvatureHistogramMinLog2) +
+					float(max(0, iBin - 1)) / float(GFSDK_FaceWorks_CurvatureHistogramBinsPerOctave));
+}
+
+// Percentile of a sorted array, interpolating between the nearest two values
+template <typename Vec>
+static float SortedPercentile(const Vec & sorted, float percentile)
+{
+	float pos = 0.01f * percentile * float(sorted.size() - 1);
+	size_t i = min(size_t(pos), sorted.size() - 1);
+	size_t iNext = min(i + 1, sorted.size() - 1);
+	float t = pos - float(i);
+	return sorted[i] + t * (sorted[iNext] - sorted[i]);
+}
+
+void CalculateCurvatureStats(
+	int vertexCount,
+	const void * pCurvatures,
+	int curvatureStrideBytes,
+	GFSDK_FaceWorks_CurvatureStats * pStatsOut,
+	gfsdk_new_delete_t * pAllocator)
+{
+	FaceWorks_Allocator<float> allocFloat(pAllocator);
+	std::vector<float, FaceWorks_Allocator<float>> sorted(allocFloat);
+	sorted.resize(vertexCount);
+
+	memset(pStatsOut, 0, sizeof(*pStatsOut));
+	pStatsOut->m_vertexCount = vertexCount;
+
+	double curvatureSum = 0.0;
+	for (int i = 0; i < vertexCount; ++i)
+	{
+		float curvature = *reinterpret_cast<const float *>((const char *)pCurvatures + i * curvatureStrideBytes);
+		sorted[i] = curvature;
+		curvatureSum += curvature;
+		++pStatsOut->m_histogram[CurvatureHistogramBin(curvature)];
+	}
+
+	std::sort(sorted.begin(), sorted.end());
+
+	pStatsOut->m_curvatureMin = sorted.front();
+	pStatsOut->m_curvatureMax = sorted.back();
+	pStatsOut->m_curvatureMean = float(curvatureSum / double(vertexCount));
+	pStatsOut->m_curvatureP1 = SortedPercentile(sorted, 1.0f);
+	pStatsOut->m_curvatureP5 = SortedPercentile(sorted, 5.0f);
+	pStatsOut->m_curvatureMedian = SortedPercentile(sorted, 50.0f);
+	pStatsOut->m_curvatureP95 = SortedPercentile(sorted, 95.0f);
+	pStatsOut->m_curvatureP99 = SortedPercentile(sorted, 99.0f);
+}
+
+// One smoothing pass over verts [iBegin, iEnd): set each one's curvature to the weighted
+// average of its neighbors' curvatures in pSrc
+static void SmoothCurvatures(
+	const MeshAdjacency & adjacency,
+	const float * pSrc,
+	int iBegin,
+	int iEnd,
+	float * pDst)
+{
+	for (int i = iBegin; i < iEnd; ++i)
+		pDst[i] = SmoothedCurvature(adjacency, pSrc, i);
+}
+
+void CalculateVertexCurvatures(
+	int vertexCount,
+	const void * pPositions,
+	int positionStrideBytes,
+	const void * pNormals,
+	int normalStrideBytes,
+	const MeshEdges & edges,
+	const MeshAdjacency & adjacency,
+	int smoothingPassCount,
+	std::vector<float, FaceWorks_Allocator<float>> * pCurvaturesOut,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig,
+	gfsdk_new_delete_t * pAllocator)
+{
+	// Calculate per-vertex curvature.  We do this by estimating the curvature along each
+	// edge using the change in normals between its vertices; then we set each vertex's
+	// curvature to the midpoint of the minimum and maximum over all the edges touching it.
+
+	FaceWorks_Allocator<float> allocFloat(pAllocator);
+	std::vector<float, FaceWorks_Allocator<float>> & curvatureMin = *pCurvaturesOut;
+	curvatureMin.assign(vertexCount, FLT_MAX);
+	std::vector<float, FaceWorks_Allocator<float>> curvatureMax(vertexCount, 0.0f, allocFloat);
+
+	// Each edge is shared by two triangles, except on the boundary, so work from the
+	// unique edges to calculate each one's curvature once.  Edges are processed in
+	// batches so the edge math can run on full SIMD vectors.
+
+	const SimdKernels * pKernels = GetSimdKernels();
+	static const int cEdgeBatch = 768;
+	float edgeCurvatures[cEdgeBatch];
+	int edgeCount = edges.EdgeCount();
+
+	for (int iEdgeBegin = 0; iEdgeBegin < edgeCount; iEdgeBegin += cEdgeBatch)
+	{
+		int batchEdgeCount = min(cEdgeBatch, edgeCount - iEdgeBegin);
+		const int * pEdgeVerts = &edges.m_verts[2 * iEdgeBegin];
+		pKernels->m_pfnCalculateEdgeCurvatures(
+					pPositions, positionStrideBytes,
+					pNormals, normalStrideBytes,
+					pEdgeVerts, batchEdgeCount,
+					edgeCurvatures);
+
+		for (int iEdge = 0; iEdge < batchEdgeCount; ++iEdge)
+		{
+			float curvature = edgeCurvatures[iEdge];
+			int iVert0 = pEdgeVerts[2 * iEdge];
+			int iVert1 = pEdgeVerts[2 * iEdge + 1];
+			curvatureMin[iVert0] = min(curvatureMin[iVert0], curvature);
+			curvatureMin[iVert1] = min(curvatureMin[iVert1], curvature);
+			curvatureMax[iVert0] = max(curvatureMax[iVert0], curvature);
+			curvatureMax[iVert1] = max(curvatureMax[iVert1], curvature);
+		}
+	}
+
+	// The curvatures are built in curvatureMin's storage, and curvatureMax's is reused as
+	// the other buffer for the smoothing passes
+	std::vector<float, FaceWorks_Allocator<float>> & curvatures = curvatureMin;
+	std::vector<float, FaceWorks_Allocator<float>> & curvaturesScratch = curvatureMax;
+	for (int i = 0; i < vertexCount; ++i)
+		curvatures[i] = 0.5f * (curvatureMin[i] + curvatureMax[i]);
+
+	// Run a couple of smoothing passes, replacing each vert's curvature by the average of
+	// its neighbors'.  Each pass gathers from the neighbor lists into the other buffer, so
+	// the verts are independent and can be split over threads.
+	for (int iPass = 0; iPass < smoothingPassCount; ++iPass)
+	{
+		const float * pSrc = &curvatures[0];
+		float * pDst = &curvaturesScratch[0];
+		ParallelForRanges(pParallelConfig, vertexCount, [&](int iBegin, int iEnd)
+		{
+			SmoothCurvatures(adjacency, pSrc, iBegin, iEnd, pDst);
+		}, pAllocator);
+		curvatures.swap(curvaturesScratch);
+	}
+}
+
+static GFSDK_FaceWorks_Result CalculateMeshCurvature(
 	int vertexCount,
 	const void * pPositions,
 	int positionStrideBytes,
@@ -168,8 +334,10 @@ GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWo
 	int smoothingPassCount,
 	void * pCurvaturesOut,
 	int curvatureStrideBytes,
+	GFSDK_FaceWorks_CurvatureStats * pStatsOut,
 	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
-	gfsdk_new_delete_t * pAllocator /*= 0*/)
+	gfsdk_new_delete_t * pAllocator,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
 {
 	// Validate parameters
 	if (vertexCount < 1)
@@ -226,88 +394,42 @@ GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWo
 		return GFSDK_FaceWorks_InvalidArgument;
 	}
 
-	// Calculate per-vertex curvature.  We do this by estimating the curvature along each
-	// edge using the change in normals between its vertices; then we set each vertex's
-	// curvature to the midpoint of the minimum and maximum over all the edges touching it.
-
 	int triCount = indexCount / 3;
+	for (int i = 0; i < 3 * triCount; ++i)
+	{
+		if (pIndices[i] < 0 || pIndices[i] >= vertexCount)
+		{
+			ErrPrintf("pIndices[%d] is %d; should be in [0, %d)\n", i, pIndices[i], vertexCount);
+			return GFSDK_FaceWorks_InvalidArgument;
+		}
+	}
 
 	// Catch out-of-memory exceptions
 	try
 	{
-		FaceWorks_Allocator<float> allocFloat(pAllocator);
-		std::vector<float, FaceWorks_Allocator<float>> curvatureMin(vertexCount, FLT_MAX, allocFloat);
-		std::vector<float, FaceWorks_Allocator<float>> curvatureMax(vertexCount, 0.0f, allocFloat);
-
-		// !!!UNDONE: SIMD-ize or GPU-ize all this math
-
-		for (int iTri = 0; iTri < triCount; ++iTri)
-		{
-			int indices[] =
-			{
-				pIndices[3*iTri],
-				pIndices[3*iTri + 1],
-				pIndices[3*iTri + 2],
-			};
+		MeshEdges edges(pAllocator);
+		BuildMeshEdges(vertexCount, triCount, pIndices, &edges, pAllocator);
 
-			float * pos[] =
-			{
-				reinterpret_cast<float *>((char *)pPositions + indices[0] * positionStrideBytes),
-				reinterpret_cast<float *>((char *)pPositions + indices[1] * positionStrideBytes),
-				reinterpret_cast<float *>((char *)pPositions + indices[2] * positionStrideBytes),
-			};
+		// The neighbor lists are only needed for smoothing
+		MeshAdjacency adjacency(pAllocator);
+		if (smoothingPassCount > 0)
+			BuildMeshAdjacency(vertexCount, edges, &adjacency);
 
-			float * normal[] =
-			{
-				reinterpret_cast<float *>((char *)pNormals + indices[0] * normalStrideBytes),
-				reinterpret_cast<float *>((char *)pNormals + indices[1] * normalStrideBytes),
-				reinterpret_cast<float *>((char *)pNormals + indices[2] * normalStrideBytes),
-			};
-
-			// Calculate each edge's curvature - most edges will be calculated twice this
-			// way, but it's hard to fix that while still making sure to handle boundary edges.
-
-			float dPx = pos[1][0] - pos[0][0];
-			float dPy = pos[1][1] - pos[0][1];
-			float dPz = pos[1][2] - pos[0][2];
-			float dNx = normal[1][0] - normal[0][0];
-			float dNy = normal[1][1] - normal[0][1];
-			float dNz = normal[1][2] - normal[0][2];
-			float curvature = sqrtf((dNx*dNx + dNy*dNy + dNz*dNz) / (dPx*dPx + dPy*dPy + dPz*dPz));
-			curvatureMin[indices[0]] = min(curvatureMin[indices[0]], curvature);
-			curvatureMin[indices[1]] = min(curvatureMin[indices[1]], curvature);
-			curvatureMax[indices[0]] = max(curvatureMax[indices[0]], curvature);
-			curvatureMax[indices[1]] = max(curvatureMax[indices[1]], curvature);
-
-			dPx = pos[2][0] - pos[1][0];
-			dPy = pos[2][1] - pos[1][1];
-			dPz = pos[2][2] - pos[1][2];
-			dNx = normal[2][0] - normal[1][0];
-			dNy = normal[2][1] - normal[1][1];
-			dNz = normal[2][2] - normal[1][2];
-			curvature = sqrtf((dNx*dNx + dNy*dNy + dNz*dNz) / (dPx*dPx + dPy*dPy + dPz*dPz));
-			curvatureMin[indices[1]] = min(curvatureMin[indices[1]], curvature);
-			curvatureMin[indices[2]] = min(curvatureMin[indices[2]], curvature);
-			curvatureMax[indices[1]] = max(curvatureMax[indices[1]], curvature);
-			curvatureMax[indices[2]] = max(curvatureMax[indices[2]], curvature);
-
-			dPx = pos[0][0] - pos[2][0];
-			dPy = pos[0][1] - pos[2][1];
-			dPz = pos[0][2] - pos[2][2];
-			dNx = normal[0][0] - normal[2][0];
-			dNy = normal[0][1] - normal[2][1];
-			dNz = normal[0][2] - normal[2][2];
-			curvature = sqrtf((dNx*dNx + dNy*dNy + dNz*dNz) / (dPx*dPx + dPy*dPy + dPz*dPz));
-			curvatureMin[indices[2]] = min(curvatureMin[indices[2]], curvature);
-			curvatureMin[indices[0]] = min(curvatureMin[indices[0]], curvature);
-			curvatureMax[indices[2]] = max(curvatureMax[indices[2]], curvature);
-			curvatureMax[indices[0]] = max(curvatureMax[indices[0]], curvature);
-		}
+		FaceWorks_Allocator<float> allocFloat(pAllocator);
+		std::vector<float, FaceWorks_Allocator<float>> curvatures(allocFloat);
+		CalculateVertexCurvatures(
+			vertexCount,
+			pPositions, positionStrideBytes,
+			pNormals, normalStrideBytes,
+			edges, adjacency,
+			smoothingPassCount,
+			&curvatures,
+			pParallelConfig, pAllocator);
 
 		for (int i = 0; i < vertexCount; ++i)
 		{
 			float * pCurvature = reinterpret_cast<float *>((char *)pCurvaturesOut + i * curvatureStrideBytes);
-			*pCurvature = 0.5f * (curvatureMin[i] + curvatureMax[i]);
+			*pCurvature = curvatures[i];
 		}
 	}
 	catch (std::bad_alloc)
@@ -315,59 +437,12 @@ GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWo
 		return GFSDK_FaceWorks_OutOfMemory;
 	}
 
-	if (smoothingPassCount > 0)
+	if (pStatsOut)
 	{
 		// Catch out-of-memory exceptions
 		try
 		{
-			FaceWorks_Allocator<float> allocFloat(pAllocator);
-			std::vector<float, FaceWorks_Allocator<float>> curvatureSum(allocFloat);
-			curvatureSum.resize(vertexCount);
-
-			FaceWorks_Allocator<int> allocInt(pAllocator);
-			std::vector<int, FaceWorks_Allocator<int>> curvatureCount(allocInt);
-			curvatureCount.resize(vertexCount);
-
-			// Run a couple of smoothing passes, replacing each vert's curvature
-			// by the average of its neighbors'
-
-			for (int iPass = 0; iPass < smoothingPassCount; ++iPass)
-			{
-				for (int i = 0; i < vertexCount; ++i)
-				{
-					curvatureSum[i] = 0.0f;
-					curvatureCount[i] = 0;
-				}
-
-				for (int iTri = 0; iTri < triCount; ++iTri)
-				{
-					int indices[] =
-					{
-						pIndices[3*iTri],
-						pIndices[3*iTri + 1],
-						pIndices[3*iTri + 2],
-					};
-
-					float curvature0 = *reinterpret_cast<float *>((char *)pCurvaturesOut + indices[0] * curvatureStrideBytes);
-					float curvature1 = *reinterpret_cast<float *>((char *)pCurvaturesOut + indices[1] * curvatureStrideBytes);
-					float curvature2 = *reinterpret_cast<float *>((char *)pCurvaturesOut + indices[2] * curvatureStrideBytes);
-
-					curvatureSum[indices[0]] += curvature1 + curvature2;
-					curvatureCount[indices[0]] += 2;
-
-					curvatureSum[indices[1]] += curvature2 + curvature0;
-					curvatureCount[indices[1]] += 2;
-
-					curvatureSum[indices[2]] += curvature0 + curvature1;
-					curvatureCount[indices[2]] += 2;
-				}
-
-				for (int i = 0; i < vertexCount; ++i)
-				{
-					float * pCurvature = reinterpret_cast<float *>((char *)pCurvaturesOut + i * curvatureStrideBytes);
-					*pCurvature = curvatureSum[i] / float(max(1, curvatureCount[i]));
-				}
-			}
+			CalculateCurvatureStats(vertexCount, pCurvaturesOut, curvatureStrideBytes, pStatsOut, pAllocator);
 		}
 		catch (std::bad_alloc)
 		{
@@ -378,6 +453,65 @@ GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWo
 	return GFSDK_FaceWorks_OK;
 }
 
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateMeshCurvature(
+	int vertexCount,
+	const void * pPositions,
+	int positionStrideBytes,
+	const void * pNormals,
+	int normalStrideBytes,
+	int indexCount,
+	const int * pIndices,
+	int smoothingPassCount,
+	void * pCurvaturesOut,
+	int curvatureStrideBytes,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	gfsdk_new_delete_t * pAllocator,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	return CalculateMeshCurvature(
+				vertexCount,
+				pPositions, positionStrideBytes,
+				pNormals, normalStrideBytes,
+				indexCount, pIndices,
+				smoothingPassCount,
+				pCurvaturesOut, curvatureStrideBytes,
+				nullptr,
+				pErrorBlobOut, pAllocator, pParallelConfig);
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateMeshCurvatureWithStats(
+	int vertexCount,
+	const void * pPositions,
+	int positionStrideBytes,
+	const void * pNormals,
+	int normalStrideBytes,
+	int indexCount,
+	const int * pIndices,
+	int smoothingPassCount,
+	void * pCurvaturesOut,
+	int curvatureStrideBytes,
+	GFSDK_FaceWorks_CurvatureStats * pStatsOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	gfsdk_new_delete_t * pAllocator,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	if (!pStatsOut)
+	{
+		ErrPrintf("pStatsOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	return CalculateMeshCurvature(
+				vertexCount,
+				pPositions, positionStrideBytes,
+				pNormals, normalStrideBytes,
+				indexCount, pIndices,
+				smoothingPassCount,
+				pCurvaturesOut, curvatureStrideBytes,
+				pStatsOut,
+				pErrorBlobOut, pAllocator, pParallelConfig);
+}
+
 
 
 GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateMeshUVScale(
@@ -444,65 +578,12 @@ GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWo
 
 	float logUvScaleSum = 0.0f;
 	int logUvScaleCount = 0;
-
-	// !!!UNDONE: SIMD-ize or GPU-ize all this math
-
-	for (int iIndex = 0; iIndex < indexCount; iIndex += 3)
-	{
-		int indices[] =
-		{
-			pIndices[iIndex],
-			pIndices[iIndex + 1],
-			pIndices[iIndex + 2],
-		};
-
-		float * pos[] =
-		{
-			reinterpret_cast<float *>((char *)pPositions + indices[0] * positionStrideBytes),
-			reinterpret_cast<float *>((char *)pPositions + indices[1] * positionStrideBytes),
-			reinterpret_cast<float *>((char *)pPositions + indices[2] * positionStrideBytes),
-		};
-
-		float * uv[] =
-		{
-			reinterpret_cast<float *>((char *)pUVs + indices[0] * uvStrideBytes),
-			reinterpret_cast<float *>((char *)pUVs + indices[1] * uvStrideBytes),
-			reinterpret_cast<float *>((char *)pUVs + indices[2] * uvStrideBytes),
-		};
-
-		// Find longest edge length in local space
-		float dP0x = pos[1][0] - pos[0][0];
-		float dP0y = pos[1][1] - pos[0][1];
-		float dP0z = pos[1][2] - pos[0][2];
-		float dP1x = pos[2][0] - pos[1][0];
-		float dP1y = pos[2][1] - pos[1][1];
-		float dP1z = pos[2][2] - pos[1][2];
-		float dP2x = pos[0][0] - pos[2][0];
-		float dP2y = pos[0][1] - pos[2][1];
-		float dP2z = pos[0][2] - pos[2][2];
-		float diameter = sqrtf(max(dP0x*dP0x + dP0y*dP0y + dP0z*dP0z, 
-							   max(dP1x*dP1x + dP1y*dP1y + dP1z*dP1z,
-								   dP2x*dP2x + dP2y*dP2y + dP2z*dP2z)));
-
-		// Find longest edge length in UV space
-		float dUV0x = uv[1][0] - uv[0][0];
-		float dUV0y = uv[1][1] - uv[0][1];
-		float dUV1x = uv[2][0] - uv[1][0];
-		float dUV1y = uv[2][1] - uv[1][1];
-		float dUV2x = uv[0][0] - uv[2][0];
-		float dUV2y = uv[0][1] - uv[2][1];
-		float uvDiameter = sqrtf(max(dUV0x*dUV0x + dUV0y*dUV0y, 
-								 max(dUV1x*dUV1x + dUV1y*dUV1y,
-									 dUV2x*dUV2x + dUV2y*dUV2y)));
-
-		// Skip degenerate triangles
-		if (diameter < 1e-6f || uvDiameter < 1e-6f)
-			continue;
-
-		float triUvScale = diameter / uvDiameter;
-		logUvScaleSum += logf(triUvScale);
-		++logUvScaleCount;
-	}
+	GetSimdKernels()->m_pfnSumTriangleLogUVScales(
+						pPositions, positionStrideBytes,
+						nullptr,
+						pUVs, uvStrideBytes,
+						pIndices, indexCount / 3,
+						&logUvScaleSum, &logUvScaleCount);
 
 	*pAverageUVScaleOut = expf(logUvScaleSum / float(logUvScaleCount));
 
@@ -530,189 +611,1737 @@ inline float Gaussian(float sigma, float x)
 	return (rsqrtTwoPi / sigma) * expf(-0.5f * (x*x) / (sigma*sigma));
 }
 
-static void EvaluateDiffusionProfile(float x, float rgb[3])	// x in millimeters
+// Integration rules for the diffusion profile.
+//
+// Midpoint: the profile is sampled at evenly spaced points, and each texel is a weighted
+// sum of its lighting function over the samples.  Simple and robust, but it takes a lot of
+// samples to resolve both the narrowest Gaussian in the profile and the kinks in the lighting
+// functions (the terminator for curvature, the ends of the smoothstep for shadows).
+//
+// Piecewise: each Gaussian lobe of the profile is integrated separately, in units of its own
+// standard deviation, and each texel's integral is split at the kinks of its lighting function.
+// Between the kinks the integrand is smooth, so it's looked up from running-integral tables,
+// interpolated with cubic Hermite splines using the integrand itself as the derivative.
+//
+// Analytic (shadow LUT only): the shadow's lighting function is piecewise polynomial, so
+// each lobe's integral is a combination of the normal distribution's partial moments,
+// which have closed forms in terms of erf and the Gaussian itself.  They're evaluated in single
+// precision, across a batch of texels at a time, by a SIMD kernel.
+//
+// Convolution (curvature LUT only): each row is the clamped cosine convolved around the
+// circle with the profile, scaled by the row's curvature.  The profile's mass is binned onto
+// an evenly spaced grid of angles, and the sliding window (the half of the circle on the lit
+// side of the terminator) is summed from running sums over the bins, once per row at each
+// bin edge; each texel then interpolates the window sums at its column's angle, which every
+// row shares, so the cost of a row is linear in the bin count plus the LUT width.
+
+// Midpoint rule sample counts per texel
+static const int cMidpointSampleCountDefault = 200;
+static const int cMidpointSampleCountMax = 512;
+
+// Piecewise rule table cells per lobe
+static const int cPiecewiseCellCountDefault = 48;
+static const int cPiecewiseCellCountMin = 8;
+static const int cPiecewiseCellCountMax = 64;
+
+// Convolution rule bins around the circle
+static const int cConvolutionBinCountDefault = 512;
+static const int cConvolutionBinCountMin = 64;
+static const int cConvolutionBinCountMax = 16384;
+
+// Standard deviations each side of a lobe's center covered by its tables;
+// the Gaussian's mass outside this is negligible
+static const float cLobeExtent = 6.0f;
+
+static const int cLobeCount = int(dim(diffusionSigmas));
+
+// The integration rule for a whole LUT
+struct IntegrationRule
 {
-	rgb[0] = 0.0f;
-	rgb[1] = 0.0f;
-	rgb[2] = 0.0f;
-
-	for (int i = 0; i < dim(diffusionSigmas); ++i)
-	{
-		static const float rsqrtTwoPi = 0.39894228f;
-		float sigma = diffusionSigmas[i];
-		float gaussian = (rsqrtTwoPi / sigma) * expf(-0.5f * (x*x) / (sigma*sigma));
-
-		rgb[0] += diffusionWeightsR[i] * gaussian;
-		rgb[1] += diffusionWeightsG[i] * gaussian;
-		rgb[2] += diffusionWeightsB[i] * gaussian;
-	}
-}
-
-GFSDK_FACEWORKS_API size_t GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateCurvatureLUTSizeBytes(
-	const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig)
+	GFSDK_FaceWorks_LUTIntegrationMode	m_mode;
+	int		m_sampleCount;		// Midpoint samples per texel, piecewise table cells per lobe, or convolution bins
+};
+
+// Precomputed samples of the diffusion profile for the midpoint rule, used as the
+// integration kernel for a whole LUT (shadow) or a whole LUT row (curvature).  The
+// weights include the size of the integration step, so integrating a texel is just
+// a weighted sum over the samples.  Unused samples at the end have zero weight,
+// padding the count to a multiple of the widest SIMD vector so the integration
+// kernels never need to copy out a partial last vector.
+struct ProfileKernel
 {
-	if (!pConfig)
-		return 0;
+	int		m_sampleCount;							// Including padding
+	float	m_delta[cMidpointSampleCountMax];		// Sample positions, in mm
+	float	m_weightsR[cMidpointSampleCountMax];	// Diffusion profile at each sample, times step size
+	float	m_weightsG[cMidpointSampleCountMax];
+	float	m_weightsB[cMidpointSampleCountMax];
+};
+
+// Running integral of f(z) * N(z) over [-cLobeExtent, cLobeExtent], where N is the standard
+// normal distribution, at the cell boundaries of an evenly spaced grid
+struct RunningIntegral
+{
+	double	m_value[cPiecewiseCellCountMax + 1];		// Integral from -cLobeExtent to each node
+	double	m_integrand[cPiecewiseCellCountMax + 1];	// f(z) * N(z) at each node
+};
 
-	return 4 * pConfig->m_texWidth * pConfig->m_texHeight;
-}
+// Where a point falls in a RunningIntegral's grid, and its cubic Hermite basis weights
+struct RunningIntegralCoords
+{
+	int		m_iCell;
+	double	m_weights[4];
+};
 
-GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GenerateCurvatureLUT(
-	const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig,
-	void * pCurvatureLUTOut,
+static GFSDK_FaceWorks_Result ValidateIntegrationRule(
+	GFSDK_FaceWorks_LUTIntegrationMode mode,
+	int sampleCount,
 	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut)
 {
-	// Validate parameters
-	if (!pConfig)
-	{
-		ErrPrintf("pConfig is null\n");
-		return GFSDK_FaceWorks_InvalidArgument;
-	}
-	if (!pCurvatureLUTOut)
-	{
-		ErrPrintf("pCurvatureLUTOut is null\n");
-		return GFSDK_FaceWorks_InvalidArgument;
-	}
-	if (pConfig->m_diffusionRadius <= 0.0f)
-	{
-		ErrPrintf("m_diffusionRadius is %g; should be greater than 0\n",
-			pConfig->m_diffusionRadius);
-		return GFSDK_FaceWorks_InvalidArgument;
-	}
-	if (pConfig->m_texWidth < 1)
-	{
-		ErrPrintf("m_texWidth is %d; should be at least 1\n",
-			pConfig->m_texWidth);
-		return GFSDK_FaceWorks_InvalidArgument;
-	}
-	if (pConfig->m_texHeight < 1)
-	{
-		ErrPrintf("m_texHeight is %d; should be at least 1\n",
-			pConfig->m_texHeight);
-		return GFSDK_FaceWorks_InvalidArgument;
-	}
-	if (pConfig->m_curvatureRadiusMin <= 0.0f)
-	{
-		ErrPrintf("m_curvatureRadiusMin is %g; should be greater than 0\n",
-			pConfig->m_curvatureRadiusMin);
-		return GFSDK_FaceWorks_InvalidArgument;
-	}
-	if (pConfig->m_curvatureRadiusMax <= 0.0f)
-	{
-		ErrPrintf("m_curvatureRadiusMax is %g; should be greater than 0\n",
-			pConfig->m_curvatureRadiusMax);
-		return GFSDK_FaceWorks_InvalidArgument;
-	}
-	if (pConfig->m_curvatureRadiusMax < pConfig->m_curvatureRadiusMin)
+	switch (mode)
 	{
-		ErrPrintf("m_curvatureRadiusMin is %g and m_curvatureRadiusMax is %g; max should be greater than min\n",
-			pConfig->m_curvatureRadiusMin, pConfig->m_curvatureRadiusMax);
-		return GFSDK_FaceWorks_InvalidArgument;
-	}
-	
-	// The diffusion profile is built assuming a (standard human skin) radius
-	// of 2.7 mm, so the curvatures and shadow widths need to be scaled to generate
-	// a LUT for the user's desired diffusion radius.
-	float diffusionRadiusFactor = pConfig->m_diffusionRadius / 2.7f;
+	case GFSDK_FaceWorks_LUTIntegration_Midpoint:
+		if (sampleCount < 0 || sampleCount > cMidpointSampleCountMax)
+		{
+			ErrPrintf("m_integrationSampleCount is %d; should be 0 or at most %d for midpoint integration\n",
+				sampleCount, cMidpointSampleCountMax);
+			return GFSDK_FaceWorks_InvalidArgument;
+		}
+		break;
 
-	float curvatureMin = diffusionRadiusFactor / pConfig->m_curvatureRadiusMax;
-	float curvatureMax = diffusionRadiusFactor / pConfig->m_curvatureRadiusMin;
-	float curvatureScale = (curvatureMax - curvatureMin) / float(pConfig->m_texHeight);
-	float curvatureBias = curvatureMin + 0.5f * curvatureScale;
+	case GFSDK_FaceWorks_LUTIntegration_Piecewise:
+		if (sampleCount != 0 && (sampleCount < cPiecewiseCellCountMin || sampleCount > cPiecewiseCellCountMax))
+		{
+			ErrPrintf("m_integrationSampleCount is %d; should be 0 or in [%d, %d] for piecewise integration\n",
+				sampleCount, cPiecewiseCellCountMin, cPiecewiseCellCountMax);
+			return GFSDK_FaceWorks_InvalidArgument;
+		}
+		break;
 
-	float NdotLScale = 2.0f / float(pConfig->m_texWidth);
-	float NdotLBias = -1.0f + 0.5f * NdotLScale;
+	case GFSDK_FaceWorks_LUTIntegration_Analytic:
+		// Sample count is ignored
+		break;
 
-	unsigned char * pPx = static_cast<unsigned char *>(pCurvatureLUTOut);
+	case GFSDK_FaceWorks_LUTIntegration_Convolution:
+		if (sampleCount != 0 &&
+			(sampleCount < cConvolutionBinCountMin || sampleCount > cConvolutionBinCountMax || (sampleCount & 3) != 0))
+		{
+			ErrPrintf("m_integrationSampleCount is %d; should be 0 or a multiple of 4 in [%d, %d] for convolution\n",
+				sampleCount, cConvolutionBinCountMin, cConvolutionBinCountMax);
+			return GFSDK_FaceWorks_InvalidArgument;
+		}
+		break;
 
-	// !!!UNDONE: SIMD-ize or GPU-ize all this math
+	default:
+		ErrPrintf("m_integrationMode is %d; should be one of the GFSDK_FaceWorks_LUTIntegrationMode values\n",
+			int(mode));
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
 
-	for (int iY = 0; iY < pConfig->m_texHeight; ++iY)
-	{
-		for (int iX = 0; iX < pConfig->m_texWidth; ++iX)
-		{
-			float NdotL = float(iX) * NdotLScale + NdotLBias;
-			float theta = acosf(NdotL);
+	return GFSDK_FaceWorks_OK;
+}
 
-			float curvature = float(iY) * curvatureScale + curvatureBias;
-			float radius = 1.0f / curvature;
+static void SetupIntegrationRule(
+	GFSDK_FaceWorks_LUTIntegrationMode mode,
+	int sampleCount,
+	IntegrationRule * pRule)
+{
+	pRule->m_mode = mode;
 
-			// Sample points around a ring, and Monte-Carlo-integrate the
-			// scattered lighting using the diffusion profile
+	switch (mode)
+	{
+	case GFSDK_FaceWorks_LUTIntegration_Midpoint:
+		pRule->m_sampleCount = (sampleCount > 0) ? sampleCount : cMidpointSampleCountDefault;
+		break;
 
-			static const int cIter = 200;
-			float rgb[3] = { 0.0f, 0.0f, 0.0f };
+	case GFSDK_FaceWorks_LUTIntegration_Piecewise:
+		pRule->m_sampleCount = (sampleCount > 0) ? sampleCount : cPiecewiseCellCountDefault;
+		break;
 
-			// Set integration bounds in arc-length in mm on the sphere
-			float lowerBound = max(-pi*radius, -10.0f);
-			float upperBound = min(pi*radius, 10.0f);
+	case GFSDK_FaceWorks_LUTIntegration_Analytic:
+		pRule->m_sampleCount = 0;
+		break;
 
-			float iterScale = (upperBound - lowerBound) / float(cIter);
-			float iterBias = lowerBound + 0.5f * iterScale;
+	case GFSDK_FaceWorks_LUTIntegration_Convolution:
+		pRule->m_sampleCount = (sampleCount > 0) ? sampleCount : cConvolutionBinCountDefault;
+		break;
+	}
+}
 
-			for (int iIter = 0; iIter < cIter; ++iIter)
-			{
-				float delta = float(iIter) * iterScale + iterBias;
-				float rgbDiffusion[3];
-				EvaluateDiffusionProfile(delta, rgbDiffusion);
-
-				float NdotLDelta = max(0.0f, cosf(theta - delta * curvature));
-				rgb[0] += NdotLDelta * rgbDiffusion[0];
-				rgb[1] += NdotLDelta * rgbDiffusion[1];
-				rgb[2] += NdotLDelta * rgbDiffusion[2];
-			}
+static bool IsSameIntegrationRule(const IntegrationRule & a, const IntegrationRule & b)
+{
+	return a.m_mode == b.m_mode && a.m_sampleCount == b.m_sampleCount;
+}
 
-			// Scale sum of samples to get value of integral
-			float scale = (upperBound - lowerBound) / float(cIter);
-			rgb[0] *= scale;
-			rgb[1] *= scale;
-			rgb[2] *= scale;
+static void BuildProfileKernel(
+	int sampleCount,
+	float lowerBound,
+	float upperBound,
+	ProfileKernel * pKernel)
+{
+	float iterScale = (upperBound - lowerBound) / float(sampleCount);
+	float iterBias = lowerBound + 0.5f * iterScale;
 
-			// Calculate delta from standard diffuse lighting (saturate(N.L)) to
-			// scattered result, remapped from [-.25, .25] to [0, 1].
-			float rgbAdjust = -max(0.0f, NdotL) * 2.0f + 0.5f;
-			rgb[0] = rgb[0] * 2.0f + rgbAdjust;
-			rgb[1] = rgb[1] * 2.0f + rgbAdjust;
-			rgb[2] = rgb[2] * 2.0f + rgbAdjust;
+	for (int iIter = 0; iIter < sampleCount; ++iIter)
+		pKernel->m_delta[iIter] = float(iIter) * iterScale + iterBias;
 
-			// Clamp to [0, 1]
-			rgb[0] = min(max(rgb[0], 0.0f), 1.0f);
-			rgb[1] = min(max(rgb[1], 0.0f), 1.0f);
-			rgb[2] = min(max(rgb[2], 0.0f), 1.0f);
+	// Evaluate the diffusion profile at the sample positions, in mm
+	GetSimdKernels()->m_pfnEvaluateGaussianMixture(
+						pKernel->m_delta, sampleCount,
+						diffusionSigmas, diffusionWeightsR, diffusionWeightsG, diffusionWeightsB, cLobeCount,
+						iterScale, pKernel->m_weightsR, pKernel->m_weightsG, pKernel->m_weightsB);
 
-			// Convert to integer format (linear RGB space)
-			*(pPx++) = static_cast<unsigned char>(255.0f * rgb[0] + 0.5f);
-			*(pPx++) = static_cast<unsigned char>(255.0f * rgb[1] + 0.5f);
-			*(pPx++) = static_cast<unsigned char>(255.0f * rgb[2] + 0.5f);
-			*(pPx++) = 255;
-		}
+	int paddedSampleCount = (sampleCount + 15) & ~15;
+	for (int iIter = sampleCount; iIter < paddedSampleCount; ++iIter)
+	{
+		pKernel->m_delta[iIter] = 0.0f;
+		pKernel->m_weightsR[iIter] = 0.0f;
+		pKernel->m_weightsG[iIter] = 0.0f;
+		pKernel->m_weightsB[iIter] = 0.0f;
 	}
+	pKernel->m_sampleCount = paddedSampleCount;
+}
 
-	return GFSDK_FaceWorks_OK;
+// Integrate fn(z) * N(z) cell by cell with Simpson's rule
+template <typename Fn>
+static void BuildRunningIntegral(int cellCount, const Fn & fn, RunningIntegral * pTable)
+{
+	static const double rsqrtTwoPi = 0.3989422804014327;
+	double cellSize = 2.0 * cLobeExtent / double(cellCount);
+
+	double z = -cLobeExtent;
+	double integrand = fn(z) * rsqrtTwoPi * exp(-0.5 * z * z);
+	double sum = 0.0;
+	pTable->m_value[0] = 0.0;
+	pTable->m_integrand[0] = integrand;
+
+	for (int iCell = 0; iCell < cellCount; ++iCell)
+	{
+		double zMid = z + 0.5 * cellSize;
+		double zEnd = z + cellSize;
+		double integrandMid = fn(zMid) * rsqrtTwoPi * exp(-0.5 * zMid * zMid);
+		double integrandEnd = fn(zEnd) * rsqrtTwoPi * exp(-0.5 * zEnd * zEnd);
+		sum += (cellSize / 6.0) * (integrand + 4.0 * integrandMid + integrandEnd);
+
+		pTable->m_value[iCell + 1] = sum;
+		pTable->m_integrand[iCell + 1] = integrandEnd;
+		z = zEnd;
+		integrand = integrandEnd;
+	}
 }
 
-GFSDK_FACEWORKS_API size_t GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateShadowLUTSizeBytes(
-	const GFSDK_FaceWorks_ShadowLUTConfig * pConfig)
+// Points outside the tables' extent are clamped to it
+static void FindRunningIntegralCoords(int cellCount, double z, RunningIntegralCoords * pCoords)
 {
-	if (!pConfig)
-		return 0;
+	double cellSize = 2.0 * cLobeExtent / double(cellCount);
+	double u = min(max((z + cLobeExtent) / cellSize, 0.0), double(cellCount));
+	int iCell = min(int(u), cellCount - 1);
+	double t = u - double(iCell);
+
+	pCoords->m_iCell = iCell;
+	pCoords->m_weights[0] = (1.0 + 2.0 * t) * (1.0 - t) * (1.0 - t);
+	pCoords->m_weights[1] = cellSize * t * (1.0 - t) * (1.0 - t);
+	pCoords->m_weights[2] = t * t * (3.0 - 2.0 * t);
+	pCoords->m_weights[3] = cellSize * t * t * (t - 1.0);
+}
 
-	return 4 * pConfig->m_texWidth * pConfig->m_texHeight;
+static double LookupRunningIntegral(const RunningIntegral & table, const RunningIntegralCoords & coords)
+{
+	int i = coords.m_iCell;
+	return	coords.m_weights[0] * table.m_value[i] +
+			coords.m_weights[1] * table.m_integrand[i] +
+			coords.m_weights[2] * table.m_value[i + 1] +
+			coords.m_weights[3] * table.m_integrand[i + 1];
 }
 
-GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GenerateShadowLUT(
-	const GFSDK_FaceWorks_ShadowLUTConfig * pConfig,
-	void * pShadowLUTOut,
-	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut)
+// Rows tested when estimating the error of a LUT configuration
+static const int cErrorEstimateRowCount = 32;
+
+// Running totals for a LUT error estimate
+struct ErrorEstimateAccumulator
 {
-	if (!pConfig)
+	float	m_maxError;
+	double	m_sumSqError;
+	int		m_count;
+};
+
+static void AccumulateError(const float rgb[3], const float rgbReference[3], ErrorEstimateAccumulator * pAccum)
+{
+	for (int i = 0; i < 3; ++i)
 	{
-		ErrPrintf("pConfig is null\n");
-		return GFSDK_FaceWorks_InvalidArgument;
+		float error = fabsf(rgb[i] - rgbReference[i]);
+		pAccum->m_maxError = max(pAccum->m_maxError, error);
+		pAccum->m_sumSqError += double(error) * double(error);
+		++pAccum->m_count;
 	}
-	if (!pShadowLUTOut)
-	{
-		ErrPrintf("pShadowLUTOut is null\n");
+}
+
+static void FinishErrorEstimate(const ErrorEstimateAccumulator & accum, GFSDK_FaceWorks_LUTErrorEstimate * pErrorEstimateOut)
+{
+	pErrorEstimateOut->m_maxError = accum.m_maxError;
+	pErrorEstimateOut->m_rmsError = (accum.m_count > 0) ? float(sqrt(accum.m_sumSqError / double(accum.m_count))) : 0.0f;
+}
+
+// LUT pixel formats
+
+GFSDK_FACEWORKS_API size_t GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateLUTTexelSizeBytes(
+	GFSDK_FaceWorks_LUTFormat format)
+{
+	switch (format)
+	{
+	case GFSDK_FaceWorks_LUTFormat_RGBA8:		return 4;
+	case GFSDK_FaceWorks_LUTFormat_RGB8:		return 3;
+	case GFSDK_FaceWorks_LUTFormat_R11G11B10F:	return 4;
+	case GFSDK_FaceWorks_LUTFormat_RGB9E5:		return 4;
+	case GFSDK_FaceWorks_LUTFormat_RGBA16F:		return 8;
+	case GFSDK_FaceWorks_LUTFormat_RGB565:		return 2;
+	default:									return 0;
+	}
+}
+
+static GFSDK_FaceWorks_Result ValidateLUTFormat(
+	GFSDK_FaceWorks_LUTFormat format,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut)
+{
+	if (GFSDK_FaceWorks_CalculateLUTTexelSizeBytes(format) == 0)
+	{
+		ErrPrintf("m_format is %d; should be one of the GFSDK_FaceWorks_LUTFormat values\n",
+			int(format));
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	return GFSDK_FaceWorks_OK;
+}
+
+// Whether a format's LUTs are meant to be sampled through an sRGB view; only the 8-bit unorm
+// formats have those, so the shadow LUT is stored linear in all the others
+static bool IsSRGBLUTFormat(GFSDK_FaceWorks_LUTFormat format)
+{
+	return format == GFSDK_FaceWorks_LUTFormat_RGBA8 || format == GFSDK_FaceWorks_LUTFormat_RGB8;
+}
+
+static float LinearToSRGB(float x)
+{
+	return (x < 0.0031308f) ? (12.92f * x) : (1.055f * powf(x, 1.0f / 2.4f) - 0.055f);
+}
+
+// Clamp normalized texel values to the range a format can represent
+void ClampToLUTFormatRange(GFSDK_FaceWorks_LUTFormat format, const float rgb[3], float rgbOut[3])
+{
+	float lower, upper;
+	switch (format)
+	{
+	case GFSDK_FaceWorks_LUTFormat_R11G11B10F:	lower = 0.0f;		upper = 64512.0f;	break;
+	case GFSDK_FaceWorks_LUTFormat_RGB9E5:		lower = 0.0f;		upper = 65408.0f;	break;
+	case GFSDK_FaceWorks_LUTFormat_RGBA16F:		lower = -65504.0f;	upper = 65504.0f;	break;
+	default:									lower = 0.0f;		upper = 1.0f;		break;
+	}
+
+	rgbOut[0] = min(max(rgb[0], lower), upper);
+	rgbOut[1] = min(max(rgb[1], lower), upper);
+	rgbOut[2] = min(max(rgb[2], lower), upper);
+}
+
+// Map curvature LUT texels from normalized values to the ones a format stores, in place; the
+// shaders undo this with the format's GFSDK_FaceWorks_CurvatureLUTDecode constants.  The unorm
+// formats store the normalized values.  RGBA16F stores the signed difference from saturate(N.L),
+// centred on 0, where a half is most precise.  The unsigned float formats can't hold negative
+// values, so they store the difference plus 0.25, the least offset that keeps it in range.
+void EncodeCurvatureLUTValues(GFSDK_FaceWorks_LUTFormat format, float * pRGB, size_t texelCount)
+{
+	float scale, bias;
+	switch (format)
+	{
+	case GFSDK_FaceWorks_LUTFormat_R11G11B10F:
+	case GFSDK_FaceWorks_LUTFormat_RGB9E5:		scale = 0.5f;	bias = 0.0f;	break;
+	case GFSDK_FaceWorks_LUTFormat_RGBA16F:		scale = 0.5f;	bias = -0.25f;	break;
+	default:									return;
+	}
+
+	for (size_t i = 0; i < 3 * texelCount; ++i)
+		pRGB[i] = pRGB[i] * scale + bias;
+}
+
+// Convert a non-negative float to an unsigned float with a 5-bit exponent (bias 15) and
+// the given number of mantissa bits, as used by R11G11B10F and the magnitude of a half,
+// rounding to nearest even.  Values too large for the format are clamped to its max.
+static unsigned int PackSmallFloat(float value, int mantissaBits)
+{
+	if (!(value > 0.0f))
+		return 0;
+
+	unsigned int bits;
+	memcpy(&bits, &value, sizeof(bits));
+	int exponent = int(bits >> 23) - 127;
+	unsigned int maxPacked = (30u << mantissaBits) | ((1u << mantissaBits) - 1);
+
+	// Denormals of the small format (rounding up into the smallest normal still packs correctly)
+	if (exponent < -14)
+		return static_cast<unsigned int>(ldexpf(value, 14 + mantissaBits) + 0.5f);
+
+	int shift = 23 - mantissaBits;
+	unsigned int rounded = (bits + ((1u << (shift - 1)) - 1) + ((bits >> shift) & 1)) >> shift;
+	unsigned int packed = rounded - ((127u - 15u) << mantissaBits);
+	return min(packed, maxPacked);
+}
+
+static unsigned int PackHalf(float value)
+{
+	unsigned int sign = (value < 0.0f) ? 0x8000 : 0;
+	return sign | PackSmallFloat(fabsf(value), 10);
+}
+
+// Shared-exponent packing, following the DXGI_FORMAT_R9G9B9E5_SHAREDEXP conversion rules
+static unsigned int PackRGB9E5(const float rgb[3])
+{
+	static const int mantissaBits = 9;
+	static const int exponentBias = 15;
+
+	float maxValue = max(max(rgb[0], rgb[1]), rgb[2]);
+	if (!(maxValue > 0.0f))
+		return 0;
+
+	// Shared exponent such that maxValue's mantissa fits in 9 bits, then bumped if rounding overflows
+	int exponent;
+	frexpf(maxValue, &exponent);
+	int sharedExponent = max(exponent, -exponentBias) + exponentBias;
+	float scale = ldexpf(1.0f, mantissaBits + exponentBias - sharedExponent);
+	if (int(maxValue * scale + 0.5f) == (1 << mantissaBits))
+	{
+		scale *= 0.5f;
+		++sharedExponent;
+	}
+
+	unsigned int r = static_cast<unsigned int>(rgb[0] * scale + 0.5f);
+	unsigned int g = static_cast<unsigned int>(rgb[1] * scale + 0.5f);
+	unsigned int b = static_cast<unsigned int>(rgb[2] * scale + 0.5f);
+	return r | (g << 9) | (b << 18) | (static_cast<unsigned int>(sharedExponent) << 27);
+}
+
+static unsigned char * WriteLittleEndian(unsigned int value, int byteCount, unsigned char * pPx)
+{
+	for (int i = 0; i < byteCount; ++i)
+		*(pPx++) = static_cast<unsigned char>(value >> (8 * i));
+	return pPx;
+}
+
+// Write one texel of normalized values, already clamped to the format's range; returns the
+// pointer just past it
+static unsigned char * WriteLUTTexel(GFSDK_FaceWorks_LUTFormat format, const float rgb[3], unsigned char * pPx)
+{
+	switch (format)
+	{
+	case GFSDK_FaceWorks_LUTFormat_RGBA8:
+	default:
+		*(pPx++) = static_cast<unsigned char>(255.0f * rgb[0] + 0.5f);
+		*(pPx++) = static_cast<unsigned char>(255.0f * rgb[1] + 0.5f);
+		*(pPx++) = static_cast<unsigned char>(255.0f * rgb[2] + 0.5f);
+		*(pPx++) = 255;
+		return pPx;
+
+	case GFSDK_FaceWorks_LUTFormat_RGB8:
+		*(pPx++) = static_cast<unsigned char>(255.0f * rgb[0] + 0.5f);
+		*(pPx++) = static_cast<unsigned char>(255.0f * rgb[1] + 0.5f);
+		*(pPx++) = static_cast<unsigned char>(255.0f * rgb[2] + 0.5f);
+		return pPx;
+
+	case GFSDK_FaceWorks_LUTFormat_R11G11B10F:
+		return WriteLittleEndian(
+				PackSmallFloat(rgb[0], 6) | (PackSmallFloat(rgb[1], 6) << 11) | (PackSmallFloat(rgb[2], 5) << 22),
+				4, pPx);
+
+	case GFSDK_FaceWorks_LUTFormat_RGB9E5:
+		return WriteLittleEndian(PackRGB9E5(rgb), 4, pPx);
+
+	case GFSDK_FaceWorks_LUTFormat_RGBA16F:
+		pPx = WriteLittleEndian(PackHalf(rgb[0]) | (PackHalf(rgb[1]) << 16), 4, pPx);
+		return WriteLittleEndian(PackHalf(rgb[2]) | (0x3c00u << 16), 4, pPx);
+
+	case GFSDK_FaceWorks_LUTFormat_RGB565:
+		return WriteLittleEndian(
+				(static_cast<unsigned int>(31.0f * rgb[0] + 0.5f) << 11) |
+				(static_cast<unsigned int>(63.0f * rgb[1] + 0.5f) << 5) |
+				static_cast<unsigned int>(31.0f * rgb[2] + 0.5f),
+				2, pPx);
+	}
+}
+
+void EncodeLUTTexels(
+	GFSDK_FaceWorks_LUTFormat format,
+	bool encodeSRGB,
+	const float * pRGB,
+	int texelCount,
+	void * pPixelsOut)
+{
+	unsigned char * pPx = static_cast<unsigned char *>(pPixelsOut);
+	encodeSRGB = encodeSRGB && IsSRGBLUTFormat(format);
+
+	for (int i = 0; i < texelCount; ++i, pRGB += 3)
+	{
+		float rgb[3];
+		ClampToLUTFormatRange(format, pRGB, rgb);
+		if (encodeSRGB)
+		{
+			rgb[0] = LinearToSRGB(rgb[0]);
+			rgb[1] = LinearToSRGB(rgb[1]);
+			rgb[2] = LinearToSRGB(rgb[2]);
+		}
+		pPx = WriteLUTTexel(format, rgb, pPx);
+	}
+}
+
+
+
+// Streaming LUTs to a row sink
+
+// Default size of the blocks of rows passed to a row sink
+static const size_t cLUTRowSinkBlockBytesDefault = 4 << 20;
+
+static GFSDK_FaceWorks_Result ValidateLUTRowSink(
+	const GFSDK_FaceWorks_LUTRowSink * pRowSink,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut)
+{
+	if (!pRowSink)
+	{
+		ErrPrintf("pRowSink is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!pRowSink->m_pfnRows)
+	{
+		ErrPrintf("pRowSink->m_pfnRows is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (pRowSink->m_blockRowCount < 0)
+	{
+		ErrPrintf("pRowSink->m_blockRowCount is %d; should be at least 0\n",
+			pRowSink->m_blockRowCount);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	return GFSDK_FaceWorks_OK;
+}
+
+// Generate a LUT one block of rows at a time, passing each block to the row sink.
+// generateBlock(iYBegin, iYEnd, pBlock) fills rows [iYBegin, iYEnd) into pBlock.
+template <typename GenerateBlockFn>
+static GFSDK_FaceWorks_Result StreamLUTBlocks(
+	const GFSDK_FaceWorks_LUTRowSink * pRowSink,
+	int texHeight,
+	size_t rowBytes,
+	gfsdk_new_delete_t * pAllocator,
+	const GenerateBlockFn & generateBlock)
+{
+	int blockRowCount = pRowSink->m_blockRowCount;
+	if (blockRowCount == 0)
+		blockRowCount = int(max(size_t(1), cLUTRowSinkBlockBytesDefault / rowBytes));
+	blockRowCount = min(blockRowCount, texHeight);
+
+	FaceWorks_Allocator<unsigned char> allocByte(pAllocator);
+	std::vector<unsigned char, FaceWorks_Allocator<unsigned char>> block(allocByte);
+	try
+	{
+		block.resize(size_t(blockRowCount) * rowBytes);
+	}
+	catch (std::bad_alloc)
+	{
+		return GFSDK_FaceWorks_OutOfMemory;
+	}
+
+	for (int iYBegin = 0; iYBegin < texHeight; iYBegin += blockRowCount)
+	{
+		int iYEnd = min(iYBegin + blockRowCount, texHeight);
+
+		GFSDK_FaceWorks_Result res = generateBlock(iYBegin, iYEnd, &block[0]);
+		if (res != GFSDK_FaceWorks_OK)
+			return res;
+
+		if (!pRowSink->m_pfnRows(pRowSink->m_pUserData, iYBegin, iYEnd - iYBegin, &block[0]))
+			return GFSDK_FaceWorks_Aborted;
+	}
+
+	return GFSDK_FaceWorks_OK;
+}
+
+// LUT arrays
+
+// Check the configs of a LUT array's slices: each must be valid on its own, and they must all
+// have the same size and format, so the slices can go in one texture array
+template <typename Config>
+static GFSDK_FaceWorks_Result ValidateLUTArrayConfigs(
+	const Config * pConfigs,
+	int sliceCount,
+	GFSDK_FaceWorks_Result (*pfnValidateConfig)(const Config *, GFSDK_FaceWorks_ErrorBlob *),
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut)
+{
+	if (!pConfigs)
+	{
+		ErrPrintf("pConfigs is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (sliceCount < 1 || sliceCount > cLUTArraySliceCountMax)
+	{
+		ErrPrintf("sliceCount is %d; should be in [1, %d]\n", sliceCount, cLUTArraySliceCountMax);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	for (int iSlice = 0; iSlice < sliceCount; ++iSlice)
+	{
+		const Config & config = pConfigs[iSlice];
+
+		GFSDK_FaceWorks_Result res = pfnValidateConfig(&config, pErrorBlobOut);
+		if (res != GFSDK_FaceWorks_OK)
+		{
+			ErrPrintf("pConfigs[%d] is invalid\n", iSlice);
+			return res;
+		}
+
+		if (config.m_texWidth != pConfigs[0].m_texWidth ||
+			config.m_texHeight != pConfigs[0].m_texHeight)
+		{
+			ErrPrintf("pConfigs[%d] is %d x %d; should match pConfigs[0], which is %d x %d\n",
+				iSlice, config.m_texWidth, config.m_texHeight, pConfigs[0].m_texWidth, pConfigs[0].m_texHeight);
+			return GFSDK_FaceWorks_InvalidArgument;
+		}
+		if (config.m_format != pConfigs[0].m_format)
+		{
+			ErrPrintf("pConfigs[%d].m_format is %d; should match pConfigs[0].m_format, which is %d\n",
+				iSlice, int(config.m_format), int(pConfigs[0].m_format));
+			return GFSDK_FaceWorks_InvalidArgument;
+		}
+	}
+
+	if ((long long)sliceCount * pConfigs[0].m_texHeight > 0x7fffffffLL)
+	{
+		ErrPrintf("sliceCount * m_texHeight is %lld; should be less than 2^31\n",
+			(long long)sliceCount * pConfigs[0].m_texHeight);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	return GFSDK_FaceWorks_OK;
+}
+
+// Call fn(iSlice, iYBegin, iYEnd, iRowOut) for the rows of a LUT array in a range of
+// [0, sliceCount * texHeight), split where the range crosses from one slice to the next;
+// iRowOut is the index of row iYBegin of slice iSlice in the whole array
+template <typename Fn>
+static void ForEachLUTArraySliceRows(int texHeight, int iRowBegin, int iRowEnd, const Fn & fn)
+{
+	for (int iRow = iRowBegin; iRow < iRowEnd; )
+	{
+		int iSlice = iRow / texHeight;
+		int iY = iRow - iSlice * texHeight;
+		int rowCount = min(iRowEnd - iRow, texHeight - iY);
+		fn(iSlice, iY, iY + rowCount, iRow);
+		iRow += rowCount;
+	}
+}
+
+GFSDK_FACEWORKS_API size_t GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateCurvatureLUTSizeBytes(
+	const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig)
+{
+	if (!pConfig)
+		return 0;
+
+	return GFSDK_FaceWorks_CalculateLUTTexelSizeBytes(pConfig->m_format) *
+			size_t(pConfig->m_texWidth) * size_t(pConfig->m_texHeight);
+}
+
+GFSDK_FaceWorks_Result ValidateCurvatureLUTConfig(
+	const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut)
+{
+	if (!pConfig)
+	{
+		ErrPrintf("pConfig is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (pConfig->m_diffusionRadius <= 0.0f)
+	{
+		ErrPrintf("m_diffusionRadius is %g; should be greater than 0\n",
+			pConfig->m_diffusionRadius);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (pConfig->m_texWidth < 1)
+	{
+		ErrPrintf("m_texWidth is %d; should be at least 1\n",
+			pConfig->m_texWidth);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (pConfig->m_texHeight < 1)
+	{
+		ErrPrintf("m_texHeight is %d; should be at least 1\n",
+			pConfig->m_texHeight);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (pConfig->m_curvatureRadiusMin <= 0.0f)
+	{
+		ErrPrintf("m_curvatureRadiusMin is %g; should be greater than 0\n",
+			pConfig->m_curvatureRadiusMin);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (pConfig->m_curvatureRadiusMax <= 0.0f)
+	{
+		ErrPrintf("m_curvatureRadiusMax is %g; should be greater than 0\n",
+			pConfig->m_curvatureRadiusMax);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (pConfig->m_curvatureRadiusMax < pConfig->m_curvatureRadiusMin)
+	{
+		ErrPrintf("m_curvatureRadiusMin is %g and m_curvatureRadiusMax is %g; max should be greater than min\n",
+			pConfig->m_curvatureRadiusMin, pConfig->m_curvatureRadiusMax);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (pConfig->m_integrationMode == GFSDK_FaceWorks_LUTIntegration_Analytic)
+	{
+		ErrPrintf("m_integrationMode is GFSDK_FaceWorks_LUTIntegration_Analytic; this is only supported for the shadow LUT\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	GFSDK_FaceWorks_Result res = ValidateLUTFormat(pConfig->m_format, pErrorBlobOut);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
+
+	return ValidateIntegrationRule(pConfig->m_integrationMode, pConfig->m_integrationSampleCount, pErrorBlobOut);
+}
+
+// Largest error, in normalized texel units, that the midpoint rule's one-sided texels may
+// introduce by ignoring the far tails of the diffusion profile (a quarter of an 8-bit step)
+static const float cCurvatureOneSidedTolerance = 0.25f / 255.0f;
+
+// Parameters shared by all the rows of a curvature LUT
+struct CurvatureLUTParams
+{
+	int				m_texWidth;
+	GFSDK_FaceWorks_LUTFormat	m_format;
+	float			m_curvatureScale, m_curvatureBias;
+	float			m_NdotLScale, m_NdotLBias;
+	IntegrationRule	m_rule;
+	float			m_oneSidedTolerance;
+};
+
+static void SetupCurvatureLUTParams(
+	const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig,
+	CurvatureLUTParams * pParams)
+{
+	// The diffusion profile is built assuming a (standard human skin) radius
+	// of 2.7 mm, so the curvatures and shadow widths need to be scaled to generate
+	// a LUT for the user's desired diffusion radius.
+	float diffusionRadiusFactor = pConfig->m_diffusionRadius / 2.7f;
+
+	float curvatureMin = diffusionRadiusFactor / pConfig->m_curvatureRadiusMax;
+	float curvatureMax = diffusionRadiusFactor / pConfig->m_curvatureRadiusMin;
+	pParams->m_curvatureScale = (curvatureMax - curvatureMin) / float(pConfig->m_texHeight);
+	pParams->m_curvatureBias = curvatureMin + 0.5f * pParams->m_curvatureScale;
+
+	pParams->m_NdotLScale = 2.0f / float(pConfig->m_texWidth);
+	pParams->m_NdotLBias = -1.0f + 0.5f * pParams->m_NdotLScale;
+
+	pParams->m_texWidth = pConfig->m_texWidth;
+	pParams->m_format = pConfig->m_format;
+
+	SetupIntegrationRule(pConfig->m_integrationMode, pConfig->m_integrationSampleCount, &pParams->m_rule);
+	pParams->m_oneSidedTolerance = cCurvatureOneSidedTolerance;
+}
+
+// Scratch space needed to set up a curvature LUT row, in floats
+static size_t CalculateCurvatureLUTRowWorkSize(const CurvatureLUTParams & params)
+{
+	if (params.m_rule.m_mode != GFSDK_FaceWorks_LUTIntegration_Convolution)
+		return 0;
+
+	// The tables every row shares (each column's coordinate in the window sums, and cos and
+	// sin of each bin's rotation), the profile density at half-bin steps (positions and RGB),
+	// the RGB mass in each bin on the positive side, the running sums, and the window sums
+	size_t texWidth = size_t(params.m_texWidth);
+	size_t binCount = size_t(params.m_rule.m_sampleCount);
+	return texWidth + binCount + 4 * (binCount + 4) + 3 * (binCount / 2) + 12 * (binCount / 2 + 1);
+}
+
+// Set up the parts of a worker's scratch space that every row of a LUT shares, before its
+// first row.  For the convolution rule, the bins' rotations only depend on the bin count and
+// the columns' angles only on N.L, so their trig functions are evaluated once, not per row.
+static void SetupCurvatureLUTWork(const CurvatureLUTParams & params, float * pWork)
+{
+	if (params.m_rule.m_mode != GFSDK_FaceWorks_LUTIntegration_Convolution)
+		return;
+
+	int halfBinCount = params.m_rule.m_sampleCount / 2;
+	double binAngle = double(pi) / double(halfBinCount);
+
+	// Each column's theta, in bin edges from 0
+	float * pColumnCoords = pWork;
+	for (int iX = 0; iX < params.m_texWidth; ++iX)
+	{
+		double NdotL = double(iX) * double(params.m_NdotLScale) + double(params.m_NdotLBias);
+		double theta = acos(min(max(NdotL, -1.0), 1.0));
+		pColumnCoords[iX] = float(min(theta / binAngle, double(halfBinCount)));
+	}
+
+	// Rotations of the bins' centers on the positive side
+	float * pCosRotation = pColumnCoords + params.m_texWidth;
+	float * pSinRotation = pCosRotation + halfBinCount;
+	for (int i = 0; i < halfBinCount; ++i)
+	{
+		pCosRotation[i] = float(cos((double(i) + 0.5) * binAngle));
+		pSinRotation[i] = float(sin((double(i) + 0.5) * binAngle));
+	}
+}
+
+// Integration samples for one row of a curvature LUT.  The samples only depend
+// on the curvature, so they're set up once per row.
+struct CurvatureLUTRow
+{
+	float			m_curvature;
+	float			m_lowerBound, m_upperBound;		// Integration bounds, in mm
+
+	// Midpoint rule
+	ProfileKernel	m_kernel;
+	float			m_cosRotation[cMidpointSampleCountMax];
+	float			m_sinRotation[cMidpointSampleCountMax];
+
+	// Midpoint rule, one-sided texels.  Texels with N.L in the unclamped range have all but
+	// the profile's far tails on the lit side of the terminator, so the clamp drops out, and
+	// the integral has a closed form: N.L times m_unclampedScale.  Texels in the unlit range
+	// have all but the far tails on the unlit side, so they're zero.  Only rows whose profile
+	// spans a small enough arc have many such texels, so this mostly pays off at large
+	// curvature radii.  An empty range has min > max.
+	float			m_unclampedNdotLMin, m_unclampedNdotLMax;
+	float			m_unlitNdotLMin, m_unlitNdotLMax;
+	float			m_unclampedScale[3];
+
+	// Convolution rule: sums of the profile's RGB mass times cos and sin of the rotation over
+	// the window lit at each theta, at the bin edges from 0 to pi; stored in the row's work
+	// space, as cos R, G, B then sin R, G, B for each edge.  Each column's coordinate in them
+	// is shared by every row.
+	const float *	m_pWindowSums;
+	const float *	m_pColumnCoords;
+
+	// Piecewise rule: running integrals of cos and sin of the rotation, for each lobe
+	RunningIntegral	m_cosRotationIntegrals[cLobeCount];
+	RunningIntegral	m_sinRotationIntegrals[cLobeCount];
+};
+
+// Find the ranges of N.L where all but the far tails of a row's profile fall on one side of
+// the terminator, and the closed form for the unclamped one.  Where the clamp drops out, the
+// integral of cos(theta - rotation) is cos(theta) times the integral of cos(rotation), as the
+// profile is even; over the whole line, that's each lobe's weight times exp(-(curvature sigma)^2 / 2),
+// the Gaussian's Fourier transform.  The mass the integration bounds cut off is no more than the
+// far tails left out of the range (or, for the 10 mm bound, 2e-5), so it's left out too.
+static void SetupCurvatureLUTRowOneSidedRanges(
+	const CurvatureLUTParams & params,
+	CurvatureLUTRow * pRow)
+{
+	const ProfileKernel & kernel = pRow->m_kernel;
+	int sampleCount = kernel.m_sampleCount;
+
+	double unclampedScale[3] = { 0.0, 0.0, 0.0 };
+	for (int iLobe = 0; iLobe < cLobeCount; ++iLobe)
+	{
+		double rotationSigma = double(pRow->m_curvature) * double(diffusionSigmas[iLobe]);
+		double transform = exp(-0.5 * rotationSigma * rotationSigma);
+		unclampedScale[0] += diffusionWeightsR[iLobe] * transform;
+		unclampedScale[1] += diffusionWeightsG[iLobe] * transform;
+		unclampedScale[2] += diffusionWeightsB[iLobe] * transform;
+	}
+	for (int i = 0; i < 3; ++i)
+		pRow->m_unclampedScale[i] = float(unclampedScale[i]);
+
+	// The far tails of the profile hardly contribute, so they're left out when deciding
+	// which side of the terminator the samples fall on.  Each sample's lighting is in [0, 1],
+	// so leaving it out changes a texel by at most its weight; the texels are scaled by 2
+	// when they're remapped, and the budget is split between the two tails.
+	float tailBudget = 0.25f * params.m_oneSidedTolerance;
+	int iFirst = 0, iLast = sampleCount - 1;
+	for (float tail = 0.0f; iFirst < iLast; ++iFirst)
+	{
+		tail += max(kernel.m_weightsR[iFirst], max(kernel.m_weightsG[iFirst], kernel.m_weightsB[iFirst]));
+		if (tail > tailBudget)
+			break;
+	}
+	for (float tail = 0.0f; iLast > iFirst; --iLast)
+	{
+		tail += max(kernel.m_weightsR[iLast], max(kernel.m_weightsG[iLast], kernel.m_weightsB[iLast]));
+		if (tail > tailBudget)
+			break;
+	}
+
+	// A sample at delta sees the light at an angle of theta - delta * curvature, and theta is in [0, pi]
+	float rotationLower = kernel.m_delta[iFirst] * pRow->m_curvature;
+	float rotationUpper = kernel.m_delta[iLast] * pRow->m_curvature;
+
+	float unclampedThetaMin = max(0.0f, rotationUpper - 0.5f * pi);
+	float unclampedThetaMax = min(pi, rotationLower + 0.5f * pi);
+	if (unclampedThetaMin <= unclampedThetaMax)
+	{
+		pRow->m_unclampedNdotLMin = cosf(unclampedThetaMax);
+		pRow->m_unclampedNdotLMax = cosf(unclampedThetaMin);
+	}
+	else
+	{
+		pRow->m_unclampedNdotLMin = 1.0f;
+		pRow->m_unclampedNdotLMax = -1.0f;
+	}
+
+	float unlitThetaMin = max(0.0f, rotationUpper + 0.5f * pi);
+	float unlitThetaMax = min(pi, rotationLower + 1.5f * pi);
+	if (unlitThetaMin <= unlitThetaMax)
+	{
+		pRow->m_unlitNdotLMin = cosf(unlitThetaMax);
+		pRow->m_unlitNdotLMax = cosf(unlitThetaMin);
+	}
+	else
+	{
+		pRow->m_unlitNdotLMin = 1.0f;
+		pRow->m_unlitNdotLMax = -1.0f;
+	}
+}
+
+// Mass of the diffusion profile between two points, in mm
+static void CalculateProfileMass(double lower, double upper, double rgbOut[3])
+{
+	static const double rsqrtTwo = 0.7071067811865476;
+	rgbOut[0] = rgbOut[1] = rgbOut[2] = 0.0;
+
+	for (int iLobe = 0; iLobe < cLobeCount; ++iLobe)
+	{
+		double scale = rsqrtTwo / double(diffusionSigmas[iLobe]);
+		double mass = 0.5 * (erfc(-upper * scale) - erfc(-lower * scale));
+		rgbOut[0] += diffusionWeightsR[iLobe] * mass;
+		rgbOut[1] += diffusionWeightsG[iLobe] * mass;
+		rgbOut[2] += diffusionWeightsB[iLobe] * mass;
+	}
+}
+
+// Convolution rule for one row of a curvature LUT.  A sample at delta sees the light at an
+// angle of theta - delta * curvature, so in terms of that rotation the row is the clamped cosine
+// convolved with the profile, over the ring's circumference (or +-10 mm, if that's shorter).
+// The circle is split into bins of equal angle, and the profile's mass in each bin is found
+// (exactly for lobes narrower than a bin, and by Simpson's rule for the rest).  Running sums
+// of the mass times cos and sin of each bin's rotation then give the integral over the lit
+// side of the terminator at each bin edge, and the texels interpolate between those.
+static void SetupCurvatureLUTRowConvolution(
+	const CurvatureLUTParams & params,
+	float * pWork,
+	CurvatureLUTRow * pRow)
+{
+	int binCount = params.m_rule.m_sampleCount;
+	int halfBinCount = binCount / 2;
+	double binAngle = 2.0 * double(pi) / double(binCount);
+	double binWidth = binAngle / double(pRow->m_curvature);		// In mm
+	double upperBound = double(pRow->m_upperBound);
+
+	// The shared tables from SetupCurvatureLUTWork come first
+	const float * pColumnCoords = pWork;
+	const float * pCosRotation = pColumnCoords + params.m_texWidth;
+	const float * pSinRotation = pCosRotation + halfBinCount;
+
+	float * pDensityX = pWork + params.m_texWidth + binCount;
+	float * pDensityR = pDensityX + (binCount + 4);
+	float * pDensityG = pDensityR + (binCount + 4);
+	float * pDensityB = pDensityG + (binCount + 4);
+	float * pMass[3] =
+	{
+		pDensityB + (binCount + 4),
+		pDensityB + (binCount + 4) + halfBinCount,
+		pDensityB + (binCount + 4) + 2 * halfBinCount,
+	};
+	float * pSums = pMass[2] + halfBinCount;
+	float * pWindowSums = pSums + 6 * (halfBinCount + 1);
+
+	// The profile is even, so only the bins on the positive side are needed; bin j covers
+	// [j, j + 1] * binWidth.  Bins before iBoundary lie wholly within the integration bounds.
+	int iBoundary = min(int(floor(upperBound / binWidth)), halfBinCount);
+	for (int i = 0; i < 3 * halfBinCount; ++i)
+		pMass[0][i] = 0.0f;
+
+	// Lobes at least a bin wide are integrated over each bin by Simpson's rule, so the
+	// profile is evaluated every half bin.  Like the narrower lobes, each is only evaluated
+	// out to cLobeExtent standard deviations: the lobes are in order of width, so the points
+	// split into runs, each evaluated with just the lobes that reach it.  The widest lobe
+	// covers any points left.
+	int iFirstWideLobe = 0;
+	while (iFirstWideLobe < cLobeCount && double(diffusionSigmas[iFirstWideLobe]) < binWidth)
+		++iFirstWideLobe;
+
+	if (iBoundary > 0 && iFirstWideLobe < cLobeCount)
+	{
+		int densityCount = 2 * iBoundary + 1;
+		double densityStep = 0.5 * binWidth;
+		for (int i = 0; i < densityCount; ++i)
+			pDensityX[i] = float(densityStep * double(i));
+
+		int iBegin = 0;
+		for (int iLobe = iFirstWideLobe; iLobe < cLobeCount && iBegin < densityCount; ++iLobe)
+		{
+			int iEnd = densityCount;
+			if (iLobe < cLobeCount - 1)
+				iEnd = min(int(cLobeExtent * double(diffusionSigmas[iLobe]) / densityStep) + 1, densityCount);
+			if (iEnd <= iBegin)
+				continue;
+
+			GetSimdKernels()->m_pfnEvaluateGaussianMixture(
+								pDensityX + iBegin, iEnd - iBegin,
+								diffusionSigmas + iLobe,
+								diffusionWeightsR + iLobe,
+								diffusionWeightsG + iLobe,
+								diffusionWeightsB + iLobe,
+								cLobeCount - iLobe,
+								float(binWidth / 6.0),
+								pDensityR + iBegin, pDensityG + iBegin, pDensityB + iBegin);
+			iBegin = iEnd;
+		}
+
+		for (int i = 0; i < iBoundary; ++i)
+		{
+			pMass[0][i] += pDensityR[2*i] + 4.0f * pDensityR[2*i + 1] + pDensityR[2*i + 2];
+			pMass[1][i] += pDensityG[2*i] + 4.0f * pDensityG[2*i + 1] + pDensityG[2*i + 2];
+			pMass[2][i] += pDensityB[2*i] + 4.0f * pDensityB[2*i + 1] + pDensityB[2*i + 2];
+		}
+	}
+
+	// Narrower lobes are integrated exactly, over the few bins they reach
+	static const double rsqrtTwo = 0.7071067811865476;
+	for (int iLobe = 0; iLobe < iFirstWideLobe; ++iLobe)
+	{
+		double scale = rsqrtTwo * binWidth / double(diffusionSigmas[iLobe]);
+		int iReach = min(int(ceil(cLobeExtent * double(diffusionSigmas[iLobe]) / binWidth)), iBoundary);
+
+		double cdfLower = 0.5;
+		for (int i = 0; i < iReach; ++i)
+		{
+			double cdfUpper = 0.5 * erfc(-double(i + 1) * scale);
+			pMass[0][i] += float(diffusionWeightsR[iLobe] * (cdfUpper - cdfLower));
+			pMass[1][i] += float(diffusionWeightsG[iLobe] * (cdfUpper - cdfLower));
+			pMass[2][i] += float(diffusionWeightsB[iLobe] * (cdfUpper - cdfLower));
+			cdfLower = cdfUpper;
+		}
+	}
+
+	// The bin cut off by the integration bounds, if any
+	if (iBoundary < halfBinCount)
+	{
+		double rgb[3];
+		CalculateProfileMass(double(iBoundary) * binWidth, upperBound, rgb);
+		pMass[0][iBoundary] += float(rgb[0]);
+		pMass[1][iBoundary] += float(rgb[1]);
+		pMass[2][iBoundary] += float(rgb[2]);
+	}
+
+	// Running sums outward from zero over the positive side's bins, at each bin edge.  The
+	// profile is even, so the sums over the negative side out to an edge are the same, with the
+	// sign of the sin sums flipped.  Only the reachCount bins that have any mass are summed;
+	// past them, the sums stay at their totals.  Masses from the far tails are flushed to zero,
+	// as they'd otherwise leave denormals, which are very slow.
+	static const float massEpsilon = 1e-20f;
+	int reachCount = min(iBoundary + 1, halfBinCount);
+	double cosSums[3] = { 0.0, 0.0, 0.0 };
+	double sinSums[3] = { 0.0, 0.0, 0.0 };
+	for (int c = 0; c < 6; ++c)
+		pSums[c] = 0.0f;
+
+	for (int i = 0; i < reachCount; ++i)
+	{
+		float * pEdgeSums = pSums + 6 * (i + 1);
+		for (int c = 0; c < 3; ++c)
+		{
+			double mass = (pMass[c][i] > massEpsilon) ? double(pMass[c][i]) : 0.0;
+			cosSums[c] += mass * double(pCosRotation[i]);
+			sinSums[c] += mass * double(pSinRotation[i]);
+			pEdgeSums[c] = float(cosSums[c]);
+			pEdgeSums[c + 3] = float(sinSums[c]);
+		}
+	}
+
+	// The running sums out to the bin edge iEdge places from zero
+	auto edgeSums = [=](int iEdge)
+	{
+		return pSums + 6 * min(iEdge, reachCount);
+	};
+
+	// Window sums at theta from 0 to pi, by bin edges.  The lit rotations are those within
+	// pi/2 of theta, or of theta - 2 pi, as for the piecewise rule; quarterBinCount is pi/2,
+	// so each window starts and ends on a bin edge.  Up to pi/2, the window spans zero, so it's
+	// the sums out to its ends on either side.  Past pi/2, it wraps around from pi to -pi, and
+	// it's the total less the unlit span between theta - 3 pi/2 and theta - pi/2, which spans
+	// zero in turn.  The total's sin sums cancel.
+	int quarterBinCount = binCount / 4;
+	const float * pTotalSums = edgeSums(halfBinCount);
+	for (int iEdge = 0; iEdge <= halfBinCount; ++iEdge)
+	{
+		float * pEdgeWindowSums = pWindowSums + 6 * iEdge;
+		if (iEdge <= quarterBinCount)
+		{
+			const float * pUpper = edgeSums(quarterBinCount + iEdge);
+			const float * pLower = edgeSums(quarterBinCount - iEdge);
+			for (int c = 0; c < 3; ++c)
+			{
+				pEdgeWindowSums[c] = pUpper[c] + pLower[c];
+				pEdgeWindowSums[c + 3] = pUpper[c + 3] - pLower[c + 3];
+			}
+		}
+		else
+		{
+			const float * pUpper = edgeSums(iEdge - quarterBinCount);
+			const float * pLower = edgeSums(3 * quarterBinCount - iEdge);
+			for (int c = 0; c < 3; ++c)
+			{
+				pEdgeWindowSums[c] = 2.0f * pTotalSums[c] - pUpper[c] - pLower[c];
+				pEdgeWindowSums[c + 3] = pLower[c + 3] - pUpper[c + 3];
+			}
+		}
+	}
+
+	pRow->m_pWindowSums = pWindowSums;
+	pRow->m_pColumnCoords = pColumnCoords;
+}
+
+static void SetupCurvatureLUTRow(
+	const CurvatureLUTParams & params,
+	int iY,
+	float * pWork,
+	CurvatureLUTRow * pRow)
+{
+	float curvature = float(iY) * params.m_curvatureScale + params.m_curvatureBias;
+	float radius = 1.0f / curvature;
+
+	// Sample points around a ring, and integrate the scattered lighting
+	// using the diffusion profile.
+
+	// Set integration bounds in arc-length in mm on the sphere
+	pRow->m_curvature = curvature;
+	pRow->m_lowerBound = max(-pi*radius, -10.0f);
+	pRow->m_upperBound = min(pi*radius, 10.0f);
+
+	switch (params.m_rule.m_mode)
+	{
+	case GFSDK_FaceWorks_LUTIntegration_Midpoint:
+	default:
+		{
+			BuildProfileKernel(params.m_rule.m_sampleCount, pRow->m_lowerBound, pRow->m_upperBound, &pRow->m_kernel);
+
+			// Each sample rotates the light direction by delta * curvature radians;
+			// precalculate the rotation so the inner loop needs no trig functions
+			for (int iIter = 0; iIter < pRow->m_kernel.m_sampleCount; ++iIter)
+			{
+				pRow->m_cosRotation[iIter] = cosf(pRow->m_kernel.m_delta[iIter] * curvature);
+				pRow->m_sinRotation[iIter] = sinf(pRow->m_kernel.m_delta[iIter] * curvature);
+			}
+
+			SetupCurvatureLUTRowOneSidedRanges(params, pRow);
+		}
+		break;
+
+	case GFSDK_FaceWorks_LUTIntegration_Piecewise:
+		for (int iLobe = 0; iLobe < cLobeCount; ++iLobe)
+		{
+			// Rotation in radians per standard deviation of this lobe
+			double rotationScale = double(curvature) * double(diffusionSigmas[iLobe]);
+
+			BuildRunningIntegral(params.m_rule.m_sampleCount,
+				[rotationScale](double z) { return cos(rotationScale * z); },
+				&pRow->m_cosRotationIntegrals[iLobe]);
+			BuildRunningIntegral(params.m_rule.m_sampleCount,
+				[rotationScale](double z) { return sin(rotationScale * z); },
+				&pRow->m_sinRotationIntegrals[iLobe]);
+		}
+		break;
+
+	case GFSDK_FaceWorks_LUTIntegration_Convolution:
+		SetupCurvatureLUTRowConvolution(params, pWork, pRow);
+		break;
+	}
+}
+
+// Piecewise rule for one texel of a curvature LUT.  A sample at delta sees the light at an
+// angle of theta - delta * curvature, so it's lit while that is within pi/2 of a multiple
+// of 2 pi; the ring only reaches pi radians either way, so at most two such arcs matter.
+// Over a lit arc the clamp does nothing, so each lobe's integral of
+// cos(theta - rotation) = cos(theta) * cos(rotation) + sin(theta) * sin(rotation)
+// comes straight from its running integrals.
+static void IntegrateCurvatureLUTTexelPiecewise(
+	const CurvatureLUTParams & params,
+	const CurvatureLUTRow & row,
+	float NdotL,
+	float sinTheta,
+	float rgbOut[3])
+{
+	double theta = acos(min(max(double(NdotL), -1.0), 1.0));
+	double rgb[3] = { 0.0, 0.0, 0.0 };
+
+	for (int iArc = 0; iArc < 2; ++iArc)
+	{
+		double arcCenter = theta - 2.0 * double(pi) * double(iArc);
+		double lower = max(double(row.m_lowerBound), (arcCenter - 0.5 * double(pi)) / double(row.m_curvature));
+		double upper = min(double(row.m_upperBound), (arcCenter + 0.5 * double(pi)) / double(row.m_curvature));
+		if (upper <= lower)
+			continue;
+
+		for (int iLobe = 0; iLobe < cLobeCount; ++iLobe)
+		{
+			// Skip lobes that don't reach the arc at all
+			double rcpSigma = 1.0 / double(diffusionSigmas[iLobe]);
+			double zLower = lower * rcpSigma, zUpper = upper * rcpSigma;
+			if (zLower >= cLobeExtent || zUpper <= -cLobeExtent)
+				continue;
+
+			RunningIntegralCoords coordsLower, coordsUpper;
+			FindRunningIntegralCoords(params.m_rule.m_sampleCount, zLower, &coordsLower);
+			FindRunningIntegralCoords(params.m_rule.m_sampleCount, zUpper, &coordsUpper);
+
+			const RunningIntegral & cosIntegral = row.m_cosRotationIntegrals[iLobe];
+			const RunningIntegral & sinIntegral = row.m_sinRotationIntegrals[iLobe];
+			double lit =
+				double(NdotL) * (LookupRunningIntegral(cosIntegral, coordsUpper) - LookupRunningIntegral(cosIntegral, coordsLower)) +
+				double(sinTheta) * (LookupRunningIntegral(sinIntegral, coordsUpper) - LookupRunningIntegral(sinIntegral, coordsLower));
+
+			rgb[0] += diffusionWeightsR[iLobe] * lit;
+			rgb[1] += diffusionWeightsG[iLobe] * lit;
+			rgb[2] += diffusionWeightsB[iLobe] * lit;
+		}
+	}
+
+	rgbOut[0] = float(rgb[0]);
+	rgbOut[1] = float(rgb[1]);
+	rgbOut[2] = float(rgb[2]);
+}
+
+// Convolution rule for one texel of a curvature LUT.  The clamp does nothing within the lit
+// window, so the integral is linear in the window sums, and they're interpolated at theta as
+// each bin's mass is spread evenly across it, at the column's theta.
+static void IntegrateCurvatureLUTTexelConvolution(
+	const CurvatureLUTParams & params,
+	const CurvatureLUTRow & row,
+	int iX,
+	float NdotL,
+	float sinTheta,
+	float rgbOut[3])
+{
+	int halfBinCount = params.m_rule.m_sampleCount / 2;
+	float u = row.m_pColumnCoords[iX];
+	int i = min(int(u), halfBinCount - 1);
+	float t = u - float(i);
+
+	const float * pLower = row.m_pWindowSums + 6 * i;
+	const float * pUpper = pLower + 6;
+	for (int c = 0; c < 3; ++c)
+	{
+		float cosSum = pLower[c] + t * (pUpper[c] - pLower[c]);
+		float sinSum = pLower[c + 3] + t * (pUpper[c + 3] - pLower[c + 3]);
+		rgbOut[c] = NdotL * cosSum + sinTheta * sinSum;
+	}
+}
+
+// Calculate one texel of a curvature LUT, as normalized values before conversion to integer format
+static void EvaluateCurvatureLUTTexel(
+	const CurvatureLUTParams & params,
+	const CurvatureLUTRow & row,
+	int iX,
+	float rgbOut[3])
+{
+	// cos(theta - rotation) = cos(theta) * cos(rotation) + sin(theta) * sin(rotation),
+	// where theta = acos(NdotL), so sin(theta) is never negative
+	float NdotL = float(iX) * params.m_NdotLScale + params.m_NdotLBias;
+	float sinTheta = sqrtf(max(0.0f, 1.0f - NdotL * NdotL));
+
+	float rgb[3];
+	switch (params.m_rule.m_mode)
+	{
+	case GFSDK_FaceWorks_LUTIntegration_Midpoint:
+	default:
+		if (NdotL >= row.m_unclampedNdotLMin && NdotL <= row.m_unclampedNdotLMax)
+		{
+			rgb[0] = NdotL * row.m_unclampedScale[0];
+			rgb[1] = NdotL * row.m_unclampedScale[1];
+			rgb[2] = NdotL * row.m_unclampedScale[2];
+		}
+		else if (NdotL >= row.m_unlitNdotLMin && NdotL <= row.m_unlitNdotLMax)
+		{
+			rgb[0] = 0.0f;
+			rgb[1] = 0.0f;
+			rgb[2] = 0.0f;
+		}
+		else
+		{
+			GetSimdKernels()->m_pfnIntegrateClampedCosine(
+								NdotL, sinTheta, row.m_cosRotation, row.m_sinRotation,
+								row.m_kernel.m_weightsR, row.m_kernel.m_weightsG, row.m_kernel.m_weightsB,
+								row.m_kernel.m_sampleCount,
+								rgb);
+		}
+		break;
+
+	case GFSDK_FaceWorks_LUTIntegration_Piecewise:
+		IntegrateCurvatureLUTTexelPiecewise(params, row, NdotL, sinTheta, rgb);
+		break;
+
+	case GFSDK_FaceWorks_LUTIntegration_Convolution:
+		IntegrateCurvatureLUTTexelConvolution(params, row, iX, NdotL, sinTheta, rgb);
+		break;
+	}
+
+	// Calculate delta from standard diffuse lighting (saturate(N.L)) to
+	// scattered result, remapped from [-.25, .25] to [0, 1].
+	float rgbAdjust = -max(0.0f, NdotL) * 2.0f + 0.5f;
+	rgb[0] = rgb[0] * 2.0f + rgbAdjust;
+	rgb[1] = rgb[1] * 2.0f + rgbAdjust;
+	rgb[2] = rgb[2] * 2.0f + rgbAdjust;
+
+	// Clamp to the range of the output format; [0, 1] for the unorm formats
+	ClampToLUTFormatRange(params.m_format, rgb, rgbOut);
+}
+
+// Generate rows [iYBegin, iYEnd) of a curvature LUT; pPixelsOut points to row iYBegin.
+// Each row only depends on its own index, so rows can be generated in any order or in parallel.
+static void GenerateCurvatureLUTRows(
+	const CurvatureLUTParams & params,
+	int iYBegin,
+	int iYEnd,
+	float * pWork,
+	void * pPixelsOut)
+{
+	unsigned char * pPx = static_cast<unsigned char *>(pPixelsOut);
+	CurvatureLUTRow row;
+	SetupCurvatureLUTWork(params, pWork);
+
+	for (int iY = iYBegin; iY < iYEnd; ++iY)
+	{
+		SetupCurvatureLUTRow(params, iY, pWork, &row);
+
+		for (int iX = 0; iX < params.m_texWidth; ++iX)
+		{
+			float rgb[3];
+			EvaluateCurvatureLUTTexel(params, row, iX, rgb);
+
+			// Convert to the output format (linear RGB space)
+			EncodeCurvatureLUTValues(params.m_format, rgb, 1);
+			pPx = WriteLUTTexel(params.m_format, rgb, pPx);
+		}
+	}
+}
+
+// Generate rows [iYBegin, iYEnd) of a curvature LUT, spread over threads; pPixelsOut points to row iYBegin.
+static GFSDK_FaceWorks_Result GenerateCurvatureLUTBlock(
+	const CurvatureLUTParams & params,
+	int iYBegin,
+	int iYEnd,
+	void * pPixelsOut,
+	gfsdk_new_delete_t * pAllocator,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	unsigned char * pPixels = static_cast<unsigned char *>(pPixelsOut);
+	size_t rowBytes = GFSDK_FaceWorks_CalculateLUTTexelSizeBytes(params.m_format) * size_t(params.m_texWidth);
+	FaceWorks_Allocator<float> allocFloat(pAllocator);
+	size_t workSize = CalculateCurvatureLUTRowWorkSize(params);
+	std::atomic<bool> outOfMemory(false);
+
+	ParallelForRanges(pParallelConfig, iYEnd - iYBegin, [&](int iBegin, int iEnd)
+	{
+		// Exceptions mustn't escape into the worker threads
+		try
+		{
+			std::vector<float, FaceWorks_Allocator<float>> work(workSize, 0.0f, allocFloat);
+			GenerateCurvatureLUTRows(
+				params, iYBegin + iBegin, iYBegin + iEnd,
+				work.empty() ? nullptr : &work[0],
+				pPixels + iBegin * rowBytes);
+		}
+		catch (std::bad_alloc)
+		{
+			outOfMemory = true;
+		}
+	}, pAllocator);
+
+	if (outOfMemory)
+		return GFSDK_FaceWorks_OutOfMemory;
+
+	return GFSDK_FaceWorks_OK;
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GenerateCurvatureLUT(
+	const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig,
+	void * pCurvatureLUTOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	gfsdk_new_delete_t * pAllocator,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	// Validate parameters
+	GFSDK_FaceWorks_Result res = ValidateCurvatureLUTConfig(pConfig, pErrorBlobOut);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
+
+	if (!pCurvatureLUTOut)
+	{
+		ErrPrintf("pCurvatureLUTOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	CurvatureLUTParams params;
+	SetupCurvatureLUTParams(pConfig, &params);
+
+	return GenerateCurvatureLUTBlock(params, 0, pConfig->m_texHeight, pCurvatureLUTOut, pAllocator, pParallelConfig);
+}
+
+GFSDK_FaceWorks_Result GenerateCurvatureLUTFloat(
+	const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig,
+	int iYBegin,
+	int iYEnd,
+	float * pRGBOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	gfsdk_new_delete_t * pAllocator,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	// Validate parameters
+	GFSDK_FaceWorks_Result res = ValidateCurvatureLUTConfig(pConfig, pErrorBlobOut);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
+
+	if (iYBegin < 0 || iYEnd > pConfig->m_texHeight || iYBegin > iYEnd)
+	{
+		ErrPrintf("row range [%d, %d) isn't within the LUT's %d rows\n", iYBegin, iYEnd, pConfig->m_texHeight);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	if (!pRGBOut)
+	{
+		ErrPrintf("pRGBOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	CurvatureLUTParams params;
+	SetupCurvatureLUTParams(pConfig, &params);
+
+	// Keep the texels unclamped, as a float LUT holds them
+	params.m_format = GFSDK_FaceWorks_LUTFormat_RGBA16F;
+
+	FaceWorks_Allocator<float> allocFloat(pAllocator);
+	size_t workSize = CalculateCurvatureLUTRowWorkSize(params);
+	std::atomic<bool> outOfMemory(false);
+
+	ParallelForRanges(pParallelConfig, iYEnd - iYBegin, [&](int iBegin, int iEnd)
+	{
+		// Exceptions mustn't escape into the worker threads
+		try
+		{
+			std::vector<float, FaceWorks_Allocator<float>> work(workSize, 0.0f, allocFloat);
+			CurvatureLUTRow row;
+			SetupCurvatureLUTWork(params, work.empty() ? nullptr : &work[0]);
+
+			for (int iY = iYBegin + iBegin; iY < iYBegin + iEnd; ++iY)
+			{
+				SetupCurvatureLUTRow(params, iY, work.empty() ? nullptr : &work[0], &row);
+
+				float * pRGB = pRGBOut + 3 * size_t(iY - iYBegin) * size_t(params.m_texWidth);
+				for (int iX = 0; iX < params.m_texWidth; ++iX, pRGB += 3)
+					EvaluateCurvatureLUTTexel(params, row, iX, pRGB);
+			}
+		}
+		catch (std::bad_alloc)
+		{
+			outOfMemory = true;
+		}
+	}, pAllocator);
+
+	if (outOfMemory)
+		return GFSDK_FaceWorks_OutOfMemory;
+
+	return GFSDK_FaceWorks_OK;
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_StreamCurvatureLUT(
+	const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig,
+	const GFSDK_FaceWorks_LUTRowSink * pRowSink,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	gfsdk_new_delete_t * pAllocator,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	// Validate parameters
+	GFSDK_FaceWorks_Result res = ValidateCurvatureLUTConfig(pConfig, pErrorBlobOut);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
+
+	res = ValidateLUTRowSink(pRowSink, pErrorBlobOut);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
+
+	CurvatureLUTParams params;
+	SetupCurvatureLUTParams(pConfig, &params);
+
+	size_t rowBytes = GFSDK_FaceWorks_CalculateLUTTexelSizeBytes(pConfig->m_format) * size_t(pConfig->m_texWidth);
+	return StreamLUTBlocks(pRowSink, pConfig->m_texHeight, rowBytes, pAllocator,
+		[&](int iYBegin, int iYEnd, void * pBlock)
+		{
+			return GenerateCurvatureLUTBlock(params, iYBegin, iYEnd, pBlock, pAllocator, pParallelConfig);
+		});
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_EstimateCurvatureLUTError(
+	const GFSDK_FaceWorks_CurvatureLUTConfig * pConfig,
+	GFSDK_FaceWorks_LUTErrorEstimate * pErrorEstimateOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut)
+{
+	// Validate parameters
+	GFSDK_FaceWorks_Result res = ValidateCurvatureLUTConfig(pConfig, pErrorBlobOut);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
+
+	if (!pErrorEstimateOut)
+	{
+		ErrPrintf("pErrorEstimateOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	CurvatureLUTParams params;
+	SetupCurvatureLUTParams(pConfig, &params);
+
+	FaceWorks_Allocator<float> allocFloat(nullptr);
+	std::vector<float, FaceWorks_Allocator<float>> work(allocFloat);
+	try
+	{
+		work.resize(CalculateCurvatureLUTRowWorkSize(params));
+	}
+	catch (std::bad_alloc)
+	{
+		return GFSDK_FaceWorks_OutOfMemory;
+	}
+
+	// Reference: the same LUT with the densest midpoint rule
+	GFSDK_FaceWorks_CurvatureLUTConfig configReference = *pConfig;
+	configReference.m_integrationMode = GFSDK_FaceWorks_LUTIntegration_Midpoint;
+	configReference.m_integrationSampleCount = cMidpointSampleCountMax;
+	CurvatureLUTParams paramsReference;
+	SetupCurvatureLUTParams(&configReference, &paramsReference);
+	paramsReference.m_oneSidedTolerance = 0.0f;
+
+	// Compare whole rows spread evenly over the LUT
+	ErrorEstimateAccumulator accum = {};
+	int rowCount = min(pConfig->m_texHeight, cErrorEstimateRowCount);
+	CurvatureLUTRow row, rowReference;
+	SetupCurvatureLUTWork(params, work.empty() ? nullptr : &work[0]);
+
+	for (int iRow = 0; iRow < rowCount; ++iRow)
+	{
+		int iY = (2 * iRow + 1) * pConfig->m_texHeight / (2 * rowCount);
+		SetupCurvatureLUTRow(params, iY, work.empty() ? nullptr : &work[0], &row);
+		SetupCurvatureLUTRow(paramsReference, iY, nullptr, &rowReference);
+
+		for (int iX = 0; iX < pConfig->m_texWidth; ++iX)
+		{
+			float rgb[3], rgbReference[3];
+			EvaluateCurvatureLUTTexel(params, row, iX, rgb);
+			EvaluateCurvatureLUTTexel(paramsReference, rowReference, iX, rgbReference);
+			AccumulateError(rgb, rgbReference, &accum);
+		}
+	}
+
+	FinishErrorEstimate(accum, pErrorEstimateOut);
+
+	return GFSDK_FaceWorks_OK;
+}
+
+// Largest height FitCurvatureLUTRange will pick (the max texture size in D3D11)
+static const int cFittedLUTHeightMax = 16384;
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_FitCurvatureLUTRange(
+	const GFSDK_FaceWorks_CurvatureStats * pStats,
+	int statsCount,
+	float coverage,
+	GFSDK_FaceWorks_CurvatureLUTConfig * pConfig,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut)
+{
+	// Validate parameters
+	GFSDK_FaceWorks_Result res = ValidateCurvatureLUTConfig(pConfig, pErrorBlobOut);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
+	if (!pStats)
+	{
+		ErrPrintf("pStats is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (statsCount < 1)
+	{
+		ErrPrintf("statsCount is %d; should be at least 1\n", statsCount);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (!(coverage > 0.0f && coverage <= 1.0f))
+	{
+		ErrPrintf("coverage is %g; should be in (0, 1]\n", coverage);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	// Sum the histograms, and find the curvature extremes over all the meshes
+
+	long long histogram[GFSDK_FaceWorks_CurvatureHistogramBinCount] = {};
+	long long vertexCount = 0;
+	float curvatureMin = FLT_MAX;
+	float curvatureMax = 0.0f;
+	for (int iStats = 0; iStats < statsCount; ++iStats)
+	{
+		const GFSDK_FaceWorks_CurvatureStats & stats = pStats[iStats];
+		if (stats.m_vertexCount < 0)
+		{
+			ErrPrintf("pStats[%d].m_vertexCount is %d; should be at least 0\n", iStats, stats.m_vertexCount);
+			return GFSDK_FaceWorks_InvalidArgument;
+		}
+		if (stats.m_vertexCount == 0)
+			continue;
+
+		for (int iBin = 0; iBin < GFSDK_FaceWorks_CurvatureHistogramBinCount; ++iBin)
+			histogram[iBin] += stats.m_histogram[iBin];
+		vertexCount += stats.m_vertexCount;
+		curvatureMin = min(curvatureMin, stats.m_curvatureMin);
+		curvatureMax = max(curvatureMax, stats.m_curvatureMax);
+	}
+	if (vertexCount == 0)
+	{
+		ErrPrintf("pStats has no vertices\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	// Trim the uncovered vertices evenly from both ends of the histogram, then round outward to
+	// the edges of the bins the range ends in.  The true extremes may be tighter still.
+
+	long long trimCount = (long long)(0.5 * (1.0 - double(coverage)) * double(vertexCount));
+
+	int iBinLo = 0;
+	for (long long countBelow = 0; iBinLo < GFSDK_FaceWorks_CurvatureHistogramBinCount - 1; ++iBinLo)
+	{
+		countBelow += histogram[iBinLo];
+		if (countBelow > trimCount)
+			break;
+	}
+
+	int iBinHi = GFSDK_FaceWorks_CurvatureHistogramBinCount - 1;
+	for (long long countAbove = 0; iBinHi > iBinLo; --iBinHi)
+	{
+		countAbove += histogram[iBinHi];
+		if (countAbove > trimCount)
+			break;
+	}
+
+	float curvatureLo = max(CurvatureHistogramBinEdge(iBinLo), curvatureMin);
+	float curvatureHi = min(CurvatureHistogramBinEdge(iBinHi + 1), curvatureMax);
+
+	// Keep the range from collapsing to a point if all the curvatures are about the same
+	float curvatureHiMin = curvatureLo * powf(2.0f, 1.0f / float(GFSDK_FaceWorks_CurvatureHistogramBinsPerOctave));
+	curvatureHi = max(curvatureHi, curvatureHiMin);
+
+	// Scale the height so the rows keep their spacing in curvature
+
+	float curvatureRangeOld = 1.0f / pConfig->m_curvatureRadiusMin - 1.0f / pConfig->m_curvatureRadiusMax;
+	float curvatureRange = curvatureHi - curvatureLo;
+	if (curvatureRangeOld > 0.0f)
+	{
+		float texHeight = ceilf(float(pConfig->m_texHeight) * curvatureRange / curvatureRangeOld);
+		pConfig->m_texHeight = int(max(1.0f, min(float(cFittedLUTHeightMax), texHeight)));
+	}
+
+	pConfig->m_curvatureRadiusMin = 1.0f / curvatureHi;
+	pConfig->m_curvatureRadiusMax = 1.0f / curvatureLo;
+
+	return GFSDK_FaceWorks_OK;
+}
+
+
+GFSDK_FACEWORKS_API size_t GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateCurvatureLUTArraySizeBytes(
+	const GFSDK_FaceWorks_CurvatureLUTConfig * pConfigs,
+	int sliceCount)
+{
+	if (!pConfigs)
+		return 0;
+
+	return GFSDK_FaceWorks_CalculateCurvatureLUTSizeBytes(pConfigs) * size_t(max(0, sliceCount));
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GenerateCurvatureLUTArray(
+	const GFSDK_FaceWorks_CurvatureLUTConfig * pConfigs,
+	int sliceCount,
+	void * pCurvatureLUTArrayOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	gfsdk_new_delete_t * pAllocator,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	// Validate parameters
+	GFSDK_FaceWorks_Result res = ValidateLUTArrayConfigs(pConfigs, sliceCount, &ValidateCurvatureLUTConfig, pErrorBlobOut);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
+
+	if (!pCurvatureLUTArrayOut)
+	{
+		ErrPrintf("pCurvatureLUTArrayOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	// Every row of a curvature LUT is set up from its own curvature, so there's nothing to share
+	// between the slices up front; but all of their rows go into one parallel job, so the threads
+	// stay busy across the slices instead of waiting at the end of each one.
+
+	unsigned char * pPixels = static_cast<unsigned char *>(pCurvatureLUTArrayOut);
+	int texHeight = pConfigs[0].m_texHeight;
+	size_t rowBytes = GFSDK_FaceWorks_CalculateLUTTexelSizeBytes(pConfigs[0].m_format) * size_t(pConfigs[0].m_texWidth);
+	std::atomic<bool> outOfMemory(false);
+
+	// Catch out-of-memory exceptions
+	try
+	{
+		FaceWorks_Allocator<CurvatureLUTParams> allocParams(pAllocator);
+		std::vector<CurvatureLUTParams, FaceWorks_Allocator<CurvatureLUTParams>> params(allocParams);
+		params.resize(sliceCount);
+
+		size_t workSize = 0;
+		for (int iSlice = 0; iSlice < sliceCount; ++iSlice)
+		{
+			SetupCurvatureLUTParams(&pConfigs[iSlice], &params[iSlice]);
+			workSize = max(workSize, CalculateCurvatureLUTRowWorkSize(params[iSlice]));
+		}
+
+		FaceWorks_Allocator<float> allocFloat(pAllocator);
+		ParallelForRanges(pParallelConfig, sliceCount * texHeight, [&](int iBegin, int iEnd)
+		{
+			// Exceptions mustn't escape into the worker threads
+			try
+			{
+				std::vector<float, FaceWorks_Allocator<float>> work(workSize, 0.0f, allocFloat);
+				ForEachLUTArraySliceRows(texHeight, iBegin, iEnd, [&](int iSlice, int iYBegin, int iYEnd, int iRowOut)
+				{
+					GenerateCurvatureLUTRows(
+						params[iSlice], iYBegin, iYEnd,
+						work.empty() ? nullptr : &work[0],
+						pPixels + iRowOut * rowBytes);
+				});
+			}
+			catch (std::bad_alloc)
+			{
+				outOfMemory = true;
+			}
+		}, pAllocator);
+	}
+	catch (std::bad_alloc)
+	{
+		return GFSDK_FaceWorks_OutOfMemory;
+	}
+
+	if (outOfMemory)
+		return GFSDK_FaceWorks_OutOfMemory;
+
+	return GFSDK_FaceWorks_OK;
+}
+
+GFSDK_FACEWORKS_API size_t GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateShadowLUTSizeBytes(
+	const GFSDK_FaceWorks_ShadowLUTConfig * pConfig)
+{
+	if (!pConfig)
+		return 0;
+
+	return GFSDK_FaceWorks_CalculateLUTTexelSizeBytes(pConfig->m_format) *
+			size_t(pConfig->m_texWidth) * size_t(pConfig->m_texHeight);
+}
+
+GFSDK_FaceWorks_Result ValidateShadowLUTConfig(
+	const GFSDK_FaceWorks_ShadowLUTConfig * pConfig,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut)
+{
+	if (!pConfig)
+	{
+		ErrPrintf("pConfig is null\n");
 		return GFSDK_FaceWorks_InvalidArgument;
 	}
 	if (pConfig->m_diffusionRadius <= 0.0f)
@@ -757,7 +2386,80 @@ GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWo
 			pConfig->m_shadowSharpening);
 		return GFSDK_FaceWorks_InvalidArgument;
 	}
+	if (pConfig->m_integrationMode == GFSDK_FaceWorks_LUTIntegration_Convolution)
+	{
+		ErrPrintf("m_integrationMode is GFSDK_FaceWorks_LUTIntegration_Convolution; this is only supported for the curvature LUT\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	GFSDK_FaceWorks_Result res = ValidateLUTFormat(pConfig->m_format, pErrorBlobOut);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
+
+	return ValidateIntegrationRule(pConfig->m_integrationMode, pConfig->m_integrationSampleCount, pErrorBlobOut);
+}
+
+// Integration samples for a shadow LUT.  The samples are the same for every texel,
+// so they're set up once for the whole LUT.
+struct ShadowLUTKernel
+{
+	// Midpoint rule
+	ProfileKernel	m_profile;
+
+	// Piecewise rule: running integrals of z^n for n = 0..3, shared by all the lobes
+	RunningIntegral	m_moments[4];
+
+	// Analytic rule: each lobe's mass above the upper integration bound
+	float			m_upperTails[cLobeCount];
+};
+
+// Parameters shared by all the rows of a shadow LUT
+struct ShadowLUTParams
+{
+	int						m_texWidth;
+	GFSDK_FaceWorks_LUTFormat	m_format;
+	float					m_shadowScale, m_shadowBias;
+	float					m_shadowSharpening;
+	IntegrationRule			m_rule;
+	const ShadowLUTKernel *	m_pKernel;
+};
+
+// The kernel is in the profile's own units, so it only depends on the integration rule
+static void SetupShadowLUTKernel(
+	const IntegrationRule & rule,
+	ShadowLUTKernel * pKernel)
+{
+	switch (rule.m_mode)
+	{
+	case GFSDK_FaceWorks_LUTIntegration_Midpoint:
+	default:
+		BuildProfileKernel(rule.m_sampleCount, -10.0f, 10.0f, &pKernel->m_profile);
+		break;
+
+	case GFSDK_FaceWorks_LUTIntegration_Piecewise:
+		for (int n = 0; n < int(dim(pKernel->m_moments)); ++n)
+		{
+			BuildRunningIntegral(rule.m_sampleCount,
+				[n](double z) { return pow(z, n); },
+				&pKernel->m_moments[n]);
+		}
+		break;
+
+	case GFSDK_FaceWorks_LUTIntegration_Analytic:
+		for (int iLobe = 0; iLobe < cLobeCount; ++iLobe)
+		{
+			static const double rsqrtTwo = 0.7071067811865476;
+			pKernel->m_upperTails[iLobe] = float(0.5 * erfc(10.0 * rsqrtTwo / double(diffusionSigmas[iLobe])));
+		}
+		break;
+	}
+}
 
+static void SetupShadowLUTParams(
+	const GFSDK_FaceWorks_ShadowLUTConfig * pConfig,
+	ShadowLUTKernel * pKernel,
+	ShadowLUTParams * pParams)
+{
 	// The diffusion profile is built assuming a (standard human skin) radius
 	// of 2.7 mm, so the curvatures and shadow widths need to be scaled to generate
 	// a LUT for the user's desired diffusion radius.
@@ -765,78 +2467,475 @@ GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWo
 
 	float shadowRcpWidthMin = diffusionRadiusFactor / pConfig->m_shadowWidthMax;
 	float shadowRcpWidthMax = diffusionRadiusFactor / pConfig->m_shadowWidthMin;
-	float shadowScale = (shadowRcpWidthMax - shadowRcpWidthMin) / float(pConfig->m_texHeight);
-	float shadowBias = shadowRcpWidthMin + 0.5f * shadowScale;
+	pParams->m_shadowScale = (shadowRcpWidthMax - shadowRcpWidthMin) / float(pConfig->m_texHeight);
+	pParams->m_shadowBias = shadowRcpWidthMin + 0.5f * pParams->m_shadowScale;
+
+	pParams->m_texWidth = pConfig->m_texWidth;
+	pParams->m_format = pConfig->m_format;
+	pParams->m_shadowSharpening = pConfig->m_shadowSharpening;
+
+	// Sample points along a line perpendicular to the shadow edge, and integrate
+	// the scattered lighting using the diffusion profile.
+	SetupIntegrationRule(pConfig->m_integrationMode, pConfig->m_integrationSampleCount, &pParams->m_rule);
+
+	// A null kernel leaves it to the caller to set up m_pKernel, so it can be shared
+	if (pKernel)
+		SetupShadowLUTKernel(pParams->m_rule, pKernel);
+	pParams->m_pKernel = pKernel;
+}
 
-	unsigned char * pPx = static_cast<unsigned char *>(pShadowLUTOut);
+// Piecewise rule for one texel of a shadow LUT.  The smoothstep's input is linear in delta,
+// so it's 0 up to one point, a cubic polynomial in delta up to another, and 1 after that.
+// In each lobe's units (z = delta / sigma) the cubic's integral against the Gaussian is
+// a combination of the running integrals of z^n, and the constant part is just the last one.
+static void IntegrateShadowLUTTexelPiecewise(
+	const ShadowLUTParams & params,
+	float posSlope,
+	float posBias,
+	float rgbOut[3])
+{
+	// Ends of the smoothstep ramp, and integration bounds, in mm
+	double rampLower = -double(posBias) / double(posSlope);
+	double rampUpper = (1.0 - double(posBias)) / double(posSlope);
+	double lowerBound = -10.0, upperBound = 10.0;
 
-	// !!!UNDONE: SIMD-ize or GPU-ize all this math
+	const RunningIntegral * moments = params.m_pKernel->m_moments;
+	int cellCount = params.m_rule.m_sampleCount;
+	double rgb[3] = { 0.0, 0.0, 0.0 };
 
-	for (int iY = 0; iY < pConfig->m_texHeight; ++iY)
+	for (int iLobe = 0; iLobe < cLobeCount; ++iLobe)
 	{
-		for (int iX = 0; iX < pConfig->m_texWidth; ++iX)
+		double sigma = double(diffusionSigmas[iLobe]);
+		double zRampLower = min(max(rampLower, lowerBound), upperBound) / sigma;
+		double zRampUpper = min(max(rampUpper, lowerBound), upperBound) / sigma;
+
+		RunningIntegralCoords coordsRampLower, coordsRampUpper, coordsUpper;
+		FindRunningIntegralCoords(cellCount, zRampLower, &coordsRampLower);
+		FindRunningIntegralCoords(cellCount, zRampUpper, &coordsRampUpper);
+		FindRunningIntegralCoords(cellCount, upperBound / sigma, &coordsUpper);
+
+		// Fully lit past the ramp
+		double lit = LookupRunningIntegral(moments[0], coordsUpper) - LookupRunningIntegral(moments[0], coordsRampUpper);
+
+		// On the ramp, smoothstep(t) = 3t^2 - 2t^3 with t = alpha * z + posBias
+		double alpha = double(posSlope) * sigma;
+		double b = double(posBias);
+		double coeffs[4] =
+		{
+			b * b * (3.0 - 2.0 * b),
+			6.0 * alpha * b * (1.0 - b),
+			3.0 * alpha * alpha * (1.0 - 2.0 * b),
+			-2.0 * alpha * alpha * alpha,
+		};
+		for (int n = 0; n < 4; ++n)
+		{
+			lit += coeffs[n] * (LookupRunningIntegral(moments[n], coordsRampUpper) -
+								LookupRunningIntegral(moments[n], coordsRampLower));
+		}
+
+		rgb[0] += diffusionWeightsR[iLobe] * lit;
+		rgb[1] += diffusionWeightsG[iLobe] * lit;
+		rgb[2] += diffusionWeightsB[iLobe] * lit;
+	}
+
+	rgbOut[0] = float(rgb[0]);
+	rgbOut[1] = float(rgb[1]);
+	rgbOut[2] = float(rgb[2]);
+}
+
+// Shadow LUT texels are evaluated a batch at a time along a row, so the analytic rule can run
+// its SIMD kernel across them
+static const int cShadowTexelBatch = 64;
+
+// Calculate texels [iXBegin, iXBegin + count) of row iY of a shadow LUT, as normalized values
+// before conversion to integer format, 3 floats per texel; count is at most cShadowTexelBatch
+static void EvaluateShadowLUTTexels(
+	const ShadowLUTParams & params,
+	int iY,
+	int iXBegin,
+	int count,
+	float * pRGBOut)
+{
+	float rcpWidth = float(iY) * params.m_shadowScale + params.m_shadowBias;
+
+	// Position along the smoothstep is linear in delta
+	float posSlope = rcpWidth * params.m_shadowSharpening;
+
+	// Calculate input position relative to the shadow edge, by approximately
+	// inverting the transfer function of a disc or Gaussian filter.
+	float posBias[cShadowTexelBatch];
+	for (int i = 0; i < count; ++i)
+	{
+		float u = (iXBegin + i + 0.5f) / float(params.m_texWidth);
+		float inputPos = (sqrtf(u) - sqrtf(1.0f - u)) * 0.5f + 0.5f;
+
+		posBias[i] = inputPos * params.m_shadowSharpening +
+					 (-0.5f * params.m_shadowSharpening + 0.5f);
+	}
+
+	// Use smoothstep as an approximation of the transfer function of a
+	// disc or Gaussian filter.
+	float rgb[cShadowTexelBatch][3];
+	switch (params.m_rule.m_mode)
+	{
+	case GFSDK_FaceWorks_LUTIntegration_Midpoint:
+	default:
+		{
+			const ProfileKernel & profile = params.m_pKernel->m_profile;
+			for (int i = 0; i < count; ++i)
+			{
+				GetSimdKernels()->m_pfnIntegrateSmoothstep(
+									posSlope, posBias[i], profile.m_delta,
+									profile.m_weightsR, profile.m_weightsG, profile.m_weightsB,
+									profile.m_sampleCount,
+									rgb[i]);
+			}
+		}
+		break;
+
+	case GFSDK_FaceWorks_LUTIntegration_Piecewise:
+		for (int i = 0; i < count; ++i)
+			IntegrateShadowLUTTexelPiecewise(params, posSlope, posBias[i], rgb[i]);
+		break;
+
+	case GFSDK_FaceWorks_LUTIntegration_Analytic:
+		{
+			// Analytic rule: the same decomposition as the piecewise rule, but with the exact
+			// partial moments of each lobe in place of the running integrals
+			float r[cShadowTexelBatch], g[cShadowTexelBatch], b[cShadowTexelBatch];
+			GetSimdKernels()->m_pfnIntegrateSmoothstepAnalytic(
+								posSlope, posBias, count,
+								diffusionSigmas, params.m_pKernel->m_upperTails,
+								diffusionWeightsR, diffusionWeightsG, diffusionWeightsB, cLobeCount,
+								r, g, b);
+			for (int i = 0; i < count; ++i)
+			{
+				rgb[i][0] = r[i];
+				rgb[i][1] = g[i];
+				rgb[i][2] = b[i];
+			}
+		}
+		break;
+	}
+
+	for (int i = 0; i < count; ++i)
+	{
+		int iX = iXBegin + i;
+		float * pRGB = pRGBOut + 3 * i;
+
+		// Hack in a fade to ensure the left edge of the image goes strictly to zero.
+		if (iX * 25 < params.m_texWidth)
+		{
+			float fade = min(25.0f * float(iX) / float(params.m_texWidth), 1.0f);
+			rgb[i][0] *= fade;
+			rgb[i][1] *= fade;
+			rgb[i][2] *= fade;
+		}
+
+		// Clamp to [0, 1]
+		rgb[i][0] = min(max(rgb[i][0], 0.0f), 1.0f);
+		rgb[i][1] = min(max(rgb[i][1], 0.0f), 1.0f);
+		rgb[i][2] = min(max(rgb[i][2], 0.0f), 1.0f);
+
+		// Convert linear to sRGB, for the formats that have sRGB views
+		if (!IsSRGBLUTFormat(params.m_format))
+		{
+			pRGB[0] = rgb[i][0];
+			pRGB[1] = rgb[i][1];
+			pRGB[2] = rgb[i][2];
+			continue;
+		}
+
+		pRGB[0] = LinearToSRGB(rgb[i][0]);
+		pRGB[1] = LinearToSRGB(rgb[i][1]);
+		pRGB[2] = LinearToSRGB(rgb[i][2]);
+	}
+}
+
+// Generate rows [iYBegin, iYEnd) of a shadow LUT; pPixelsOut points to row iYBegin.
+static void GenerateShadowLUTRows(
+	const ShadowLUTParams & params,
+	int iYBegin,
+	int iYEnd,
+	void * pPixelsOut)
+{
+	unsigned char * pPx = static_cast<unsigned char *>(pPixelsOut);
+
+	for (int iY = iYBegin; iY < iYEnd; ++iY)
+	{
+		for (int iX = 0; iX < params.m_texWidth; iX += cShadowTexelBatch)
 		{
-			// Calculate input position relative to the shadow edge, by approximately
-			// inverting the transfer function of a disc or Gaussian filter.
-			float u = (iX + 0.5f) / float(pConfig->m_texWidth);
-			float inputPos = (sqrtf(u) - sqrtf(1.0f - u)) * 0.5f + 0.5f;
+			int count = min(cShadowTexelBatch, params.m_texWidth - iX);
+			float rgb[3 * cShadowTexelBatch];
+			EvaluateShadowLUTTexels(params, iY, iX, count, rgb);
+
+			// Convert to the output format
+			for (int i = 0; i < count; ++i)
+				pPx = WriteLUTTexel(params.m_format, rgb + 3 * i, pPx);
+		}
+	}
+}
+
+// Generate rows [iYBegin, iYEnd) of a shadow LUT, spread over threads; pPixelsOut points to row iYBegin.
+static void GenerateShadowLUTBlock(
+	const ShadowLUTParams & params,
+	int iYBegin,
+	int iYEnd,
+	void * pPixelsOut,
+	gfsdk_new_delete_t * pAllocator,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	unsigned char * pPixels = static_cast<unsigned char *>(pPixelsOut);
+	size_t rowBytes = GFSDK_FaceWorks_CalculateLUTTexelSizeBytes(params.m_format) * size_t(params.m_texWidth);
+
+	ParallelForRanges(pParallelConfig, iYEnd - iYBegin, [&](int iBegin, int iEnd)
+	{
+		GenerateShadowLUTRows(params, iYBegin + iBegin, iYBegin + iEnd, pPixels + iBegin * rowBytes);
+	}, pAllocator);
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GenerateShadowLUT(
+	const GFSDK_FaceWorks_ShadowLUTConfig * pConfig,
+	void * pShadowLUTOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	gfsdk_new_delete_t * pAllocator,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	// Validate parameters
+	GFSDK_FaceWorks_Result res = ValidateShadowLUTConfig(pConfig, pErrorBlobOut);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
+
+	if (!pShadowLUTOut)
+	{
+		ErrPrintf("pShadowLUTOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	ShadowLUTKernel kernel;
+	ShadowLUTParams params;
+	SetupShadowLUTParams(pConfig, &kernel, &params);
+
+	GenerateShadowLUTBlock(params, 0, pConfig->m_texHeight, pShadowLUTOut, pAllocator, pParallelConfig);
+
+	return GFSDK_FaceWorks_OK;
+}
+
+GFSDK_FaceWorks_Result GenerateShadowLUTFloat(
+	const GFSDK_FaceWorks_ShadowLUTConfig * pConfig,
+	int iYBegin,
+	int iYEnd,
+	float * pRGBOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	gfsdk_new_delete_t * pAllocator,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	// Validate parameters
+	GFSDK_FaceWorks_Result res = ValidateShadowLUTConfig(pConfig, pErrorBlobOut);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
 
-			float rcpWidth = float(iY) * shadowScale + shadowBias;
+	if (iYBegin < 0 || iYEnd > pConfig->m_texHeight || iYBegin > iYEnd)
+	{
+		ErrPrintf("row range [%d, %d) isn't within the LUT's %d rows\n", iYBegin, iYEnd, pConfig->m_texHeight);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
 
-			// Sample points along a line perpendicular to the shadow edge, and
-			// Monte-Carlo-integrate the scattered lighting using the diffusion profile
+	if (!pRGBOut)
+	{
+		ErrPrintf("pRGBOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
 
-			static const int cIter = 200;
-			float rgb[3] = { 0.0f, 0.0f, 0.0f };
+	ShadowLUTKernel kernel;
+	ShadowLUTParams params;
+	SetupShadowLUTParams(pConfig, &kernel, &params);
 
-			float iterScale = 20.0f / float(cIter);
-			float iterBias = -10.0f + 0.5f * iterScale;
+	// Keep the texels linear, as the shaders see them after sampling an sRGB LUT
+	params.m_format = GFSDK_FaceWorks_LUTFormat_RGBA16F;
 
-			for (int iIter = 0; iIter < cIter; ++iIter)
+	ParallelForRanges(pParallelConfig, iYEnd - iYBegin, [&](int iBegin, int iEnd)
+	{
+		for (int iY = iYBegin + iBegin; iY < iYBegin + iEnd; ++iY)
+		{
+			float * pRGB = pRGBOut + 3 * size_t(iY - iYBegin) * size_t(params.m_texWidth);
+			for (int iX = 0; iX < params.m_texWidth; iX += cShadowTexelBatch)
 			{
-				float delta = float(iIter) * iterScale + iterBias;
-				float rgbDiffusion[3];
-				EvaluateDiffusionProfile(delta, rgbDiffusion);
-
-				// Use smoothstep as an approximation of the transfer function of a
-				// disc or Gaussian filter.
-				float newPos = (inputPos + delta * rcpWidth) * pConfig->m_shadowSharpening +
-											(-0.5f * pConfig->m_shadowSharpening + 0.5f);
-				float newPosClamped = min(max(newPos, 0.0f), 1.0f);
-				float newShadow = (3.0f - 2.0f * newPosClamped) * newPosClamped * newPosClamped;
-
-				rgb[0] += newShadow * rgbDiffusion[0];
-				rgb[1] += newShadow * rgbDiffusion[1];
-				rgb[2] += newShadow * rgbDiffusion[2];
+				int count = min(cShadowTexelBatch, params.m_texWidth - iX);
+				EvaluateShadowLUTTexels(params, iY, iX, count, pRGB + 3 * iX);
 			}
+		}
+	}, pAllocator);
+
+	return GFSDK_FaceWorks_OK;
+}
 
-			// Scale sum of samples to get value of integral.  Also hack in a
-			// fade to ensure the left edge of the image goes strictly to zero.
-			float scale = 20.0f / float(cIter);
-			if (iX * 25 < pConfig->m_texWidth)
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_StreamShadowLUT(
+	const GFSDK_FaceWorks_ShadowLUTConfig * pConfig,
+	const GFSDK_FaceWorks_LUTRowSink * pRowSink,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	gfsdk_new_delete_t * pAllocator,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	// Validate parameters
+	GFSDK_FaceWorks_Result res = ValidateShadowLUTConfig(pConfig, pErrorBlobOut);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
+
+	res = ValidateLUTRowSink(pRowSink, pErrorBlobOut);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
+
+	ShadowLUTKernel kernel;
+	ShadowLUTParams params;
+	SetupShadowLUTParams(pConfig, &kernel, &params);
+
+	size_t rowBytes = GFSDK_FaceWorks_CalculateLUTTexelSizeBytes(pConfig->m_format) * size_t(pConfig->m_texWidth);
+	return StreamLUTBlocks(pRowSink, pConfig->m_texHeight, rowBytes, pAllocator,
+		[&](int iYBegin, int iYEnd, void * pBlock)
+		{
+			GenerateShadowLUTBlock(params, iYBegin, iYEnd, pBlock, pAllocator, pParallelConfig);
+			return GFSDK_FaceWorks_OK;
+		});
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_EstimateShadowLUTError(
+	const GFSDK_FaceWorks_ShadowLUTConfig * pConfig,
+	GFSDK_FaceWorks_LUTErrorEstimate * pErrorEstimateOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut)
+{
+	// Validate parameters
+	GFSDK_FaceWorks_Result res = ValidateShadowLUTConfig(pConfig, pErrorBlobOut);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
+
+	if (!pErrorEstimateOut)
+	{
+		ErrPrintf("pErrorEstimateOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	ShadowLUTKernel kernel;
+	ShadowLUTParams params;
+	SetupShadowLUTParams(pConfig, &kernel, &params);
+
+	// Reference: the same LUT evaluated in closed form
+	GFSDK_FaceWorks_ShadowLUTConfig configReference = *pConfig;
+	configReference.m_integrationMode = GFSDK_FaceWorks_LUTIntegration_Analytic;
+	configReference.m_integrationSampleCount = 0;
+	ShadowLUTKernel kernelReference;
+	ShadowLUTParams paramsReference;
+	SetupShadowLUTParams(&configReference, &kernelReference, &paramsReference);
+
+	// Compare whole rows spread evenly over the LUT
+	ErrorEstimateAccumulator accum = {};
+	int rowCount = min(pConfig->m_texHeight, cErrorEstimateRowCount);
+
+	for (int iRow = 0; iRow < rowCount; ++iRow)
+	{
+		int iY = (2 * iRow + 1) * pConfig->m_texHeight / (2 * rowCount);
+
+		for (int iX = 0; iX < pConfig->m_texWidth; iX += cShadowTexelBatch)
+		{
+			int count = min(cShadowTexelBatch, pConfig->m_texWidth - iX);
+			float rgb[3 * cShadowTexelBatch], rgbReference[3 * cShadowTexelBatch];
+			EvaluateShadowLUTTexels(params, iY, iX, count, rgb);
+			EvaluateShadowLUTTexels(paramsReference, iY, iX, count, rgbReference);
+			for (int i = 0; i < count; ++i)
+				AccumulateError(rgb + 3 * i, rgbReference + 3 * i, &accum);
+		}
+	}
+
+	FinishErrorEstimate(accum, pErrorEstimateOut);
+
+	return GFSDK_FaceWorks_OK;
+}
+
+GFSDK_FACEWORKS_API size_t GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_CalculateShadowLUTArraySizeBytes(
+	const GFSDK_FaceWorks_ShadowLUTConfig * pConfigs,
+	int sliceCount)
+{
+	if (!pConfigs)
+		return 0;
+
+	return GFSDK_FaceWorks_CalculateShadowLUTSizeBytes(pConfigs) * size_t(max(0, sliceCount));
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_GenerateShadowLUTArray(
+	const GFSDK_FaceWorks_ShadowLUTConfig * pConfigs,
+	int sliceCount,
+	void * pShadowLUTArrayOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut,
+	gfsdk_new_delete_t * pAllocator,
+	const GFSDK_FaceWorks_ParallelConfig * pParallelConfig)
+{
+	// Validate parameters
+	GFSDK_FaceWorks_Result res = ValidateLUTArrayConfigs(pConfigs, sliceCount, &ValidateShadowLUTConfig, pErrorBlobOut);
+	if (res != GFSDK_FaceWorks_OK)
+		return res;
+
+	if (!pShadowLUTArrayOut)
+	{
+		ErrPrintf("pShadowLUTArrayOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	unsigned char * pPixels = static_cast<unsigned char *>(pShadowLUTArrayOut);
+	int texHeight = pConfigs[0].m_texHeight;
+	size_t rowBytes = GFSDK_FaceWorks_CalculateLUTTexelSizeBytes(pConfigs[0].m_format) * size_t(pConfigs[0].m_texWidth);
+
+	// Catch out-of-memory exceptions
+	try
+	{
+		FaceWorks_Allocator<ShadowLUTParams> allocParams(pAllocator);
+		std::vector<ShadowLUTParams, FaceWorks_Allocator<ShadowLUTParams>> params(allocParams);
+		params.resize(sliceCount);
+
+		// The integration kernel only depends on the integration rule, so it's built once
+		// for each rule used, and shared by all the slices using that rule.  kernelSlices
+		// holds the first slice using each rule.
+		FaceWorks_Allocator<int> allocInt(pAllocator);
+		std::vector<int, FaceWorks_Allocator<int>> kernelSlices(allocInt);
+		for (int iSlice = 0; iSlice < sliceCount; ++iSlice)
+		{
+			SetupShadowLUTParams(&pConfigs[iSlice], nullptr, &params[iSlice]);
+
+			bool shared = false;
+			for (size_t iKernel = 0; iKernel < kernelSlices.size() && !shared; ++iKernel)
+				shared = IsSameIntegrationRule(params[kernelSlices[iKernel]].m_rule, params[iSlice].m_rule);
+			if (!shared)
+				kernelSlices.push_back(iSlice);
+		}
+
+		FaceWorks_Allocator<ShadowLUTKernel> allocKernel(pAllocator);
+		std::vector<ShadowLUTKernel, FaceWorks_Allocator<ShadowLUTKernel>> kernels(allocKernel);
+		kernels.resize(kernelSlices.size());
+		for (size_t iKernel = 0; iKernel < kernelSlices.size(); ++iKernel)
+			SetupShadowLUTKernel(params[kernelSlices[iKernel]].m_rule, &kernels[iKernel]);
+
+		for (int iSlice = 0; iSlice < sliceCount; ++iSlice)
+		{
+			for (size_t iKernel = 0; iKernel < kernelSlices.size(); ++iKernel)
 			{
-				scale *= min(25.0f * float(iX) / float(pConfig->m_texWidth), 1.0f);
+				if (IsSameIntegrationRule(params[kernelSlices[iKernel]].m_rule, params[iSlice].m_rule))
+				{
+					params[iSlice].m_pKernel = &kernels[iKernel];
+					break;
+				}
 			}
-			rgb[0] *= scale;
-			rgb[1] *= scale;
-			rgb[2] *= scale;
-
-			// Clamp to [0, 1]
-			rgb[0] = min(max(rgb[0], 0.0f), 1.0f);
-			rgb[1] = min(max(rgb[1], 0.0f), 1.0f);
-			rgb[2] = min(max(rgb[2], 0.0f), 1.0f);
-
-			// Convert linear to sRGB
-			rgb[0] = (rgb[0] < 0.0031308f) ? (12.92f * rgb[0]) : (1.055f * powf(rgb[0], 1.0f / 2.4f) - 0.055f);
-			rgb[1] = (rgb[1] < 0.0031308f) ? (12.92f * rgb[1]) : (1.055f * powf(rgb[1], 1.0f / 2.4f) - 0.055f);
-			rgb[2] = (rgb[2] < 0.0031308f) ? (12.92f * rgb[2]) : (1.055f * powf(rgb[2], 1.0f / 2.4f) - 0.055f);
-
-			// Convert to integer format
-			*(pPx++) = static_cast<unsigned char>(255.0f * rgb[0] + 0.5f);
-			*(pPx++) = static_cast<unsigned char>(255.0f * rgb[1] + 0.5f);
-			*(pPx++) = static_cast<unsigned char>(255.0f * rgb[2] + 0.5f);
-			*(pPx++) = 255;
 		}
+
+		ParallelForRanges(pParallelConfig, sliceCount * texHeight, [&](int iBegin, int iEnd)
+		{
+			ForEachLUTArraySliceRows(texHeight, iBegin, iEnd, [&](int iSlice, int iYBegin, int iYEnd, int iRowOut)
+			{
+				GenerateShadowLUTRows(params[iSlice], iYBegin, iYEnd, pPixels + iRowOut * rowBytes);
+			});
+		}, pAllocator);
+	}
+	catch (std::bad_alloc)
+	{
+		return GFSDK_FaceWorks_OutOfMemory;
 	}
 
 	return GFSDK_FaceWorks_OK;
@@ -116,6 +116,13 @@ GFSDK_FaceWorks_Result ValidateSSSConfig(
 			"pConfig->m_averageUVScale is %g; should be greater than 0.0\n",
 			pConfig->m_averageUVScale);
 	}
+	if (pConfig->m_lutArraySlice < 0 || pConfig->m_lutArraySlice >= cLUTArraySliceCountMax)
+	{
+		ErrPrintf(
+			"pConfig->m_lutArraySlice is %d; should be in [0, %d)\n",
+			pConfig->m_lutArraySlice, cLUTArraySliceCountMax);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
 
 	return GFSDK_FaceWorks_OK;
 }
@@ -166,6 +173,43 @@ GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWo
 	pCBDataOut->data[0].z = shadowScale / pConfig->m_shadowFilterWidth;
 	pCBDataOut->data[0].w = shadowBias;
 	pCBDataOut->data[1].x = minLevelForBlurredNormal;
+	pCBDataOut->data[2].y = float(pConfig->m_lutArraySlice);
+
+	return GFSDK_FaceWorks_OK;
+}
+
+GFSDK_FACEWORKS_API GFSDK_FaceWorks_Result GFSDK_FACEWORKS_CALLCONV GFSDK_FaceWorks_WriteCBDataForLUTAtlas(
+	const GFSDK_FaceWorks_LUTAtlasLayout * pLayout,
+	GFSDK_FaceWorks_CBData * pCBDataOut,
+	GFSDK_FaceWorks_ErrorBlob * pErrorBlobOut)
+{
+	// Validate params
+
+	if (!pLayout)
+	{
+		ErrPrintf("GFSDK_FaceWorks_WriteCBDataForLUTAtlas: pLayout is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+	if (pLayout->m_lutWidth < 1 || pLayout->m_lutHeight < 1 || pLayout->m_padding < 1 ||
+		pLayout->m_width != 2 * (pLayout->m_lutWidth + 2 * pLayout->m_padding) ||
+		pLayout->m_height != pLayout->m_lutHeight + 2 * pLayout->m_padding)
+	{
+		ErrPrintf(
+			"GFSDK_FaceWorks_WriteCBDataForLUTAtlas: pLayout (%dx%d, LUTs %dx%d, padding %d) isn't a LUT atlas layout\n",
+			pLayout->m_width, pLayout->m_height, pLayout->m_lutWidth, pLayout->m_lutHeight, pLayout->m_padding);
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	if (!pCBDataOut)
+	{
+		ErrPrintf("GFSDK_FaceWorks_WriteCBDataForLUTAtlas: pCBDataOut is null\n");
+		return GFSDK_FaceWorks_InvalidArgument;
+	}
+
+	// The shaders derive each LUT's offset in the atlas from its relative size,
+	// since the padding makes up the rest
+	pCBDataOut->data[2].z = float(pLayout->m_lutWidth) / float(pLayout->m_width);
+	pCBDataOut->data[2].w = float(pLayout->m_lutHeight) / float(pLayout->m_height);
 
 	return GFSDK_FaceWorks_OK;
 }
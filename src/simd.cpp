@@ -0,0 +1,922 @@
+//----------------------------------------------------------------------------------
+// File:        FaceWorks/src/simd.cpp
+// SDK Version: v1.0
+// Email:       gameworks@nvidia.com
+// Site:        http://developer.nvidia.com/
+//
+// Copyright (c) 2014-2016, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------------
+
+
+#include "internal.h"
+
+// Which instruction sets can be compiled in.  MSVC accepts intrinsics for any instruction set
+// without changing the target architecture of the whole file, though its AVX-512 intrinsics
+// need VS2017 15.3 or later.  GCC and Clang accept them in any function marked with a target
+// attribute for that instruction set, so the vector classes and the kernel tables' entry
+// points below are marked, and a default build still gets every kernel for runtime dispatch.
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#	define FACEWORKS_SIMD_X86 1
+#	define FACEWORKS_SIMD_SSE41 1
+#	define FACEWORKS_SIMD_AVX2 1
+#	if !defined(_MSC_VER) || _MSC_VER >= 1911
+#		define FACEWORKS_SIMD_AVX512 1
+#	endif
+#endif
+
+#if defined(_MSC_VER)
+#	define FACEWORKS_SIMD_TARGET(isa)
+#else
+#	define FACEWORKS_SIMD_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+#if defined(_MSC_VER) && FACEWORKS_SIMD_X86
+#	include <intrin.h>
+#elif FACEWORKS_SIMD_X86
+#	include <cpuid.h>
+#	include <immintrin.h>
+#endif
+
+// The kernel templates are compiled for the default target and only run flattened into the
+// entry points below, so GCC's warnings about returning wide vectors from them don't apply.
+// (Its note about passing them as parameters can't be silenced, so helpers take references.)
+// GCC 12's AVX-512 headers also trip its uninitialized-variable warnings (GCC bug 105593).
+#if defined(__GNUC__) && !defined(__clang__) && FACEWORKS_SIMD_X86
+#	pragma GCC diagnostic ignored "-Wpsabi"
+#	if __GNUC__ == 12
+#		pragma GCC diagnostic ignored "-Wuninitialized"
+#		pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#	endif
+#endif
+
+
+
+// Each instruction set is wrapped in a little vector class with the same interface, so the
+// kernels below are written once as templates and instantiated per instruction set.
+// exp() and log() are the Cephes single-precision polynomials, accurate to a couple of ulps
+// over the ranges used here.
+
+template <typename T>
+static inline typename T::V Exp(const typename T::V & a)
+{
+	typename T::V x = T::Min(T::Max(a, T::Set(-87.3365f)), T::Set(88.3762f));
+
+	// Split into 2^n * e^r, with |r| <= ln(2)/2
+	typename T::V n = T::Round(T::Mul(x, T::Set(1.44269504f)));
+	x = T::MulAdd(n, T::Set(-0.693359375f), x);
+	x = T::MulAdd(n, T::Set(2.12194440e-4f), x);
+
+	typename T::V y = T::Set(1.9875691500e-4f);
+	y = T::MulAdd(y, x, T::Set(1.3981999507e-3f));
+	y = T::MulAdd(y, x, T::Set(8.3334519073e-3f));
+	y = T::MulAdd(y, x, T::Set(4.1665795894e-2f));
+	y = T::MulAdd(y, x, T::Set(1.6666665459e-1f));
+	y = T::MulAdd(y, x, T::Set(5.0000001201e-1f));
+	y = T::MulAdd(y, T::Mul(x, x), T::Add(x, T::Set(1.0f)));
+
+	return T::Mul(y, T::Pow2(n));
+}
+
+template <typename T>
+static inline typename T::V Log(const typename T::V & a)
+{
+	// Only valid for positive, normal a
+	typename T::V e;
+	typename T::V m = T::Frexp(a, &e);
+
+	// Shift the mantissa range to [sqrt(0.5), sqrt(2)) so the polynomial is centered on 1
+	typename T::M small = T::Less(m, T::Set(0.707106781f));
+	e = T::Select(small, T::Sub(e, T::Set(1.0f)), e);
+	typename T::V x = T::Sub(T::Select(small, T::Add(m, m), m), T::Set(1.0f));
+
+	typename T::V z = T::Mul(x, x);
+	typename T::V y = T::Set(7.0376836292e-2f);
+	y = T::MulAdd(y, x, T::Set(-1.1514610310e-1f));
+	y = T::MulAdd(y, x, T::Set(1.1676998740e-1f));
+	y = T::MulAdd(y, x, T::Set(-1.2420140846e-1f));
+	y = T::MulAdd(y, x, T::Set(1.4249322787e-1f));
+	y = T::MulAdd(y, x, T::Set(-1.6668057665e-1f));
+	y = T::MulAdd(y, x, T::Set(2.0000714765e-1f));
+	y = T::MulAdd(y, x, T::Set(-2.4999993993e-1f));
+	y = T::MulAdd(y, x, T::Set(3.3333331174e-1f));
+	y = T::Mul(T::Mul(y, x), z);
+
+	y = T::MulAdd(e, T::Set(-2.12194440e-4f), y);
+	y = T::MulAdd(z, T::Set(-0.5f), y);
+	x = T::Add(x, y);
+	return T::MulAdd(e, T::Set(0.693359375f), x);
+}
+
+struct Scalar
+{
+	typedef float V;
+	typedef bool M;
+	enum { width = 1 };
+
+	static V Set(float a)					{ return a; }
+	static V Load(const float * p)			{ return *p; }
+	static void Store(float * p, V a)		{ *p = a; }
+	static V Add(V a, V b)					{ return a + b; }
+	static V Sub(V a, V b)					{ return a - b; }
+	static V Mul(V a, V b)					{ return a * b; }
+	static V MulAdd(V a, V b, V c)			{ return a * b + c; }
+	static V Div(V a, V b)					{ return a / b; }
+	static V Min(V a, V b)					{ return min(a, b); }
+	static V Max(V a, V b)					{ return max(a, b); }
+	static V Sqrt(V a)						{ return sqrtf(a); }
+	static M Less(V a, V b)					{ return a < b; }
+	static M And(M a, M b)					{ return a && b; }
+	static V Select(M m, V a, V b)			{ return m ? a : b; }
+	static float Sum(V a)					{ return a; }
+	static V Exp(V a)						{ return expf(a); }
+	static V Log(V a)						{ return logf(a); }
+};
+
+#if FACEWORKS_SIMD_SSE41
+#define FACEWORKS_SIMD_FN static FACEWORKS_SIMD_TARGET("sse4.1")
+struct SSE41
+{
+	typedef __m128 V;
+	typedef __m128 M;
+	enum { width = 4 };
+
+	FACEWORKS_SIMD_FN V Set(float a)					{ return _mm_set1_ps(a); }
+	FACEWORKS_SIMD_FN V Load(const float * p)			{ return _mm_loadu_ps(p); }
+	FACEWORKS_SIMD_FN void Store(float * p, V a)		{ _mm_storeu_ps(p, a); }
+	FACEWORKS_SIMD_FN V Add(V a, V b)					{ return _mm_add_ps(a, b); }
+	FACEWORKS_SIMD_FN V Sub(V a, V b)					{ return _mm_sub_ps(a, b); }
+	FACEWORKS_SIMD_FN V Mul(V a, V b)					{ return _mm_mul_ps(a, b); }
+	FACEWORKS_SIMD_FN V MulAdd(V a, V b, V c)			{ return _mm_add_ps(_mm_mul_ps(a, b), c); }
+	FACEWORKS_SIMD_FN V Div(V a, V b)					{ return _mm_div_ps(a, b); }
+	FACEWORKS_SIMD_FN V Min(V a, V b)					{ return _mm_min_ps(a, b); }
+	FACEWORKS_SIMD_FN V Max(V a, V b)					{ return _mm_max_ps(a, b); }
+	FACEWORKS_SIMD_FN V Sqrt(V a)						{ return _mm_sqrt_ps(a); }
+	FACEWORKS_SIMD_FN M Less(V a, V b)					{ return _mm_cmplt_ps(a, b); }
+	FACEWORKS_SIMD_FN M And(M a, M b)					{ return _mm_and_ps(a, b); }
+	FACEWORKS_SIMD_FN V Select(M m, V a, V b)			{ return _mm_blendv_ps(b, a, m); }
+	FACEWORKS_SIMD_FN V Round(V a)						{ return _mm_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+	FACEWORKS_SIMD_FN float Sum(V a)
+	{
+		a = _mm_add_ps(a, _mm_movehl_ps(a, a));
+		a = _mm_add_ss(a, _mm_shuffle_ps(a, a, 1));
+		return _mm_cvtss_f32(a);
+	}
+	FACEWORKS_SIMD_FN V Pow2(V n)
+	{
+		__m128i bits = _mm_add_epi32(_mm_cvtps_epi32(n), _mm_set1_epi32(127));
+		return _mm_castsi128_ps(_mm_slli_epi32(bits, 23));
+	}
+	FACEWORKS_SIMD_FN V Frexp(V a, V * pExponent)
+	{
+		__m128i bits = _mm_castps_si128(a);
+		*pExponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(126)));
+		bits = _mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f000000));
+		return _mm_castsi128_ps(bits);
+	}
+	FACEWORKS_SIMD_FN V Exp(V a)						{ return ::Exp<SSE41>(a); }
+	FACEWORKS_SIMD_FN V Log(V a)						{ return ::Log<SSE41>(a); }
+};
+#undef FACEWORKS_SIMD_FN
+#endif // FACEWORKS_SIMD_SSE41
+
+#if FACEWORKS_SIMD_AVX2
+#define FACEWORKS_SIMD_FN static FACEWORKS_SIMD_TARGET("avx2,fma")
+struct AVX2
+{
+	typedef __m256 V;
+	typedef __m256 M;
+	enum { width = 8 };
+
+	FACEWORKS_SIMD_FN V Set(float a)					{ return _mm256_set1_ps(a); }
+	FACEWORKS_SIMD_FN V Load(const float * p)			{ return _mm256_loadu_ps(p); }
+	FACEWORKS_SIMD_FN void Store(float * p, V a)		{ _mm256_storeu_ps(p, a); }
+	FACEWORKS_SIMD_FN V Add(V a, V b)					{ return _mm256_add_ps(a, b); }
+	FACEWORKS_SIMD_FN V Sub(V a, V b)					{ return _mm256_sub_ps(a, b); }
+	FACEWORKS_SIMD_FN V Mul(V a, V b)					{ return _mm256_mul_ps(a, b); }
+	FACEWORKS_SIMD_FN V MulAdd(V a, V b, V c)			{ return _mm256_fmadd_ps(a, b, c); }
+	FACEWORKS_SIMD_FN V Div(V a, V b)					{ return _mm256_div_ps(a, b); }
+	FACEWORKS_SIMD_FN V Min(V a, V b)					{ return _mm256_min_ps(a, b); }
+	FACEWORKS_SIMD_FN V Max(V a, V b)					{ return _mm256_max_ps(a, b); }
+	FACEWORKS_SIMD_FN V Sqrt(V a)						{ return _mm256_sqrt_ps(a); }
+	FACEWORKS_SIMD_FN M Less(V a, V b)					{ return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+	FACEWORKS_SIMD_FN M And(M a, M b)					{ return _mm256_and_ps(a, b); }
+	FACEWORKS_SIMD_FN V Select(M m, V a, V b)			{ return _mm256_blendv_ps(b, a, m); }
+	FACEWORKS_SIMD_FN V Round(V a)						{ return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+	FACEWORKS_SIMD_FN float Sum(V a)
+	{
+		__m128 b = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+		b = _mm_add_ps(b, _mm_movehl_ps(b, b));
+		b = _mm_add_ss(b, _mm_shuffle_ps(b, b, 1));
+		return _mm_cvtss_f32(b);
+	}
+	FACEWORKS_SIMD_FN V Pow2(V n)
+	{
+		__m256i bits = _mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127));
+		return _mm256_castsi256_ps(_mm256_slli_epi32(bits, 23));
+	}
+	FACEWORKS_SIMD_FN V Frexp(V a, V * pExponent)
+	{
+		__m256i bits = _mm256_castps_si256(a);
+		*pExponent = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(126)));
+		bits = _mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)), _mm256_set1_epi32(0x3f000000));
+		return _mm256_castsi256_ps(bits);
+	}
+	FACEWORKS_SIMD_FN V Exp(V a)						{ return ::Exp<AVX2>(a); }
+	FACEWORKS_SIMD_FN V Log(V a)						{ return ::Log<AVX2>(a); }
+};
+#undef FACEWORKS_SIMD_FN
+#endif // FACEWORKS_SIMD_AVX2
+
+#if FACEWORKS_SIMD_AVX512
+#define FACEWORKS_SIMD_FN static FACEWORKS_SIMD_TARGET("avx512f,avx2,fma")
+struct AVX512
+{
+	typedef __m512 V;
+	typedef __mmask16 M;
+	enum { width = 16 };
+
+	FACEWORKS_SIMD_FN V Set(float a)					{ return _mm512_set1_ps(a); }
+	FACEWORKS_SIMD_FN V Load(const float * p)			{ return _mm512_loadu_ps(p); }
+	FACEWORKS_SIMD_FN void Store(float * p, V a)		{ _mm512_storeu_ps(p, a); }
+	FACEWORKS_SIMD_FN V Add(V a, V b)					{ return _mm512_add_ps(a, b); }
+	FACEWORKS_SIMD_FN V Sub(V a, V b)					{ return _mm512_sub_ps(a, b); }
+	FACEWORKS_SIMD_FN V Mul(V a, V b)					{ return _mm512_mul_ps(a, b); }
+	FACEWORKS_SIMD_FN V MulAdd(V a, V b, V c)			{ return _mm512_fmadd_ps(a, b, c); }
+	FACEWORKS_SIMD_FN V Div(V a, V b)					{ return _mm512_div_ps(a, b); }
+	FACEWORKS_SIMD_FN V Min(V a, V b)					{ return _mm512_min_ps(a, b); }
+	FACEWORKS_SIMD_FN V Max(V a, V b)					{ return _mm512_max_ps(a, b); }
+	FACEWORKS_SIMD_FN V Sqrt(V a)						{ return _mm512_sqrt_ps(a); }
+	FACEWORKS_SIMD_FN M Less(V a, V b)					{ return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+	FACEWORKS_SIMD_FN M And(M a, M b)					{ return M(a & b); }
+	FACEWORKS_SIMD_FN V Select(M m, V a, V b)			{ return _mm512_mask_blend_ps(m, b, a); }
+	FACEWORKS_SIMD_FN V Round(V a)						{ return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+	FACEWORKS_SIMD_FN float Sum(V a)					{ return _mm512_reduce_add_ps(a); }
+	FACEWORKS_SIMD_FN V Pow2(V n)
+	{
+		__m512i bits = _mm512_add_epi32(_mm512_cvtps_epi32(n), _mm512_set1_epi32(127));
+		return _mm512_castsi512_ps(_mm512_slli_epi32(bits, 23));
+	}
+	FACEWORKS_SIMD_FN V Frexp(V a, V * pExponent)
+	{
+		__m512i bits = _mm512_castps_si512(a);
+		*pExponent = _mm512_cvtepi32_ps(_mm512_sub_epi32(_mm512_srli_epi32(bits, 23), _mm512_set1_epi32(126)));
+		bits = _mm512_or_si512(_mm512_and_si512(bits, _mm512_set1_epi32(0x007fffff)), _mm512_set1_epi32(0x3f000000));
+		return _mm512_castsi512_ps(bits);
+	}
+	FACEWORKS_SIMD_FN V Exp(V a)						{ return ::Exp<AVX512>(a); }
+	FACEWORKS_SIMD_FN V Log(V a)						{ return ::Log<AVX512>(a); }
+};
+#undef FACEWORKS_SIMD_FN
+#endif // FACEWORKS_SIMD_AVX512
+
+
+
+// Kernels.  Each one runs full vectors as far as it can, then copies the leftover elements into
+// one more vector, padded so the extra lanes have no effect.  Every element then goes through
+// the same instructions wherever it falls in the batch; a scalar tail would round differently
+// from the vector lanes where they use FMA.
+
+template <typename T>
+static void EvaluateGaussianMixture(
+	const float * pX, int count,
+	const float * pSigmas, const float * pWeightsR, const float * pWeightsG, const float * pWeightsB, int lobeCount,
+	float scale, float * pROut, float * pGOut, float * pBOut)
+{
+	typedef typename T::V V;
+	static const float rsqrtTwoPi = 0.39894228f;
+
+	// Lobes are flushed to zero past 10 standard deviations, where they're negligible;
+	// otherwise the far tails of narrow lobes leave denormals, which are very slow
+	static const float exponentMin = -50.0f;
+
+	auto evaluate = [&](const float * pXVec, float * pRVec, float * pGVec, float * pBVec)
+	{
+		V x = T::Load(pXVec);
+		V xSquared = T::Mul(x, x);
+		V r = T::Set(0.0f), g = r, b = r;
+
+		for (int iLobe = 0; iLobe < lobeCount; ++iLobe)
+		{
+			float sigma = pSigmas[iLobe];
+			V exponent = T::Mul(xSquared, T::Set(-0.5f / (sigma*sigma)));
+			V gaussian = T::Select(
+							T::Less(exponent, T::Set(exponentMin)),
+							T::Set(0.0f), T::Mul(T::Set(scale * rsqrtTwoPi / sigma), T::Exp(exponent)));
+			r = T::MulAdd(gaussian, T::Set(pWeightsR[iLobe]), r);
+			g = T::MulAdd(gaussian, T::Set(pWeightsG[iLobe]), g);
+			b = T::MulAdd(gaussian, T::Set(pWeightsB[iLobe]), b);
+		}
+
+		T::Store(pRVec, r);
+		T::Store(pGVec, g);
+		T::Store(pBVec, b);
+	};
+
+	int i = 0;
+	for (; i + T::width <= count; i += T::width)
+		evaluate(pX + i, pROut + i, pGOut + i, pBOut + i);
+
+	if (i < count)
+	{
+		float x[T::width] = {}, r[T::width], g[T::width], b[T::width];
+		int tailCount = count - i;
+		for (int j = 0; j < tailCount; ++j)
+			x[j] = pX[i + j];
+		evaluate(x, r, g, b);
+		for (int j = 0; j < tailCount; ++j)
+		{
+			pROut[i + j] = r[j];
+			pGOut[i + j] = g[j];
+			pBOut[i + j] = b[j];
+		}
+	}
+}
+
+// The sums below pad their last vector with zero weights, so the extra lanes add zero
+
+template <typename T>
+static void IntegrateClampedCosine(
+	float cosTheta, float sinTheta, const float * pCos, const float * pSin,
+	const float * pWeightsR, const float * pWeightsG, const float * pWeightsB, int count,
+	float rgbOut[3])
+{
+	typedef typename T::V V;
+
+	V vecCosTheta = T::Set(cosTheta), vecSinTheta = T::Set(sinTheta);
+	V zero = T::Set(0.0f);
+	V r = zero, g = zero, b = zero;
+
+	auto accumulate = [&](const float * pCosVec, const float * pSinVec, const float * pRVec, const float * pGVec, const float * pBVec)
+	{
+		V cosine = T::MulAdd(vecCosTheta, T::Load(pCosVec), T::Mul(vecSinTheta, T::Load(pSinVec)));
+		V irradiance = T::Max(zero, cosine);
+		r = T::MulAdd(irradiance, T::Load(pRVec), r);
+		g = T::MulAdd(irradiance, T::Load(pGVec), g);
+		b = T::MulAdd(irradiance, T::Load(pBVec), b);
+	};
+
+	int i = 0;
+	for (; i + T::width <= count; i += T::width)
+		accumulate(pCos + i, pSin + i, pWeightsR + i, pWeightsG + i, pWeightsB + i);
+
+	if (i < count)
+	{
+		float tail[5][T::width] = {};
+		for (int j = 0; j < count - i; ++j)
+		{
+			tail[0][j] = pCos[i + j];
+			tail[1][j] = pSin[i + j];
+			tail[2][j] = pWeightsR[i + j];
+			tail[3][j] = pWeightsG[i + j];
+			tail[4][j] = pWeightsB[i + j];
+		}
+		accumulate(tail[0], tail[1], tail[2], tail[3], tail[4]);
+	}
+
+	rgbOut[0] = T::Sum(r);
+	rgbOut[1] = T::Sum(g);
+	rgbOut[2] = T::Sum(b);
+}
+
+template <typename T>
+static void IntegrateSmoothstep(
+	float posSlope, float posBias, const float * pDelta,
+	const float * pWeightsR, const float * pWeightsG, const float * pWeightsB, int count,
+	float rgbOut[3])
+{
+	typedef typename T::V V;
+
+	V vecSlope = T::Set(posSlope), vecBias = T::Set(posBias);
+	V zero = T::Set(0.0f), one = T::Set(1.0f), two = T::Set(2.0f), three = T::Set(3.0f);
+	V r = zero, g = zero, b = zero;
+
+	auto accumulate = [&](const float * pDeltaVec, const float * pRVec, const float * pGVec, const float * pBVec)
+	{
+		V pos = T::Min(one, T::Max(zero, T::MulAdd(T::Load(pDeltaVec), vecSlope, vecBias)));
+		V shadow = T::Mul(T::Mul(pos, pos), T::Sub(three, T::Mul(two, pos)));
+		r = T::MulAdd(shadow, T::Load(pRVec), r);
+		g = T::MulAdd(shadow, T::Load(pGVec), g);
+		b = T::MulAdd(shadow, T::Load(pBVec), b);
+	};
+
+	int i = 0;
+	for (; i + T::width <= count; i += T::width)
+		accumulate(pDelta + i, pWeightsR + i, pWeightsG + i, pWeightsB + i);
+
+	if (i < count)
+	{
+		float tail[4][T::width] = {};
+		for (int j = 0; j < count - i; ++j)
+		{
+			tail[0][j] = pDelta[i + j];
+			tail[1][j] = pWeightsR[i + j];
+			tail[2][j] = pWeightsG[i + j];
+			tail[3][j] = pWeightsB[i + j];
+		}
+		accumulate(tail[0], tail[1], tail[2], tail[3]);
+	}
+
+	rgbOut[0] = T::Sum(r);
+	rgbOut[1] = T::Sum(g);
+	rgbOut[2] = T::Sum(b);
+}
+
+// For the analytic rule, texels go across the lanes, and each lobe's integral over the smoothstep
+// ramp comes from the partial moments of the normal distribution at the ramp's ends.  For z >= 0
+// the moments of t^n over [z, inf) are q, pdf, q + z pdf and (z^2 + 2) pdf, where q is the tail
+// mass; the tail below -z mirrors them, with the odd ones negated.  So each partial moment below z
+// is a signed tail moment, plus the whole moment (1, 0, 1, 0) if z >= 0, and differences of them
+// never cancel the whole moments against each other.  q is erfc by Abramowitz and Stegun 7.1.26,
+// accurate to 1.5e-7, which shares its exponential with the pdf.
+
+template <typename T>
+static void IntegrateSmoothstepAnalytic(
+	float posSlope, const float * pPosBias, int count,
+	const float * pSigmas, const float * pUpperTails,
+	const float * pWeightsR, const float * pWeightsG, const float * pWeightsB, int lobeCount,
+	float * pROut, float * pGOut, float * pBOut)
+{
+	typedef typename T::V V;
+	static const float rsqrtTwo = 0.70710678f;
+	static const float rsqrtTwoPi = 0.39894228f;
+
+	V zero = T::Set(0.0f), one = T::Set(1.0f), two = T::Set(2.0f), three = T::Set(3.0f);
+	V lowerBound = T::Set(-10.0f), upperBound = T::Set(10.0f);
+	V rcpSlope = T::Set(1.0f / posSlope);
+
+	// Each partial moment below z, less the whole moment if z >= 0.  The tails past 9 standard
+	// deviations are below 1e-17, so |z| is limited to that, keeping clear of denormals.
+	auto tailTerms = [&](const V & z, V terms[4])
+	{
+		V a = T::Min(T::Max(z, T::Sub(zero, z)), T::Set(9.0f));
+		V x = T::Mul(a, T::Set(rsqrtTwo));
+		V gaussian = T::Exp(T::Mul(T::Sub(zero, x), x));
+		V t = T::Div(one, T::MulAdd(x, T::Set(0.3275911f), one));
+		V poly = T::Set(1.061405429f);
+		poly = T::MulAdd(poly, t, T::Set(-1.453152027f));
+		poly = T::MulAdd(poly, t, T::Set(1.421413741f));
+		poly = T::MulAdd(poly, t, T::Set(-0.284496736f));
+		poly = T::MulAdd(poly, t, T::Set(0.254829592f));
+		V q = T::Mul(T::Mul(poly, t), T::Mul(gaussian, T::Set(0.5f)));
+		V pdf = T::Mul(gaussian, T::Set(rsqrtTwoPi));
+		V sign = T::Select(T::Less(z, zero), one, T::Set(-1.0f));
+		terms[0] = T::Mul(sign, q);
+		terms[1] = T::Sub(zero, pdf);
+		terms[2] = T::Mul(sign, T::MulAdd(a, pdf, q));
+		terms[3] = T::Sub(zero, T::Mul(T::MulAdd(a, a, two), pdf));
+	};
+
+	auto evaluate = [&](const float * pBiasVec, float * pRVec, float * pGVec, float * pBVec)
+	{
+		V bias = T::Load(pBiasVec);
+
+		// Ends of the smoothstep ramp, in mm, limited to the integration bounds
+		V rampLower = T::Min(upperBound, T::Max(lowerBound, T::Mul(T::Sub(zero, bias), rcpSlope)));
+		V rampUpper = T::Min(upperBound, T::Max(lowerBound, T::Mul(T::Sub(one, bias), rcpSlope)));
+
+		// On the ramp, smoothstep(t) = 3t^2 - 2t^3 with t = alpha * z + bias, a cubic in z
+		// with coefficients c0, alpha c1, alpha^2 c2 and -2 alpha^3
+		V c0 = T::Mul(T::Mul(bias, bias), T::Sub(three, T::Add(bias, bias)));
+		V c1 = T::Mul(T::Set(6.0f), T::Mul(bias, T::Sub(one, bias)));
+		V c2 = T::Mul(three, T::Sub(one, T::Add(bias, bias)));
+
+		V r = zero, g = zero, b = zero;
+		for (int iLobe = 0; iLobe < lobeCount; ++iLobe)
+		{
+			float sigma = pSigmas[iLobe];
+			float alpha = posSlope * sigma;
+			V rcpSigma = T::Set(1.0f / sigma);
+			V zLower = T::Mul(rampLower, rcpSigma), zUpper = T::Mul(rampUpper, rcpSigma);
+
+			V lower[4], upper[4];
+			tailTerms(zLower, lower);
+			tailTerms(zUpper, upper);
+
+			// The whole moments come in where the ramp straddles zero
+			V upperBelowZero = T::Select(T::Less(zUpper, zero), one, zero);
+			V straddle = T::Sub(T::Select(T::Less(zLower, zero), one, zero), upperBelowZero);
+
+			// Fully lit from the top of the ramp to the upper bound
+			V lit = T::Sub(T::Sub(upperBelowZero, T::Set(pUpperTails[iLobe])), upper[0]);
+
+			V ramp = T::Mul(T::Set(-2.0f * alpha), T::Sub(upper[3], lower[3]));
+			ramp = T::Mul(T::Set(alpha), T::MulAdd(c2, T::Add(T::Sub(upper[2], lower[2]), straddle), ramp));
+			ramp = T::Mul(T::Set(alpha), T::MulAdd(c1, T::Sub(upper[1], lower[1]), ramp));
+			lit = T::Add(lit, T::MulAdd(c0, T::Add(T::Sub(upper[0], lower[0]), straddle), ramp));
+
+			r = T::MulAdd(lit, T::Set(pWeightsR[iLobe]), r);
+			g = T::MulAdd(lit, T::Set(pWeightsG[iLobe]), g);
+			b = T::MulAdd(lit, T::Set(pWeightsB[iLobe]), b);
+		}
+
+		T::Store(pRVec, r);
+		T::Store(pGVec, g);
+		T::Store(pBVec, b);
+	};
+
+	int i = 0;
+	for (; i + T::width <= count; i += T::width)
+		evaluate(pPosBias + i, pROut + i, pGOut + i, pBOut + i);
+
+	if (i < count)
+	{
+		float bias[T::width] = {}, r[T::width], g[T::width], b[T::width];
+		int tailCount = count - i;
+		for (int j = 0; j < tailCount; ++j)
+			bias[j] = pPosBias[i + j];
+		evaluate(bias, r, g, b);
+		for (int j = 0; j < tailCount; ++j)
+		{
+			pROut[i + j] = r[j];
+			pGOut[i + j] = g[j];
+			pBOut[i + j] = b[j];
+		}
+	}
+}
+
+// Mesh data is indexed, so vertex attributes are gathered into SoA form one lane at a time
+// and the math is done across full vectors.  A partial last vector repeats its first element
+// in the spare lanes, so they stay well-defined, and only the real lanes are stored.
+static inline const float * Attribute(const void * pBase, int strideBytes, int iVert)
+{
+	return (const float *)((const char *)pBase + ptrdiff_t(iVert) * strideBytes);
+}
+
+template <typename T>
+static inline void StoreLanes(float * pOut, const typename T::V & a, int laneCount)
+{
+	if (laneCount == T::width)
+	{
+		T::Store(pOut, a);
+		return;
+	}
+
+	float lanes[T::width];
+	T::Store(lanes, a);
+	for (int iLane = 0; iLane < laneCount; ++iLane)
+		pOut[iLane] = lanes[iLane];
+}
+
+template <typename T>
+static void CalculateEdgeCurvatures(
+	const void * pPositions, int positionStrideBytes,
+	const void * pNormals, int normalStrideBytes,
+	const int * pEdgeVerts, int edgeCount,
+	float * pCurvaturesOut)
+{
+	typedef typename T::V V;
+
+	for (int i = 0; i < edgeCount; i += T::width)
+	{
+		int laneCount = min(int(T::width), edgeCount - i);
+
+		// dP[3], dN[3] for each lane
+		float deltas[6][T::width];
+		for (int iLane = 0; iLane < T::width; ++iLane)
+		{
+			int iEdge = i + ((iLane < laneCount) ? iLane : 0);
+			int iVert0 = pEdgeVerts[2 * iEdge];
+			int iVert1 = pEdgeVerts[2 * iEdge + 1];
+			const float * pPos0 = Attribute(pPositions, positionStrideBytes, iVert0);
+			const float * pPos1 = Attribute(pPositions, positionStrideBytes, iVert1);
+			const float * pNormal0 = Attribute(pNormals, normalStrideBytes, iVert0);
+			const float * pNormal1 = Attribute(pNormals, normalStrideBytes, iVert1);
+			for (int j = 0; j < 3; ++j)
+			{
+				deltas[j][iLane] = pPos1[j] - pPos0[j];
+				deltas[3 + j][iLane] = pNormal1[j] - pNormal0[j];
+			}
+		}
+
+		V dPx = T::Load(deltas[0]), dPy = T::Load(deltas[1]), dPz = T::Load(deltas[2]);
+		V dNx = T::Load(deltas[3]), dNy = T::Load(deltas[4]), dNz = T::Load(deltas[5]);
+		V dPLengthSq = T::MulAdd(dPz, dPz, T::MulAdd(dPy, dPy, T::Mul(dPx, dPx)));
+		V dNLengthSq = T::MulAdd(dNz, dNz, T::MulAdd(dNy, dNy, T::Mul(dNx, dNx)));
+		StoreLanes<T>(pCurvaturesOut + i, T::Sqrt(T::Div(dNLengthSq, dPLengthSq)), laneCount);
+	}
+}
+
+template <typename T>
+static void CalculateTriangleDiametersSq(
+	const void * pPositions, int positionStrideBytes,
+	const int * pIndices, int triCount,
+	float * pDiametersSqOut)
+{
+	typedef typename T::V V;
+
+	V zero = T::Set(0.0f);
+
+	for (int i = 0; i < triCount; i += T::width)
+	{
+		int laneCount = min(int(T::width), triCount - i);
+
+		// Edge vectors for each lane
+		float edges[9][T::width];
+		for (int iLane = 0; iLane < T::width; ++iLane)
+		{
+			const int * pTri = &pIndices[3 * (i + ((iLane < laneCount) ? iLane : 0))];
+			const float * pPos[3];
+			for (int iVert = 0; iVert < 3; ++iVert)
+				pPos[iVert] = Attribute(pPositions, positionStrideBytes, pTri[iVert]);
+			for (int iEdge = 0; iEdge < 3; ++iEdge)
+			{
+				int iVert0 = iEdge, iVert1 = (iEdge + 1) % 3;
+				for (int j = 0; j < 3; ++j)
+					edges[3 * iEdge + j][iLane] = pPos[iVert1][j] - pPos[iVert0][j];
+			}
+		}
+
+		// Squared diameter of each triangle (longest edge)
+		V diameterSq = zero;
+		for (int iEdge = 0; iEdge < 3; ++iEdge)
+		{
+			V x = T::Load(edges[3 * iEdge]), y = T::Load(edges[3 * iEdge + 1]), z = T::Load(edges[3 * iEdge + 2]);
+			diameterSq = T::Max(diameterSq, T::MulAdd(z, z, T::MulAdd(y, y, T::Mul(x, x))));
+		}
+		StoreLanes<T>(pDiametersSqOut + i, diameterSq, laneCount);
+	}
+}
+
+template <typename T>
+static void SumTriangleLogUVScales(
+	const void * pPositions, int positionStrideBytes,
+	const float * pDiametersSq,
+	const void * pUVs, int uvStrideBytes,
+	const int * pIndices, int triCount,
+	float * pLogUVScaleSumOut, int * pTriCountOut)
+{
+	typedef typename T::V V;
+	typedef typename T::M M;
+
+	V zero = T::Set(0.0f), one = T::Set(1.0f);
+	V epsilonSq = T::Set(1e-12f);
+	V logSum = zero, validCount = zero;
+
+	for (int i = 0; i < triCount; i += T::width)
+	{
+		int laneCount = min(int(T::width), triCount - i);
+
+		// Edge vectors in position and UV space for each lane; the position-space ones aren't
+		// needed if the diameters were calculated up front.  Spare lanes get zero-sized
+		// triangles, which are skipped as degenerate.
+		float edges[15][T::width] = {};
+		float diametersSq[T::width] = {};
+		for (int iLane = 0; iLane < laneCount; ++iLane)
+		{
+			const int * pTri = &pIndices[3 * (i + iLane)];
+			const float * pPos[3], * pUV[3];
+			for (int iVert = 0; iVert < 3; ++iVert)
+			{
+				pPos[iVert] = pDiametersSq ? nullptr : Attribute(pPositions, positionStrideBytes, pTri[iVert]);
+				pUV[iVert] = Attribute(pUVs, uvStrideBytes, pTri[iVert]);
+			}
+			for (int iEdge = 0; iEdge < 3; ++iEdge)
+			{
+				int iVert0 = iEdge, iVert1 = (iEdge + 1) % 3;
+				if (!pDiametersSq)
+				{
+					for (int j = 0; j < 3; ++j)
+						edges[3 * iEdge + j][iLane] = pPos[iVert1][j] - pPos[iVert0][j];
+				}
+				for (int j = 0; j < 2; ++j)
+					edges[9 + 2 * iEdge + j][iLane] = pUV[iVert1][j] - pUV[iVert0][j];
+			}
+			if (pDiametersSq)
+				diametersSq[iLane] = pDiametersSq[i + iLane];
+		}
+
+		// Squared diameter of each triangle in both spaces (longest edge)
+		V diameterSq = zero, uvDiameterSq = zero;
+		for (int iEdge = 0; iEdge < 3; ++iEdge)
+		{
+			if (!pDiametersSq)
+			{
+				V x = T::Load(edges[3 * iEdge]), y = T::Load(edges[3 * iEdge + 1]), z = T::Load(edges[3 * iEdge + 2]);
+				diameterSq = T::Max(diameterSq, T::MulAdd(z, z, T::MulAdd(y, y, T::Mul(x, x))));
+			}
+			V u = T::Load(edges[9 + 2 * iEdge]), v = T::Load(edges[9 + 2 * iEdge + 1]);
+			uvDiameterSq = T::Max(uvDiameterSq, T::MulAdd(v, v, T::Mul(u, u)));
+		}
+		if (pDiametersSq)
+			diameterSq = T::Load(diametersSq);
+
+		// Skip degenerate triangles
+		M valid = T::And(T::Less(epsilonSq, diameterSq), T::Less(epsilonSq, uvDiameterSq));
+		V safeRatio = T::Select(valid, T::Div(diameterSq, uvDiameterSq), one);
+
+		// log(diameter / uvDiameter) = 0.5 * log(diameter^2 / uvDiameter^2)
+		logSum = T::MulAdd(T::Log(safeRatio), T::Select(valid, T::Set(0.5f), zero), logSum);
+		validCount = T::Add(validCount, T::Select(valid, one, zero));
+	}
+
+	*pLogUVScaleSumOut = T::Sum(logSum);
+	*pTriCountOut = int(T::Sum(validCount));
+}
+
+
+
+// Kernel table entry points.  MSVC can point straight at the kernels.  GCC and Clang compile the
+// kernel templates for the default target, so each entry point is a wrapper marked with its
+// vector class's instruction sets, which flattens the kernel and the vector class into itself.
+
+#if defined(_MSC_VER)
+
+#define FACEWORKS_SIMD_ENTRY(T, kernel) &kernel<T>
+
+#else
+
+template <typename T, typename Fn, Fn * pfn> struct SimdEntry;
+
+template <typename T, typename... Args, void (*pfn)(Args...)>
+struct SimdEntry<T, void(Args...), pfn>
+{
+	static void Run(Args... args)			{ pfn(args...); }
+};
+
+#define FACEWORKS_SIMD_TARGET_ENTRY(T, isa) \
+	template <typename... Args, void (*pfn)(Args...)> \
+	struct SimdEntry<T, void(Args...), pfn> \
+	{ \
+		static FACEWORKS_SIMD_TARGET(isa) __attribute__((flatten)) void Run(Args... args) { pfn(args...); } \
+	};
+
+#if FACEWORKS_SIMD_SSE41
+FACEWORKS_SIMD_TARGET_ENTRY(SSE41, "sse4.1")
+#endif
+#if FACEWORKS_SIMD_AVX2
+FACEWORKS_SIMD_TARGET_ENTRY(AVX2, "avx2,fma")
+#endif
+#if FACEWORKS_SIMD_AVX512
+FACEWORKS_SIMD_TARGET_ENTRY(AVX512, "avx512f,avx2,fma")
+#endif
+
+#undef FACEWORKS_SIMD_TARGET_ENTRY
+
+#define FACEWORKS_SIMD_ENTRY(T, kernel) &SimdEntry<T, decltype(kernel<T>), &kernel<T>>::Run
+
+#endif
+
+// Kernel tables; aggregate-initialized so they're ready before any dynamic initialization runs
+
+#define FACEWORKS_SIMD_KERNELS(T, name) \
+	{ \
+		name, \
+		FACEWORKS_SIMD_ENTRY(T, EvaluateGaussianMixture), \
+		FACEWORKS_SIMD_ENTRY(T, IntegrateClampedCosine), \
+		FACEWORKS_SIMD_ENTRY(T, IntegrateSmoothstep), \
+		FACEWORKS_SIMD_ENTRY(T, IntegrateSmoothstepAnalytic), \
+		FACEWORKS_SIMD_ENTRY(T, CalculateEdgeCurvatures), \
+		FACEWORKS_SIMD_ENTRY(T, CalculateTriangleDiametersSq), \
+		FACEWORKS_SIMD_ENTRY(T, SumTriangleLogUVScales), \
+	}
+
+static const SimdKernels s_kernelsScalar = FACEWORKS_SIMD_KERNELS(Scalar, "scalar");
+#if FACEWORKS_SIMD_SSE41
+static const SimdKernels s_kernelsSSE41 = FACEWORKS_SIMD_KERNELS(SSE41, "SSE4.1");
+#endif
+#if FACEWORKS_SIMD_AVX2
+static const SimdKernels s_kernelsAVX2 = FACEWORKS_SIMD_KERNELS(AVX2, "AVX2");
+#endif
+#if FACEWORKS_SIMD_AVX512
+static const SimdKernels s_kernelsAVX512 = FACEWORKS_SIMD_KERNELS(AVX512, "AVX-512");
+#endif
+
+#undef FACEWORKS_SIMD_KERNELS
+#undef FACEWORKS_SIMD_ENTRY
+
+
+
+// CPU feature detection
+
+#if FACEWORKS_SIMD_X86
+
+static void CPUID(int leaf, int subleaf, unsigned int regs[4])
+{
+#if defined(_MSC_VER)
+	__cpuidex((int *)regs, leaf, subleaf);
+#else
+	__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// Which register state the OS saves on context switch
+static unsigned long long XGETBV()
+{
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	unsigned int lo, hi;
+	__asm__ __volatile__ ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+	return (unsigned long long)hi << 32 | lo;
+#endif
+}
+
+static bool IsSimdLevelSupportedByCPU(SimdLevel level)
+{
+	unsigned int regs[4];
+	CPUID(0, 0, regs);
+	unsigned int maxLeaf = regs[0];
+	if (maxLeaf < 1)
+		return level == SimdLevel_Scalar;
+
+	CPUID(1, 0, regs);
+	unsigned int features1 = regs[2];
+	bool sse41 = (features1 & (1u << 19)) != 0;
+	if (level <= SimdLevel_SSE41)
+		return level == SimdLevel_Scalar || sse41;
+
+	// AVX needs the OS to save YMM state as well as the CPU supporting it
+	bool fma = (features1 & (1u << 12)) != 0;
+	bool osxsave = (features1 & (1u << 27)) != 0;
+	bool avx = (features1 & (1u << 28)) != 0;
+	if (!sse41 || !fma || !osxsave || !avx || maxLeaf < 7)
+		return false;
+
+	unsigned long long xcr0 = XGETBV();
+	if ((xcr0 & 0x06) != 0x06)
+		return false;
+
+	CPUID(7, 0, regs);
+	unsigned int features7 = regs[1];
+	bool avx2 = (features7 & (1u << 5)) != 0;
+	if (level == SimdLevel_AVX2)
+		return avx2;
+
+	// AVX-512 also needs opmask and ZMM state
+	bool avx512f = (features7 & (1u << 16)) != 0;
+	return avx2 && avx512f && (xcr0 & 0xe6) == 0xe6;
+}
+
+#else // FACEWORKS_SIMD_X86
+
+static bool IsSimdLevelSupportedByCPU(SimdLevel level)
+{
+	return level == SimdLevel_Scalar;
+}
+
+#endif // FACEWORKS_SIMD_X86
+
+const SimdKernels * GetSimdKernelsForLevel(SimdLevel level)
+{
+	if (!IsSimdLevelSupportedByCPU(level))
+		return nullptr;
+
+	switch (level)
+	{
+	case SimdLevel_Scalar:	return &s_kernelsScalar;
+#if FACEWORKS_SIMD_SSE41
+	case SimdLevel_SSE41:	return &s_kernelsSSE41;
+#endif
+#if FACEWORKS_SIMD_AVX2
+	case SimdLevel_AVX2:	return &s_kernelsAVX2;
+#endif
+#if FACEWORKS_SIMD_AVX512
+	case SimdLevel_AVX512:	return &s_kernelsAVX512;
+#endif
+	default:				return nullptr;
+	}
+}
+
+static const SimdKernels * SelectSimdKernels()
+{
+	for (int level = SimdLevel_Count - 1; level > SimdLevel_Scalar; --level)
+	{
+		if (const SimdKernels * pKernels = GetSimdKernelsForLevel(SimdLevel(level)))
+			return pKernels;
+	}
+	return &s_kernelsScalar;
+}
+
+// Picked once when the library is loaded, so there's no race on first use
+static const SimdKernels * s_pSimdKernels = SelectSimdKernels();
+
+const SimdKernels * GetSimdKernels()
+{
+	return s_pSimdKernels;
+}